@@ -0,0 +1,484 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <math.h>
+
+#include "animation.h"
+#include "deepzoom.h"
+#include "threadpool.h"
+#include "platform.h"
+
+//a frame pixel spans up to four lattice samples, plus one either side it only partly covers
+#define ANIMATION_MAX_TAPS 6
+#define ANIMATION_ROWS_PER_TASK 8
+#define ANIMATION_KEY_MARGIN 32		//key frames reach a frame width over this past the frame on every side
+
+bool AnimationPathLoad(const char* Path, struct AnimationPath* restrict AnimationPath)
+{
+	memset(AnimationPath, 0, sizeof(struct AnimationPath));
+
+	FILE* File = fopen(Path, "r");
+	if (File == NULL)
+	{
+		fprintf(stderr, "unable to open %s\n", Path);
+		return false;
+	}
+
+	uint32_t Capacity = 0;
+	char Line[512];
+	uint32_t LineNumber = 0;
+	bool bOk = true;
+	while (bOk && fgets(Line, sizeof(Line), File))
+	{
+		LineNumber++;
+		char* Comment = strchr(Line, '#');
+		if (Comment)
+			*Comment = '\0';
+
+		struct AnimationKeyframe Keyframe;
+		memset(&Keyframe, 0, sizeof(Keyframe));
+		char SetName[64];
+		char TypeName[64];
+		const int Fields = sscanf(Line, "%lf %63s %63s %lf %lf %lf %lf %lf",
+			&Keyframe.Time, SetName, TypeName, &Keyframe.Scale,
+			&Keyframe.Centre[0], &Keyframe.Centre[1], &Keyframe.JuliaPos[0], &Keyframe.JuliaPos[1]);
+		if (Fields <= 0)
+			continue;
+
+		int Set = 0;
+		while (Set < FRACTAL_SET_COUNT && Fields >= 2 && strcmp(SetName, FractalFormulas[Set].Name) != 0)
+		{
+			Set++;
+		}
+		Keyframe.Set = (enum FractalSet)Set;
+		Keyframe.Type = Fields >= 3 && strcmp(TypeName, "julia") == 0 ? FRACTAL_TYPE_JULIA : FRACTAL_TYPE_BASE;
+
+		bOk = (Fields == 6 || Fields == 8)
+			&& Set != FRACTAL_SET_COUNT
+			&& (strcmp(TypeName, "base") == 0 || strcmp(TypeName, "julia") == 0)
+			&& Keyframe.Scale > 0.0
+			&& (AnimationPath->Count == 0 || Keyframe.Time > AnimationPath->Keyframes[AnimationPath->Count - 1].Time);
+		if (!bOk)
+		{
+			fprintf(stderr, "%s:%u: expected TIME SET base|julia SCALE X Y [JULIA_X JULIA_Y] with increasing times\n", Path, LineNumber);
+			break;
+		}
+
+		if (AnimationPath->Count == Capacity)
+		{
+			Capacity = max(Capacity * 2, 16u);
+			AnimationPath->Keyframes = realloc(AnimationPath->Keyframes, Capacity * sizeof(struct AnimationKeyframe));
+			CHECK_ALLOC(AnimationPath->Keyframes);
+		}
+		AnimationPath->Keyframes[AnimationPath->Count++] = Keyframe;
+	}
+	fclose(File);
+
+	if (bOk && AnimationPath->Count == 0)
+	{
+		fprintf(stderr, "%s has no keyframes\n", Path);
+		bOk = false;
+	}
+	if (!bOk)
+		AnimationPathRelease(AnimationPath);
+	return bOk;
+}
+
+void AnimationPathRelease(struct AnimationPath* restrict AnimationPath)
+{
+	free(AnimationPath->Keyframes);
+	AnimationPath->Keyframes = NULL;
+	AnimationPath->Count = 0;
+}
+
+void AnimationPathGetView(const struct AnimationPath* restrict AnimationPath, double Time, struct CpuView* restrict View)
+{
+	const struct AnimationKeyframe* Keyframes = AnimationPath->Keyframes;
+	uint32_t Next = 0;
+	while (Next < AnimationPath->Count && Keyframes[Next].Time <= Time)
+	{
+		Next++;
+	}
+
+	const struct AnimationKeyframe* a = &Keyframes[Next == 0 ? 0 : Next - 1];
+	const struct AnimationKeyframe* b = Next < AnimationPath->Count ? &Keyframes[Next] : a;
+	const double t = b != a ? (Time - a->Time) / (b->Time - a->Time) : 0.0;
+
+	//with the scale moving geometrically, a centre that moves in proportion to the
+	//scale covers the same part of the frame every frame
+	const double Scale = a->Scale * pow(b->Scale / a->Scale, t);
+	const double Progress = a->Scale != b->Scale ? (a->Scale - Scale) / (a->Scale - b->Scale) : t;
+
+	View->Set = a->Set;
+	View->Type = a->Type;
+	View->WindowPos[0] = Scale;
+	View->WindowPos[1] = Scale * View->Height / View->Width;
+	View->WindowPos[2] = a->Centre[0] + (b->Centre[0] - a->Centre[0]) * Progress;
+	View->WindowPos[3] = a->Centre[1] + (b->Centre[1] - a->Centre[1]) * Progress;
+	View->JuliaPos[0] = a->JuliaPos[0] + (b->JuliaPos[0] - a->JuliaPos[0]) * t;
+	View->JuliaPos[1] = a->JuliaPos[1] + (b->JuliaPos[1] - a->JuliaPos[1]) * t;
+}
+
+//the lattice samples that make up each frame pixel along one axis, weighted by how much of the pixel they cover
+struct ResampleTaps
+{
+	uint32_t First;
+	uint32_t Count;
+	float Weights[ANIMATION_MAX_TAPS];
+};
+
+//the lattice covers every footprint, see CpuRenderFrameLattice, so no tap falls outside it
+static void GetResampleTaps(double FrameOrigin, double FrameStep, uint32_t FrameCount, double LatticeOrigin, double LatticeStep, struct ResampleTaps* restrict Taps)
+{
+	//in lattice units where sample j covers [j, j + 1)
+	const double Width = FrameStep / LatticeStep;
+	for (uint32_t i = 0; i < FrameCount; i++)
+	{
+		const double Low = (FrameOrigin + (i - 0.5) * FrameStep - LatticeOrigin) / LatticeStep + 0.5;
+		const double High = Low + Width;
+		const int64_t First = (int64_t)floor(Low);
+
+		Taps[i].First = (uint32_t)First;
+		Taps[i].Count = 0;
+		for (int64_t j = First; j < High && Taps[i].Count < ANIMATION_MAX_TAPS; j++)
+		{
+			Taps[i].Weights[Taps[i].Count++] = (float)((fmin(High, (double)(j + 1)) - fmax(Low, (double)j)) / Width);
+		}
+	}
+}
+
+struct ResampleContext
+{
+	const uint8_t* SampleRgba;
+	uint32_t SampleWidth;
+	const struct ResampleTaps* ColumnTaps;
+	const struct ResampleTaps* RowTaps;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t FirstColumn;	//lattice columns the frame uses
+	uint32_t ColumnCount;
+	float* Scratch;			//ColumnCount * 3 floats per thread
+	uint8_t* Frame;			//rgb24
+};
+
+//box filters the lattice colours down onto a few rows of the frame, columns of
+//the lattice rows first, then across
+static void ResampleRows(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	const struct ResampleContext* Resample = Context;
+	float* restrict Columns = Resample->Scratch + (size_t)ThreadIndex * Resample->ColumnCount * 3;
+
+	const uint32_t FirstY = TaskIndex * ANIMATION_ROWS_PER_TASK;
+	const uint32_t LastY = min(FirstY + ANIMATION_ROWS_PER_TASK, Resample->Height);
+	for (uint32_t y = FirstY; y < LastY; y++)
+	{
+		const struct ResampleTaps* RowTaps = &Resample->RowTaps[y];
+		memset(Columns, 0, (size_t)Resample->ColumnCount * 3 * sizeof(float));
+		for (uint32_t Tap = 0; Tap < RowTaps->Count; Tap++)
+		{
+			const float Weight = RowTaps->Weights[Tap];
+			const uint8_t* restrict In = Resample->SampleRgba + ((size_t)(RowTaps->First + Tap) * Resample->SampleWidth + Resample->FirstColumn) * 4;
+			for (uint32_t x = 0; x < Resample->ColumnCount; x++)
+			{
+				Columns[x * 3 + 0] += In[x * 4 + 0] * Weight;
+				Columns[x * 3 + 1] += In[x * 4 + 1] * Weight;
+				Columns[x * 3 + 2] += In[x * 4 + 2] * Weight;
+			}
+		}
+
+		uint8_t* restrict Out = Resample->Frame + (size_t)y * Resample->Width * 3;
+		for (uint32_t x = 0; x < Resample->Width; x++)
+		{
+			const struct ResampleTaps* ColumnTaps = &Resample->ColumnTaps[x];
+			const float* restrict Source = Columns + (size_t)(ColumnTaps->First - Resample->FirstColumn) * 3;
+			float Color[3] = { 0.0f, 0.0f, 0.0f };
+			for (uint32_t Tap = 0; Tap < ColumnTaps->Count; Tap++)
+			{
+				Color[0] += Source[Tap * 3 + 0] * ColumnTaps->Weights[Tap];
+				Color[1] += Source[Tap * 3 + 1] * ColumnTaps->Weights[Tap];
+				Color[2] += Source[Tap * 3 + 2] * ColumnTaps->Weights[Tap];
+			}
+			Out[x * 3 + 0] = (uint8_t)fminf(Color[0] + 0.5f, 255.0f);
+			Out[x * 3 + 1] = (uint8_t)fminf(Color[1] + 0.5f, 255.0f);
+			Out[x * 3 + 2] = (uint8_t)fminf(Color[2] + 0.5f, 255.0f);
+		}
+	}
+}
+
+//box filters Rgba, sampled on Grid, onto the frame
+static void ResampleFrame(struct ThreadPool* Pool, const uint8_t* restrict Rgba, uint32_t RgbaWidth, const struct PixelGrid* restrict Grid, const struct CpuView* restrict View, struct ResampleTaps* restrict ColumnTaps, struct ResampleTaps* restrict RowTaps, float** Scratch, size_t* ScratchSize, uint8_t* restrict Frame)
+{
+	struct PixelGrid FrameGrid;
+	CpuViewGetPixelGrid(View, &FrameGrid);
+	GetResampleTaps(FrameGrid.OriginX, FrameGrid.StepX, View->Width, Grid->OriginX, Grid->StepX, ColumnTaps);
+	GetResampleTaps(FrameGrid.OriginY, FrameGrid.StepY, View->Height, Grid->OriginY, Grid->StepY, RowTaps);
+
+	struct ResampleContext Resample;
+	Resample.SampleRgba = Rgba;
+	Resample.SampleWidth = RgbaWidth;
+	Resample.ColumnTaps = ColumnTaps;
+	Resample.RowTaps = RowTaps;
+	Resample.Width = View->Width;
+	Resample.Height = View->Height;
+	Resample.FirstColumn = ColumnTaps[0].First;
+	Resample.ColumnCount = ColumnTaps[View->Width - 1].First + ColumnTaps[View->Width - 1].Count - Resample.FirstColumn;
+	Resample.Frame = Frame;
+
+	const size_t ScratchNeeded = (size_t)Resample.ColumnCount * 3 * ThreadPoolGetThreadCount(Pool);
+	if (ScratchNeeded > *ScratchSize)
+	{
+		AlignedFree(*Scratch);
+		*ScratchSize = ScratchNeeded;
+		*Scratch = AlignedAlloc(ScratchNeeded * sizeof(float), 64);
+	}
+	Resample.Scratch = *Scratch;
+	ThreadPoolRun(Pool, ResampleRows, &Resample, (View->Height + ANIMATION_ROWS_PER_TASK - 1) / ANIMATION_ROWS_PER_TASK);
+}
+
+//frames are only resampled while the next frame can use the same samples
+static bool IsSteadyFrame(const struct CpuView* restrict View, const struct CpuView* restrict NextView)
+{
+	return NextView == NULL || (NextView->Set == View->Set && NextView->Type == View->Type && memcmp(NextView->JuliaPos, View->JuliaPos, sizeof(View->JuliaPos)) == 0);
+}
+
+//the lattice's finer pixels have to resolve in the float tier
+static bool IsLatticeFrame(const struct CpuView* restrict View, struct DeepView* restrict DeepView)
+{
+	struct CpuView Finest = *View;
+	Finest.WindowPos[0] *= 0.25;
+	Finest.WindowPos[1] *= 0.25;
+	DeepViewFromCpuView(DeepView, &Finest);
+	return SelectPrecisionTier(DeepView) == PRECISION_TIER_FLOAT;
+}
+
+//past the float tier there is no lattice, a key frame is iterated at whichever
+//tier its pixels need and with one to two samples per frame pixel along each
+//axis like the lattice, so it lasts an octave. its samples are not carried over
+//to the next key
+struct KeyFrame
+{
+	struct CpuView View;
+	struct IterationBuffer Buffer;
+	bool bValid;
+};
+
+static bool IsKeyFrameCovering(const struct KeyFrame* restrict Key, const struct CpuView* restrict View)
+{
+	if (!Key->bValid || Key->View.Set != View->Set || Key->View.Type != View->Type || Key->View.MaxIterations != View->MaxIterations || memcmp(Key->View.JuliaPos, View->JuliaPos, sizeof(View->JuliaPos)) != 0)
+		return false;
+
+	const double KeyStep = Key->View.WindowPos[0] / Key->View.Width;
+	const double FrameStep = View->WindowPos[0] / View->Width;
+	if (KeyStep > FrameStep * (1.0 + 1e-9) || KeyStep * 4.0 <= FrameStep)
+		return false;
+
+	//the frame's footprint, half a frame pixel past its outer centres, inside the key's samples
+	for (int Axis = 0; Axis < 2; Axis++)
+	{
+		const double KeyHalf = Key->View.WindowPos[Axis] * 0.5 - KeyStep;
+		const double FrameHalf = View->WindowPos[Axis] * 0.5;
+		if (fabs(View->WindowPos[Axis + 2] - Key->View.WindowPos[Axis + 2]) + FrameHalf > KeyHalf)
+			return false;
+	}
+	return true;
+}
+
+//zooming in, the key starts at twice the frame's resolution and the frames grow
+//into it. zooming out it starts at the frame's resolution and twice its size
+static void RenderKeyFrame(struct CpuRenderer* Renderer, const struct CpuView* restrict View, const struct CpuView* restrict NextView, bool bFractions, struct KeyFrame* restrict Key, struct DeepView* restrict DeepView, struct CpuRenderStats* restrict Stats)
+{
+	const bool bZoomingOut = NextView != NULL && NextView->WindowPos[0] > View->WindowPos[0];
+	const double Resolution = bZoomingOut ? 1.0 : 2.0;
+	const uint32_t Margin = (uint32_t)(View->Width / ANIMATION_KEY_MARGIN + 0.5);
+	const uint32_t Width = (View->Width + Margin * 2) * 2;
+	const uint32_t Height = (View->Height + Margin * 2) * 2;
+
+	Key->View = *View;
+	Key->View.Width = Width;
+	Key->View.Height = Height;
+	Key->View.WindowPos[0] = View->WindowPos[0] / View->Width / Resolution * Width;
+	Key->View.WindowPos[1] = View->WindowPos[1] / View->Height / Resolution * Height;
+
+	if (Key->Buffer.Width != Width || Key->Buffer.Height != Height)
+	{
+		IterationBufferRelease(&Key->Buffer);
+		IterationBufferInit(&Key->Buffer, Width, Height);
+		if (bFractions)
+			IterationBufferAddFractions(&Key->Buffer);
+	}
+
+	DeepViewFromCpuView(DeepView, &Key->View);
+	CpuRenderTierFrame(Renderer, DeepView, SelectPrecisionTier(DeepView), &Key->Buffer, Stats, NULL);
+	if (Key->Buffer.Fractions && Stats->Tier != PRECISION_TIER_FLOAT)
+		IterationBufferClearFractions(&Key->Buffer);
+	Key->bValid = true;
+}
+
+bool CpuRenderAnimation(struct CpuRenderer* Renderer, const struct AnimationPath* restrict AnimationPath, const struct AnimationSettings* restrict Settings, AnimationProgressCallback Progress, void* Context, struct AnimationStats* restrict Stats)
+{
+	const double StartTime = GetTime();
+	const uint32_t Width = Settings->Width;
+	const uint32_t Height = Settings->Height;
+	const double Duration = AnimationPath->Keyframes[AnimationPath->Count - 1].Time;
+	const uint32_t FrameCount = (uint32_t)floor(Duration * Settings->FramesPerSecond + 1e-9) + 1;
+	struct ThreadPool* Pool = CpuRendererGetThreadPool(Renderer);
+
+	struct AnimationStats Totals;
+	memset(&Totals, 0, sizeof(Totals));
+
+	struct LatticeBuffer Lattice;
+	LatticeBufferInit(&Lattice);
+	Lattice.bFractions = Settings->bSmooth;
+	struct KeyFrame Key;
+	memset(&Key, 0, sizeof(Key));
+	uint8_t* SampleRgba = NULL;		//the lattice or key frame coloured, whichever was iterated last
+	size_t SampleRgbaSize = 0;
+
+	struct IterationBuffer Direct;
+	IterationBufferInit(&Direct, Width, Height);
+	if (Settings->bSmooth)
+		IterationBufferAddFractions(&Direct);
+	uint8_t* DirectRgba = AlignedAlloc((size_t)Width * Height * 4, 64);
+
+	struct ResampleTaps* ColumnTaps = malloc(Width * sizeof(struct ResampleTaps));
+	struct ResampleTaps* RowTaps = malloc(Height * sizeof(struct ResampleTaps));
+	uint8_t* Frame = malloc((size_t)Width * Height * 3);
+	struct DeepView* DeepView = malloc(sizeof(struct DeepView));
+	CHECK_ALLOC(ColumnTaps);
+	CHECK_ALLOC(RowTaps);
+	CHECK_ALLOC(Frame);
+	CHECK_ALLOC(DeepView);
+	float* Scratch = NULL;
+	size_t ScratchSize = 0;
+
+	struct CpuView View;
+	CpuViewSetDefault(&View, FRACTAL_SET_MANDELBROT, FRACTAL_TYPE_BASE, Width, Height);
+	View.MaxIterations = Settings->MaxIterations;
+	struct CpuView NextView = View;
+	AnimationPathGetView(AnimationPath, 0.0, &NextView);
+
+	bool bOk = true;
+	for (uint32_t FrameIndex = 0; FrameIndex < FrameCount && bOk; FrameIndex++)
+	{
+		View = NextView;
+		if (FrameIndex + 1 < FrameCount)
+			AnimationPathGetView(AnimationPath, (FrameIndex + 1) / Settings->FramesPerSecond, &NextView);
+
+		const struct CpuView* Ahead = FrameIndex + 1 < FrameCount ? &NextView : NULL;
+		struct CpuRenderStats FrameStats;
+		if (IsSteadyFrame(&View, Ahead) && IsLatticeFrame(&View, DeepView))
+		{
+			if (CpuRenderFrameLattice(Renderer, &View, &Lattice, &FrameStats))
+			{
+				const size_t PixelCount = (size_t)Lattice.Buffer.Width * Lattice.Buffer.Height;
+				if (PixelCount * 4 > SampleRgbaSize)
+				{
+					AlignedFree(SampleRgba);
+					SampleRgbaSize = PixelCount * 4;
+					SampleRgba = AlignedAlloc(SampleRgbaSize, 64);
+				}
+				ColorizePalette(Settings->Palette, &Lattice.Buffer, SampleRgba, (size_t)Lattice.Buffer.Width * 4);
+
+				Key.bValid = false;
+
+				Totals.LatticeRenders++;
+				Totals.TotalIterations += FrameStats.TotalIterations;
+				Totals.IteratedPixels += PixelCount - FrameStats.ReusedPixels;
+				Totals.ReusedPixels += FrameStats.ReusedPixels;
+			}
+
+			struct PixelGrid LatticeGrid;
+			LatticeBufferGetGrid(&Lattice, &LatticeGrid);
+			ResampleFrame(Pool, SampleRgba, Lattice.Buffer.Width, &LatticeGrid, &View, ColumnTaps, RowTaps, &Scratch, &ScratchSize, Frame);
+		}
+		else if (IsSteadyFrame(&View, Ahead))
+		{
+			if (!IsKeyFrameCovering(&Key, &View))
+			{
+				RenderKeyFrame(Renderer, &View, Ahead, Settings->bSmooth, &Key, DeepView, &FrameStats);
+				const size_t PixelCount = (size_t)Key.Buffer.Width * Key.Buffer.Height;
+				if (PixelCount * 4 > SampleRgbaSize)
+				{
+					AlignedFree(SampleRgba);
+					SampleRgbaSize = PixelCount * 4;
+					SampleRgba = AlignedAlloc(SampleRgbaSize, 64);
+				}
+				ColorizePalette(Settings->Palette, &Key.Buffer, SampleRgba, (size_t)Key.Buffer.Width * 4);
+				Lattice.bValid = false;
+
+				Totals.KeyFrames++;
+				Totals.TotalIterations += FrameStats.TotalIterations;
+				Totals.IteratedPixels += PixelCount;
+			}
+
+			struct PixelGrid KeyGrid;
+			CpuViewGetPixelGrid(&Key.View, &KeyGrid);
+			ResampleFrame(Pool, SampleRgba, Key.Buffer.Width, &KeyGrid, &View, ColumnTaps, RowTaps, &Scratch, &ScratchSize, Frame);
+		}
+		else
+		{
+			DeepViewFromCpuView(DeepView, &View);
+			const enum PrecisionTier Tier = SelectPrecisionTier(DeepView);
+			CpuRenderTierFrame(Renderer, DeepView, Tier, &Direct, &FrameStats, NULL);
+			if (Direct.Fractions && FrameStats.Tier != PRECISION_TIER_FLOAT)
+				IterationBufferClearFractions(&Direct);
+			ColorizePalette(Settings->Palette, &Direct, DirectRgba, (size_t)Width * 4);
+
+			const size_t PixelCount = (size_t)Width * Height;
+			for (size_t i = 0; i < PixelCount; i++)
+			{
+				Frame[i * 3 + 0] = DirectRgba[i * 4 + 0];
+				Frame[i * 3 + 1] = DirectRgba[i * 4 + 1];
+				Frame[i * 3 + 2] = DirectRgba[i * 4 + 2];
+			}
+
+			Totals.DirectFrames++;
+			Totals.TotalIterations += FrameStats.TotalIterations;
+			Totals.IteratedPixels += PixelCount;
+		}
+
+		bOk = fwrite(Frame, 3, (size_t)Width * Height, Settings->Output) == (size_t)Width * Height;
+		Totals.FrameCount++;
+
+		if (Progress)
+		{
+			struct AnimationProgress Report;
+			Report.FramesDone = FrameIndex + 1;
+			Report.FrameCount = FrameCount;
+			Report.Seconds = GetTime() - StartTime;
+			Report.EtaSeconds = Report.Seconds * (FrameCount - Report.FramesDone) / Report.FramesDone;
+			Progress(Context, &Report);
+		}
+	}
+
+	bOk = fflush(Settings->Output) == 0 && bOk;
+
+	LatticeBufferRelease(&Lattice);
+	IterationBufferRelease(&Key.Buffer);
+	IterationBufferRelease(&Direct);
+	AlignedFree(SampleRgba);
+	AlignedFree(DirectRgba);
+	AlignedFree(Scratch);
+	free(ColumnTaps);
+	free(RowTaps);
+	free(Frame);
+	free(DeepView);
+
+	Totals.Seconds = GetTime() - StartTime;
+	if (Stats)
+		*Stats = Totals;
+	return bOk;
+}
@@ -0,0 +1,92 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//batch zoom animations. a path of keyframes is rendered at a fixed frame size
+//and streamed out as raw rgb24, so an encoder can read the frames from a pipe.
+//frames are resampled from a LatticeBuffer with one to two samples per frame
+//pixel along each axis, which only has to be iterated again once per octave of
+//zoom and then copies the quarter of its samples it shares with the one before.
+//past the float tier a key frame at the deeper tier stands in for the lattice
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cpurender.h"
+
+struct AnimationKeyframe
+{
+	double Time;			//seconds from the start
+	enum FractalSet Set;
+	enum FractalType Type;
+	double Scale;			//WindowPos.x, WindowPos.y follows from the frame size
+	double Centre[2];		//WindowPos.zw
+	double JuliaPos[2];
+};
+
+struct AnimationPath
+{
+	struct AnimationKeyframe* Keyframes;
+	uint32_t Count;
+};
+
+//one keyframe a line: TIME SET base|julia SCALE X Y [JULIA_X JULIA_Y], with # starting
+//a comment. times have to increase. false, after saying why on stderr, if the file does not parse
+bool AnimationPathLoad(const char* Path, struct AnimationPath* restrict AnimationPath);
+void AnimationPathRelease(struct AnimationPath* restrict AnimationPath);
+
+//the view at Time. the scale is interpolated geometrically, the centre so that it
+//moves at a steady rate on screen and JuliaPos linearly. the set and type change
+//at the keyframe that names them. Width, Height and MaxIterations are left as they are
+void AnimationPathGetView(const struct AnimationPath* restrict AnimationPath, double Time, struct CpuView* restrict View);
+
+struct AnimationSettings
+{
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t MaxIterations;
+	double FramesPerSecond;
+	bool bSmooth;			//colour with the smooth iteration fraction
+	const struct Palette* Palette;
+	FILE* Output;			//Width * Height * 3 bytes a frame, top row first
+};
+
+struct AnimationProgress
+{
+	uint32_t FramesDone;
+	uint32_t FrameCount;
+	double Seconds;
+	double EtaSeconds;		//at the rate so far
+};
+
+//called after every frame has been written
+typedef void (*AnimationProgressCallback)(void* Context, const struct AnimationProgress* restrict Progress);
+
+struct AnimationStats
+{
+	double Seconds;
+	uint32_t FrameCount;
+	uint32_t LatticeRenders;	//lattice buffers iterated
+	uint32_t KeyFrames;			//key frames iterated past the float tier
+	uint32_t DirectFrames;		//frames iterated on their own while JuliaPos or the set changes every frame
+	uint64_t TotalIterations;
+	uint64_t IteratedPixels;
+	uint64_t ReusedPixels;		//lattice samples copied from the buffer before
+};
+
+//renders every frame from time 0 to the last keyframe. false if a frame cannot be written
+bool CpuRenderAnimation(struct CpuRenderer* Renderer, const struct AnimationPath* restrict AnimationPath, const struct AnimationSettings* restrict Settings, AnimationProgressCallback Progress, void* Context, struct AnimationStats* restrict Stats);
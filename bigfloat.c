@@ -0,0 +1,321 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "bigfloat.h"
+#include "platform.h"
+
+static bool IsZero(const struct BigFloat* restrict x)
+{
+	for (uint32_t i = 0; i < x->LimbCount; i++)
+	{
+		if (x->Limbs[i] != 0)
+			return false;
+	}
+	return true;
+}
+
+//compares magnitudes over the first LimbCount limbs
+static int CompareMagnitude(const uint32_t* a, const uint32_t* b, uint32_t LimbCount)
+{
+	for (uint32_t i = 0; i < LimbCount; i++)
+	{
+		if (a[i] != b[i])
+			return a[i] < b[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+static void AddMagnitude(uint32_t* Result, const uint32_t* a, const uint32_t* b, uint32_t LimbCount)
+{
+	uint64_t Carry = 0;
+	for (int i = (int)LimbCount - 1; i >= 0; i--)
+	{
+		uint64_t Sum = (uint64_t)a[i] + b[i] + Carry;
+		Result[i] = (uint32_t)Sum;
+		Carry = Sum >> 32;
+	}
+}
+
+//a must be >= b
+static void SubMagnitude(uint32_t* Result, const uint32_t* a, const uint32_t* b, uint32_t LimbCount)
+{
+	int64_t Borrow = 0;
+	for (int i = (int)LimbCount - 1; i >= 0; i--)
+	{
+		int64_t Difference = (int64_t)a[i] - b[i] - Borrow;
+		Borrow = Difference < 0;
+		Result[i] = (uint32_t)(Difference + (Borrow << 32));
+	}
+}
+
+void BigFloatZero(struct BigFloat* restrict x, uint32_t LimbCount)
+{
+	CHECK_TRUE(LimbCount >= 1 && LimbCount <= BIGFLOAT_MAX_LIMBS);
+	memset(x, 0, sizeof(struct BigFloat));
+	x->LimbCount = LimbCount;
+}
+
+void BigFloatFromDouble(struct BigFloat* restrict x, double Value, uint32_t LimbCount)
+{
+	BigFloatZero(x, LimbCount);
+	x->bNegative = Value < 0;
+	Value = fabs(Value);
+
+	double Integer = floor(Value);
+	x->Limbs[0] = (uint32_t)Integer;
+	Value -= Integer;
+
+	//a double has at most 53 significant bits, this loop stops as soon as they run out
+	for (uint32_t i = 1; i < LimbCount && Value != 0; i++)
+	{
+		Value *= 4294967296.0;
+		double Limb = floor(Value);
+		x->Limbs[i] = (uint32_t)Limb;
+		Value -= Limb;
+	}
+}
+
+bool BigFloatFromString(struct BigFloat* restrict x, const char* String, uint32_t LimbCount)
+{
+	BigFloatZero(x, LimbCount);
+
+	while (isspace((unsigned char)*String))
+		String++;
+
+	bool bNegative = false;
+	if (*String == '-' || *String == '+')
+		bNegative = *String++ == '-';
+
+	//collect the digits as 0.DDDD * 10^Exponent
+	char Digits[1024];
+	int DigitCount = 0;
+	int Exponent = 0;
+	bool bSeenPoint = false;
+	bool bSeenDigit = false;
+
+	for (; *String; String++)
+	{
+		if (isdigit((unsigned char)*String))
+		{
+			bSeenDigit = true;
+			if (DigitCount == 0 && *String == '0')
+			{
+				//leading zeros only move the decimal point
+				if (bSeenPoint)
+					Exponent--;
+				continue;
+			}
+			if (DigitCount < (int)sizeof(Digits))
+				Digits[DigitCount++] = *String - '0';
+			if (!bSeenPoint)
+				Exponent++;
+		}
+		else if (*String == '.' && !bSeenPoint)
+		{
+			bSeenPoint = true;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (!bSeenDigit)
+		return false;
+
+	if (*String == 'e' || *String == 'E')
+	{
+		char* End;
+		long ExplicitExponent = strtol(String + 1, &End, 10);
+		if (End == String + 1)
+			return false;
+		Exponent += (int)ExplicitExponent;
+		String = End;
+	}
+
+	while (isspace((unsigned char)*String))
+		String++;
+
+	if (*String != '\0')
+		return false;
+
+	//horner from the least significant digit: x = (x + d) / 10
+	for (int i = DigitCount - 1; i >= 0; i--)
+	{
+		x->Limbs[0] += Digits[i];
+		BigFloatDivInt(x, x, 10);
+	}
+
+	for (; Exponent > 0; Exponent--)
+	{
+		BigFloatMulInt(x, x, 10);
+	}
+
+	for (; Exponent < 0; Exponent++)
+	{
+		BigFloatDivInt(x, x, 10);
+	}
+
+	x->bNegative = bNegative && !IsZero(x);
+	return true;
+}
+
+double BigFloatToDouble(const struct BigFloat* restrict x)
+{
+	uint32_t First = 0;
+	while (First < x->LimbCount && x->Limbs[First] == 0)
+		First++;
+
+	double Value = 0;
+	for (uint32_t i = First; i < x->LimbCount && i < First + 3; i++)
+	{
+		Value += ldexp((double)x->Limbs[i], -32 * (int)i);
+	}
+
+	return x->bNegative ? -Value : Value;
+}
+
+void BigFloatSetPrecision(struct BigFloat* restrict x, uint32_t LimbCount)
+{
+	CHECK_TRUE(LimbCount >= 1 && LimbCount <= BIGFLOAT_MAX_LIMBS);
+	for (uint32_t i = x->LimbCount; i < LimbCount; i++)
+	{
+		x->Limbs[i] = 0;
+	}
+	x->LimbCount = LimbCount;
+}
+
+static void AddSigned(struct BigFloat* Result, const struct BigFloat* a, const struct BigFloat* b, bool bNegateB)
+{
+	const uint32_t LimbCount = a->LimbCount;
+	const bool bNegativeB = b->bNegative != bNegateB;
+
+	if (a->bNegative == bNegativeB)
+	{
+		AddMagnitude(Result->Limbs, a->Limbs, b->Limbs, LimbCount);
+		Result->bNegative = a->bNegative;
+	}
+	else if (CompareMagnitude(a->Limbs, b->Limbs, LimbCount) >= 0)
+	{
+		const bool bNegative = a->bNegative;
+		SubMagnitude(Result->Limbs, a->Limbs, b->Limbs, LimbCount);
+		Result->bNegative = bNegative;
+	}
+	else
+	{
+		SubMagnitude(Result->Limbs, b->Limbs, a->Limbs, LimbCount);
+		Result->bNegative = bNegativeB;
+	}
+
+	Result->LimbCount = LimbCount;
+	if (IsZero(Result))
+		Result->bNegative = false;
+}
+
+void BigFloatAdd(struct BigFloat* Result, const struct BigFloat* a, const struct BigFloat* b)
+{
+	AddSigned(Result, a, b, false);
+}
+
+void BigFloatSub(struct BigFloat* Result, const struct BigFloat* a, const struct BigFloat* b)
+{
+	AddSigned(Result, a, b, true);
+}
+
+void BigFloatMul(struct BigFloat* Result, const struct BigFloat* a, const struct BigFloat* b)
+{
+	const uint32_t LimbCount = a->LimbCount;
+
+	//limb i of a times limb j of b lands in column i + j, columns past
+	//LimbCount only feed carries so the last few are kept as guard digits
+	uint64_t Columns[BIGFLOAT_MAX_LIMBS + 2] = { 0 };
+	uint64_t High[BIGFLOAT_MAX_LIMBS + 2] = { 0 };
+	const uint32_t ColumnCount = min(LimbCount + 2, BIGFLOAT_MAX_LIMBS + 2);
+
+	for (uint32_t i = 0; i < LimbCount; i++)
+	{
+		if (a->Limbs[i] == 0)
+			continue;
+
+		for (uint32_t j = 0; j < LimbCount && i + j < ColumnCount; j++)
+		{
+			uint64_t Product = (uint64_t)a->Limbs[i] * b->Limbs[j];
+			uint64_t Low = Columns[i + j] + (uint32_t)Product;
+			Columns[i + j] = (uint32_t)Low;
+			High[i + j] += (Low >> 32) + (Product >> 32);
+		}
+	}
+
+	//each column holds a 32 bit low part, its high part belongs one column to the left
+	uint64_t Carry = 0;
+	uint32_t Limbs[BIGFLOAT_MAX_LIMBS + 2];
+	for (int i = (int)ColumnCount - 1; i >= 0; i--)
+	{
+		uint64_t Sum = Columns[i] + Carry;
+		Limbs[i] = (uint32_t)Sum;
+		Carry = (Sum >> 32) + High[i];
+	}
+
+	memcpy(Result->Limbs, Limbs, LimbCount * sizeof(uint32_t));
+	Result->LimbCount = LimbCount;
+	Result->bNegative = (a->bNegative != b->bNegative) && !IsZero(Result);
+}
+
+void BigFloatMulInt(struct BigFloat* Result, const struct BigFloat* a, int32_t b)
+{
+	const uint32_t LimbCount = a->LimbCount;
+	const uint64_t Multiplier = (uint64_t)(b < 0 ? -(int64_t)b : b);
+	const bool bNegative = a->bNegative != (b < 0);
+
+	uint64_t Carry = 0;
+	for (int i = (int)LimbCount - 1; i >= 0; i--)
+	{
+		uint64_t Product = a->Limbs[i] * Multiplier + Carry;
+		Result->Limbs[i] = (uint32_t)Product;
+		Carry = Product >> 32;
+	}
+
+	Result->LimbCount = LimbCount;
+	Result->bNegative = bNegative && !IsZero(Result);
+}
+
+void BigFloatDivInt(struct BigFloat* Result, const struct BigFloat* a, uint32_t b)
+{
+	const uint32_t LimbCount = a->LimbCount;
+	const bool bNegative = a->bNegative;
+
+	uint64_t Remainder = 0;
+	for (uint32_t i = 0; i < LimbCount; i++)
+	{
+		uint64_t Dividend = (Remainder << 32) | a->Limbs[i];
+		Result->Limbs[i] = (uint32_t)(Dividend / b);
+		Remainder = Dividend % b;
+	}
+
+	Result->LimbCount = LimbCount;
+	Result->bNegative = bNegative && !IsZero(Result);
+}
+
+uint32_t BigFloatLimbsForResolution(double Resolution, uint32_t GuardBits)
+{
+	double Bits = Resolution > 0 ? -log2(Resolution) : 0;
+	uint32_t FractionalBits = (uint32_t)max(Bits, 0.0) + GuardBits;
+	uint32_t LimbCount = 1 + (FractionalBits + 31) / 32;
+	return min(LimbCount, BIGFLOAT_MAX_LIMBS);
+}
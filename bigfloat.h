@@ -0,0 +1,58 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//signed fixed point numbers with one 32 bit integer limb followed by
+//LimbCount - 1 fractional limbs, most significant first. only meant for
+//values of the size that show up in an escape time orbit
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//2016 fractional bits, a bit over 600 decimal digits
+#define BIGFLOAT_MAX_LIMBS 64
+
+struct BigFloat
+{
+	bool bNegative;
+	uint32_t LimbCount;
+	uint32_t Limbs[BIGFLOAT_MAX_LIMBS];
+};
+
+void BigFloatZero(struct BigFloat* restrict x, uint32_t LimbCount);
+void BigFloatFromDouble(struct BigFloat* restrict x, double Value, uint32_t LimbCount);
+
+//decimal with an optional exponent, "-0.743643887037158704752191506114774e-2" style.
+//returns false on malformed input
+bool BigFloatFromString(struct BigFloat* restrict x, const char* String, uint32_t LimbCount);
+
+double BigFloatToDouble(const struct BigFloat* restrict x);
+
+//truncates or zero extends to LimbCount limbs
+void BigFloatSetPrecision(struct BigFloat* restrict x, uint32_t LimbCount);
+
+//the result takes the limb count of a, aliasing between the arguments is allowed
+void BigFloatAdd(struct BigFloat* Result, const struct BigFloat* a, const struct BigFloat* b);
+void BigFloatSub(struct BigFloat* Result, const struct BigFloat* a, const struct BigFloat* b);
+void BigFloatMul(struct BigFloat* Result, const struct BigFloat* a, const struct BigFloat* b);
+void BigFloatMulInt(struct BigFloat* Result, const struct BigFloat* a, int32_t b);
+void BigFloatDivInt(struct BigFloat* Result, const struct BigFloat* a, uint32_t b);
+
+static inline void BigFloatAbs(struct BigFloat* x) { x->bNegative = false; }
+static inline void BigFloatNegate(struct BigFloat* x) { x->bNegative = !x->bNegative; }
+
+//limbs needed to resolve steps of Resolution with GuardBits to spare
+uint32_t BigFloatLimbsForResolution(double Resolution, uint32_t GuardBits);
@@ -25,6 +25,8 @@ Texture2D Texture : register(t0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 SamplerState MySampler : register(s0);
 
+#include "fractal.hlsli"
+
 float Burningship(float2 coord)
 {
     uint MaxIterations = (uint) MyConstantBuffer.MaxIterations.z;
@@ -33,12 +35,29 @@ float Burningship(float2 coord)
     float2 z = coord;
     float2 c = coord;
 
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 4.0)
     {
         float xtemp = z.x * z.x - z.y * z.y + c.x;
         z.y = 2.0 * abs(z.x * z.y) + c.y;
         z.x = xtemp;
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        if (dot(Delta, Delta) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            NextSave *= 2;
+        }
     }
     
     return frac((float) iter / MyConstantBuffer.MaxIterations.z);
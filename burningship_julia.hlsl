@@ -23,6 +23,8 @@ struct ConstantBufferData
 RWTexture2D<float4> Framebuffer : register(u0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 
+#include "fractal.hlsli"
+
 float Julia(float2 coord)
 {
     uint MaxIterations = (uint) MyConstantBuffer.MaxIterations.z;
@@ -31,12 +33,29 @@ float Julia(float2 coord)
     float2 z = coord;
     float2 c = MyConstantBuffer.JuliaPos.xy;
 
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 4.0)
     {
         float xtemp = z.x * z.x - z.y * z.y + c.x;
         z.y = 2.0 * abs(z.x * z.y) + c.y;
         z.x = xtemp;
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        if (dot(Delta, Delta) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            NextSave *= 2;
+        }
     }
     
     return frac((float) iter / MyConstantBuffer.MaxIterations.z);
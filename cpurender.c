@@ -0,0 +1,2061 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "cpurender.h"
+#include "kernels.h"
+#include "threadpool.h"
+#include "platform.h"
+
+const struct FractalFormula FractalFormulas[FRACTAL_SET_COUNT] = {
+#define FORMULA_ENTRY(Enum, Suffix, Name, IterationMultiplier, Bailout, Degree, bConnected, bConjugateSymmetric, bEven) \
+	{ Name, IterationMultiplier, Bailout, Degree, bConnected, bConjugateSymmetric, bEven },
+	FRACTAL_FORMULAS(FORMULA_ENTRY)
+#undef FORMULA_ENTRY
+};
+
+//rectangles this small are iterated outright, below this the wide kernels lose
+//more to part-filled vectors than subdivision saves
+#define SUBDIVISION_MIN_SIZE 16
+
+const char* const KernelIsaNames[KERNEL_ISA_COUNT] = {
+	"scalar",
+	"avx2",
+	"avx512"
+};
+
+const char* const PrecisionTierNames[PRECISION_TIER_COUNT] = {
+	"float",
+	"double",
+	"fixed",
+	"perturbation",
+	"dd",
+	"qd"
+};
+
+static const RowKernel RowKernels[KERNEL_ISA_COUNT] = {
+	ScalarRowKernel,
+	Avx2RowKernel,
+	Avx512RowKernel
+};
+
+static const RowKernel BytecodeRowKernels[KERNEL_ISA_COUNT] = {
+	ScalarBytecodeRowKernel,
+	Avx2BytecodeRowKernel,
+	Avx512BytecodeRowKernel
+};
+
+static const PaletteRowKernel PaletteRowKernels[KERNEL_ISA_COUNT] = {
+	ScalarPaletteRowKernel,
+	Avx2PaletteRowKernel,
+	Avx512PaletteRowKernel
+};
+
+struct CpuRenderer
+{
+	struct ThreadPool* Pool;
+	uint32_t TileSize;
+	enum KernelIsa Isa;
+	bool bSubdivide;
+	bool bInteriorChecks;
+	bool bFastMath;
+	const struct UserFormula* Formula;	//NULL for the built in formulas
+
+	//nanoseconds each tile of the last full frame took, they seed the split of the next one
+	int64_t* TileCosts;
+	uint32_t CostTilesX;
+	uint32_t CostTilesY;
+	uint32_t* Partition;	//ThreadCount + 1 task boundaries
+};
+
+void CpuViewSetDefault(struct CpuView* restrict View, enum FractalSet Set, enum FractalType Type, uint32_t Width, uint32_t Height)
+{
+	memset(View, 0, sizeof(struct CpuView));
+	View->Set = Set;
+	View->Type = Type;
+	View->Width = Width;
+	View->Height = Height;
+	View->MaxIterations = 700;
+	View->WindowPos[0] = 4.f;
+	View->WindowPos[1] = 2.25;
+	View->WindowPos[2] = -.65;
+	View->WindowPos[3] = 0;
+}
+
+void CpuViewFromConstantBuffer(struct CpuView* restrict View, const struct ConstantBufferData* restrict CbData, enum FractalSet Set, enum FractalType Type)
+{
+	View->Set = Set;
+	View->Type = Type;
+	View->Width = (uint32_t)CbData->MaxIterations[0];
+	View->Height = (uint32_t)CbData->MaxIterations[1];
+	View->MaxIterations = (uint32_t)CbData->MaxIterations[2];
+
+	for (int i = 0; i < 4; i++)
+	{
+		View->WindowPos[i] = CbData->WindowPos[i];
+	}
+
+	View->JuliaPos[0] = CbData->JuliaPos[0];
+	View->JuliaPos[1] = CbData->JuliaPos[1];
+}
+
+void CpuViewGetPixelGrid(const struct CpuView* restrict View, struct PixelGrid* restrict Grid)
+{
+	//myConsumer: Coord = ((DTid / res) * (1, -1) + (-.5, .5)) * WindowPos.xy + WindowPos.zw, then Coord *= (1, -1)
+	Grid->StepX = View->WindowPos[0] / View->Width;
+	Grid->StepY = View->WindowPos[1] / View->Height;
+	Grid->OriginX = View->WindowPos[2] - View->WindowPos[0] * 0.5;
+	Grid->OriginY = -View->WindowPos[3] - View->WindowPos[1] * 0.5;
+}
+
+uint32_t CpuViewGetIterationLimit(const struct CpuView* restrict View)
+{
+	return View->MaxIterations * FractalFormulas[View->Set].IterationMultiplier;
+}
+
+void IterationBufferInit(struct IterationBuffer* restrict Buffer, uint32_t Width, uint32_t Height)
+{
+	Buffer->Width = Width;
+	Buffer->Height = Height;
+	Buffer->Iterations = AlignedAlloc((size_t)Width * Height * sizeof(uint32_t), 64);
+	Buffer->Fractions = NULL;
+}
+
+void IterationBufferRelease(struct IterationBuffer* restrict Buffer)
+{
+	AlignedFree(Buffer->Iterations);
+	if (Buffer->Fractions)
+		AlignedFree(Buffer->Fractions);
+	Buffer->Iterations = NULL;
+	Buffer->Fractions = NULL;
+}
+
+void IterationBufferAddFractions(struct IterationBuffer* restrict Buffer)
+{
+	if (Buffer->Fractions == NULL)
+		Buffer->Fractions = AlignedAlloc((size_t)Buffer->Width * Buffer->Height, 64);
+	IterationBufferClearFractions(Buffer);
+}
+
+void IterationBufferClearFractions(struct IterationBuffer* restrict Buffer)
+{
+	if (Buffer->Fractions)
+		memset(Buffer->Fractions, 0, (size_t)Buffer->Width * Buffer->Height);
+}
+
+void ResumeBufferInit(struct ResumeBuffer* restrict Resume, uint32_t Width, uint32_t Height)
+{
+	memset(Resume, 0, sizeof(struct ResumeBuffer));
+	IterationBufferInit(&Resume->Buffer, Width, Height);
+
+	const size_t PixelCount = (size_t)Width * Height;
+	Resume->Status = AlignedAlloc(PixelCount, 64);
+	Resume->Orbits = AlignedAlloc(PixelCount * sizeof(struct OrbitState), 64);
+}
+
+void ResumeBufferRelease(struct ResumeBuffer* restrict Resume)
+{
+	IterationBufferRelease(&Resume->Buffer);
+	AlignedFree(Resume->Status);
+	AlignedFree(Resume->Orbits);
+	Resume->Status = NULL;
+	Resume->Orbits = NULL;
+	Resume->bValid = false;
+}
+
+void PanBufferInit(struct PanBuffer* restrict Pan, uint32_t Width, uint32_t Height)
+{
+	memset(Pan, 0, sizeof(struct PanBuffer));
+	IterationBufferInit(&Pan->Buffer, Width, Height);
+}
+
+void PanBufferRelease(struct PanBuffer* restrict Pan)
+{
+	IterationBufferRelease(&Pan->Buffer);
+	Pan->bValid = false;
+}
+
+void ZoomBufferInit(struct ZoomBuffer* restrict Zoom, uint32_t Width, uint32_t Height)
+{
+	memset(Zoom, 0, sizeof(struct ZoomBuffer));
+	IterationBufferInit(&Zoom->Buffer, Width, Height);
+
+	const size_t PixelCount = (size_t)Width * Height;
+	const size_t BlockCount = (size_t)(Width + CPU_ZOOM_BLOCK_WIDTH - 1) / CPU_ZOOM_BLOCK_WIDTH * Height;
+	Zoom->Priority = AlignedAlloc(PixelCount * sizeof(float), 64);
+	Zoom->ScratchIterations = AlignedAlloc(PixelCount * sizeof(uint32_t), 64);
+	Zoom->ScratchPriority = AlignedAlloc(PixelCount * sizeof(float), 64);
+	Zoom->BlockBuckets = AlignedAlloc(BlockCount, 64);
+	Zoom->BlockOrder = AlignedAlloc(BlockCount * sizeof(uint32_t), 64);
+}
+
+void ZoomBufferRelease(struct ZoomBuffer* restrict Zoom)
+{
+	IterationBufferRelease(&Zoom->Buffer);
+	AlignedFree(Zoom->Priority);
+	AlignedFree(Zoom->ScratchIterations);
+	if (Zoom->ScratchFractions)
+		AlignedFree(Zoom->ScratchFractions);
+	AlignedFree(Zoom->ScratchPriority);
+	AlignedFree(Zoom->BlockBuckets);
+	AlignedFree(Zoom->BlockOrder);
+	Zoom->Priority = NULL;
+	Zoom->ScratchIterations = NULL;
+	Zoom->ScratchFractions = NULL;
+	Zoom->ScratchPriority = NULL;
+	Zoom->BlockBuckets = NULL;
+	Zoom->BlockOrder = NULL;
+	Zoom->bValid = false;
+}
+
+void LatticeBufferInit(struct LatticeBuffer* restrict Lattice)
+{
+	memset(Lattice, 0, sizeof(struct LatticeBuffer));
+}
+
+void LatticeBufferRelease(struct LatticeBuffer* restrict Lattice)
+{
+	if (Lattice->Buffer.Iterations)
+		IterationBufferRelease(&Lattice->Buffer);
+	Lattice->Buffer.Width = 0;
+	Lattice->Buffer.Height = 0;
+	Lattice->bValid = false;
+}
+
+void LatticeBufferGetGrid(const struct LatticeBuffer* restrict Lattice, struct PixelGrid* restrict Grid)
+{
+	Grid->StepX = ldexp(Lattice->Anchor.StepX, -Lattice->Level);
+	Grid->StepY = ldexp(Lattice->Anchor.StepY, -Lattice->Level);
+	Grid->OriginX = Lattice->Anchor.OriginX + (double)Lattice->OffsetX * Grid->StepX;
+	Grid->OriginY = Lattice->Anchor.OriginY + (double)Lattice->OffsetY * Grid->StepY;
+}
+
+bool IsKernelIsaSupported(enum KernelIsa Isa)
+{
+	switch (Isa)
+	{
+	case KERNEL_ISA_SCALAR:
+		return true;
+	case KERNEL_ISA_AVX2:
+		return CpuSupportsAvx2();
+	case KERNEL_ISA_AVX512:
+		return CpuSupportsAvx512();
+	default:
+		return false;
+	}
+}
+
+enum KernelIsa GetBestKernelIsa(void)
+{
+	if (IsKernelIsaSupported(KERNEL_ISA_AVX512))
+		return KERNEL_ISA_AVX512;
+	if (IsKernelIsaSupported(KERNEL_ISA_AVX2))
+		return KERNEL_ISA_AVX2;
+	return KERNEL_ISA_SCALAR;
+}
+
+struct CpuRenderer* CpuRendererCreate(uint32_t ThreadCount, uint32_t TileSize)
+{
+	struct CpuRenderer* Renderer = calloc(1, sizeof(struct CpuRenderer));
+	CHECK_ALLOC(Renderer);
+
+	Renderer->Pool = ThreadPoolCreate(ThreadCount);
+	Renderer->TileSize = TileSize ? TileSize : CPU_RENDER_DEFAULT_TILE_SIZE;
+	Renderer->Isa = GetBestKernelIsa();
+	Renderer->bInteriorChecks = true;
+	Renderer->Partition = malloc((ThreadPoolGetThreadCount(Renderer->Pool) + 1) * sizeof(uint32_t));
+	CHECK_ALLOC(Renderer->Partition);
+	return Renderer;
+}
+
+void CpuRendererDestroy(struct CpuRenderer* Renderer)
+{
+	ThreadPoolDestroy(Renderer->Pool);
+	free(Renderer->TileCosts);
+	free(Renderer->Partition);
+	free(Renderer);
+}
+
+bool CpuRendererSetIsa(struct CpuRenderer* Renderer, enum KernelIsa Isa)
+{
+	if (!IsKernelIsaSupported(Isa))
+		return false;
+
+	Renderer->Isa = Isa;
+	return true;
+}
+
+enum KernelIsa CpuRendererGetIsa(const struct CpuRenderer* Renderer)
+{
+	return Renderer->Isa;
+}
+
+void CpuRendererSetSubdivision(struct CpuRenderer* Renderer, bool bEnable)
+{
+	Renderer->bSubdivide = bEnable;
+}
+
+bool CpuRendererGetSubdivision(const struct CpuRenderer* Renderer)
+{
+	return Renderer->bSubdivide;
+}
+
+void CpuRendererSetInteriorChecks(struct CpuRenderer* Renderer, bool bEnable)
+{
+	Renderer->bInteriorChecks = bEnable;
+}
+
+bool CpuRendererGetInteriorChecks(const struct CpuRenderer* Renderer)
+{
+	return Renderer->bInteriorChecks;
+}
+
+void CpuRendererSetFastMath(struct CpuRenderer* Renderer, bool bEnable)
+{
+	Renderer->bFastMath = bEnable;
+}
+
+bool CpuRendererGetFastMath(const struct CpuRenderer* Renderer)
+{
+	return Renderer->bFastMath;
+}
+
+void CpuRendererSetFormula(struct CpuRenderer* Renderer, const struct UserFormula* Formula)
+{
+	Renderer->Formula = Formula;
+}
+
+const struct UserFormula* CpuRendererGetFormula(const struct CpuRenderer* Renderer)
+{
+	return Renderer->Formula;
+}
+
+struct ThreadPool* CpuRendererGetThreadPool(struct CpuRenderer* Renderer)
+{
+	return Renderer->Pool;
+}
+
+uint32_t CpuRendererGetTileSize(const struct CpuRenderer* Renderer)
+{
+	return Renderer->TileSize;
+}
+
+bool IsSubdivisionSafe(enum FractalSet Set, enum FractalType Type, const double JuliaPos[2], uint32_t Limit)
+{
+	if (!FractalFormulas[Set].bConnected)
+		return false;
+	if (Type == FRACTAL_TYPE_BASE)
+		return true;
+
+	//a julia pixel at the origin iterates the critical orbit of JuliaPos
+	struct RowJob Job = { 0 };
+	Job.Set = Set;
+	Job.Type = FRACTAL_TYPE_JULIA;
+	Job.Limit = Limit;
+	Job.StrideX = 1;
+	Job.Count = 1;
+	Job.JuliaX = JuliaPos[0];
+	Job.JuliaY = JuliaPos[1];
+
+	uint32_t Iterations;
+	ScalarRowKernel(&Job, &Iterations);
+	return Iterations == Limit;
+}
+
+struct Subdivision
+{
+	PixelRun Run;
+	void* Context;
+	uint32_t* Iterations;
+	uint32_t Pitch;
+	uint64_t Total;
+	uint64_t Filled;
+};
+
+static inline uint32_t* SubdivisionPixel(struct Subdivision* Subdivision, uint32_t x, uint32_t y)
+{
+	return Subdivision->Iterations + (size_t)y * Subdivision->Pitch + x;
+}
+
+static void SubdivisionRow(struct Subdivision* Subdivision, uint32_t x0, uint32_t x1, uint32_t y)
+{
+	if (x0 <= x1)
+		Subdivision->Total += Subdivision->Run(Subdivision->Context, x0, y, x1 - x0 + 1, SubdivisionPixel(Subdivision, x0, y));
+}
+
+static void SubdivisionColumn(struct Subdivision* Subdivision, uint32_t x, uint32_t y0, uint32_t y1)
+{
+	for (uint32_t y = y0; y <= y1 && y0 <= y1; y++)
+	{
+		Subdivision->Total += Subdivision->Run(Subdivision->Context, x, y, 1, SubdivisionPixel(Subdivision, x, y));
+	}
+}
+
+static bool IsBorderUniform(struct Subdivision* Subdivision, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+	const uint32_t Value = *SubdivisionPixel(Subdivision, x0, y0);
+
+	for (uint32_t x = x0; x <= x1; x++)
+	{
+		if (*SubdivisionPixel(Subdivision, x, y0) != Value || *SubdivisionPixel(Subdivision, x, y1) != Value)
+			return false;
+	}
+
+	for (uint32_t y = y0 + 1; y < y1; y++)
+	{
+		if (*SubdivisionPixel(Subdivision, x0, y) != Value || *SubdivisionPixel(Subdivision, x1, y) != Value)
+			return false;
+	}
+
+	return true;
+}
+
+//the border of the inclusive rectangle (x0, y0)-(x1, y1) is already computed
+static void SubdivideRect(struct Subdivision* Subdivision, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+	if (x1 - x0 < 2 || y1 - y0 < 2)
+		return;
+
+	if (IsBorderUniform(Subdivision, x0, y0, x1, y1))
+	{
+		const uint32_t Value = *SubdivisionPixel(Subdivision, x0, y0);
+		for (uint32_t y = y0 + 1; y < y1; y++)
+		{
+			uint32_t* restrict Row = SubdivisionPixel(Subdivision, 0, y);
+			for (uint32_t x = x0 + 1; x < x1; x++)
+			{
+				Row[x] = Value;
+			}
+		}
+		Subdivision->Filled += (uint64_t)(x1 - x0 - 1) * (y1 - y0 - 1);
+		return;
+	}
+
+	if (x1 - x0 <= SUBDIVISION_MIN_SIZE || y1 - y0 <= SUBDIVISION_MIN_SIZE)
+	{
+		for (uint32_t y = y0 + 1; y < y1; y++)
+		{
+			SubdivisionRow(Subdivision, x0 + 1, x1 - 1, y);
+		}
+		return;
+	}
+
+	//iterate the cross through the middle, which completes the border of each quarter
+	const uint32_t xm = (x0 + x1) / 2;
+	const uint32_t ym = (y0 + y1) / 2;
+	SubdivisionRow(Subdivision, x0 + 1, x1 - 1, ym);
+	SubdivisionColumn(Subdivision, xm, y0 + 1, ym - 1);
+	SubdivisionColumn(Subdivision, xm, ym + 1, y1 - 1);
+
+	SubdivideRect(Subdivision, x0, y0, xm, ym);
+	SubdivideRect(Subdivision, xm, y0, x1, ym);
+	SubdivideRect(Subdivision, x0, ym, xm, y1);
+	SubdivideRect(Subdivision, xm, ym, x1, y1);
+}
+
+uint64_t SubdivideTile(PixelRun Run, void* Context, struct IterationBuffer* restrict Buffer, uint32_t TileX, uint32_t TileY, uint32_t TileWidth, uint32_t TileHeight, uint64_t* restrict FilledPixels)
+{
+	struct Subdivision Subdivision = { 0 };
+	Subdivision.Run = Run;
+	Subdivision.Context = Context;
+	Subdivision.Iterations = Buffer->Iterations;
+	Subdivision.Pitch = Buffer->Width;
+
+	const uint32_t x1 = TileX + TileWidth - 1;
+	const uint32_t y1 = TileY + TileHeight - 1;
+
+	SubdivisionRow(&Subdivision, TileX, x1, TileY);
+	if (y1 > TileY)
+	{
+		SubdivisionRow(&Subdivision, TileX, x1, y1);
+		SubdivisionColumn(&Subdivision, TileX, TileY + 1, y1 - 1);
+		if (x1 > TileX)
+			SubdivisionColumn(&Subdivision, x1, TileY + 1, y1 - 1);
+	}
+
+	SubdivideRect(&Subdivision, TileX, TileY, x1, y1);
+
+	*FilledPixels += Subdivision.Filled;
+	return Subdivision.Total;
+}
+
+enum SymmetryType GetSymmetryType(enum FractalSet Set, enum FractalType Type)
+{
+	const struct FractalFormula* Formula = &FractalFormulas[Set];
+	if (Type == FRACTAL_TYPE_BASE)
+		return Formula->bConjugateSymmetric ? SYMMETRY_CONJUGATE : SYMMETRY_NONE;
+
+	//z -> -z maps the orbit of a julia set of an even formula onto the orbit of -z
+	return Formula->bEven ? SYMMETRY_POINT : SYMMETRY_NONE;
+}
+
+static void AddSymmetryRect(struct FrameSymmetry* restrict Symmetry, int64_t x, int64_t y, int64_t Width, int64_t Height)
+{
+	if (Width <= 0 || Height <= 0)
+		return;
+
+	uint32_t* Rect = Symmetry->Rects[Symmetry->RectCount++];
+	Rect[0] = (uint32_t)x;
+	Rect[1] = (uint32_t)y;
+	Rect[2] = (uint32_t)Width;
+	Rect[3] = (uint32_t)Height;
+}
+
+//a sliver is not worth tiling the frame in pieces for
+#define SYMMETRY_MIN_FRACTION 16
+
+bool GetFrameSymmetry(enum SymmetryType Type, uint32_t Width, uint32_t Height, int64_t MirrorX, int64_t MirrorY, struct FrameSymmetry* restrict Symmetry)
+{
+	memset(Symmetry, 0, sizeof(struct FrameSymmetry));
+	if (Type == SYMMETRY_NONE)
+		return false;
+
+	//the rows on the low side of the axis whose mirror is in the buffer, the axis row itself is iterated
+	const int64_t FirstRow = max(0, MirrorY - ((int64_t)Height - 1));
+	const int64_t EndRow = MirrorY < 0 ? 0 : (MirrorY + 1) / 2;
+	int64_t FirstColumn = 0;
+	int64_t EndColumn = Width;
+	if (Type == SYMMETRY_POINT)
+	{
+		FirstColumn = max(0, MirrorX - ((int64_t)Width - 1));
+		EndColumn = min((int64_t)Width, MirrorX + 1);
+	}
+
+	if (EndRow <= FirstRow || EndColumn <= FirstColumn)
+		return false;
+
+	if ((uint64_t)(EndRow - FirstRow) * (uint64_t)(EndColumn - FirstColumn) * SYMMETRY_MIN_FRACTION < (uint64_t)Width * Height)
+		return false;
+
+	Symmetry->Type = Type;
+	Symmetry->MirrorX = MirrorX;
+	Symmetry->MirrorY = MirrorY;
+	Symmetry->FirstRow = (uint32_t)FirstRow;
+	Symmetry->RowCount = (uint32_t)(EndRow - FirstRow);
+	Symmetry->FirstColumn = (uint32_t)FirstColumn;
+	Symmetry->ColumnCount = (uint32_t)(EndColumn - FirstColumn);
+
+	AddSymmetryRect(Symmetry, 0, 0, Width, FirstRow);
+	AddSymmetryRect(Symmetry, 0, EndRow, Width, Height - EndRow);
+	AddSymmetryRect(Symmetry, 0, FirstRow, FirstColumn, EndRow - FirstRow);
+	AddSymmetryRect(Symmetry, EndColumn, FirstRow, Width - EndColumn, EndRow - FirstRow);
+	return true;
+}
+
+uint64_t MirrorIterations(const struct FrameSymmetry* restrict Symmetry, struct IterationBuffer* restrict Buffer)
+{
+	const uint32_t Width = Buffer->Width;
+	const uint32_t FirstColumn = Symmetry->FirstColumn;
+	const uint32_t EndColumn = FirstColumn + Symmetry->ColumnCount;
+
+	for (uint32_t y = Symmetry->FirstRow; y < Symmetry->FirstRow + Symmetry->RowCount; y++)
+	{
+		const size_t Row = (size_t)y * Width;
+		const size_t SourceRow = (size_t)(Symmetry->MirrorY - y) * Width;
+
+		if (Symmetry->Type == SYMMETRY_CONJUGATE)
+		{
+			memcpy(Buffer->Iterations + Row, Buffer->Iterations + SourceRow, Width * sizeof(uint32_t));
+			if (Buffer->Fractions)
+				memcpy(Buffer->Fractions + Row, Buffer->Fractions + SourceRow, Width);
+			continue;
+		}
+
+		const size_t Source = SourceRow + (size_t)Symmetry->MirrorX;
+		for (uint32_t x = FirstColumn; x < EndColumn; x++)
+		{
+			Buffer->Iterations[Row + x] = Buffer->Iterations[Source - x];
+		}
+		if (Buffer->Fractions)
+		{
+			for (uint32_t x = FirstColumn; x < EndColumn; x++)
+			{
+				Buffer->Fractions[Row + x] = Buffer->Fractions[Source - x];
+			}
+		}
+	}
+
+	return (uint64_t)Symmetry->RowCount * Symmetry->ColumnCount;
+}
+
+struct FrameContext
+{
+	const struct CpuView* View;
+	struct IterationBuffer* Buffer;
+	struct PixelGrid Grid;
+	RowKernel Kernel;
+	uint32_t Limit;
+	uint32_t TileSize;
+	uint32_t RectX;			//part of Buffer the current ThreadPoolRun covers
+	uint32_t RectY;
+	uint32_t RectWidth;
+	uint32_t RectHeight;
+	uint32_t TilesX;
+	uint32_t SliceRows;		//rows of a tile one task covers, a thread that runs dry can take half a tile
+	uint32_t SlicesPerTile;
+	volatile int64_t* TileCosts;	//NULL unless the frame records them
+	uint32_t Steals;
+	int64_t GridOffsetX;	//Buffer pixel (x, y) is Grid pixel (x + GridOffsetX, y + GridOffsetY)
+	int64_t GridOffsetY;
+	uint32_t Stride;		//pass of CpuRenderFrameProgressive, 0 for every pixel
+	bool bSubdivide;
+	bool bInteriorChecks;
+	bool bFastMath;
+	const struct UserFormula* Formula;
+	struct ResumeBuffer* Resume;	//NULL unless the frame keeps per pixel state
+	uint32_t FirstIteration;		//limit Resume was left at, 0 for a fresh frame
+	volatile int64_t TotalIterations;
+	volatile int64_t FilledPixels;
+	uint64_t MirroredPixels;
+};
+
+static void InitRowJob(const struct FrameContext* restrict Frame, struct RowJob* restrict Job)
+{
+	const struct CpuView* View = Frame->View;
+
+	memset(Job, 0, sizeof(struct RowJob));
+	Job->Set = View->Set;
+	Job->Type = View->Type;
+	Job->Limit = Frame->Limit;
+	Job->OriginX = Frame->Grid.OriginX;
+	Job->OriginY = Frame->Grid.OriginY;
+	Job->StepX = Frame->Grid.StepX;
+	Job->StepY = Frame->Grid.StepY;
+	Job->StrideX = 1;
+	Job->JuliaX = View->JuliaPos[0];
+	Job->JuliaY = View->JuliaPos[1];
+	Job->bInteriorChecks = Frame->bInteriorChecks;
+	Job->bFastMath = Frame->bFastMath;
+	Job->Formula = Frame->Formula;
+}
+
+static uint64_t RenderRun(void* Context, uint32_t x, uint32_t y, uint32_t Count, uint32_t* restrict Out)
+{
+	const struct FrameContext* Frame = Context;
+
+	struct RowJob Job;
+	InitRowJob(Frame, &Job);
+	Job.FirstX = Frame->GridOffsetX + x;
+	Job.Y = Frame->GridOffsetY + y;
+	Job.Count = Count;
+	return Frame->Kernel(&Job, Out);
+}
+
+//up to SliceRows rows of one tile, starting at FirstY and ending before TileEnd
+static uint64_t RenderTileRows(const struct FrameContext* restrict Frame, uint32_t TileX, uint32_t TileWidth, uint32_t FirstY, uint32_t TileEnd)
+{
+	const struct CpuView* View = Frame->View;
+
+	struct RowJob Job;
+	InitRowJob(Frame, &Job);
+	Job.FirstX = Frame->GridOffsetX + TileX;
+	Job.Count = TileWidth;
+	Job.FirstIteration = Frame->FirstIteration;
+
+	uint64_t Total = 0;
+	for (uint32_t y = FirstY; y < min(FirstY + Frame->SliceRows, TileEnd); y++)
+	{
+		const size_t Offset = (size_t)y * View->Width + TileX;
+		if (Frame->Resume)
+		{
+			Job.Status = Frame->Resume->Status + Offset;
+			Job.Orbits = Frame->Resume->Orbits + Offset;
+		}
+
+		if (Frame->Buffer->Fractions)
+			Job.Fractions = Frame->Buffer->Fractions + Offset;
+
+		Job.Y = Frame->GridOffsetY + y;
+		Total += Frame->Kernel(&Job, Frame->Buffer->Iterations + Offset);
+	}
+
+	return Total;
+}
+
+#define PROGRESSIVE_FIRST_STRIDE 8
+#define PROGRESSIVE_RUN 64
+
+//the pixels the pass at Stride adds: every Stride-th pixel of every Stride-th
+//row, less the ones the pass before it already iterated
+static uint64_t RenderProgressiveTile(const struct FrameContext* restrict Frame, uint32_t TileX, uint32_t TileY, uint32_t TileWidth, uint32_t TileHeight)
+{
+	const uint32_t Stride = Frame->Stride;
+	const uint32_t Width = Frame->View->Width;
+
+	struct RowJob Job;
+	InitRowJob(Frame, &Job);
+
+	uint32_t Samples[PROGRESSIVE_RUN];
+	uint64_t Total = 0;
+	for (uint32_t y = (TileY + Stride - 1) / Stride * Stride; y < TileY + TileHeight; y += Stride)
+	{
+		//rows the previous pass went over only need the columns in between
+		const bool bCovered = Stride < PROGRESSIVE_FIRST_STRIDE && y % (Stride * 2) == 0;
+		const uint32_t RowStride = bCovered ? Stride * 2 : Stride;
+		const uint32_t Phase = bCovered ? Stride : 0;
+		uint32_t* restrict Row = Frame->Buffer->Iterations + (size_t)y * Width;
+
+		Job.Y = Frame->GridOffsetY + y;
+		Job.StrideX = RowStride;
+
+		uint32_t x = TileX + (Phase + RowStride - TileX % RowStride) % RowStride;
+		while (x < TileX + TileWidth)
+		{
+			Job.FirstX = Frame->GridOffsetX + x;
+			Job.Count = min(PROGRESSIVE_RUN, (TileX + TileWidth - x + RowStride - 1) / RowStride);
+			Total += Frame->Kernel(&Job, Samples);
+
+			for (uint32_t i = 0; i < Job.Count; i++)
+			{
+				Row[x + i * RowStride] = Samples[i];
+			}
+			x += Job.Count * RowStride;
+		}
+	}
+
+	return Total;
+}
+
+static void RenderTile(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	(void)ThreadIndex;
+	struct FrameContext* Frame = Context;
+	const double StartTime = Frame->TileCosts ? GetTime() : 0.0;
+
+	const uint32_t TileIndex = TaskIndex / Frame->SlicesPerTile;
+	const uint32_t TileX = Frame->RectX + (TileIndex % Frame->TilesX) * Frame->TileSize;
+	const uint32_t TileY = Frame->RectY + (TileIndex / Frame->TilesX) * Frame->TileSize;
+	const uint32_t TileWidth = min(Frame->TileSize, Frame->RectX + Frame->RectWidth - TileX);
+	const uint32_t TileHeight = min(Frame->TileSize, Frame->RectY + Frame->RectHeight - TileY);
+
+	uint64_t Total = 0;
+	if (Frame->Stride != 0)
+	{
+		Total = RenderProgressiveTile(Frame, TileX, TileY, TileWidth, TileHeight);
+	}
+	else if (Frame->bSubdivide)
+	{
+		uint64_t Filled = 0;
+		Total = SubdivideTile(RenderRun, Frame, Frame->Buffer, TileX, TileY, TileWidth, TileHeight, &Filled);
+		AtomicAdd64(&Frame->FilledPixels, (int64_t)Filled);
+	}
+	else
+	{
+		Total = RenderTileRows(Frame, TileX, TileWidth, TileY + (TaskIndex % Frame->SlicesPerTile) * Frame->SliceRows, TileY + TileHeight);
+	}
+
+	AtomicAdd64(&Frame->TotalIterations, (int64_t)Total);
+	if (Frame->TileCosts)
+		AtomicAdd64(&Frame->TileCosts[TileIndex], (int64_t)((GetTime() - StartTime) * 1e9));
+}
+
+static void InitFrame(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, struct ResumeBuffer* restrict Resume, struct FrameContext* restrict Frame)
+{
+	CHECK_TRUE(Buffer->Width == View->Width && Buffer->Height == View->Height);
+
+	memset(Frame, 0, sizeof(struct FrameContext));
+	Frame->View = View;
+	Frame->Buffer = Buffer;
+	Frame->Kernel = Renderer->Formula ? BytecodeRowKernels[Renderer->Isa] : RowKernels[Renderer->Isa];
+	Frame->Limit = CpuViewGetIterationLimit(View);
+	Frame->TileSize = Renderer->TileSize;
+	Frame->bSubdivide = Resume == NULL && Buffer->Fractions == NULL && Renderer->bSubdivide && Renderer->Formula == NULL && IsSubdivisionSafe(View->Set, View->Type, View->JuliaPos, Frame->Limit);
+	Frame->bInteriorChecks = Renderer->bInteriorChecks;
+	Frame->bFastMath = Renderer->bFastMath;
+	Frame->Formula = Renderer->Formula;
+	Frame->Resume = Resume;
+	CpuViewGetPixelGrid(View, &Frame->Grid);
+}
+
+#define TILE_SLICE_ROWS 8
+
+//splits the tasks of a frame into one contiguous run per thread, each about as
+//costly as the others by the tile costs of the last frame. NULL when there are
+//none for this tiling, which splits evenly
+static const uint32_t* GetCostPartition(struct CpuRenderer* Renderer, uint32_t TilesX, uint32_t TilesY, uint32_t SlicesPerTile)
+{
+	if (Renderer->CostTilesX != TilesX || Renderer->CostTilesY != TilesY)
+		return NULL;
+
+	const uint32_t TileCount = TilesX * TilesY;
+	int64_t TotalCost = 0;
+	for (uint32_t i = 0; i < TileCount; i++)
+	{
+		TotalCost += Renderer->TileCosts[i];
+	}
+	if (TotalCost <= 0)
+		return NULL;
+
+	//task boundaries fall on tiles, a thread left short steals slices anyway
+	const uint32_t ThreadCount = ThreadPoolGetThreadCount(Renderer->Pool);
+	uint32_t* Partition = Renderer->Partition;
+	uint32_t Thread = 1;
+	int64_t Cost = 0;
+	Partition[0] = 0;
+	for (uint32_t i = 0; i < TileCount && Thread < ThreadCount; i++)
+	{
+		Cost += Renderer->TileCosts[i];
+		while (Thread < ThreadCount && Cost * ThreadCount >= TotalCost * Thread)
+			Partition[Thread++] = (i + 1) * SlicesPerTile;
+	}
+	while (Thread <= ThreadCount)
+		Partition[Thread++] = TileCount * SlicesPerTile;
+
+	return Partition;
+}
+
+//tiles the given part of the buffer over the pool, returns the tile count
+static uint32_t RenderRect(struct CpuRenderer* Renderer, struct FrameContext* restrict Frame, uint32_t RectX, uint32_t RectY, uint32_t RectWidth, uint32_t RectHeight)
+{
+	if (RectWidth == 0 || RectHeight == 0)
+		return 0;
+
+	Frame->RectX = RectX;
+	Frame->RectY = RectY;
+	Frame->RectWidth = RectWidth;
+	Frame->RectHeight = RectHeight;
+	Frame->TilesX = (RectWidth + Frame->TileSize - 1) / Frame->TileSize;
+
+	const uint32_t TilesY = (RectHeight + Frame->TileSize - 1) / Frame->TileSize;
+	const uint32_t TileCount = Frame->TilesX * TilesY;
+
+	//subdivision and the progressive passes need a tile to themselves
+	const bool bSliced = !Frame->bSubdivide && Frame->Stride == 0;
+	Frame->SliceRows = bSliced ? min(TILE_SLICE_ROWS, Frame->TileSize) : Frame->TileSize;
+	Frame->SlicesPerTile = (Frame->TileSize + Frame->SliceRows - 1) / Frame->SliceRows;
+	const uint32_t TaskCount = TileCount * Frame->SlicesPerTile;
+
+	//only whole frames are costed, the strips of a pan or zoom say little about the next frame
+	const bool bWholeFrame = RectWidth == Frame->View->Width && RectHeight == Frame->View->Height;
+	const uint32_t* Partition = bWholeFrame ? GetCostPartition(Renderer, Frame->TilesX, TilesY, Frame->SlicesPerTile) : NULL;
+
+	Frame->TileCosts = NULL;
+	if (bWholeFrame)
+	{
+		if (Renderer->CostTilesX * Renderer->CostTilesY != TileCount)
+		{
+			free(Renderer->TileCosts);
+			Renderer->TileCosts = malloc(TileCount * sizeof(int64_t));
+			CHECK_ALLOC(Renderer->TileCosts);
+		}
+		Renderer->CostTilesX = Frame->TilesX;
+		Renderer->CostTilesY = TilesY;
+		memset(Renderer->TileCosts, 0, TileCount * sizeof(int64_t));
+		Frame->TileCosts = Renderer->TileCosts;
+	}
+
+	ThreadPoolRunStealing(Renderer->Pool, RenderTile, Frame, TaskCount, Partition);
+	Frame->Steals += ThreadPoolGetStealCount(Renderer->Pool);
+	return TileCount;
+}
+
+static void GetFrameStats(struct CpuRenderer* Renderer, const struct FrameContext* restrict Frame, double StartTime, uint32_t TileCount, struct CpuRenderStats* restrict Stats)
+{
+	if (Stats == NULL)
+		return;
+
+	Stats->Seconds = GetTime() - StartTime;
+	Stats->TotalIterations = (uint64_t)Frame->TotalIterations;
+	Stats->TileCount = TileCount;
+	Stats->ThreadCount = ThreadPoolGetThreadCount(Renderer->Pool);
+	Stats->Isa = Renderer->Isa;
+	Stats->Tier = PRECISION_TIER_FLOAT;
+	Stats->FilledPixels = (uint64_t)Frame->FilledPixels;
+	Stats->ReusedPixels = 0;
+	Stats->PendingPixels = 0;
+	Stats->Steals = Frame->Steals;
+	Stats->SupersampledPixels = 0;
+	Stats->MirroredPixels = Frame->MirroredPixels;
+}
+
+//twice the index the grid coordinates Origin + i * Step change sign at, counted
+//from grid index Offset. false unless the kernels see exactly negated coordinates
+//for every pair of indices of [0, Size) it mirrors onto each other
+static bool GetFloatMirror(double Origin, double Step, int64_t Offset, uint32_t Size, int64_t* restrict Mirror)
+{
+	const double Axis = -2.0 * (Origin / Step + (double)Offset);
+	if (!(fabs(Axis) < 4.0 * Size))
+		return false;
+
+	*Mirror = llround(Axis);
+	for (int64_t i = max(0, *Mirror - ((int64_t)Size - 1)); i <= *Mirror - i; i++)
+	{
+		//as GetRowJobX and GetRowJobY have it
+		const float a = (float)(Origin + (double)(Offset + i) * Step);
+		const float b = (float)(Origin + (double)(Offset + *Mirror - i) * Step);
+		if (a != -b)
+			return false;
+	}
+	return true;
+}
+
+//iterates only the unique part of a frame that straddles the axis or centre of
+//symmetry of its formula and mirrors the rest, returns the tile count
+static uint32_t RenderSymmetricFrame(struct CpuRenderer* Renderer, struct FrameContext* restrict Frame)
+{
+	const struct CpuView* View = Frame->View;
+	const enum SymmetryType Type = Frame->Formula ? SYMMETRY_NONE : GetSymmetryType(View->Set, View->Type);
+
+	struct FrameSymmetry Symmetry;
+	int64_t MirrorX = 0;
+	int64_t MirrorY = 0;
+	const bool bSymmetric = Type != SYMMETRY_NONE
+		&& GetFloatMirror(Frame->Grid.OriginY, Frame->Grid.StepY, Frame->GridOffsetY, View->Height, &MirrorY)
+		&& (Type != SYMMETRY_POINT || GetFloatMirror(Frame->Grid.OriginX, Frame->Grid.StepX, Frame->GridOffsetX, View->Width, &MirrorX))
+		&& GetFrameSymmetry(Type, View->Width, View->Height, MirrorX, MirrorY, &Symmetry);
+	if (!bSymmetric)
+		return RenderRect(Renderer, Frame, 0, 0, View->Width, View->Height);
+
+	uint32_t TileCount = 0;
+	for (uint32_t i = 0; i < Symmetry.RectCount; i++)
+	{
+		const uint32_t* Rect = Symmetry.Rects[i];
+		TileCount += RenderRect(Renderer, Frame, Rect[0], Rect[1], Rect[2], Rect[3]);
+	}
+
+	Frame->MirroredPixels = MirrorIterations(&Symmetry, Frame->Buffer);
+	return TileCount;
+}
+
+static void RenderFrame(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, struct ResumeBuffer* restrict Resume, uint32_t FirstIteration, struct CpuRenderStats* restrict Stats)
+{
+	const double StartTime = GetTime();
+
+	struct FrameContext Frame;
+	InitFrame(Renderer, View, Buffer, Resume, &Frame);
+	Frame.FirstIteration = FirstIteration;
+
+	//a resumed pixel carries state its mirror image does not have
+	const uint32_t TileCount = Resume ? RenderRect(Renderer, &Frame, 0, 0, View->Width, View->Height) : RenderSymmetricFrame(Renderer, &Frame);
+
+	GetFrameStats(Renderer, &Frame, StartTime, TileCount, Stats);
+}
+
+void CpuRenderFrame(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats)
+{
+	RenderFrame(Renderer, View, Buffer, NULL, 0, Stats);
+}
+
+void CpuRenderFrameRegion(struct CpuRenderer* Renderer, const struct CpuView* restrict View, uint32_t FirstColumn, uint32_t FirstRow, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats)
+{
+	CHECK_TRUE(FirstColumn + Buffer->Width <= View->Width && FirstRow + Buffer->Height <= View->Height);
+
+	const double StartTime = GetTime();
+
+	//the region is a frame of its own as far as tiling goes, on the pixel grid of the whole view
+	struct CpuView Region = *View;
+	Region.Width = Buffer->Width;
+	Region.Height = Buffer->Height;
+
+	struct FrameContext Frame;
+	InitFrame(Renderer, &Region, Buffer, NULL, &Frame);
+	CpuViewGetPixelGrid(View, &Frame.Grid);
+	Frame.GridOffsetX = FirstColumn;
+	Frame.GridOffsetY = FirstRow;
+
+	const uint32_t TileCount = RenderSymmetricFrame(Renderer, &Frame);
+
+	GetFrameStats(Renderer, &Frame, StartTime, TileCount, Stats);
+}
+
+//copies each sample a pass at Stride left over the Stride x Stride block it is the top left corner of
+static void FillProgressiveBlocks(struct IterationBuffer* restrict Buffer, uint32_t Stride)
+{
+	for (uint32_t y = 0; y < Buffer->Height; y++)
+	{
+		uint32_t* restrict Row = Buffer->Iterations + (size_t)y * Buffer->Width;
+		const uint32_t* restrict SourceRow = Buffer->Iterations + (size_t)(y - y % Stride) * Buffer->Width;
+		for (uint32_t x = 0; x < Buffer->Width; x++)
+		{
+			Row[x] = SourceRow[x - x % Stride];
+		}
+	}
+}
+
+void CpuRenderFrameProgressive(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, ProgressivePass Pass, void* Context, struct CpuRenderStats* restrict Stats)
+{
+	double StartTime = GetTime();
+	IterationBufferClearFractions(Buffer);
+
+	struct FrameContext Frame;
+	InitFrame(Renderer, View, Buffer, NULL, &Frame);
+	Frame.bSubdivide = false;
+
+	struct CpuRenderStats PassStats;
+	uint32_t TileCount = 0;
+	for (uint32_t Stride = PROGRESSIVE_FIRST_STRIDE; Stride != 0; Stride /= 2)
+	{
+		Frame.Stride = Stride;
+		TileCount += RenderRect(Renderer, &Frame, 0, 0, View->Width, View->Height);
+		GetFrameStats(Renderer, &Frame, StartTime, TileCount, &PassStats);
+
+		if (Stride > 1)
+			FillProgressiveBlocks(Buffer, Stride);
+		if (Pass)
+		{
+			//the time spent showing a pass is not part of the frame
+			const double PassTime = GetTime();
+			Pass(Context, Buffer, Stride, &PassStats);
+			StartTime += GetTime() - PassTime;
+		}
+	}
+
+	if (Stats)
+		*Stats = PassStats;
+}
+
+//same pixels apart from MaxIterations
+static bool IsSameViewRegion(const struct CpuView* restrict a, const struct CpuView* restrict b)
+{
+	return a->Set == b->Set
+		&& a->Type == b->Type
+		&& a->Width == b->Width
+		&& a->Height == b->Height
+		&& memcmp(a->WindowPos, b->WindowPos, sizeof(a->WindowPos)) == 0
+		&& memcmp(a->JuliaPos, b->JuliaPos, sizeof(a->JuliaPos)) == 0;
+}
+
+void CpuRenderFrameResumable(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct ResumeBuffer* restrict Resume, struct CpuRenderStats* restrict Stats)
+{
+	CHECK_TRUE(Resume->Buffer.Width == View->Width && Resume->Buffer.Height == View->Height);
+
+	const bool bResume = Resume->bValid && IsSameViewRegion(&Resume->View, View) && Resume->View.MaxIterations <= View->MaxIterations;
+	const uint32_t FirstIteration = bResume ? CpuViewGetIterationLimit(&Resume->View) : 0;
+
+	RenderFrame(Renderer, View, &Resume->Buffer, Resume, FirstIteration, Stats);
+
+	Resume->View = *View;
+	Resume->bValid = true;
+}
+
+//same pixels apart from the centre
+static bool IsSamePanRegion(const struct CpuView* restrict a, const struct CpuView* restrict b)
+{
+	return a->Set == b->Set
+		&& a->Type == b->Type
+		&& a->Width == b->Width
+		&& a->Height == b->Height
+		&& a->MaxIterations == b->MaxIterations
+		&& a->WindowPos[0] == b->WindowPos[0]
+		&& a->WindowPos[1] == b->WindowPos[1]
+		&& memcmp(a->JuliaPos, b->JuliaPos, sizeof(a->JuliaPos)) == 0;
+}
+
+//Buffer pixel (x, y) takes the old pixel (x + dx, y + dy), the ones that fall outside are left as they were
+static void ScrollIterations(struct IterationBuffer* restrict Buffer, int64_t dx, int64_t dy)
+{
+	const int64_t Width = Buffer->Width;
+	const int64_t Height = Buffer->Height;
+
+	const int64_t FirstX = max(0, -dx);
+	const int64_t Columns = Width - (dx < 0 ? -dx : dx);
+	const int64_t FirstY = max(0, -dy);
+	const int64_t Rows = Height - (dy < 0 ? -dy : dy);
+
+	//walk the rows away from the ones still to be read
+	for (int64_t i = 0; i < Rows; i++)
+	{
+		const int64_t y = dy > 0 ? FirstY + i : FirstY + Rows - 1 - i;
+		memmove(
+			Buffer->Iterations + y * Width + FirstX,
+			Buffer->Iterations + (y + dy) * Width + FirstX + dx,
+			(size_t)Columns * sizeof(uint32_t));
+		if (Buffer->Fractions)
+			memmove(Buffer->Fractions + y * Width + FirstX, Buffer->Fractions + (y + dy) * Width + FirstX + dx, (size_t)Columns);
+	}
+}
+
+void CpuRenderFramePanned(struct CpuRenderer* Renderer, struct CpuView* restrict View, struct PanBuffer* restrict Pan, struct CpuRenderStats* restrict Stats)
+{
+	CHECK_TRUE(Pan->Buffer.Width == View->Width && Pan->Buffer.Height == View->Height);
+
+	const double StartTime = GetTime();
+
+	if (!Pan->bValid || !IsSamePanRegion(&Pan->View, View))
+	{
+		RenderFrame(Renderer, View, &Pan->Buffer, NULL, 0, Stats);
+
+		CpuViewGetPixelGrid(View, &Pan->Anchor);
+		Pan->OffsetX = 0;
+		Pan->OffsetY = 0;
+		Pan->View = *View;
+		Pan->bValid = true;
+		return;
+	}
+
+	//the centre moves the other way to the origin in y, see CpuViewGetPixelGrid
+	const int64_t dx = llround((View->WindowPos[2] - Pan->View.WindowPos[2]) / Pan->Anchor.StepX);
+	const int64_t dy = llround((Pan->View.WindowPos[3] - View->WindowPos[3]) / Pan->Anchor.StepY);
+
+	Pan->OffsetX += dx;
+	Pan->OffsetY += dy;
+	View->WindowPos[2] = Pan->Anchor.OriginX + Pan->OffsetX * Pan->Anchor.StepX + View->WindowPos[0] * 0.5;
+	View->WindowPos[3] = -(Pan->Anchor.OriginY + Pan->OffsetY * Pan->Anchor.StepY) - View->WindowPos[1] * 0.5;
+	Pan->View = *View;
+
+	struct FrameContext Frame;
+	InitFrame(Renderer, View, &Pan->Buffer, NULL, &Frame);
+	Frame.Grid = Pan->Anchor;
+	Frame.GridOffsetX = Pan->OffsetX;
+	Frame.GridOffsetY = Pan->OffsetY;
+
+	const uint32_t Width = View->Width;
+	const uint32_t Height = View->Height;
+	uint32_t TileCount = 0;
+	uint64_t ReusedPixels = 0;
+
+	if ((uint64_t)llabs(dx) >= Width || (uint64_t)llabs(dy) >= Height)
+	{
+		TileCount = RenderRect(Renderer, &Frame, 0, 0, Width, Height);
+	}
+	else
+	{
+		ScrollIterations(&Pan->Buffer, dx, dy);
+
+		const uint32_t ExposedColumns = (uint32_t)llabs(dx);
+		const uint32_t ExposedRows = (uint32_t)llabs(dy);
+		ReusedPixels = (uint64_t)(Width - ExposedColumns) * (Height - ExposedRows);
+
+		//the exposed columns over the full height, then the exposed rows beside them
+		const uint32_t ColumnX = dx > 0 ? Width - ExposedColumns : 0;
+		const uint32_t RowX = dx > 0 ? 0 : ExposedColumns;
+		const uint32_t RowY = dy > 0 ? Height - ExposedRows : 0;
+		TileCount += RenderRect(Renderer, &Frame, ColumnX, 0, ExposedColumns, Height);
+		TileCount += RenderRect(Renderer, &Frame, RowX, RowY, Width - ExposedColumns, ExposedRows);
+	}
+
+	GetFrameStats(Renderer, &Frame, StartTime, TileCount, Stats);
+	if (Stats)
+		Stats->ReusedPixels = ReusedPixels;
+}
+
+#define ZOOM_PRIORITY_BUCKETS 64
+#define ZOOM_BLOCKS_PER_TASK 4
+#define ZOOM_TASKS_PER_THREAD 4
+
+//same pixels apart from WindowPos
+static bool IsSameZoomRegion(const struct CpuView* restrict a, const struct CpuView* restrict b)
+{
+	return a->Set == b->Set
+		&& a->Type == b->Type
+		&& a->Width == b->Width
+		&& a->Height == b->Height
+		&& a->MaxIterations == b->MaxIterations
+		&& memcmp(a->JuliaPos, b->JuliaPos, sizeof(a->JuliaPos)) == 0;
+}
+
+//half octave buckets, 0 is kept for exact pixels
+static uint8_t GetPriorityBucket(float Priority)
+{
+	if (Priority == 0.0f)
+		return 0;
+
+	const int Bucket = (int)floorf(log2f(Priority) * 2.0f) + ZOOM_PRIORITY_BUCKETS / 2;
+	return (uint8_t)min(max(Bucket, 1), ZOOM_PRIORITY_BUCKETS - 1);
+}
+
+//nearest neighbour resample of the previous frame onto View. pixels that map
+//outside it take the nearest edge pixel and the largest priority. returns how many mapped inside
+static uint64_t ReprojectIterations(struct ZoomBuffer* restrict Zoom, const struct CpuView* restrict View)
+{
+	struct PixelGrid Old;
+	struct PixelGrid New;
+	CpuViewGetPixelGrid(&Zoom->View, &Old);
+	CpuViewGetPixelGrid(View, &New);
+
+	const int64_t Width = View->Width;
+	const int64_t Height = View->Height;
+	const float Magnification = (float)fmax(Old.StepX / New.StepX, Old.StepY / New.StepY);
+
+	if (Zoom->Buffer.Fractions && Zoom->ScratchFractions == NULL)
+		Zoom->ScratchFractions = AlignedAlloc((size_t)Width * Height, 64);
+
+	uint64_t Reused = 0;
+	for (int64_t y = 0; y < Height; y++)
+	{
+		const int64_t RawY = llround((New.OriginY + y * New.StepY - Old.OriginY) / Old.StepY);
+		const int64_t SourceY = min(max(RawY, 0), Height - 1);
+
+		for (int64_t x = 0; x < Width; x++)
+		{
+			const int64_t RawX = llround((New.OriginX + x * New.StepX - Old.OriginX) / Old.StepX);
+			const int64_t SourceX = min(max(RawX, 0), Width - 1);
+			const size_t Source = (size_t)(SourceY * Width + SourceX);
+			const size_t Target = (size_t)(y * Width + x);
+
+			Zoom->ScratchIterations[Target] = Zoom->Buffer.Iterations[Source];
+			if (Zoom->Buffer.Fractions)
+				Zoom->ScratchFractions[Target] = Zoom->Buffer.Fractions[Source];
+			if (RawX == SourceX && RawY == SourceY)
+			{
+				const float SourcePriority = Zoom->Priority[Source];
+				Zoom->ScratchPriority[Target] = fmaxf((SourcePriority == 0.0f ? 1.0f : SourcePriority) * Magnification, FLT_MIN);
+				Reused++;
+			}
+			else
+			{
+				Zoom->ScratchPriority[Target] = FLT_MAX;
+			}
+		}
+	}
+
+	uint32_t* Iterations = Zoom->Buffer.Iterations;
+	Zoom->Buffer.Iterations = Zoom->ScratchIterations;
+	Zoom->ScratchIterations = Iterations;
+
+	if (Zoom->Buffer.Fractions)
+	{
+		uint8_t* Fractions = Zoom->Buffer.Fractions;
+		Zoom->Buffer.Fractions = Zoom->ScratchFractions;
+		Zoom->ScratchFractions = Fractions;
+	}
+
+	float* Priority = Zoom->Priority;
+	Zoom->Priority = Zoom->ScratchPriority;
+	Zoom->ScratchPriority = Priority;
+
+	return Reused;
+}
+
+//bucket sorts the blocks holding inexact pixels, most urgent first, and ages those pixels by a frame
+static uint32_t OrderBlocks(struct ZoomBuffer* restrict Zoom)
+{
+	const uint32_t Width = Zoom->Buffer.Width;
+	const uint32_t Height = Zoom->Buffer.Height;
+	const uint32_t BlocksX = (Width + CPU_ZOOM_BLOCK_WIDTH - 1) / CPU_ZOOM_BLOCK_WIDTH;
+
+	uint32_t Counts[ZOOM_PRIORITY_BUCKETS] = { 0 };
+	for (uint32_t y = 0; y < Height; y++)
+	{
+		float* restrict Row = Zoom->Priority + (size_t)y * Width;
+		for (uint32_t Block = 0; Block < BlocksX; Block++)
+		{
+			const uint32_t FirstX = Block * CPU_ZOOM_BLOCK_WIDTH;
+			const uint32_t LastX = min(FirstX + CPU_ZOOM_BLOCK_WIDTH, Width);
+
+			float Worst = 0.0f;
+			for (uint32_t x = FirstX; x < LastX; x++)
+			{
+				if (Row[x] != 0.0f)
+					Row[x] += 1.0f;
+				Worst = fmaxf(Worst, Row[x]);
+			}
+
+			const uint8_t Bucket = GetPriorityBucket(Worst);
+			Zoom->BlockBuckets[(size_t)y * BlocksX + Block] = Bucket;
+			Counts[Bucket]++;
+		}
+	}
+
+	uint32_t Starts[ZOOM_PRIORITY_BUCKETS];
+	uint32_t OrderCount = 0;
+	for (int Bucket = ZOOM_PRIORITY_BUCKETS - 1; Bucket > 0; Bucket--)
+	{
+		Starts[Bucket] = OrderCount;
+		OrderCount += Counts[Bucket];
+	}
+
+	const uint32_t BlockCount = BlocksX * Height;
+	for (uint32_t Block = 0; Block < BlockCount; Block++)
+	{
+		const uint8_t Bucket = Zoom->BlockBuckets[Block];
+		if (Bucket != 0)
+			Zoom->BlockOrder[Starts[Bucket]++] = Block;
+	}
+
+	return OrderCount;
+}
+
+struct BlockRun
+{
+	struct FrameContext Frame;
+	float* Priority;
+	const uint32_t* Blocks;
+	uint32_t BlockCount;
+	uint32_t BlocksX;
+};
+
+static void RenderBlocks(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	(void)ThreadIndex;
+	struct BlockRun* Run = Context;
+	const uint32_t Width = Run->Frame.View->Width;
+
+	const uint32_t First = TaskIndex * ZOOM_BLOCKS_PER_TASK;
+	const uint32_t Last = min(First + ZOOM_BLOCKS_PER_TASK, Run->BlockCount);
+
+	uint64_t Total = 0;
+	for (uint32_t i = First; i < Last; i++)
+	{
+		const uint32_t Block = Run->Blocks[i];
+		const uint32_t x = (Block % Run->BlocksX) * CPU_ZOOM_BLOCK_WIDTH;
+		const uint32_t y = Block / Run->BlocksX;
+		const uint32_t Count = min(CPU_ZOOM_BLOCK_WIDTH, Width - x);
+		const size_t Offset = (size_t)y * Width + x;
+
+		struct RowJob Job;
+		InitRowJob(&Run->Frame, &Job);
+		Job.FirstX = Run->Frame.GridOffsetX + x;
+		Job.Y = Run->Frame.GridOffsetY + y;
+		Job.Count = Count;
+		if (Run->Frame.Buffer->Fractions)
+			Job.Fractions = Run->Frame.Buffer->Fractions + Offset;
+		Total += Run->Frame.Kernel(&Job, Run->Frame.Buffer->Iterations + Offset);
+		for (uint32_t j = 0; j < Count; j++)
+		{
+			Run->Priority[Offset + j] = 0.0f;
+		}
+	}
+
+	AtomicAdd64(&Run->Frame.TotalIterations, (int64_t)Total);
+}
+
+bool CpuRenderFrameReprojected(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct ZoomBuffer* restrict Zoom, uint64_t IterationBudget, struct CpuRenderStats* restrict Stats)
+{
+	CHECK_TRUE(Zoom->Buffer.Width == View->Width && Zoom->Buffer.Height == View->Height);
+
+	const size_t PixelCount = (size_t)View->Width * View->Height;
+
+	if (!Zoom->bValid || !IsSameZoomRegion(&Zoom->View, View))
+	{
+		CpuRenderFrame(Renderer, View, &Zoom->Buffer, Stats);
+		memset(Zoom->Priority, 0, PixelCount * sizeof(float));
+		Zoom->View = *View;
+		Zoom->bValid = true;
+		if (Stats)
+			Stats->PendingPixels = 0;
+		return true;
+	}
+
+	const double StartTime = GetTime();
+
+	uint64_t ReusedPixels = PixelCount;
+	if (memcmp(Zoom->View.WindowPos, View->WindowPos, sizeof(View->WindowPos)) != 0)
+		ReusedPixels = ReprojectIterations(Zoom, View);
+	Zoom->View = *View;
+
+	struct BlockRun Run;
+	InitFrame(Renderer, View, &Zoom->Buffer, NULL, &Run.Frame);
+	Run.Priority = Zoom->Priority;
+	Run.BlocksX = (View->Width + CPU_ZOOM_BLOCK_WIDTH - 1) / CPU_ZOOM_BLOCK_WIDTH;
+
+	//blocks go out in chunks so the budget is checked a few times per thread
+	const uint32_t OrderCount = OrderBlocks(Zoom);
+	const uint32_t ChunkBlocks = ThreadPoolGetThreadCount(Renderer->Pool) * ZOOM_TASKS_PER_THREAD * ZOOM_BLOCKS_PER_TASK;
+	uint32_t TaskCount = 0;
+	uint32_t Next = 0;
+	while (Next < OrderCount)
+	{
+		Run.Blocks = Zoom->BlockOrder + Next;
+		Run.BlockCount = min(ChunkBlocks, OrderCount - Next);
+
+		const uint32_t Tasks = (Run.BlockCount + ZOOM_BLOCKS_PER_TASK - 1) / ZOOM_BLOCKS_PER_TASK;
+		ThreadPoolRun(Renderer->Pool, RenderBlocks, &Run, Tasks);
+		TaskCount += Tasks;
+		Next += Run.BlockCount;
+
+		if (IterationBudget != 0 && (uint64_t)Run.Frame.TotalIterations >= IterationBudget)
+			break;
+	}
+
+	uint64_t PendingPixels = 0;
+	for (size_t i = 0; i < PixelCount; i++)
+	{
+		PendingPixels += Zoom->Priority[i] != 0.0f;
+	}
+
+	GetFrameStats(Renderer, &Run.Frame, StartTime, TaskCount, Stats);
+	if (Stats)
+	{
+		Stats->ReusedPixels = ReusedPixels;
+		Stats->PendingPixels = PendingPixels;
+	}
+
+	return PendingPixels == 0;
+}
+
+//a lattice buffer reaches a 1/LATTICE_MARGIN of the frame size past each edge
+#define LATTICE_MARGIN 32
+
+//same pixels apart from WindowPos and the frame size
+static bool IsSameLatticeRegion(const struct CpuView* restrict a, const struct CpuView* restrict b)
+{
+	return a->Set == b->Set
+		&& a->Type == b->Type
+		&& a->MaxIterations == b->MaxIterations
+		&& memcmp(a->JuliaPos, b->JuliaPos, sizeof(a->JuliaPos)) == 0;
+}
+
+//true if samples First .. Last of Grid take in every pixel of View along x, footprints included
+static bool IsLatticeCoveringX(const struct PixelGrid* restrict Grid, const struct PixelGrid* restrict Frame, uint32_t Width, uint32_t Count)
+{
+	return Grid->OriginX <= Frame->OriginX - Frame->StepX * 0.5
+		&& Grid->OriginX + (Count - 1) * Grid->StepX >= Frame->OriginX + (Width - 0.5) * Frame->StepX;
+}
+
+static bool IsLatticeCoveringY(const struct PixelGrid* restrict Grid, const struct PixelGrid* restrict Frame, uint32_t Height, uint32_t Count)
+{
+	return Grid->OriginY <= Frame->OriginY - Frame->StepY * 0.5
+		&& Grid->OriginY + (Count - 1) * Grid->StepY >= Frame->OriginY + (Height - 0.5) * Frame->StepY;
+}
+
+struct LatticeRun
+{
+	struct FrameContext Frame;
+	uint32_t ReuseStride;	//0 if nothing was copied, else the stride of the copied samples
+	int64_t ReuseX;			//copied samples lie on multiples of ReuseStride in this rectangle
+	int64_t ReuseY;
+	int64_t ReuseWidth;
+	int64_t ReuseHeight;
+};
+
+//Count samples of row y from x on, every Stride-th one
+static uint64_t RenderLatticeSpan(const struct FrameContext* restrict Frame, struct RowJob* restrict Job, uint32_t x, uint32_t y, uint32_t Count, uint32_t Stride)
+{
+	const size_t Offset = (size_t)y * Frame->View->Width + x;
+	if (Stride == 1)
+	{
+		Job->FirstX = Frame->GridOffsetX + x;
+		Job->StrideX = 1;
+		Job->Count = Count;
+		Job->Fractions = Frame->Buffer->Fractions ? Frame->Buffer->Fractions + Offset : NULL;
+		return Frame->Kernel(Job, Frame->Buffer->Iterations + Offset);
+	}
+
+	uint32_t Samples[PROGRESSIVE_RUN];
+	uint8_t Fractions[PROGRESSIVE_RUN];
+	uint64_t Total = 0;
+	Job->StrideX = Stride;
+	Job->Fractions = Frame->Buffer->Fractions ? Fractions : NULL;
+	for (uint32_t First = 0; First < Count; First += PROGRESSIVE_RUN)
+	{
+		Job->FirstX = Frame->GridOffsetX + x + (int64_t)First * Stride;
+		Job->Count = min(PROGRESSIVE_RUN, Count - First);
+		Total += Frame->Kernel(Job, Samples);
+
+		for (uint32_t i = 0; i < Job->Count; i++)
+		{
+			const size_t Pixel = Offset + (size_t)(First + i) * Stride;
+			Frame->Buffer->Iterations[Pixel] = Samples[i];
+			if (Job->Fractions)
+				Frame->Buffer->Fractions[Pixel] = Fractions[i];
+		}
+	}
+	return Total;
+}
+
+//every sample of a slice of rows that was not copied from the old buffer
+static void RenderLatticeRows(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	(void)ThreadIndex;
+	struct LatticeRun* Run = Context;
+	const struct FrameContext* Frame = &Run->Frame;
+	const uint32_t Width = Frame->View->Width;
+	const uint32_t FirstY = TaskIndex * TILE_SLICE_ROWS;
+	const uint32_t LastY = min(FirstY + TILE_SLICE_ROWS, Frame->View->Height);
+
+	struct RowJob Job;
+	InitRowJob(Frame, &Job);
+
+	uint64_t Total = 0;
+	for (uint32_t y = FirstY; y < LastY; y++)
+	{
+		Job.Y = Frame->GridOffsetY + y;
+
+		const bool bReused = Run->ReuseStride != 0
+			&& (int64_t)y >= Run->ReuseY && (int64_t)y < Run->ReuseY + Run->ReuseHeight
+			&& (Run->ReuseY - (int64_t)y) % Run->ReuseStride == 0;
+		if (!bReused)
+		{
+			Total += RenderLatticeSpan(Frame, &Job, 0, y, Width, 1);
+			continue;
+		}
+
+		const uint32_t Left = (uint32_t)Run->ReuseX;
+		const uint32_t Right = (uint32_t)(Run->ReuseX + Run->ReuseWidth);
+		Total += RenderLatticeSpan(Frame, &Job, 0, y, Left, 1);
+		Total += RenderLatticeSpan(Frame, &Job, Right, y, Width - Right, 1);
+		if (Run->ReuseStride == 2 && Run->ReuseWidth > 1)
+			Total += RenderLatticeSpan(Frame, &Job, Left + 1, y, (uint32_t)(Run->ReuseWidth / 2), 2);
+	}
+
+	AtomicAdd64(&Run->Frame.TotalIterations, (int64_t)Total);
+}
+
+static int64_t FloorDivide(int64_t a, int64_t b)
+{
+	const int64_t Quotient = a / b;
+	return (a % b != 0 && (a < 0) != (b < 0)) ? Quotient - 1 : Quotient;
+}
+
+//copies the samples Old shares with the buffer about to be rendered at Level and
+//Offset into New, and describes them in Run. a level more than one finer shares too few to bother
+static uint64_t CopyLatticeSamples(const struct LatticeBuffer* restrict Old, int32_t Level, int64_t OffsetX, int64_t OffsetY, struct IterationBuffer* restrict New, struct LatticeRun* restrict Run)
+{
+	Run->ReuseStride = 0;
+	if (Level > Old->Level + 1 || Old->Level - Level > 30)
+		return 0;
+
+	//lattice position p of the new level is old position p * Scale, or p / 2 for the even
+	//positions of a level one finer
+	const bool bFiner = Level == Old->Level + 1;
+	const int64_t Scale = bFiner ? 1 : (int64_t)1 << (Old->Level - Level);
+	const int64_t Stride = bFiner ? 2 : 1;
+
+	//the new pixels along each axis that land inside the old buffer
+	const int64_t Offsets[2] = { OffsetX, OffsetY };
+	const int64_t OldFirst[2] = { Old->OffsetX, Old->OffsetY };
+	const int64_t OldLast[2] = { Old->OffsetX + Old->Buffer.Width - 1, Old->OffsetY + Old->Buffer.Height - 1 };
+	const int64_t Sizes[2] = { New->Width, New->Height };
+	int64_t First[2];
+	int64_t Last[2];
+	for (int Axis = 0; Axis < 2; Axis++)
+	{
+		if (bFiner)
+		{
+			First[Axis] = OldFirst[Axis] * 2 - Offsets[Axis];
+			Last[Axis] = OldLast[Axis] * 2 - Offsets[Axis];
+		}
+		else
+		{
+			First[Axis] = -FloorDivide(-OldFirst[Axis], Scale) - Offsets[Axis];
+			Last[Axis] = FloorDivide(OldLast[Axis], Scale) - Offsets[Axis];
+		}
+
+		if (First[Axis] < 0)
+			First[Axis] += (-First[Axis] + Stride - 1) / Stride * Stride;
+		Last[Axis] = min(Last[Axis], Sizes[Axis] - 1);
+		if (First[Axis] > Last[Axis])
+			return 0;
+		Last[Axis] -= (Last[Axis] - First[Axis]) % Stride;
+	}
+
+	const int64_t OldWidth = Old->Buffer.Width;
+	uint64_t Copied = 0;
+	for (int64_t y = First[1]; y <= Last[1]; y += Stride)
+	{
+		const int64_t OldY = (bFiner ? (y + OffsetY) / 2 : (y + OffsetY) * Scale) - Old->OffsetY;
+		const uint32_t* restrict OldRow = Old->Buffer.Iterations + OldY * OldWidth;
+		const uint8_t* restrict OldFractions = Old->Buffer.Fractions ? Old->Buffer.Fractions + OldY * OldWidth : NULL;
+		uint32_t* restrict Row = New->Iterations + y * New->Width;
+		uint8_t* restrict Fractions = New->Fractions ? New->Fractions + y * New->Width : NULL;
+
+		for (int64_t x = First[0]; x <= Last[0]; x += Stride)
+		{
+			const int64_t OldX = (bFiner ? (x + OffsetX) / 2 : (x + OffsetX) * Scale) - Old->OffsetX;
+			Row[x] = OldRow[OldX];
+			if (Fractions)
+				Fractions[x] = OldFractions ? OldFractions[OldX] : 0;
+		}
+		Copied += (uint64_t)((Last[0] - First[0]) / Stride + 1);
+	}
+
+	Run->ReuseStride = (uint32_t)Stride;
+	Run->ReuseX = First[0];
+	Run->ReuseY = First[1];
+	Run->ReuseWidth = Last[0] - First[0] + 1;
+	Run->ReuseHeight = Last[1] - First[1] + 1;
+	return Copied;
+}
+
+bool CpuRenderFrameLattice(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct LatticeBuffer* restrict Lattice, struct CpuRenderStats* restrict Stats)
+{
+	const double StartTime = GetTime();
+
+	struct PixelGrid Frame;
+	CpuViewGetPixelGrid(View, &Frame);
+
+	const bool bSameRegion = Lattice->bValid && IsSameLatticeRegion(&Lattice->View, View);
+	if (bSameRegion)
+	{
+		struct PixelGrid Grid;
+		LatticeBufferGetGrid(Lattice, &Grid);
+		if (Grid.StepX <= Frame.StepX && Grid.StepX * 4.0 > Frame.StepX
+			&& IsLatticeCoveringX(&Grid, &Frame, View->Width, Lattice->Buffer.Width)
+			&& IsLatticeCoveringY(&Grid, &Frame, View->Height, Lattice->Buffer.Height))
+			return false;
+	}
+	else
+	{
+		Lattice->Anchor.OriginX = Frame.OriginX;
+		Lattice->Anchor.OriginY = Frame.OriginY;
+		Lattice->Anchor.StepX = Frame.StepX * 0.5;
+		Lattice->Anchor.StepY = Frame.StepY * 0.5;
+	}
+
+	//the level with more than one and up to two samples per frame pixel, which lasts
+	//an octave of zooming in. the buffer takes in a margin around the frame, so a
+	//path that drifts sideways does not need a new one every frame
+	const int32_t Level = (int32_t)floor(log2(2.0 * Lattice->Anchor.StepX / Frame.StepX) + 1e-9);
+	const double StepX = ldexp(Lattice->Anchor.StepX, -Level);
+	const double StepY = ldexp(Lattice->Anchor.StepY, -Level);
+	const double MarginX = (View->Width / LATTICE_MARGIN + 0.5) * Frame.StepX;
+	const double MarginY = (View->Height / LATTICE_MARGIN + 0.5) * Frame.StepY;
+	const int64_t FirstX = (int64_t)floor((Frame.OriginX - MarginX - Lattice->Anchor.OriginX) / StepX);
+	const int64_t LastX = (int64_t)ceil((Frame.OriginX + (View->Width - 1) * Frame.StepX + MarginX - Lattice->Anchor.OriginX) / StepX);
+	const int64_t FirstY = (int64_t)floor((Frame.OriginY - MarginY - Lattice->Anchor.OriginY) / StepY);
+	const int64_t LastY = (int64_t)ceil((Frame.OriginY + (View->Height - 1) * Frame.StepY + MarginY - Lattice->Anchor.OriginY) / StepY);
+
+	//the kernels only see the lattice, the view is there for the tiling and limit
+	struct CpuView Region = *View;
+	Region.Width = (uint32_t)(LastX - FirstX + 1);
+	Region.Height = (uint32_t)(LastY - FirstY + 1);
+
+	struct IterationBuffer Buffer;
+	IterationBufferInit(&Buffer, Region.Width, Region.Height);
+	if (Lattice->bFractions)
+		IterationBufferAddFractions(&Buffer);
+
+	struct LatticeRun Run;
+	InitFrame(Renderer, &Region, &Buffer, NULL, &Run.Frame);
+	Run.Frame.Grid = Lattice->Anchor;
+	Run.Frame.Grid.StepX = StepX;
+	Run.Frame.Grid.StepY = StepY;
+	Run.Frame.GridOffsetX = FirstX;
+	Run.Frame.GridOffsetY = FirstY;
+
+	const uint64_t ReusedPixels = bSameRegion ? CopyLatticeSamples(Lattice, Level, FirstX, FirstY, &Buffer, &Run) : 0;
+	if (!bSameRegion)
+		Run.ReuseStride = 0;
+
+	const uint32_t TaskCount = (Region.Height + TILE_SLICE_ROWS - 1) / TILE_SLICE_ROWS;
+	ThreadPoolRunStealing(Renderer->Pool, RenderLatticeRows, &Run, TaskCount, NULL);
+	Run.Frame.Steals = ThreadPoolGetStealCount(Renderer->Pool);
+
+	LatticeBufferRelease(Lattice);
+	Lattice->Buffer = Buffer;
+	Lattice->View = *View;
+	Lattice->bValid = true;
+	Lattice->Level = Level;
+	Lattice->OffsetX = FirstX;
+	Lattice->OffsetY = FirstY;
+
+	GetFrameStats(Renderer, &Run.Frame, StartTime, TaskCount, Stats);
+	if (Stats)
+		Stats->ReusedPixels = ReusedPixels;
+	return true;
+}
+
+static inline float frac(float x)
+{
+	return x - floorf(x);
+}
+
+static inline uint8_t FloatToUnorm8(float x)
+{
+	x = fminf(fmaxf(x, 0.0f), 1.0f);
+	return (uint8_t)(x * 255.0f + 0.5f);
+}
+
+void ColorizeIterations(const struct CpuView* restrict View, const struct IterationBuffer* restrict Buffer, uint8_t* restrict Rgba, size_t RowPitch)
+{
+	const float MaxIterations = (float)View->MaxIterations;
+
+	for (uint32_t y = 0; y < Buffer->Height; y++)
+	{
+		const uint32_t* restrict Row = Buffer->Iterations + (size_t)y * Buffer->Width;
+		uint8_t* restrict Out = Rgba + y * RowPitch;
+
+		for (uint32_t x = 0; x < Buffer->Width; x++)
+		{
+			float ColorIndex = frac((float)Row[x] / MaxIterations);
+			Out[x * 4 + 0] = FloatToUnorm8(frac(ColorIndex * 1));
+			Out[x * 4 + 1] = FloatToUnorm8(frac(ColorIndex * 3));
+			Out[x * 4 + 2] = FloatToUnorm8(frac(ColorIndex * 5));
+			Out[x * 4 + 3] = 0;
+		}
+	}
+}
+
+const char* const PaletteTypeNames[PALETTE_TYPE_COUNT] =
+{
+	"classic",
+	"fire",
+	"ice"
+};
+
+struct PaletteStop
+{
+	float Position;
+	float Color[3];
+};
+
+//the gradients start and end on the same colour so cycling them has no seam
+static const struct PaletteStop FireStops[] =
+{
+	{ 0.00f, { 0.00f, 0.00f, 0.00f } },
+	{ 0.30f, { 0.70f, 0.05f, 0.00f } },
+	{ 0.55f, { 1.00f, 0.55f, 0.00f } },
+	{ 0.75f, { 1.00f, 1.00f, 0.60f } },
+	{ 1.00f, { 0.00f, 0.00f, 0.00f } }
+};
+
+static const struct PaletteStop IceStops[] =
+{
+	{ 0.00f, { 0.00f, 0.00f, 0.00f } },
+	{ 0.35f, { 0.05f, 0.15f, 0.55f } },
+	{ 0.60f, { 0.20f, 0.75f, 0.95f } },
+	{ 0.80f, { 0.95f, 1.00f, 1.00f } },
+	{ 1.00f, { 0.00f, 0.00f, 0.00f } }
+};
+
+static uint32_t PackColor(uint8_t R, uint8_t G, uint8_t B)
+{
+	const uint8_t Bytes[4] = { R, G, B, 0 };
+	uint32_t Color;
+	memcpy(&Color, Bytes, sizeof(Color));
+	return Color;
+}
+
+static uint32_t SampleGradient(const struct PaletteStop* restrict Stops, uint32_t StopCount, float Position)
+{
+	uint32_t i = 1;
+	while (i < StopCount - 1 && Stops[i].Position < Position)
+		i++;
+
+	const struct PaletteStop* Lo = &Stops[i - 1];
+	const struct PaletteStop* Hi = &Stops[i];
+	const float t = (Position - Lo->Position) / (Hi->Position - Lo->Position);
+
+	uint8_t Channels[3];
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		Channels[c] = FloatToUnorm8(Lo->Color[c] + (Hi->Color[c] - Lo->Color[c]) * t);
+	}
+	return PackColor(Channels[0], Channels[1], Channels[2]);
+}
+
+void PaletteInit(struct Palette* restrict Palette, enum PaletteType Type, double CycleLength)
+{
+	CHECK_TRUE(Type < PALETTE_TYPE_COUNT);
+	CHECK_TRUE(CycleLength > 0.0);
+
+	for (uint32_t i = 0; i < PALETTE_SIZE; i++)
+	{
+		const float c = (float)i / PALETTE_SIZE;
+		switch (Type)
+		{
+		case PALETTE_TYPE_CLASSIC:
+			Palette->Colors[i] = PackColor(FloatToUnorm8(frac(c * 1)), FloatToUnorm8(frac(c * 3)), FloatToUnorm8(frac(c * 5)));
+			break;
+		case PALETTE_TYPE_FIRE:
+			Palette->Colors[i] = SampleGradient(FireStops, sizeof(FireStops) / sizeof(FireStops[0]), c);
+			break;
+		default:
+			Palette->Colors[i] = SampleGradient(IceStops, sizeof(IceStops) / sizeof(IceStops[0]), c);
+			break;
+		}
+	}
+
+	Palette->CycleLength = CycleLength;
+	Palette->Offset = 0.0;
+}
+
+//index = (iterations + fraction / 256) * PALETTE_SIZE / CycleLength + Offset * PALETTE_SIZE,
+//in 40.24 fixed point so the inner loop is a multiply, an add and a shift.
+//wrapping past 2^64 only drops whole trips around the table
+struct PaletteMapping
+{
+	uint64_t Scale;
+	uint64_t Phase;
+};
+
+static void GetPaletteMapping(const struct Palette* restrict Palette, struct PaletteMapping* restrict Mapping)
+{
+	Mapping->Scale = (uint64_t)llround(PALETTE_SIZE * 65536.0 / Palette->CycleLength);
+	Mapping->Phase = (uint64_t)llround((Palette->Offset - floor(Palette->Offset)) * PALETTE_SIZE * 16777216.0);
+}
+
+static inline uint32_t MapPalette(const struct Palette* restrict Palette, struct PaletteMapping Mapping, uint32_t Iterations, uint8_t Fraction)
+{
+	const uint64_t Index = (((((uint64_t)Iterations << 8) + Fraction) * Mapping.Scale + Mapping.Phase) >> 24) & (PALETTE_SIZE - 1);
+	return Palette->Colors[Index];
+}
+
+void ColorizePalette(const struct Palette* restrict Palette, const struct IterationBuffer* restrict Buffer, uint8_t* restrict Rgba, size_t RowPitch)
+{
+	struct PaletteMapping Mapping;
+	GetPaletteMapping(Palette, &Mapping);
+
+	//integer only, so every isa writes the same bytes
+	const PaletteRowKernel Kernel = PaletteRowKernels[GetBestKernelIsa()];
+
+	struct PaletteRowJob Job;
+	Job.Colors = Palette->Colors;
+	Job.IndexMask = PALETTE_SIZE - 1;
+	Job.Scale = Mapping.Scale;
+	Job.Phase = Mapping.Phase;
+	Job.Count = Buffer->Width;
+
+	for (uint32_t y = 0; y < Buffer->Height; y++)
+	{
+		const size_t Offset = (size_t)y * Buffer->Width;
+		Job.Iterations = Buffer->Iterations + Offset;
+		Job.Fractions = Buffer->Fractions ? Buffer->Fractions + Offset : NULL;
+		Kernel(&Job, Rgba + y * RowPitch);
+	}
+}
+
+//sub-sample positions a stratum of an antialiased pixel can jitter between, per axis
+#define ANTIALIAS_JITTER_STEPS 8
+
+//samples every flagged pixel starts with, the rest only go to pixels these disagree on
+#define ANTIALIAS_FIRST_SIDE 2
+
+//one row of AntialiasRow per thread. Width entries each, the samples Width * CPU_ANTIALIAS_MAX_SIDE
+struct AntialiasScratch
+{
+	uint32_t* Pixels;		//flagged columns of the row
+	uint32_t* Indices;		//entries of Pixels the next pass samples
+	uint32_t (*Sum)[4];
+	uint32_t* SampleCount;
+	int64_t* Low;			//smooth iterations of the samples so far, as GetSmoothIterations
+	int64_t* High;
+	int64_t* Columns;
+	uint32_t* Iterations;
+	uint8_t* Fractions;
+};
+
+struct AntialiasContext
+{
+	struct FrameContext Frame;
+	const struct Palette* Palette;
+	struct PaletteMapping Mapping;
+	uint32_t Side;				//samples per axis of a flagged pixel
+	int64_t Threshold;			//in 1/256ths of an iteration
+	uint8_t* Rgba;
+	size_t RowPitch;
+	struct AntialiasScratch* Scratch;	//one per thread
+	volatile int64_t SupersampledPixels;
+};
+
+static inline int64_t GetSmoothIterations(const struct IterationBuffer* restrict Buffer, size_t Offset)
+{
+	return ((int64_t)Buffer->Iterations[Offset] << 8) + (Buffer->Fractions ? Buffer->Fractions[Offset] : 0);
+}
+
+static bool IsAntialiasEdge(const struct AntialiasContext* restrict Context, uint32_t x, uint32_t y)
+{
+	const struct IterationBuffer* Buffer = Context->Frame.Buffer;
+	const size_t Offset = (size_t)y * Buffer->Width + x;
+	const int64_t Value = GetSmoothIterations(Buffer, Offset);
+
+	if (x > 0 && llabs(GetSmoothIterations(Buffer, Offset - 1) - Value) > Context->Threshold)
+		return true;
+	if (x + 1 < Buffer->Width && llabs(GetSmoothIterations(Buffer, Offset + 1) - Value) > Context->Threshold)
+		return true;
+	if (y > 0 && llabs(GetSmoothIterations(Buffer, Offset - Buffer->Width) - Value) > Context->Threshold)
+		return true;
+	if (y + 1 < Buffer->Height && llabs(GetSmoothIterations(Buffer, Offset + Buffer->Width) - Value) > Context->Threshold)
+		return true;
+	return false;
+}
+
+//jitter of a sample, the same for every run and thread count
+static inline uint32_t GetJitter(uint32_t x, uint32_t y, uint32_t Salt)
+{
+	uint32_t Hash = x * 0x9E3779B1u ^ y * 0x85EBCA77u ^ Salt * 0xC2B2AE3Du;
+	Hash ^= Hash >> 15;
+	Hash *= 0x2C1B3C6Du;
+	Hash ^= Hash >> 12;
+	return Hash;
+}
+
+//Side x Side stratified samples over each of the Count pixels of row y that
+//Scratch->Indices picks, each pixel in the middle of its samples. a sub-row of
+//all of them is one kernel call on a grid ANTIALIAS_JITTER_STEPS times finer than
+//a stratum, so the kernels get whole vectors however scattered the pixels are
+static uint64_t SupersamplePixels(const struct AntialiasContext* restrict Context, struct AntialiasScratch* restrict Scratch, uint32_t y, uint32_t Count, uint32_t Side)
+{
+	const struct FrameContext* Frame = &Context->Frame;
+	const int64_t SubSteps = (int64_t)Side * ANTIALIAS_JITTER_STEPS;
+
+	struct RowJob Job;
+	InitRowJob(Frame, &Job);
+	Job.StepX /= SubSteps;
+	Job.StepY /= SubSteps;
+	Job.Columns = Scratch->Columns;
+	Job.Count = Count * Side;
+	if (Frame->Buffer->Fractions)
+		Job.Fractions = Scratch->Fractions;
+	else
+		memset(Scratch->Fractions, 0, Job.Count);
+
+	uint64_t Total = 0;
+	for (uint32_t Row = 0; Row < Side; Row++)
+	{
+		const uint32_t Salt = (Side * CPU_ANTIALIAS_MAX_SIDE + Row) * (CPU_ANTIALIAS_MAX_SIDE + 1);
+		for (uint32_t i = 0; i < Count; i++)
+		{
+			const uint32_t x = Scratch->Pixels[Scratch->Indices[i]];
+			for (uint32_t Column = 0; Column < Side; Column++)
+			{
+				const uint32_t Jitter = GetJitter(x, y, Salt + Column) % ANTIALIAS_JITTER_STEPS;
+				Scratch->Columns[i * Side + Column] = (Frame->GridOffsetX + x) * SubSteps - SubSteps / 2 + Column * ANTIALIAS_JITTER_STEPS + Jitter;
+			}
+		}
+
+		const uint32_t Jitter = GetJitter(UINT32_MAX, y, Salt + Side) % ANTIALIAS_JITTER_STEPS;
+		Job.Y = (Frame->GridOffsetY + y) * SubSteps - SubSteps / 2 + Row * ANTIALIAS_JITTER_STEPS + Jitter;
+		Total += Frame->Kernel(&Job, Scratch->Iterations);
+
+		for (uint32_t i = 0; i < Job.Count; i++)
+		{
+			const uint32_t Pixel = Scratch->Indices[i / Side];
+			const int64_t Value = ((int64_t)Scratch->Iterations[i] << 8) + Scratch->Fractions[i];
+			Scratch->Low[Pixel] = min(Scratch->Low[Pixel], Value);
+			Scratch->High[Pixel] = max(Scratch->High[Pixel], Value);
+
+			uint8_t Color[4];
+			const uint32_t Packed = MapPalette(Context->Palette, Context->Mapping, Scratch->Iterations[i], Scratch->Fractions[i]);
+			memcpy(Color, &Packed, 4);
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				Scratch->Sum[Pixel][c] += Color[c];
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < Count; i++)
+	{
+		Scratch->SampleCount[Scratch->Indices[i]] += Side * Side;
+	}
+	return Total;
+}
+
+//ANTIALIAS_FIRST_SIDE^2 samples of every flagged pixel of the row, then Side^2
+//more of the ones whose samples still disagree
+static void AntialiasRow(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	struct AntialiasContext* Antialias = Context;
+	struct AntialiasScratch* Scratch = &Antialias->Scratch[ThreadIndex];
+	const struct IterationBuffer* Buffer = Antialias->Frame.Buffer;
+	const uint32_t y = TaskIndex;
+
+	uint32_t Count = 0;
+	for (uint32_t x = 0; x < Buffer->Width; x++)
+	{
+		if (!IsAntialiasEdge(Antialias, x, y))
+			continue;
+
+		const int64_t Value = GetSmoothIterations(Buffer, (size_t)y * Buffer->Width + x);
+		Scratch->Pixels[Count] = x;
+		Scratch->Indices[Count] = Count;
+		memset(Scratch->Sum[Count], 0, sizeof(Scratch->Sum[Count]));
+		Scratch->SampleCount[Count] = 0;
+		Scratch->Low[Count] = Value;
+		Scratch->High[Count] = Value;
+		Count++;
+	}
+	if (Count == 0)
+		return;
+
+	const uint32_t FirstSide = min(ANTIALIAS_FIRST_SIDE, Antialias->Side);
+	uint64_t Total = SupersamplePixels(Antialias, Scratch, y, Count, FirstSide);
+
+	if (Antialias->Side > FirstSide)
+	{
+		uint32_t RefineCount = 0;
+		for (uint32_t i = 0; i < Count; i++)
+		{
+			if (Scratch->High[i] - Scratch->Low[i] > Antialias->Threshold)
+				Scratch->Indices[RefineCount++] = i;
+		}
+		if (RefineCount != 0)
+			Total += SupersamplePixels(Antialias, Scratch, y, RefineCount, Antialias->Side);
+	}
+
+	uint8_t* restrict Out = Antialias->Rgba + y * Antialias->RowPitch;
+	for (uint32_t i = 0; i < Count; i++)
+	{
+		const uint32_t SampleCount = Scratch->SampleCount[i];
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			Out[Scratch->Pixels[i] * 4 + c] = (uint8_t)((Scratch->Sum[i][c] + SampleCount / 2) / SampleCount);
+		}
+	}
+
+	AtomicAdd64(&Antialias->Frame.TotalIterations, (int64_t)Total);
+	AtomicAdd64(&Antialias->SupersampledPixels, Count);
+}
+
+void CpuRenderFrameAntialiased(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, const struct Palette* restrict Palette, const struct AntialiasSettings* restrict Settings, uint8_t* restrict Rgba, size_t RowPitch, struct CpuRenderStats* restrict Stats)
+{
+	CHECK_TRUE(Settings->MaxSamples >= 1 && Settings->Threshold >= 0.0f);
+
+	const double StartTime = GetTime();
+
+	struct AntialiasContext Context;
+	memset(&Context, 0, sizeof(struct AntialiasContext));
+	InitFrame(Renderer, View, Buffer, NULL, &Context.Frame);
+	const uint32_t TileCount = RenderRect(Renderer, &Context.Frame, 0, 0, View->Width, View->Height);
+
+	ColorizePalette(Palette, Buffer, Rgba, RowPitch);
+
+	Context.Palette = Palette;
+	GetPaletteMapping(Palette, &Context.Mapping);
+	Context.Side = 1;
+	while ((Context.Side + 1) * (Context.Side + 1) <= min(Settings->MaxSamples, CPU_ANTIALIAS_MAX_SIDE * CPU_ANTIALIAS_MAX_SIDE))
+		Context.Side++;
+	Context.Threshold = (int64_t)(Settings->Threshold * 256.0f);
+	Context.Rgba = Rgba;
+	Context.RowPitch = RowPitch;
+
+	if (Context.Side > 1)
+	{
+		const uint32_t ThreadCount = ThreadPoolGetThreadCount(Renderer->Pool);
+		const size_t Width = View->Width;
+		const size_t SampleCount = Width * CPU_ANTIALIAS_MAX_SIDE;
+		Context.Scratch = malloc(ThreadCount * sizeof(struct AntialiasScratch));
+		CHECK_ALLOC(Context.Scratch);
+		for (uint32_t i = 0; i < ThreadCount; i++)
+		{
+			struct AntialiasScratch* Scratch = &Context.Scratch[i];
+			Scratch->Pixels = AlignedAlloc(Width * sizeof(uint32_t), 64);
+			Scratch->Indices = AlignedAlloc(Width * sizeof(uint32_t), 64);
+			Scratch->Sum = AlignedAlloc(Width * sizeof(Scratch->Sum[0]), 64);
+			Scratch->SampleCount = AlignedAlloc(Width * sizeof(uint32_t), 64);
+			Scratch->Low = AlignedAlloc(Width * sizeof(int64_t), 64);
+			Scratch->High = AlignedAlloc(Width * sizeof(int64_t), 64);
+			Scratch->Columns = AlignedAlloc(SampleCount * sizeof(int64_t), 64);
+			Scratch->Iterations = AlignedAlloc(SampleCount * sizeof(uint32_t), 64);
+			Scratch->Fractions = AlignedAlloc(SampleCount, 64);
+		}
+
+		ThreadPoolRun(Renderer->Pool, AntialiasRow, &Context, View->Height);
+
+		for (uint32_t i = 0; i < ThreadCount; i++)
+		{
+			struct AntialiasScratch* Scratch = &Context.Scratch[i];
+			AlignedFree(Scratch->Pixels);
+			AlignedFree(Scratch->Indices);
+			AlignedFree(Scratch->Sum);
+			AlignedFree(Scratch->SampleCount);
+			AlignedFree(Scratch->Low);
+			AlignedFree(Scratch->High);
+			AlignedFree(Scratch->Columns);
+			AlignedFree(Scratch->Iterations);
+			AlignedFree(Scratch->Fractions);
+		}
+		free(Context.Scratch);
+	}
+
+	GetFrameStats(Renderer, &Context.Frame, StartTime, TileCount, Stats);
+	if (Stats)
+		Stats->SupersampledPixels = (uint64_t)Context.SupersampledPixels;
+}
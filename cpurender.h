@@ -0,0 +1,377 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//headless cpu implementation of the escape time kernels in the .hlsl files
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "fractal.h"
+
+#define CPU_RENDER_DEFAULT_TILE_SIZE 64
+
+//pixels of a row a reprojected frame iterates at once, a whole vector for every isa
+#define CPU_ZOOM_BLOCK_WIDTH 16
+
+//cpu side copy of ConstantBufferData, kept in double so it can go deeper than the gpu path
+struct CpuView
+{
+	enum FractalSet Set;
+	enum FractalType Type;
+	uint32_t Width;			//MaxIterations.x
+	uint32_t Height;		//MaxIterations.y
+	uint32_t MaxIterations;	//MaxIterations.z, before the per set multiplier
+	double WindowPos[4];	//view extent xy, view centre zw
+	double JuliaPos[2];
+};
+
+//maps a pixel index to the complex plane: c = Origin + Pixel * Step
+struct PixelGrid
+{
+	double OriginX;
+	double OriginY;
+	double StepX;
+	double StepY;
+};
+
+struct FractalFormula
+{
+	const char* Name;
+	uint32_t IterationMultiplier;	//the .hlsl kernels run MaxIterations.z times this
+	float Bailout;					//escape when dot(z, z) reaches this
+	float Degree;					//|z| grows like |z|^Degree once it escapes
+	bool bConnected;				//the set and its julia sets for bounded critical orbits are connected
+	bool bConjugateSymmetric;		//the set mirrors onto itself about the real axis
+	bool bEven;						//f(-z) = f(z), every julia set is point symmetric about 0
+};
+
+extern const struct FractalFormula FractalFormulas[FRACTAL_SET_COUNT];
+
+enum KernelIsa
+{
+	KERNEL_ISA_SCALAR,
+	KERNEL_ISA_AVX2,
+	KERNEL_ISA_AVX512,
+	KERNEL_ISA_COUNT
+};
+
+extern const char* const KernelIsaNames[KERNEL_ISA_COUNT];
+
+//number formats a frame can be iterated in, cheapest first
+enum PrecisionTier
+{
+	PRECISION_TIER_FLOAT,			//the .hlsl kernels as they are
+	PRECISION_TIER_DOUBLE,
+	PRECISION_TIER_FIXED,			//Q4.60 integers, bit for bit the same on every isa
+	PRECISION_TIER_PERTURBATION,	//double offsets from a BigFloat reference orbit
+	PRECISION_TIER_DOUBLE_DOUBLE,
+	PRECISION_TIER_QUAD_DOUBLE,
+	PRECISION_TIER_COUNT
+};
+
+extern const char* const PrecisionTierNames[PRECISION_TIER_COUNT];
+
+struct IterationBuffer
+{
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t* Iterations;
+	uint8_t* Fractions;		//smooth iteration fraction in 1/256ths, NULL unless IterationBufferAddFractions was called
+};
+
+#define PALETTE_SIZE 1024
+
+enum PaletteType
+{
+	PALETTE_TYPE_CLASSIC,	//the frac(c * 1), frac(c * 3), frac(c * 5) ramp of myConsumer
+	PALETTE_TYPE_FIRE,
+	PALETTE_TYPE_ICE,
+	PALETTE_TYPE_COUNT
+};
+
+extern const char* const PaletteTypeNames[PALETTE_TYPE_COUNT];
+
+//lookup table the colouring pass maps iteration counts through
+struct Palette
+{
+	uint32_t Colors[PALETTE_SIZE];	//R8G8B8A8 in memory order
+	double CycleLength;				//iterations per trip around Colors
+	double Offset;					//part of a trip to rotate by, moving it cycles the colours
+};
+
+//samples per axis a pixel of an antialiased frame can take
+#define CPU_ANTIALIAS_MAX_SIDE 8
+
+struct AntialiasSettings
+{
+	uint32_t MaxSamples;	//samples a flagged pixel averages, rounded down to a square up to CPU_ANTIALIAS_MAX_SIDE^2
+	float Threshold;		//iterations, fraction included, a pixel may differ from a neighbour by before it is flagged
+};
+
+struct OrbitState;
+
+//per pixel state kept between frames of one view, so raising MaxIterations
+//only iterates pixels that ran into the old limit, from where they stopped
+struct ResumeBuffer
+{
+	struct IterationBuffer Buffer;
+	struct CpuView View;		//the view Buffer holds, MaxIterations is the limit it was left at
+	bool bValid;
+	uint8_t* Status;			//enum PixelStatus per pixel
+	struct OrbitState* Orbits;
+};
+
+//iteration buffer kept between frames of a pan. every frame sits on the pixel
+//grid of the frame the pan started from, so scrolled pixels keep their exact coordinates
+struct PanBuffer
+{
+	struct IterationBuffer Buffer;
+	struct CpuView View;		//the view Buffer holds, centre snapped to Anchor
+	bool bValid;
+	struct PixelGrid Anchor;
+	int64_t OffsetX;			//whole pixels Buffer is scrolled from Anchor
+	int64_t OffsetY;
+};
+
+//iteration buffer kept between frames of a zoom. a new view starts out as the
+//previous frame resampled onto it, then the worst pixels are iterated exactly
+//within a per frame budget until the frame converges
+struct ZoomBuffer
+{
+	struct IterationBuffer Buffer;
+	struct CpuView View;		//the view Buffer holds
+	bool bValid;
+	float* Priority;			//0 for exact pixels, else the footprint in pixels of the sample shown plus frames since it was exact
+	uint32_t* ScratchIterations;
+	uint8_t* ScratchFractions;	//allocated once Buffer has fractions
+	float* ScratchPriority;
+	uint8_t* BlockBuckets;		//per CPU_ZOOM_BLOCK_WIDTH pixels of a row
+	uint32_t* BlockOrder;		//blocks still to iterate, most urgent first
+};
+
+//iteration buffer on a lattice of power of two pixel sizes, kept between frames
+//of a zoom animation. level L has 2^L times as many pixels per unit as level 0,
+//and every pixel of a level sits exactly on a pixel of the next finer one, so a
+//buffer shares all its samples with a buffer of the same level and a quarter of
+//them with one a level coarser
+struct LatticeBuffer
+{
+	struct IterationBuffer Buffer;	//empty until the first frame
+	struct CpuView View;		//Set, Type, MaxIterations and JuliaPos Buffer holds, the rest is unused
+	bool bValid;
+	bool bFractions;			//give Buffer fractions, set before the first frame
+	struct PixelGrid Anchor;	//level 0, from the first frame
+	int32_t Level;
+	int64_t OffsetX;			//Buffer pixel (x, y) is pixel (x + OffsetX, y + OffsetY) of Level
+	int64_t OffsetY;
+};
+
+struct CpuRenderStats
+{
+	double Seconds;
+	uint64_t TotalIterations;
+	uint32_t TileCount;
+	uint32_t ThreadCount;
+	enum KernelIsa Isa;
+	enum PrecisionTier Tier;
+	uint64_t FilledPixels;	//pixels subdivision filled in without iterating them
+	uint64_t ReusedPixels;	//pixels a pan scrolled over or a zoom resampled from the previous frame
+	uint64_t PendingPixels;	//pixels a reprojected frame still shows resampled values for
+	uint32_t Steals;		//task ranges threads that ran dry took over from busy ones
+	uint64_t SupersampledPixels;	//pixels an antialiased frame took more than one sample of
+	uint64_t MirroredPixels;	//pixels copied from their mirror image across a symmetry axis
+};
+
+struct CpuRenderer;
+struct ThreadPool;
+struct UserFormula;
+
+//the same defaults WndProc sets up in WM_INIT
+void CpuViewSetDefault(struct CpuView* restrict View, enum FractalSet Set, enum FractalType Type, uint32_t Width, uint32_t Height);
+void CpuViewFromConstantBuffer(struct CpuView* restrict View, const struct ConstantBufferData* restrict CbData, enum FractalSet Set, enum FractalType Type);
+void CpuViewGetPixelGrid(const struct CpuView* restrict View, struct PixelGrid* restrict Grid);
+uint32_t CpuViewGetIterationLimit(const struct CpuView* restrict View);
+
+void IterationBufferInit(struct IterationBuffer* restrict Buffer, uint32_t Width, uint32_t Height);
+void IterationBufferRelease(struct IterationBuffer* restrict Buffer);
+
+//CpuRenderFrame, CpuRenderFrameResumable, CpuRenderFramePanned and
+//CpuRenderFrameReprojected fill Fractions in, the latter two carrying them along
+//with the reused pixels. the other render paths zero them. subdivision is skipped for such buffers, a filled pixel has no fraction
+void IterationBufferAddFractions(struct IterationBuffer* restrict Buffer);
+void IterationBufferClearFractions(struct IterationBuffer* restrict Buffer);
+
+void ResumeBufferInit(struct ResumeBuffer* restrict Resume, uint32_t Width, uint32_t Height);
+void ResumeBufferRelease(struct ResumeBuffer* restrict Resume);
+
+void PanBufferInit(struct PanBuffer* restrict Pan, uint32_t Width, uint32_t Height);
+void PanBufferRelease(struct PanBuffer* restrict Pan);
+
+void ZoomBufferInit(struct ZoomBuffer* restrict Zoom, uint32_t Width, uint32_t Height);
+void ZoomBufferRelease(struct ZoomBuffer* restrict Zoom);
+
+void LatticeBufferInit(struct LatticeBuffer* restrict Lattice);
+void LatticeBufferRelease(struct LatticeBuffer* restrict Lattice);
+
+//Lattice->Buffer pixel (x, y) is at Grid->Origin + (x, y) * Grid->Step
+void LatticeBufferGetGrid(const struct LatticeBuffer* restrict Lattice, struct PixelGrid* restrict Grid);
+
+bool IsKernelIsaSupported(enum KernelIsa Isa);
+enum KernelIsa GetBestKernelIsa(void);
+
+//ThreadCount == 0 uses every core, TileSize == 0 uses CPU_RENDER_DEFAULT_TILE_SIZE.
+//the widest isa the cpu supports is picked at creation
+struct CpuRenderer* CpuRendererCreate(uint32_t ThreadCount, uint32_t TileSize);
+void CpuRendererDestroy(struct CpuRenderer* Renderer);
+
+//returns false and keeps the current kernels if the cpu lacks Isa
+bool CpuRendererSetIsa(struct CpuRenderer* Renderer, enum KernelIsa Isa);
+enum KernelIsa CpuRendererGetIsa(const struct CpuRenderer* Renderer);
+
+//Mariani-Silver subdivision, off by default. only used for views where IsSubdivisionSafe holds
+void CpuRendererSetSubdivision(struct CpuRenderer* Renderer, bool bEnable);
+bool CpuRendererGetSubdivision(const struct CpuRenderer* Renderer);
+
+//cardioid/bulb test and cycle detection, on by default. pixels found to be
+//inside get the iteration limit without running to it
+void CpuRendererSetInteriorChecks(struct CpuRenderer* Renderer, bool bEnable);
+bool CpuRendererGetInteriorChecks(const struct CpuRenderer* Renderer);
+
+//polynomial atan2 and sin in the float mosaic kernels, off by default. several
+//times faster, but the mosaic orbits amplify the approximation error, so a small
+//share of the pixels ends a few iterations away from the exact path
+void CpuRendererSetFastMath(struct CpuRenderer* Renderer, bool bEnable);
+bool CpuRendererGetFastMath(const struct CpuRenderer* Renderer);
+
+//runs Formula through the bytecode kernels in place of the formula of the view's
+//set, NULL goes back to the built in ones. the set still picks the iteration
+//multiplier. frames of a user formula are neither mirrored nor subdivided, and
+//the render paths outside cpurender.c keep to the built in formulas. Formula has
+//to outlive the frames rendered with it
+void CpuRendererSetFormula(struct CpuRenderer* Renderer, const struct UserFormula* Formula);
+const struct UserFormula* CpuRendererGetFormula(const struct CpuRenderer* Renderer);
+
+//for render paths that live outside cpurender.c but share its threads and tiling
+struct ThreadPool* CpuRendererGetThreadPool(struct CpuRenderer* Renderer);
+uint32_t CpuRendererGetTileSize(const struct CpuRenderer* Renderer);
+
+//computes Count pixels of row y starting at column x into Out, returns their iteration sum
+typedef uint64_t (*PixelRun)(void* Context, uint32_t x, uint32_t y, uint32_t Count, uint32_t* restrict Out);
+
+//a rectangle whose border has a single iteration count can only hold that count
+//when every level set of the escape time is connected. true for connected sets,
+//and for their julia sets when the critical orbit of JuliaPos stays bounded
+bool IsSubdivisionSafe(enum FractalSet Set, enum FractalType Type, const double JuliaPos[2], uint32_t Limit);
+
+//renders one tile by Mariani-Silver subdivision: borders are iterated, rectangles
+//with a uniform border are filled, the rest are split in four. returns the
+//iteration sum of the pixels it iterated and adds the filled ones to *FilledPixels
+uint64_t SubdivideTile(PixelRun Run, void* Context, struct IterationBuffer* restrict Buffer, uint32_t TileX, uint32_t TileY, uint32_t TileWidth, uint32_t TileHeight, uint64_t* restrict FilledPixels);
+
+enum SymmetryType
+{
+	SYMMETRY_NONE,
+	SYMMETRY_CONJUGATE,	//about the real axis, the base sets with bConjugateSymmetric
+	SYMMETRY_POINT,		//through 0, the julia sets of even formulas
+	SYMMETRY_TYPE_COUNT
+};
+
+enum SymmetryType GetSymmetryType(enum FractalSet Set, enum FractalType Type);
+
+//the part of a buffer that is the mirror image of another part. MirrorY is twice
+//the buffer row of the axis, rows FirstRow .. FirstRow + RowCount - 1 are copied
+//from row MirrorY - y. point symmetry reverses them too, column x coming from
+//MirrorX - x, and the columns of those rows without a mirror in the buffer are
+//left to Rects, which is everything that still has to be iterated
+struct FrameSymmetry
+{
+	enum SymmetryType Type;
+	int64_t MirrorX;
+	int64_t MirrorY;
+	uint32_t FirstRow;
+	uint32_t RowCount;
+	uint32_t FirstColumn;
+	uint32_t ColumnCount;
+	uint32_t RectCount;
+	uint32_t Rects[4][4];	//x, y, width, height
+};
+
+//false when no two rows (columns) of the buffer mirror each other. the caller
+//has to make sure the kernels see exactly negated coordinates for each pair
+bool GetFrameSymmetry(enum SymmetryType Type, uint32_t Width, uint32_t Height, int64_t MirrorX, int64_t MirrorY, struct FrameSymmetry* restrict Symmetry);
+
+//fills in the mirrored part once Rects are iterated, returns its pixel count
+uint64_t MirrorIterations(const struct FrameSymmetry* restrict Symmetry, struct IterationBuffer* restrict Buffer);
+
+//Buffer must already be sized to View->Width x View->Height
+void CpuRenderFrame(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats);
+
+//the Buffer sized part of View from (FirstColumn, FirstRow) on, exactly as
+//CpuRenderFrame would render it, so a frame too big to hold can be rendered a
+//piece at a time. subdivision only matches on multiples of the tile size
+void CpuRenderFrameRegion(struct CpuRenderer* Renderer, const struct CpuView* restrict View, uint32_t FirstColumn, uint32_t FirstRow, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats);
+
+//called after each pass of CpuRenderFrameProgressive with Stats for the frame so
+//far. every sample of the pass fills the Stride x Stride block below and right of it
+typedef void (*ProgressivePass)(void* Context, const struct IterationBuffer* restrict Buffer, uint32_t Stride, const struct CpuRenderStats* restrict Stats);
+
+//CpuRenderFrame in passes at 1/8, 1/4, 1/2 and full resolution. each pass only
+//iterates the pixels the ones before it have not, so the last pass ends with the
+//buffer CpuRenderFrame gives for the same work. never subdivides
+void CpuRenderFrameProgressive(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, ProgressivePass Pass, void* Context, struct CpuRenderStats* restrict Stats);
+
+//CpuRenderFrame into Resume->Buffer. when Resume holds the same view at a lower
+//MaxIterations only the pixels that hit that limit are iterated on, otherwise
+//the frame is rendered from scratch. never subdivides, a filled pixel has no orbit to resume
+void CpuRenderFrameResumable(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct ResumeBuffer* restrict Resume, struct CpuRenderStats* restrict Stats);
+
+//CpuRenderFrame into Pan->Buffer. when Pan holds the same view apart from its
+//centre, the centre of View is snapped to a whole pixel offset from the pan's
+//first frame, the previous pixels are scrolled by that offset and only the
+//exposed strips are iterated. any other change renders from scratch and starts a new pan
+void CpuRenderFramePanned(struct CpuRenderer* Renderer, struct CpuView* restrict View, struct PanBuffer* restrict Pan, struct CpuRenderStats* restrict Stats);
+
+//CpuRenderFrame into Zoom->Buffer, bounded by IterationBudget. when Zoom holds the
+//same view apart from WindowPos the previous frame is resampled onto View, then
+//the blocks with the largest magnified or oldest samples are iterated until the
+//budget is spent. returns true once every pixel is exact. IterationBudget == 0,
+//or any other change to the view, renders the whole frame
+bool CpuRenderFrameReprojected(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct ZoomBuffer* restrict Zoom, uint64_t IterationBudget, struct CpuRenderStats* restrict Stats);
+
+//makes Lattice->Buffer cover View, pixel footprints included, with from one to
+//four samples per pixel of View along each axis. returns false and renders nothing
+//when the buffer it has already does. otherwise a buffer is rendered at the level
+//with more than one and up to two, copying every sample it shares with the old
+//one, and Stats is written. the first frame of a view region puts level 0 at twice its resolution
+bool CpuRenderFrameLattice(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct LatticeBuffer* restrict Lattice, struct CpuRenderStats* restrict Stats);
+
+//the colouring at the end of myConsumer, written as R8G8B8A8_UNORM
+void ColorizeIterations(const struct CpuView* restrict View, const struct IterationBuffer* restrict Buffer, uint8_t* restrict Rgba, size_t RowPitch);
+
+//PALETTE_TYPE_CLASSIC with CycleLength = MaxIterations.z matches ColorizeIterations to the table's resolution
+void PaletteInit(struct Palette* restrict Palette, enum PaletteType Type, double CycleLength);
+
+//ColorizeIterations through Palette, without running any kernel again. uses
+//Buffer->Fractions when it has them, which blends the bands into each other
+void ColorizePalette(const struct Palette* restrict Palette, const struct IterationBuffer* restrict Buffer, uint8_t* restrict Rgba, size_t RowPitch);
+
+//CpuRenderFrame coloured through Palette, after which every pixel whose smooth
+//iteration count is more than Settings->Threshold away from one of its four
+//neighbours is replaced by the mean colour of MaxSamples jittered samples spread
+//over it. Buffer keeps the one sample per pixel frame
+void CpuRenderFrameAntialiased(struct CpuRenderer* Renderer, const struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, const struct Palette* restrict Palette, const struct AntialiasSettings* restrict Settings, uint8_t* restrict Rgba, size_t RowPitch, struct CpuRenderStats* restrict Stats);
@@ -0,0 +1,741 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include "deepzoom.h"
+#include "multidouble.h"
+#include "kernels.h"
+#include "threadpool.h"
+#include "platform.h"
+
+//bits kept below the pixel spacing while iterating the reference
+#define REFERENCE_GUARD_BITS 64
+
+//bits a tier needs beyond resolving one pixel, rounding error grows along the orbit
+#define PRECISION_GUARD_BITS 8
+
+//below this the squared offsets of the perturbation step leave the double exponent range
+#define PERTURBATION_MIN_STEP 1e-290
+
+struct ReferenceOrbit
+{
+	uint32_t Length;
+	double* X;
+	double* Y;
+};
+
+struct DeepFrameContext
+{
+	const struct DeepView* View;
+	struct IterationBuffer* Buffer;
+	const struct ReferenceOrbit* Start;		//orbit of the first iteration
+	const struct ReferenceOrbit* Rebase;	//orbit of zero, deltas get rebased onto this one
+	double PixelStepX;
+	double PixelStepY;
+	uint32_t Limit;
+	float Bailout;
+	uint32_t TileSize;
+	uint32_t TilesX;
+	bool bSubdivide;
+	bool bBulbs;			//cardioid/bulb test against the view centre in double
+	double CentreX;
+	double CentreY;
+	volatile int64_t TotalIterations;
+	volatile int64_t Rebases;
+	volatile int64_t FilledPixels;
+};
+
+//per tile, so rebases are only published once per tile
+struct DeepTile
+{
+	struct DeepFrameContext* Frame;
+	uint64_t Rebases;
+};
+
+static const RowKernel FloatRowKernels[KERNEL_ISA_COUNT] = {
+	ScalarRowKernel,
+	Avx2RowKernel,
+	Avx512RowKernel
+};
+
+static const MultiDoubleRowKernel MultiDoubleRowKernels[PRECISION_TIER_COUNT][KERNEL_ISA_COUNT] = {
+	[PRECISION_TIER_DOUBLE] = { ScalarDblRowKernel, Avx2DblRowKernel, Avx512DblRowKernel },
+	[PRECISION_TIER_FIXED] = { ScalarFixedRowKernel, Avx2FixedRowKernel, Avx512FixedRowKernel },
+	[PRECISION_TIER_DOUBLE_DOUBLE] = { ScalarDdRowKernel, Avx2DdRowKernel, Avx512DdRowKernel },
+	[PRECISION_TIER_QUAD_DOUBLE] = { ScalarQdRowKernel, Avx2QdRowKernel, Avx512QdRowKernel }
+};
+
+//significand bits of the tiers that iterate every pixel directly, fraction bits
+//for fixed point, whose resolution does not shrink with the magnitude. fixed is
+//picked between 53 and 60 required bits, pixel steps of about 3e-14 to 2e-16
+static const uint32_t PrecisionTierBits[PRECISION_TIER_COUNT] = {
+	[PRECISION_TIER_FLOAT] = 24,
+	[PRECISION_TIER_DOUBLE] = 53,
+	[PRECISION_TIER_FIXED] = 60,
+	[PRECISION_TIER_DOUBLE_DOUBLE] = 106,
+	[PRECISION_TIER_QUAD_DOUBLE] = 212
+};
+
+bool DeepZoomSupportsSet(enum FractalSet Set)
+{
+	return Set == FRACTAL_SET_MANDELBROT || Set == FRACTAL_SET_TRICORN || Set == FRACTAL_SET_BURNINGSHIP;
+}
+
+void DeepViewFromCpuView(struct DeepView* restrict DeepView, const struct CpuView* restrict View)
+{
+	DeepView->Set = View->Set;
+	DeepView->Type = View->Type;
+	DeepView->Width = View->Width;
+	DeepView->Height = View->Height;
+	DeepView->MaxIterations = View->MaxIterations;
+	DeepView->JuliaPos[0] = View->JuliaPos[0];
+	DeepView->JuliaPos[1] = View->JuliaPos[1];
+
+	for (int i = 0; i < 4; i++)
+	{
+		BigFloatFromDouble(&DeepView->WindowPos[i], View->WindowPos[i], BIGFLOAT_MAX_LIMBS);
+	}
+}
+
+void CpuViewFromDeepView(struct CpuView* restrict View, const struct DeepView* restrict DeepView)
+{
+	View->Set = DeepView->Set;
+	View->Type = DeepView->Type;
+	View->Width = DeepView->Width;
+	View->Height = DeepView->Height;
+	View->MaxIterations = DeepView->MaxIterations;
+	View->JuliaPos[0] = DeepView->JuliaPos[0];
+	View->JuliaPos[1] = DeepView->JuliaPos[1];
+
+	for (int i = 0; i < 4; i++)
+	{
+		View->WindowPos[i] = BigFloatToDouble(&DeepView->WindowPos[i]);
+	}
+}
+
+bool DeepViewSetWindow(struct DeepView* restrict DeepView, const char* const WindowPos[4])
+{
+	for (int i = 0; i < 4; i++)
+	{
+		if (!BigFloatFromString(&DeepView->WindowPos[i], WindowPos[i], BIGFLOAT_MAX_LIMBS))
+			return false;
+	}
+	return true;
+}
+
+//iterates the set's formula in BigFloat from (StartX, StartY) until it escapes or MaxLength entries exist
+static void ComputeReferenceOrbit(struct ReferenceOrbit* restrict Orbit, enum FractalSet Set, const struct BigFloat* StartX, const struct BigFloat* StartY, const struct BigFloat* Cx, const struct BigFloat* Cy, uint32_t MaxLength)
+{
+	Orbit->X = malloc(MaxLength * sizeof(double));
+	Orbit->Y = malloc(MaxLength * sizeof(double));
+	CHECK_ALLOC(Orbit->X);
+	CHECK_ALLOC(Orbit->Y);
+
+	struct BigFloat x = *StartX;
+	struct BigFloat y = *StartY;
+	struct BigFloat x2;
+	struct BigFloat y2;
+	struct BigFloat xy;
+
+	Orbit->X[0] = BigFloatToDouble(&x);
+	Orbit->Y[0] = BigFloatToDouble(&y);
+	Orbit->Length = 1;
+
+	while (Orbit->Length < MaxLength)
+	{
+		const double LastX = Orbit->X[Orbit->Length - 1];
+		const double LastY = Orbit->Y[Orbit->Length - 1];
+		if (LastX * LastX + LastY * LastY >= 16.0)
+			break;
+
+		BigFloatMul(&x2, &x, &x);
+		BigFloatMul(&y2, &y, &y);
+		BigFloatMul(&xy, &x, &y);
+
+		if (Set == FRACTAL_SET_BURNINGSHIP)
+			BigFloatAbs(&xy);
+
+		BigFloatSub(&x, &x2, &y2);
+		BigFloatAdd(&x, &x, Cx);
+		BigFloatMulInt(&y, &xy, Set == FRACTAL_SET_TRICORN ? -2 : 2);
+		BigFloatAdd(&y, &y, Cy);
+
+		Orbit->X[Orbit->Length] = BigFloatToDouble(&x);
+		Orbit->Y[Orbit->Length] = BigFloatToDouble(&y);
+		Orbit->Length++;
+	}
+}
+
+static void ReleaseReferenceOrbit(struct ReferenceOrbit* restrict Orbit)
+{
+	free(Orbit->X);
+	free(Orbit->Y);
+}
+
+//|a + b| - |a| without cancellation
+static inline double DiffAbs(double a, double b)
+{
+	if (a >= 0)
+		return (a + b >= 0) ? b : -(2 * a + b);
+	else
+		return (a + b > 0) ? (2 * a + b) : -b;
+}
+
+//one step of the difference between a pixel orbit and the reference at (X, Y)
+static FORCE_INLINE void PerturbStep(const enum FractalSet Set, double X, double Y, double* restrict Dx, double* restrict Dy, double Dcx, double Dcy)
+{
+	const double dx = *Dx;
+	const double dy = *Dy;
+	const double Cross = X * dy + Y * dx + dx * dy;
+
+	*Dx = (2 * X + dx) * dx - (2 * Y + dy) * dy + Dcx;
+
+	switch (Set)
+	{
+	case FRACTAL_SET_TRICORN:
+		*Dy = -2 * Cross + Dcy;
+		break;
+	case FRACTAL_SET_BURNINGSHIP:
+		*Dy = 2 * DiffAbs(X * Y, Cross) + Dcy;
+		break;
+	case FRACTAL_SET_MANDELBROT:
+	default:
+		*Dy = 2 * Cross + Dcy;
+		break;
+	}
+}
+
+static FORCE_INLINE uint32_t PerturbPixel(const enum FractalSet Set, const struct DeepFrameContext* restrict Frame, double Dx, double Dy, double Dcx, double Dcy, uint64_t* restrict Rebases)
+{
+	const struct ReferenceOrbit* Orbit = Frame->Start;
+	const uint32_t Limit = Frame->Limit;
+	const double Bailout = Frame->Bailout;
+	uint32_t m = 0;
+
+	//the .hlsl kernels start at z = c, one step past the usual z = 0
+	if (Frame->View->Type == FRACTAL_TYPE_BASE)
+	{
+		PerturbStep(Set, Orbit->X[0], Orbit->Y[0], &Dx, &Dy, Dcx, Dcy);
+		m = 1;
+	}
+
+	double Zx = Orbit->X[m] + Dx;
+	double Zy = Orbit->Y[m] + Dy;
+	uint32_t iter = 0;
+
+	while (iter < Limit)
+	{
+		const double Magnitude = Zx * Zx + Zy * Zy;
+		if (Magnitude >= Bailout)
+			break;
+
+		if (m == Orbit->Length - 1 || Magnitude < Dx * Dx + Dy * Dy)
+		{
+			Dx = Zx;
+			Dy = Zy;
+			Orbit = Frame->Rebase;
+			m = 0;
+			(*Rebases)++;
+		}
+
+		PerturbStep(Set, Orbit->X[m], Orbit->Y[m], &Dx, &Dy, Dcx, Dcy);
+		m++;
+
+		Zx = Orbit->X[m] + Dx;
+		Zy = Orbit->Y[m] + Dy;
+		iter++;
+	}
+
+	return iter;
+}
+
+static FORCE_INLINE uint64_t DeepRunImpl(const enum FractalSet Set, const struct DeepFrameContext* restrict Frame, uint32_t FirstX, uint32_t y, uint32_t Count, uint32_t* restrict Out, uint64_t* restrict Rebases)
+{
+	const struct DeepView* View = Frame->View;
+	const bool bBase = View->Type == FRACTAL_TYPE_BASE;
+	const double OffsetY = ((double)y - View->Height * 0.5) * Frame->PixelStepY;
+
+	uint64_t Total = 0;
+	for (uint32_t i = 0; i < Count; i++)
+	{
+		const double OffsetX = ((double)(FirstX + i) - View->Width * 0.5) * Frame->PixelStepX;
+
+		//not iterated, so it adds nothing to the total
+		if (Set == FRACTAL_SET_MANDELBROT && Frame->bBulbs && IsInMandelbrotBulbs(Frame->CentreX + OffsetX, Frame->CentreY + OffsetY))
+		{
+			Out[i] = Frame->Limit;
+			continue;
+		}
+
+		uint32_t iter;
+		if (bBase)
+			iter = PerturbPixel(Set, Frame, 0, 0, OffsetX, OffsetY, Rebases);
+		else
+			iter = PerturbPixel(Set, Frame, OffsetX, OffsetY, 0, 0, Rebases);
+
+		Out[i] = iter;
+		Total += iter;
+	}
+
+	return Total;
+}
+
+static uint64_t DeepRun(void* Context, uint32_t x, uint32_t y, uint32_t Count, uint32_t* restrict Out)
+{
+	struct DeepTile* Tile = Context;
+
+	switch (Tile->Frame->View->Set)
+	{
+	case FRACTAL_SET_TRICORN:
+		return DeepRunImpl(FRACTAL_SET_TRICORN, Tile->Frame, x, y, Count, Out, &Tile->Rebases);
+	case FRACTAL_SET_BURNINGSHIP:
+		return DeepRunImpl(FRACTAL_SET_BURNINGSHIP, Tile->Frame, x, y, Count, Out, &Tile->Rebases);
+	case FRACTAL_SET_MANDELBROT:
+	default:
+		return DeepRunImpl(FRACTAL_SET_MANDELBROT, Tile->Frame, x, y, Count, Out, &Tile->Rebases);
+	}
+}
+
+static void DeepRenderTile(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	(void)ThreadIndex;
+	struct DeepFrameContext* Frame = Context;
+	const struct DeepView* View = Frame->View;
+
+	const uint32_t TileX = (TaskIndex % Frame->TilesX) * Frame->TileSize;
+	const uint32_t TileY = (TaskIndex / Frame->TilesX) * Frame->TileSize;
+	const uint32_t TileWidth = min(Frame->TileSize, View->Width - TileX);
+	const uint32_t TileHeight = min(Frame->TileSize, View->Height - TileY);
+
+	struct DeepTile Tile = { 0 };
+	Tile.Frame = Frame;
+
+	uint64_t Total = 0;
+	if (Frame->bSubdivide)
+	{
+		uint64_t Filled = 0;
+		Total = SubdivideTile(DeepRun, &Tile, Frame->Buffer, TileX, TileY, TileWidth, TileHeight, &Filled);
+		AtomicAdd64(&Frame->FilledPixels, (int64_t)Filled);
+	}
+	else
+	{
+		for (uint32_t y = TileY; y < TileY + TileHeight; y++)
+		{
+			Total += DeepRun(&Tile, TileX, y, TileWidth, Frame->Buffer->Iterations + (size_t)y * View->Width + TileX);
+		}
+	}
+
+	AtomicAdd64(&Frame->TotalIterations, (int64_t)Total);
+	AtomicAdd64(&Frame->Rebases, (int64_t)Tile.Rebases);
+}
+
+void CpuRenderDeepFrame(struct CpuRenderer* Renderer, const struct DeepView* restrict View, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats, struct DeepRenderStats* restrict DeepStats)
+{
+	CHECK_TRUE(DeepZoomSupportsSet(View->Set));
+	CHECK_TRUE(Buffer->Width == View->Width && Buffer->Height == View->Height);
+
+	const double StartTime = GetTime();
+	IterationBufferClearFractions(Buffer);
+
+	struct DeepFrameContext Frame = { 0 };
+	Frame.View = View;
+	Frame.Buffer = Buffer;
+	Frame.Limit = View->MaxIterations * FractalFormulas[View->Set].IterationMultiplier;
+	Frame.Bailout = FractalFormulas[View->Set].Bailout;
+	Frame.PixelStepX = BigFloatToDouble(&View->WindowPos[0]) / View->Width;
+	Frame.PixelStepY = BigFloatToDouble(&View->WindowPos[1]) / View->Height;
+	Frame.TileSize = CpuRendererGetTileSize(Renderer);
+	Frame.TilesX = (View->Width + Frame.TileSize - 1) / Frame.TileSize;
+	Frame.bSubdivide = CpuRendererGetSubdivision(Renderer) && IsSubdivisionSafe(View->Set, View->Type, View->JuliaPos, Frame.Limit);
+
+	const uint32_t LimbCount = BigFloatLimbsForResolution(min(fabs(Frame.PixelStepX), fabs(Frame.PixelStepY)), REFERENCE_GUARD_BITS);
+
+	//view centre in the complex plane, myConsumer flips the sign of WindowPos.w
+	struct BigFloat CentreX = View->WindowPos[2];
+	struct BigFloat CentreY = View->WindowPos[3];
+	BigFloatSetPrecision(&CentreX, LimbCount);
+	BigFloatSetPrecision(&CentreY, LimbCount);
+	BigFloatNegate(&CentreY);
+
+	//cycle detection is left out here, pixel orbits shadow the reference far
+	//closer than a double can tell apart from a real cycle
+	Frame.bBulbs = CpuRendererGetInteriorChecks(Renderer) && View->Set == FRACTAL_SET_MANDELBROT && View->Type == FRACTAL_TYPE_BASE;
+	Frame.CentreX = BigFloatToDouble(&CentreX);
+	Frame.CentreY = BigFloatToDouble(&CentreY);
+
+	struct BigFloat Zero;
+	BigFloatZero(&Zero, LimbCount);
+
+	//one extra entry for the z = c shift of the base sets
+	const uint32_t MaxLength = Frame.Limit + 2;
+
+	struct ReferenceOrbit StartOrbit = { 0 };
+	struct ReferenceOrbit ZeroOrbit = { 0 };
+
+	if (View->Type == FRACTAL_TYPE_BASE)
+	{
+		ComputeReferenceOrbit(&ZeroOrbit, View->Set, &Zero, &Zero, &CentreX, &CentreY, MaxLength);
+		Frame.Start = &ZeroOrbit;
+		Frame.Rebase = &ZeroOrbit;
+	}
+	else
+	{
+		struct BigFloat JuliaX;
+		struct BigFloat JuliaY;
+		BigFloatFromDouble(&JuliaX, View->JuliaPos[0], LimbCount);
+		BigFloatFromDouble(&JuliaY, View->JuliaPos[1], LimbCount);
+
+		ComputeReferenceOrbit(&StartOrbit, View->Set, &CentreX, &CentreY, &JuliaX, &JuliaY, MaxLength);
+		ComputeReferenceOrbit(&ZeroOrbit, View->Set, &Zero, &Zero, &JuliaX, &JuliaY, MaxLength);
+		Frame.Start = &StartOrbit;
+		Frame.Rebase = &ZeroOrbit;
+	}
+
+	const double ReferenceTime = GetTime();
+
+	const uint32_t TilesY = (View->Height + Frame.TileSize - 1) / Frame.TileSize;
+	const uint32_t TileCount = Frame.TilesX * TilesY;
+	struct ThreadPool* Pool = CpuRendererGetThreadPool(Renderer);
+	ThreadPoolRun(Pool, DeepRenderTile, &Frame, TileCount);
+
+	if (Stats)
+	{
+		Stats->Seconds = GetTime() - StartTime;
+		Stats->TotalIterations = (uint64_t)Frame.TotalIterations;
+		Stats->TileCount = TileCount;
+		Stats->ThreadCount = ThreadPoolGetThreadCount(Pool);
+		Stats->Isa = KERNEL_ISA_SCALAR;
+		Stats->Tier = PRECISION_TIER_PERTURBATION;
+		Stats->FilledPixels = (uint64_t)Frame.FilledPixels;
+		Stats->ReusedPixels = 0;
+		Stats->PendingPixels = 0;
+		Stats->Steals = 0;
+		Stats->SupersampledPixels = 0;
+		Stats->MirroredPixels = 0;
+	}
+
+	if (DeepStats)
+	{
+		DeepStats->ReferenceSeconds = ReferenceTime - StartTime;
+		DeepStats->ReferenceLength = Frame.Start->Length;
+		DeepStats->LimbCount = LimbCount;
+		DeepStats->Rebases = (uint64_t)Frame.Rebases;
+	}
+
+	if (View->Type != FRACTAL_TYPE_BASE)
+		ReleaseReferenceOrbit(&StartOrbit);
+	ReleaseReferenceOrbit(&ZeroOrbit);
+}
+
+struct MultiDoubleFrameContext
+{
+	const struct DeepView* View;
+	struct IterationBuffer* Buffer;
+	MultiDoubleRowKernel Kernel;
+	struct MultiDoubleRowJob Job;	//every field but the tile position
+	uint32_t TileSize;
+	uint32_t RectX;			//part of Buffer the current ThreadPoolRun covers
+	uint32_t RectY;
+	uint32_t RectWidth;
+	uint32_t RectHeight;
+	uint32_t TilesX;
+	bool bSubdivide;
+	volatile int64_t TotalIterations;
+	volatile int64_t FilledPixels;
+};
+
+static uint64_t MultiDoubleRun(void* Context, uint32_t x, uint32_t y, uint32_t Count, uint32_t* restrict Out)
+{
+	const struct MultiDoubleFrameContext* Frame = Context;
+
+	struct MultiDoubleRowJob Job = Frame->Job;
+	Job.FirstX = x;
+	Job.Y = y;
+	Job.Count = Count;
+	return Frame->Kernel(&Job, Out);
+}
+
+static void MultiDoubleRenderTile(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	(void)ThreadIndex;
+	struct MultiDoubleFrameContext* Frame = Context;
+	const struct DeepView* View = Frame->View;
+
+	const uint32_t TileX = Frame->RectX + (TaskIndex % Frame->TilesX) * Frame->TileSize;
+	const uint32_t TileY = Frame->RectY + (TaskIndex / Frame->TilesX) * Frame->TileSize;
+	const uint32_t TileWidth = min(Frame->TileSize, Frame->RectX + Frame->RectWidth - TileX);
+	const uint32_t TileHeight = min(Frame->TileSize, Frame->RectY + Frame->RectHeight - TileY);
+
+	if (Frame->bSubdivide)
+	{
+		uint64_t Filled = 0;
+		const uint64_t Total = SubdivideTile(MultiDoubleRun, Frame, Frame->Buffer, TileX, TileY, TileWidth, TileHeight, &Filled);
+		AtomicAdd64(&Frame->TotalIterations, (int64_t)Total);
+		AtomicAdd64(&Frame->FilledPixels, (int64_t)Filled);
+		return;
+	}
+
+	struct MultiDoubleRowJob Job = Frame->Job;
+	Job.FirstX = TileX;
+	Job.Count = TileWidth;
+
+	uint64_t Total = 0;
+	for (uint32_t y = TileY; y < TileY + TileHeight; y++)
+	{
+		Job.Y = y;
+		Total += Frame->Kernel(&Job, Frame->Buffer->Iterations + (size_t)y * View->Width + TileX);
+	}
+
+	AtomicAdd64(&Frame->TotalIterations, (int64_t)Total);
+}
+
+//tiles the given part of the buffer over the pool, returns the tile count
+static uint32_t MultiDoubleRenderRect(struct ThreadPool* Pool, struct MultiDoubleFrameContext* restrict Frame, uint32_t RectX, uint32_t RectY, uint32_t RectWidth, uint32_t RectHeight)
+{
+	if (RectWidth == 0 || RectHeight == 0)
+		return 0;
+
+	Frame->RectX = RectX;
+	Frame->RectY = RectY;
+	Frame->RectWidth = RectWidth;
+	Frame->RectHeight = RectHeight;
+	Frame->TilesX = (RectWidth + Frame->TileSize - 1) / Frame->TileSize;
+
+	const uint32_t TilesY = (RectHeight + Frame->TileSize - 1) / Frame->TileSize;
+	const uint32_t TileCount = Frame->TilesX * TilesY;
+	ThreadPoolRun(Pool, MultiDoubleRenderTile, Frame, TileCount);
+	return TileCount;
+}
+
+static bool IsQdZero(const double x[4])
+{
+	return x[0] == 0.0 && x[1] == 0.0 && x[2] == 0.0 && x[3] == 0.0;
+}
+
+void CpuRenderMultiDoubleFrame(struct CpuRenderer* Renderer, const struct DeepView* restrict View, enum PrecisionTier Tier, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats)
+{
+	CHECK_TRUE(Tier == PRECISION_TIER_DOUBLE || Tier == PRECISION_TIER_FIXED || Tier == PRECISION_TIER_DOUBLE_DOUBLE || Tier == PRECISION_TIER_QUAD_DOUBLE);
+	CHECK_TRUE(Buffer->Width == View->Width && Buffer->Height == View->Height);
+
+	const double StartTime = GetTime();
+	IterationBufferClearFractions(Buffer);
+	const enum KernelIsa Isa = CpuRendererGetIsa(Renderer);
+
+	struct MultiDoubleFrameContext Frame = { 0 };
+	Frame.View = View;
+	Frame.Buffer = Buffer;
+	Frame.Kernel = MultiDoubleRowKernels[Tier][Isa];
+	Frame.TileSize = CpuRendererGetTileSize(Renderer);
+
+	struct MultiDoubleRowJob* Job = &Frame.Job;
+	Job->Set = View->Set;
+	Job->Type = View->Type;
+	Job->Limit = View->MaxIterations * FractalFormulas[View->Set].IterationMultiplier;
+	Job->StepX = BigFloatToDouble(&View->WindowPos[0]) / View->Width;
+	Job->StepY = BigFloatToDouble(&View->WindowPos[1]) / View->Height;
+	Job->HalfWidth = View->Width * 0.5;
+	Job->HalfHeight = View->Height * 0.5;
+	Job->JuliaX = View->JuliaPos[0];
+	Job->JuliaY = View->JuliaPos[1];
+	Job->bInteriorChecks = CpuRendererGetInteriorChecks(Renderer);
+	Frame.bSubdivide = CpuRendererGetSubdivision(Renderer) && IsSubdivisionSafe(View->Set, View->Type, View->JuliaPos, Job->Limit);
+
+	//view centre in the complex plane, myConsumer flips the sign of WindowPos.w
+	struct BigFloat CentreY = View->WindowPos[3];
+	BigFloatNegate(&CentreY);
+
+	struct Qd Centre;
+	QdFromBigFloat(&Centre, &View->WindowPos[2]);
+	memcpy(Job->CentreX, Centre.x, sizeof(Job->CentreX));
+	QdFromBigFloat(&Centre, &CentreY);
+	memcpy(Job->CentreY, Centre.x, sizeof(Job->CentreY));
+
+	//pixel offsets from the centre are (i - Size / 2) * Step, so with a centre
+	//component of exactly 0 row y and row Height - y mirror each other exactly
+	const enum SymmetryType Symmetry = GetSymmetryType(View->Set, View->Type);
+	const bool bSymmetric = IsQdZero(Job->CentreY) && (Symmetry != SYMMETRY_POINT || IsQdZero(Job->CentreX));
+
+	struct FrameSymmetry Mirror;
+	if (!bSymmetric || !GetFrameSymmetry(Symmetry, View->Width, View->Height, View->Width, View->Height, &Mirror))
+	{
+		Mirror.Type = SYMMETRY_NONE;
+		Mirror.RectCount = 1;
+		Mirror.Rects[0][0] = 0;
+		Mirror.Rects[0][1] = 0;
+		Mirror.Rects[0][2] = View->Width;
+		Mirror.Rects[0][3] = View->Height;
+	}
+
+	struct ThreadPool* Pool = CpuRendererGetThreadPool(Renderer);
+	uint32_t TileCount = 0;
+	for (uint32_t i = 0; i < Mirror.RectCount; i++)
+	{
+		const uint32_t* Rect = Mirror.Rects[i];
+		TileCount += MultiDoubleRenderRect(Pool, &Frame, Rect[0], Rect[1], Rect[2], Rect[3]);
+	}
+	const uint64_t MirroredPixels = Mirror.Type != SYMMETRY_NONE ? MirrorIterations(&Mirror, Buffer) : 0;
+
+	if (Stats)
+	{
+		Stats->Seconds = GetTime() - StartTime;
+		Stats->TotalIterations = (uint64_t)Frame.TotalIterations;
+		Stats->TileCount = TileCount;
+		Stats->ThreadCount = ThreadPoolGetThreadCount(Pool);
+		Stats->Isa = Isa;
+		Stats->Tier = Tier;
+		Stats->FilledPixels = (uint64_t)Frame.FilledPixels;
+		Stats->ReusedPixels = 0;
+		Stats->PendingPixels = 0;
+		Stats->Steals = 0;
+		Stats->SupersampledPixels = 0;
+		Stats->MirroredPixels = MirroredPixels;
+	}
+}
+
+bool IsPrecisionTierSupported(enum PrecisionTier Tier, enum FractalSet Set)
+{
+	switch (Tier)
+	{
+	case PRECISION_TIER_PERTURBATION:
+	case PRECISION_TIER_FIXED:
+		return DeepZoomSupportsSet(Set);
+	case PRECISION_TIER_FLOAT:
+	case PRECISION_TIER_DOUBLE:
+	case PRECISION_TIER_DOUBLE_DOUBLE:
+	case PRECISION_TIER_QUAD_DOUBLE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static enum PrecisionTier SelectTier(const struct DeepView* restrict View, bool bPerturbation)
+{
+	const double Step = min(fabs(BigFloatToDouble(&View->WindowPos[0])) / View->Width, fabs(BigFloatToDouble(&View->WindowPos[1])) / View->Height);
+
+	//orbits live at |z| of order one, so the spacing of representable numbers
+	//near the centre is never finer than at 1
+	const double Scale = max(max(fabs(BigFloatToDouble(&View->WindowPos[2])), fabs(BigFloatToDouble(&View->WindowPos[3]))), 1.0);
+	const double RequiredBits = log2(Scale / Step) + PRECISION_GUARD_BITS;
+
+	for (int i = 0; i < PRECISION_TIER_COUNT; i++)
+	{
+		const enum PrecisionTier Tier = (enum PrecisionTier)i;
+		if (!IsPrecisionTierSupported(Tier, View->Set) || (Tier == PRECISION_TIER_PERTURBATION && !bPerturbation))
+			continue;
+
+		if (Tier == PRECISION_TIER_PERTURBATION ? Step >= PERTURBATION_MIN_STEP : RequiredBits <= PrecisionTierBits[Tier])
+			return Tier;
+	}
+
+	return bPerturbation && IsPrecisionTierSupported(PRECISION_TIER_PERTURBATION, View->Set) ? PRECISION_TIER_PERTURBATION : PRECISION_TIER_QUAD_DOUBLE;
+}
+
+enum PrecisionTier SelectPrecisionTier(const struct DeepView* restrict View)
+{
+	return SelectTier(View, true);
+}
+
+enum PrecisionTier SelectPointPrecisionTier(const struct DeepView* restrict View)
+{
+	return SelectTier(View, false);
+}
+
+uint64_t CpuRenderPoints(struct CpuRenderer* Renderer, const struct DeepView* restrict View, enum PrecisionTier Tier, const double* restrict Offsets, uint32_t Count, double Spacing, double* restrict Points, uint32_t* restrict Iterations, uint8_t* restrict Fractions)
+{
+	CHECK_TRUE(Tier != PRECISION_TIER_PERTURBATION && IsPrecisionTierSupported(Tier, View->Set));
+	const enum KernelIsa Isa = CpuRendererGetIsa(Renderer);
+	const uint32_t Limit = View->MaxIterations * FractalFormulas[View->Set].IterationMultiplier;
+
+	//myConsumer flips the sign of WindowPos.w
+	struct BigFloat CentreY = View->WindowPos[3];
+	BigFloatNegate(&CentreY);
+
+	if (Tier == PRECISION_TIER_FLOAT)
+	{
+		const double CentreX = BigFloatToDouble(&View->WindowPos[2]);
+		const double CentreYDouble = BigFloatToDouble(&CentreY);
+		for (uint32_t i = 0; i < Count; i++)
+		{
+			Points[i * 2] = CentreX + Offsets[i * 2];
+			Points[i * 2 + 1] = CentreYDouble + Offsets[i * 2 + 1];
+		}
+
+		struct RowJob Job;
+		memset(&Job, 0, sizeof(struct RowJob));
+		Job.Set = View->Set;
+		Job.Type = View->Type;
+		Job.Limit = Limit;
+		Job.StepX = Spacing;
+		Job.StepY = Spacing;
+		Job.StrideX = 1;
+		Job.Points = Points;
+		Job.Count = Count;
+		Job.JuliaX = View->JuliaPos[0];
+		Job.JuliaY = View->JuliaPos[1];
+		Job.bInteriorChecks = CpuRendererGetInteriorChecks(Renderer);
+		Job.bFastMath = CpuRendererGetFastMath(Renderer);
+		Job.Fractions = Fractions;
+		return FloatRowKernels[Isa](&Job, Iterations);
+	}
+
+	struct MultiDoubleRowJob Job;
+	memset(&Job, 0, sizeof(struct MultiDoubleRowJob));
+	Job.Set = View->Set;
+	Job.Type = View->Type;
+	Job.Limit = Limit;
+	Job.StepX = Spacing;
+	Job.StepY = Spacing;
+	Job.Count = Count;
+	Job.Offsets = Offsets;
+	Job.JuliaX = View->JuliaPos[0];
+	Job.JuliaY = View->JuliaPos[1];
+	Job.bInteriorChecks = CpuRendererGetInteriorChecks(Renderer);
+
+	struct Qd Centre;
+	QdFromBigFloat(&Centre, &View->WindowPos[2]);
+	memcpy(Job.CentreX, Centre.x, sizeof(Job.CentreX));
+	QdFromBigFloat(&Centre, &CentreY);
+	memcpy(Job.CentreY, Centre.x, sizeof(Job.CentreY));
+
+	//the deeper kernels have no smooth fraction
+	if (Fractions)
+		memset(Fractions, 0, Count);
+	return MultiDoubleRowKernels[Tier][Isa](&Job, Iterations);
+}
+
+void CpuRenderTierFrame(struct CpuRenderer* Renderer, const struct DeepView* restrict View, enum PrecisionTier Tier, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats, struct DeepRenderStats* restrict DeepStats)
+{
+	CHECK_TRUE(IsPrecisionTierSupported(Tier, View->Set));
+
+	switch (Tier)
+	{
+	case PRECISION_TIER_FLOAT:
+	{
+		struct CpuView FloatView;
+		CpuViewFromDeepView(&FloatView, View);
+		CpuRenderFrame(Renderer, &FloatView, Buffer, Stats);
+		break;
+	}
+	case PRECISION_TIER_PERTURBATION:
+		CpuRenderDeepFrame(Renderer, View, Buffer, Stats, DeepStats);
+		break;
+	default:
+		CpuRenderMultiDoubleFrame(Renderer, View, Tier, Buffer, Stats);
+		break;
+	}
+}
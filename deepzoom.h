@@ -0,0 +1,85 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//perturbation rendering: one orbit at the view centre is iterated in BigFloat,
+//every pixel then iterates only its double precision difference from it.
+//differences are rebased onto the start of the orbit whenever the pixel gets
+//closer to zero than to the reference, which keeps one reference glitch free.
+//
+//for mid depth zooms every pixel can instead iterate the full orbit in
+//double, double-double or quad-double, which works for every set, or in Q4.60
+//fixed point for the z^2 sets
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bigfloat.h"
+#include "cpurender.h"
+
+//same meaning as CpuView but the window lives in arbitrary precision
+struct DeepView
+{
+	enum FractalSet Set;
+	enum FractalType Type;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t MaxIterations;
+	struct BigFloat WindowPos[4];
+	double JuliaPos[2];
+};
+
+struct DeepRenderStats
+{
+	double ReferenceSeconds;
+	uint32_t ReferenceLength;
+	uint32_t LimbCount;
+	uint64_t Rebases;
+};
+
+//perturbation needs a polynomial step, so the trig driven mosaic and the
+//folded cubic doubletricorn are not supported
+bool DeepZoomSupportsSet(enum FractalSet Set);
+
+void DeepViewFromCpuView(struct DeepView* restrict DeepView, const struct CpuView* restrict View);
+void CpuViewFromDeepView(struct CpuView* restrict View, const struct DeepView* restrict DeepView);
+
+//WindowPos as decimal strings, returns false if one does not parse
+bool DeepViewSetWindow(struct DeepView* restrict DeepView, const char* const WindowPos[4]);
+
+void CpuRenderDeepFrame(struct CpuRenderer* Renderer, const struct DeepView* restrict View, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats, struct DeepRenderStats* restrict DeepStats);
+
+//Tier is PRECISION_TIER_DOUBLE, PRECISION_TIER_FIXED, PRECISION_TIER_DOUBLE_DOUBLE or PRECISION_TIER_QUAD_DOUBLE
+void CpuRenderMultiDoubleFrame(struct CpuRenderer* Renderer, const struct DeepView* restrict View, enum PrecisionTier Tier, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats);
+
+bool IsPrecisionTierSupported(enum PrecisionTier Tier, enum FractalSet Set);
+
+//the cheapest tier that still tells neighbouring pixels apart at the view centre,
+//or the deepest one the set supports once nothing does
+enum PrecisionTier SelectPrecisionTier(const struct DeepView* restrict View);
+
+//the same for points off the pixel grid, which perturbation cannot render
+enum PrecisionTier SelectPointPrecisionTier(const struct DeepView* restrict View);
+
+//iterates Count points at the centre of View plus Offsets, x, y pairs in the
+//kernels' coordinates, in any tier but perturbation. Spacing is the distance
+//between neighbouring points, Points is scratch for Count pairs and Fractions
+//may be NULL. returns the iterations run
+uint64_t CpuRenderPoints(struct CpuRenderer* Renderer, const struct DeepView* restrict View, enum PrecisionTier Tier, const double* restrict Offsets, uint32_t Count, double Spacing, double* restrict Points, uint32_t* restrict Iterations, uint8_t* restrict Fractions);
+
+//renders View in Tier, the tier ends up in Stats->Tier. DeepStats is only
+//written by the perturbation tier and may be NULL
+void CpuRenderTierFrame(struct CpuRenderer* Renderer, const struct DeepView* restrict View, enum PrecisionTier Tier, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats, struct DeepRenderStats* restrict DeepStats);
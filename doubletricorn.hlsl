@@ -25,6 +25,8 @@ Texture2D Texture : register(t0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 SamplerState MySampler : register(s0);
 
+#include "fractal.hlsli"
+
 float Mandelbrot(float2 Coord)
 {
     uint MaxIterations = (uint) MyConstantBuffer.MaxIterations.z * 4;
@@ -33,6 +35,11 @@ float Mandelbrot(float2 Coord)
     float2 z = Coord;
     float2 c = Coord;
 
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 4.0)
     {
         // Burning-ship style folding
@@ -53,6 +60,18 @@ float Mandelbrot(float2 Coord)
 
         z = z3 + c;
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        if (dot(Delta, Delta) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            NextSave *= 2;
+        }
     }
 
     return frac((float) iter / MyConstantBuffer.MaxIterations.z);
@@ -23,6 +23,8 @@ struct ConstantBufferData
 RWTexture2D<float4> Framebuffer : register(u0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 
+#include "fractal.hlsli"
+
 float Julia(float2 Coord)
 {
     uint MaxIterations = (uint) MyConstantBuffer.MaxIterations.z * 4;
@@ -31,6 +33,11 @@ float Julia(float2 Coord)
     float2 z = Coord;
     float2 c = MyConstantBuffer.JuliaPos.xy;
 
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 4.0)
     {
         // Burning-ship style folding
@@ -51,6 +58,18 @@ float Julia(float2 Coord)
 
         z = z3 + c;
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        if (dot(Delta, Delta) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            NextSave *= 2;
+        }
     }
 
     return frac((float) iter / MyConstantBuffer.MaxIterations.z);
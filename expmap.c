@@ -0,0 +1,354 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <math.h>
+
+#include "expmap.h"
+#include "threadpool.h"
+#include "platform.h"
+
+#define EXPMAP_PI 3.14159265358979323846
+#define EXPMAP_CHUNK_ROWS 64		//strip rows iterated and coloured together
+#define EXPMAP_ROWS_PER_TASK 8		//frame rows resampled per task
+#define EXPMAP_MIN_RADIUS 0.5		//pixels, keeps the log radius of the centre pixel finite
+#define EXPMAP_CENTRE_MARGIN 2.0	//pixels of the last frame inside its edge the strip stops at
+
+struct StripContext
+{
+	struct CpuRenderer* Renderer;
+	const struct DeepView* View;
+	enum PrecisionTier Tier;
+	uint32_t Width;
+	const double* Cos;			//of each column's angle
+	const double* Sin;
+	double TopLog;				//log radius of row 0
+	double LogStep;				//between rows, and the angle between columns
+	int64_t FirstRow;
+	struct IterationBuffer* Buffer;
+	double* Scratch;			//Width * 4 doubles per thread
+	volatile int64_t TotalIterations;
+};
+
+//one row of the strip, a circle of Width samples at the row's radius
+static void RenderStripRow(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	struct StripContext* Strip = Context;
+	const double Radius = exp(Strip->TopLog - (double)(Strip->FirstRow + TaskIndex) * Strip->LogStep);
+	double* restrict Offsets = Strip->Scratch + (size_t)ThreadIndex * Strip->Width * 4;
+	double* restrict Points = Offsets + (size_t)Strip->Width * 2;
+
+	for (uint32_t i = 0; i < Strip->Width; i++)
+	{
+		Offsets[i * 2] = Radius * Strip->Cos[i];
+		Offsets[i * 2 + 1] = Radius * Strip->Sin[i];
+	}
+
+	const size_t Row = (size_t)TaskIndex * Strip->Width;
+	uint8_t* Fractions = Strip->Buffer->Fractions ? Strip->Buffer->Fractions + Row : NULL;
+	const uint64_t Total = CpuRenderPoints(Strip->Renderer, Strip->View, Strip->Tier, Offsets, Strip->Width, Radius * Strip->LogStep, Points, Strip->Buffer->Iterations + Row, Fractions);
+	AtomicAdd64(&Strip->TotalIterations, (int64_t)Total);
+}
+
+struct ExpFrameContext
+{
+	const uint8_t* Ring;		//coloured strip rows, row r at r % RingRows
+	int64_t RingRows;
+	int64_t RingBase;			//a multiple of RingRows at or below every row the frame reads
+	uint32_t StripWidth;
+	double InnerRow;			//the strip ends here, closer in pixels come from Centre
+	int64_t LastRow;
+	const float* Angles;		//strip column of each frame pixel
+	const float* Depths;		//strip rows each frame pixel lies below Base
+	double Base;				//strip row at a radius of one frame pixel
+	const uint8_t* Centre;		//the last frame iterated on its own, rgba
+	double CentreScale;			//last frame pixels per frame pixel
+	uint32_t Width;
+	uint32_t Height;
+	uint8_t* Frame;				//rgb24
+};
+
+//weights in 1/256ths
+static inline void SampleBilinear(const uint8_t* restrict Near, const uint8_t* restrict Far, uint32_t Column0, uint32_t Column1, uint32_t ColumnWeight, uint32_t RowWeight, uint8_t* restrict Out)
+{
+	for (int Channel = 0; Channel < 3; Channel++)
+	{
+		const uint32_t a = Near[Column0 * 4 + Channel] * (256 - ColumnWeight) + Near[Column1 * 4 + Channel] * ColumnWeight;
+		const uint32_t b = Far[Column0 * 4 + Channel] * (256 - ColumnWeight) + Far[Column1 * 4 + Channel] * ColumnWeight;
+		Out[Channel] = (uint8_t)((a * (256 - RowWeight) + b * RowWeight + 32768) >> 16);
+	}
+}
+
+//bilinear between the two columns and two rows around each frame pixel, of the
+//strip or, inside the strip's inner radius, of the last frame
+static void ResampleStripRows(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	(void)ThreadIndex;
+	const struct ExpFrameContext* Frame = Context;
+	const size_t RowBytes = (size_t)Frame->StripWidth * 4;
+	const size_t CentreBytes = (size_t)Frame->Width * 4;
+
+	const uint32_t FirstY = TaskIndex * EXPMAP_ROWS_PER_TASK;
+	const uint32_t LastY = min(FirstY + EXPMAP_ROWS_PER_TASK, Frame->Height);
+	for (uint32_t y = FirstY; y < LastY; y++)
+	{
+		uint8_t* restrict Out = Frame->Frame + (size_t)y * Frame->Width * 3;
+		for (uint32_t x = 0; x < Frame->Width; x++)
+		{
+			const size_t Pixel = (size_t)y * Frame->Width + x;
+			const double Row = fmax(Frame->Base + Frame->Depths[Pixel], 0.0);
+			if (Row > Frame->InnerRow)
+			{
+				const double CentreX = fmin(fmax((x - Frame->Width * 0.5) * Frame->CentreScale + Frame->Width * 0.5, 0.0), Frame->Width - 1.0);
+				const double CentreY = fmin(fmax((y - Frame->Height * 0.5) * Frame->CentreScale + Frame->Height * 0.5, 0.0), Frame->Height - 1.0);
+				const uint32_t Column0 = (uint32_t)CentreX;
+				const uint32_t Row0 = (uint32_t)CentreY;
+				const uint8_t* restrict Near = Frame->Centre + Row0 * CentreBytes;
+				const uint8_t* restrict Far = Frame->Centre + min(Row0 + 1, Frame->Height - 1) * CentreBytes;
+				SampleBilinear(Near, Far, Column0, min(Column0 + 1, Frame->Width - 1), (uint32_t)((CentreX - Column0) * 256.0), (uint32_t)((CentreY - Row0) * 256.0), Out + x * 3);
+				continue;
+			}
+
+			//rows of one frame span less than the ring, so one subtraction wraps them
+			const int64_t Row0 = (int64_t)Row;
+			int64_t Slot0 = Row0 - Frame->RingBase;
+			if (Slot0 >= Frame->RingRows)
+				Slot0 -= Frame->RingRows;
+			int64_t Slot1 = Row0 + 1 > Frame->LastRow ? Slot0 : Slot0 + 1;
+			if (Slot1 >= Frame->RingRows)
+				Slot1 -= Frame->RingRows;
+
+			const float Column = Frame->Angles[Pixel];
+			const uint32_t Column0 = (uint32_t)Column;
+			const uint32_t Column1 = Column0 + 1 == Frame->StripWidth ? 0 : Column0 + 1;
+
+			const uint8_t* restrict Near = Frame->Ring + (size_t)Slot0 * RowBytes;
+			const uint8_t* restrict Far = Frame->Ring + (size_t)Slot1 * RowBytes;
+			SampleBilinear(Near, Far, Column0, Column1, (uint32_t)((Column - (float)Column0) * 256.0f), (uint32_t)((Row - (double)Row0) * 256.0), Out + x * 3);
+		}
+	}
+}
+
+bool CpuRenderExpMapZoom(struct CpuRenderer* Renderer, const struct DeepView* restrict Target, const struct ExpMapSettings* restrict Settings, AnimationProgressCallback Progress, void* Context, struct ExpMapStats* restrict Stats)
+{
+	const double StartTime = GetTime();
+	const uint32_t Width = Settings->Width;
+	const uint32_t Height = Settings->Height;
+	const double StartStep = Settings->StartScale / Width;
+	const double EndStep = fabs(BigFloatToDouble(&Target->WindowPos[0])) / Width;
+	CHECK_TRUE(EndStep < StartStep);
+
+	const uint32_t FrameCount = (uint32_t)floor(Settings->Duration * Settings->FramesPerSecond + 1e-9) + 1;
+	struct ThreadPool* Pool = CpuRendererGetThreadPool(Renderer);
+
+	struct ExpMapStats Totals;
+	memset(&Totals, 0, sizeof(Totals));
+
+	//the frame corners get a sample per pixel around the circle, and rows are as
+	//far apart in log radius as columns are in angle
+	const double OuterRadius = hypot(Width * 0.5, Height * 0.5);
+	const uint32_t StripWidth = ((uint32_t)ceil(EXPMAP_PI * OuterRadius * 2.0) + 15) / 16 * 16;
+	const double LogStep = 2.0 * EXPMAP_PI / StripWidth;
+	const double TopLog = log(StartStep * OuterRadius);
+	const double InnerDepth = -log(EXPMAP_MIN_RADIUS) / LogStep;
+
+	//the last frame covers the circle it fits around the centre at a finer step
+	//than any frame before it needs there, so the strip stops at that circle and
+	//the last frame is iterated on its own for everything inside
+	const double InnerRow = (TopLog - log(EndStep * (min(Width, Height) * 0.5 - EXPMAP_CENTRE_MARGIN))) / LogStep;
+	const int64_t StripRows = (int64_t)ceil(InnerRow) + 2;
+	const uint32_t RingRows = (uint32_t)ceil((log(OuterRadius) - log(EXPMAP_MIN_RADIUS)) / LogStep) + EXPMAP_CHUNK_ROWS + 2;
+
+	double* Cos = malloc(StripWidth * sizeof(double));
+	double* Sin = malloc(StripWidth * sizeof(double));
+	float* Angles = AlignedAlloc((size_t)Width * Height * sizeof(float), 64);
+	float* Depths = AlignedAlloc((size_t)Width * Height * sizeof(float), 64);
+	uint8_t* Ring = AlignedAlloc((size_t)RingRows * StripWidth * 4, 64);
+	uint8_t* ChunkRgba = AlignedAlloc((size_t)EXPMAP_CHUNK_ROWS * StripWidth * 4, 64);
+	double* Scratch = AlignedAlloc((size_t)StripWidth * 4 * ThreadPoolGetThreadCount(Pool) * sizeof(double), 64);
+	uint8_t* CentreRgba = AlignedAlloc((size_t)Width * Height * 4, 64);
+	uint8_t* Frame = malloc((size_t)Width * Height * 3);
+	struct DeepView* TierView = malloc(sizeof(struct DeepView));
+	CHECK_ALLOC(Cos);
+	CHECK_ALLOC(Sin);
+	CHECK_ALLOC(Frame);
+	CHECK_ALLOC(TierView);
+
+	for (uint32_t i = 0; i < StripWidth; i++)
+	{
+		Cos[i] = cos(i * LogStep);
+		Sin[i] = sin(i * LogStep);
+	}
+
+	//pixel x, y sits (x - Width / 2, y - Height / 2) pixels from the centre, see CpuViewGetPixelGrid
+	for (uint32_t y = 0; y < Height; y++)
+	{
+		for (uint32_t x = 0; x < Width; x++)
+		{
+			const double dx = x - Width * 0.5;
+			const double dy = y - Height * 0.5;
+			double Angle = atan2(dy, dx);
+			if (Angle < 0.0)
+				Angle += 2.0 * EXPMAP_PI;
+
+			float Column = (float)(Angle / LogStep);
+			if (Column >= (float)StripWidth)
+				Column -= (float)StripWidth;
+
+			const size_t Pixel = (size_t)y * Width + x;
+			Angles[Pixel] = Column;
+			Depths[Pixel] = (float)(-log(fmax(hypot(dx, dy), EXPMAP_MIN_RADIUS)) / LogStep);
+		}
+	}
+
+	//the last frame with square pixels, in whichever tier it needs
+	*TierView = *Target;
+	TierView->Width = Width;
+	TierView->Height = Height;
+	BigFloatMulInt(&TierView->WindowPos[1], &Target->WindowPos[0], (int32_t)Height);
+	BigFloatDivInt(&TierView->WindowPos[1], &TierView->WindowPos[1], Width);
+	{
+		const double CentreStartTime = GetTime();
+		struct IterationBuffer Centre;
+		IterationBufferInit(&Centre, Width, Height);
+		if (Settings->bSmooth)
+			IterationBufferAddFractions(&Centre);
+
+		struct CpuRenderStats CentreStats;
+		CpuRenderTierFrame(Renderer, TierView, SelectPrecisionTier(TierView), &Centre, &CentreStats, NULL);
+		if (Centre.Fractions && CentreStats.Tier != PRECISION_TIER_FLOAT)
+			IterationBufferClearFractions(&Centre);
+		ColorizePalette(Settings->Palette, &Centre, CentreRgba, (size_t)Width * 4);
+		IterationBufferRelease(&Centre);
+
+		Totals.TotalIterations += CentreStats.TotalIterations;
+		Totals.IteratedPixels += (uint64_t)Width * Height;
+		Totals.StripSeconds += GetTime() - CentreStartTime;
+	}
+
+	struct IterationBuffer Chunk;
+	IterationBufferInit(&Chunk, StripWidth, EXPMAP_CHUNK_ROWS);
+	if (Settings->bSmooth)
+		IterationBufferAddFractions(&Chunk);
+
+	struct StripContext Strip;
+	memset(&Strip, 0, sizeof(Strip));
+	Strip.Renderer = Renderer;
+	Strip.View = Target;
+	Strip.Width = StripWidth;
+	Strip.Cos = Cos;
+	Strip.Sin = Sin;
+	Strip.TopLog = TopLog;
+	Strip.LogStep = LogStep;
+	Strip.Buffer = &Chunk;
+	Strip.Scratch = Scratch;
+
+	struct ExpFrameContext Resample;
+	Resample.Ring = Ring;
+	Resample.RingRows = RingRows;
+	Resample.StripWidth = StripWidth;
+	Resample.InnerRow = InnerRow;
+	Resample.LastRow = StripRows - 1;
+	Resample.Centre = CentreRgba;
+	Resample.Angles = Angles;
+	Resample.Depths = Depths;
+	Resample.Width = Width;
+	Resample.Height = Height;
+	Resample.Frame = Frame;
+
+	*TierView = *Target;
+	TierView->Width = StripWidth;
+	TierView->Height = StripWidth;
+
+	int64_t RowsDone = 0;
+	bool bOk = true;
+	for (uint32_t FrameIndex = 0; FrameIndex < FrameCount && bOk; FrameIndex++)
+	{
+		const double Progression = FrameCount > 1 ? (double)FrameIndex / (FrameCount - 1) : 1.0;
+		const double Step = StartStep * pow(EndStep / StartStep, Progression);
+		Resample.Base = (TopLog - log(Step)) / LogStep;
+		Resample.CentreScale = Step / EndStep;
+		Resample.RingBase = max((int64_t)floor(Resample.Base - log(OuterRadius) / LogStep) - 1, (int64_t)0) / RingRows * RingRows;
+
+		//rows only move inwards from frame to frame, so the ones above this frame's
+		//outer corner are never read again and the ring can reuse them
+		const int64_t Needed = min((int64_t)floor(Resample.Base + InnerDepth) + 1, StripRows - 1);
+		while (RowsDone <= Needed)
+		{
+			const double StripStartTime = GetTime();
+			const uint32_t Rows = (uint32_t)min((int64_t)EXPMAP_CHUNK_ROWS, StripRows - RowsDone);
+
+			//the innermost row of the chunk has the finest spacing
+			const double Spacing = exp(TopLog - (double)(RowsDone + Rows - 1) * LogStep) * LogStep;
+			const uint32_t LimbCount = BigFloatLimbsForResolution(Spacing, 32);
+			BigFloatFromDouble(&TierView->WindowPos[0], Spacing * StripWidth, LimbCount);
+			TierView->WindowPos[1] = TierView->WindowPos[0];
+			Strip.Tier = SelectPointPrecisionTier(TierView);
+			Strip.FirstRow = RowsDone;
+			Strip.TotalIterations = 0;
+
+			Chunk.Height = Rows;
+			ThreadPoolRun(Pool, RenderStripRow, &Strip, Rows);
+			ColorizePalette(Settings->Palette, &Chunk, ChunkRgba, (size_t)StripWidth * 4);
+
+			for (uint32_t Row = 0; Row < Rows; Row++)
+			{
+				memcpy(Ring + (size_t)((RowsDone + Row) % RingRows) * StripWidth * 4, ChunkRgba + (size_t)Row * StripWidth * 4, (size_t)StripWidth * 4);
+			}
+
+			RowsDone += Rows;
+			Totals.TotalIterations += (uint64_t)Strip.TotalIterations;
+			Totals.IteratedPixels += (uint64_t)Rows * StripWidth;
+			Totals.StripSeconds += GetTime() - StripStartTime;
+		}
+
+		ThreadPoolRun(Pool, ResampleStripRows, &Resample, (Height + EXPMAP_ROWS_PER_TASK - 1) / EXPMAP_ROWS_PER_TASK);
+
+		bOk = fwrite(Frame, 3, (size_t)Width * Height, Settings->Output) == (size_t)Width * Height;
+		Totals.FrameCount++;
+
+		if (Progress)
+		{
+			struct AnimationProgress Report;
+			Report.FramesDone = FrameIndex + 1;
+			Report.FrameCount = FrameCount;
+			Report.Seconds = GetTime() - StartTime;
+			Report.EtaSeconds = Report.Seconds * (FrameCount - Report.FramesDone) / Report.FramesDone;
+			Progress(Context, &Report);
+		}
+	}
+
+	bOk = fflush(Settings->Output) == 0 && bOk;
+
+	Chunk.Height = EXPMAP_CHUNK_ROWS;
+	IterationBufferRelease(&Chunk);
+	free(Cos);
+	free(Sin);
+	AlignedFree(Angles);
+	AlignedFree(Depths);
+	AlignedFree(Ring);
+	AlignedFree(ChunkRgba);
+	AlignedFree(CentreRgba);
+	AlignedFree(Scratch);
+	free(Frame);
+	free(TierView);
+
+	Totals.Seconds = GetTime() - StartTime;
+	Totals.StripWidth = StripWidth;
+	Totals.StripRows = (uint32_t)StripRows;
+	if (Stats)
+		*Stats = Totals;
+	return bOk;
+}
@@ -0,0 +1,57 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//exponential map zooms. a zoom straight into one point is rendered as a single
+//log-polar strip around it, one row per step of log radius and one column per
+//step of angle, with both steps equal so the samples stay square. every frame is
+//then resampled from the strip, so each octave of zoom is iterated once whatever
+//the frame rate, and the strip only has to be kept for the radii one frame spans
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "animation.h"
+#include "deepzoom.h"
+
+struct ExpMapSettings
+{
+	uint32_t Width;
+	uint32_t Height;
+	double StartScale;		//WindowPos.x of the first frame, the last one has the target's
+	double Duration;		//seconds from the first frame to the last
+	double FramesPerSecond;
+	bool bSmooth;			//colour with the smooth iteration fraction
+	const struct Palette* Palette;
+	FILE* Output;			//Width * Height * 3 bytes a frame, top row first
+};
+
+struct ExpMapStats
+{
+	double Seconds;
+	double StripSeconds;	//spent iterating the strip
+	uint32_t FrameCount;
+	uint32_t StripWidth;	//samples around the circle
+	uint32_t StripRows;
+	uint64_t TotalIterations;
+	uint64_t IteratedPixels;
+};
+
+//zooms from StartScale into Target, centred on its WindowPos.zw, with square
+//pixels of WindowPos.x / Width. rows are iterated in the cheapest tier that
+//resolves them apart from perturbation. false if a frame cannot be written
+bool CpuRenderExpMapZoom(struct CpuRenderer* Renderer, const struct DeepView* restrict Target, const struct ExpMapSettings* restrict Settings, AnimationProgressCallback Progress, void* Context, struct ExpMapStats* restrict Stats);
@@ -0,0 +1,188 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//escape time loop over FX_LANES pixels in Q4.60 fixed point, the z^2 family only.
+//no include guard, kernels_fixed.c includes this once per isa with:
+//  FX_T, FX_LANES, FX_TARGET   lane type (int64_t lanes), width and target attribute
+//  FX_NAME(x)                  prefix of the generated functions
+//  FX_SET(x), FX_LOAD(p)       x in every lane, FX_LANES int64_t from p
+//  FX_ADD(a, b), FX_SUB(a, b)  wrapping, so lanes that already escaped cannot trap
+//  FX_ABS(x)                   |x|, x is never INT64_MIN
+//  FX_MULHI(a, b, s)           a * b / 2^s rounded to nearest for 0 <= a, b < 2^62 and 33 <= s < 64
+//  FX_XOR(a, b)
+//  FX_NEGATE_WHERE(x, s)       -x in the lanes where s < 0
+//  FX_MASK, FX_LT(a, b), FX_AND(m, n), FX_MASK_BITS(m), FX_SELECT(m, a, b)
+//  FX_COUNT, FX_COUNT_ZERO, FX_COUNT_ADD(c, m), FX_STORE_COUNT(p, c)
+//
+//every operation is exact integer arithmetic, so all instantiations agree bit for bit.
+//an orbit escapes once |x| or |y| reaches 2 or |z|^2 reaches 4, which keeps every
+//square at most 4 and every new point below 8 so nothing overflows. products are
+//rounded on their magnitude with the sign applied afterwards, so mirrored pixels
+//iterate mirrored orbits exactly
+
+//brent cycle detection in the max norm, only for points inside |x|, |y| < 2 like
+//every point saved while the lane is still active, so the differences cannot
+//overflow. Tolerance is an exclusive bound, 0 turns it off and 1 catches the
+//states that repeat exactly, which are cycles of the fixed point map itself
+static FORCE_INLINE FX_TARGET FX_COUNT FX_NAME(Iterate)(const enum FractalSet Set, FX_T Zx, FX_T Zy, const FX_T Cx, const FX_T Cy, const uint32_t Limit, const FX_T Tolerance, unsigned* restrict PeriodicLanes)
+{
+	const FX_T Two = FX_SET(FIXED_ONE * 2);
+	const FX_T Four = FX_SET(FIXED_ONE * 4);
+	const FX_T Escaped = FX_SET(FIXED_PAD);
+
+	FX_COUNT Count = FX_COUNT_ZERO;
+
+	FX_T SavedX = Zx;
+	FX_T SavedY = Zy;
+	uint32_t NextSave = 1;
+
+	for (uint32_t iter = 0; iter < Limit; iter++)
+	{
+		const FX_T Ax = FX_ABS(Zx);
+		const FX_T Ay = FX_ABS(Zy);
+		const FX_T x2 = FX_MULHI(Ax, Ax, FIXED_FRACTION_BITS);
+		const FX_T y2 = FX_MULHI(Ay, Ay, FIXED_FRACTION_BITS);
+
+		const FX_MASK Active = FX_AND(FX_AND(FX_LT(Ax, Two), FX_LT(Ay, Two)), FX_LT(FX_ADD(x2, y2), Four));
+		const unsigned ActiveBits = FX_MASK_BITS(Active);
+		if (ActiveBits == 0)
+			break;
+
+		//2|xy|, the one bit less of shift doubles it
+		const FX_T xy2 = FX_MULHI(Ax, Ay, FIXED_FRACTION_BITS - 1);
+		const FX_T NewX = FX_ADD(FX_SUB(x2, y2), Cx);
+
+		FX_T NewY;
+		switch (Set)
+		{
+		case FRACTAL_SET_TRICORN:
+			NewY = FX_SUB(Cy, FX_NEGATE_WHERE(xy2, FX_XOR(Zx, Zy)));
+			break;
+		case FRACTAL_SET_BURNINGSHIP:
+			NewY = FX_ADD(xy2, Cy);
+			break;
+		case FRACTAL_SET_MANDELBROT:
+		default:
+			NewY = FX_ADD(FX_NEGATE_WHERE(xy2, FX_XOR(Zx, Zy)), Cy);
+			break;
+		}
+
+		Zx = FX_SELECT(Active, NewX, Zx);
+		Zy = FX_SELECT(Active, NewY, Zy);
+		Count = FX_COUNT_ADD(Count, Active);
+
+		const FX_MASK Inside = FX_AND(FX_LT(FX_ABS(Zx), Two), FX_LT(FX_ABS(Zy), Two));
+		const FX_MASK Periodic = FX_AND(Inside, FX_AND(FX_LT(FX_ABS(FX_SUB(Zx, SavedX)), Tolerance), FX_LT(FX_ABS(FX_SUB(Zy, SavedY)), Tolerance)));
+		const unsigned PeriodicBits = FX_MASK_BITS(Periodic) & ActiveBits;
+		if (PeriodicBits != 0)
+		{
+			*PeriodicLanes |= PeriodicBits;
+			Zx = FX_SELECT(Periodic, Escaped, Zx);
+			Zy = FX_SELECT(Periodic, Escaped, Zy);
+		}
+
+		if (iter + 1 == NextSave)
+		{
+			SavedX = Zx;
+			SavedY = Zy;
+			NextSave *= 2;
+		}
+	}
+
+	return Count;
+}
+
+static FORCE_INLINE FX_TARGET uint64_t FX_NAME(Row)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations, const enum FractalSet Set, const enum FractalType Type)
+{
+	const int64_t CentreX = FixedFromQd(Job->CentreX);
+	const int64_t CentreY = FixedFromQd(Job->CentreY);
+	const FX_T JuliaX = FX_SET(FixedFromDouble(Job->JuliaX));
+	const FX_T JuliaY = FX_SET(FixedFromDouble(Job->JuliaY));
+	const double OffsetY = ((double)Job->Y - Job->HalfHeight) * Job->StepY;
+	const FX_T Tolerance = FX_SET(Job->bInteriorChecks ? (int64_t)ldexp(fmin(fabs(Job->StepX), fabs(Job->StepY)) * PERIOD_TOLERANCE_PIXELS, FIXED_FRACTION_BITS) + 1 : 0);
+	const bool bBulbs = Job->bInteriorChecks && Set == FRACTAL_SET_MANDELBROT && Type == FRACTAL_TYPE_BASE;
+	uint64_t Total = 0;
+
+	for (uint32_t i = 0; i < Job->Count; i += FX_LANES)
+	{
+		const uint32_t Lanes = min(FX_LANES, Job->Count - i);
+
+		//the bulb test runs on the leading double like the multi-double kernels
+		unsigned InteriorLanes = 0;
+
+		int64_t X[FX_LANES];
+		int64_t Y[FX_LANES];
+		for (uint32_t Lane = 0; Lane < FX_LANES; Lane++)
+		{
+			X[Lane] = FIXED_PAD;
+			Y[Lane] = FIXED_PAD;
+			if (Lane >= Lanes)
+				continue;
+
+			const double OffsetX = Job->Offsets ? Job->Offsets[(i + Lane) * 2] : ((double)(Job->FirstX + i + Lane) - Job->HalfWidth) * Job->StepX;
+			const double LaneOffsetY = Job->Offsets ? Job->Offsets[(i + Lane) * 2 + 1] : OffsetY;
+			if (bBulbs && IsInMandelbrotBulbs(Job->CentreX[0] + OffsetX, Job->CentreY[0] + LaneOffsetY))
+			{
+				InteriorLanes |= 1u << Lane;
+				continue;
+			}
+
+			X[Lane] = CentreX + FixedFromDouble(OffsetX);
+			Y[Lane] = CentreY + FixedFromDouble(LaneOffsetY);
+		}
+
+		const FX_T Px = FX_LOAD(X);
+		const FX_T Py = FX_LOAD(Y);
+
+		FX_COUNT Count;
+		if (Type == FRACTAL_TYPE_BASE)
+			Count = FX_NAME(Iterate)(Set, Px, Py, Px, Py, Job->Limit, Tolerance, &InteriorLanes);
+		else
+			Count = FX_NAME(Iterate)(Set, Px, Py, JuliaX, JuliaY, Job->Limit, Tolerance, &InteriorLanes);
+
+		uint64_t Out[FX_LANES];
+		FX_STORE_COUNT(Out, Count);
+		for (uint32_t Lane = 0; Lane < Lanes; Lane++)
+		{
+			Total += Out[Lane];
+			if (InteriorLanes & (1u << Lane))
+				Out[Lane] = Job->Limit;
+
+			Iterations[i + Lane] = (uint32_t)Out[Lane];
+		}
+	}
+
+	return Total;
+}
+
+static FX_TARGET uint64_t FX_NAME(RowMandelbrot)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return FX_NAME(Row)(Job, Iterations, FRACTAL_SET_MANDELBROT, FRACTAL_TYPE_BASE); }
+static FX_TARGET uint64_t FX_NAME(RowMandelbrotJulia)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return FX_NAME(Row)(Job, Iterations, FRACTAL_SET_MANDELBROT, FRACTAL_TYPE_JULIA); }
+static FX_TARGET uint64_t FX_NAME(RowTricorn)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return FX_NAME(Row)(Job, Iterations, FRACTAL_SET_TRICORN, FRACTAL_TYPE_BASE); }
+static FX_TARGET uint64_t FX_NAME(RowTricornJulia)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return FX_NAME(Row)(Job, Iterations, FRACTAL_SET_TRICORN, FRACTAL_TYPE_JULIA); }
+static FX_TARGET uint64_t FX_NAME(RowBurningship)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return FX_NAME(Row)(Job, Iterations, FRACTAL_SET_BURNINGSHIP, FRACTAL_TYPE_BASE); }
+static FX_TARGET uint64_t FX_NAME(RowBurningshipJulia)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return FX_NAME(Row)(Job, Iterations, FRACTAL_SET_BURNINGSHIP, FRACTAL_TYPE_JULIA); }
+
+//IsPrecisionTierSupported keeps the other sets away from this tier
+static const MultiDoubleRowKernel FX_NAME(RowKernels)[FRACTAL_SET_COUNT][FRACTAL_TYPE_COUNT] = {
+	[FRACTAL_SET_MANDELBROT] = { FX_NAME(RowMandelbrotJulia), FX_NAME(RowMandelbrot) },
+	[FRACTAL_SET_TRICORN] = { FX_NAME(RowTricornJulia), FX_NAME(RowTricorn) },
+	[FRACTAL_SET_BURNINGSHIP] = { FX_NAME(RowBurningshipJulia), FX_NAME(RowBurningship) }
+};
+
+uint64_t FX_NAME(RowKernel)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	CHECK_TRUE(FX_NAME(RowKernels)[Job->Set][Job->Type] != NULL);
+	return FX_NAME(RowKernels)[Job->Set][Job->Type](Job, Iterations);
+}
@@ -0,0 +1,140 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//one iteration of every formula in float, written once for the scalar, avx2 and
+//avx512 kernels the way Mandelbrot() in the .hlsl files has it. a kernel defines,
+//for its lane type and before it uses FORMULA_STEP:
+//  F_T                   lane type
+//  F_SET(x)              x in every lane
+//  F_ADD(a, b), F_SUB(a, b), F_MUL(a, b), F_DIV(a, b), F_MIN(a, b), F_MAX(a, b), F_ABS(x)
+//  F_LESS(a, b)          mask of the lanes where a < b
+//  F_SIGN(x)             mask of the lanes where x has its sign bit set, -0.0f included
+//  F_SELECT(m, a, b)     a in the lanes m has active, b in the others
+//  F_SPIRAL()            MosaicSpiral of the active lanes
+//FORMULA_STEP(Set) reads Zx, Zy, x2, y2, Magnitude, Cx, Cy and Active, writes
+//NewX and NewY, and carries PrevX and PrevY for the formulas with a memory.
+//every kernel runs the same operations in the same order and platform.h keeps the
+//compiler from fusing them into fma, so they agree bit for bit
+
+#include <math.h>
+#include <float.h>
+
+#include "fractal.h"
+
+#define FORMULA_STEP_MANDELBROT \
+	NewX = F_ADD(F_SUB(x2, y2), Cx); \
+	NewY = F_ADD(F_MUL(F_MUL(F_SET(2.0f), Zx), Zy), Cy);
+
+#define FORMULA_STEP_TRICORN \
+	NewX = F_ADD(F_SUB(x2, y2), Cx); \
+	NewY = F_ADD(F_MUL(F_MUL(F_SET(-2.0f), Zx), Zy), Cy);
+
+#define FORMULA_STEP_BURNINGSHIP \
+	NewX = F_ADD(F_SUB(x2, y2), Cx); \
+	NewY = F_ADD(F_MUL(F_SET(2.0f), F_ABS(F_MUL(Zx, Zy))), Cy);
+
+//cube of (|x|, |y|) with a slight skew to make it less symmetric
+#define FORMULA_STEP_DOUBLETRICORN \
+	const F_T z3y = F_MUL(F_ABS(Zy), F_SUB(F_MUL(F_SET(3.0f), x2), y2)); \
+	const F_T z3x = F_ADD(F_MUL(F_ABS(Zx), F_SUB(x2, F_MUL(F_SET(3.0f), y2))), F_MUL(F_SET(0.2f), z3y)); \
+	NewX = F_ADD(z3x, Cx); \
+	NewY = F_ADD(z3y, Cy);
+
+//phoenix: z^2 + c + k * previous, modulated by a golden spiral
+#define FORMULA_STEP_MOSAIC \
+	const F_T z2x = F_SUB(x2, y2); \
+	const F_T z2y = F_MUL(F_MUL(F_SET(2.0f), Zx), Zy); \
+	const F_T Spiral = F_SPIRAL(); \
+	NewX = F_ADD(F_ADD(z2x, Cx), F_MUL(F_MUL(F_SET(0.15f), PrevX), Spiral)); \
+	NewY = F_ADD(F_ADD(z2y, Cy), F_MUL(F_MUL(F_SET(0.15f), PrevY), Spiral)); \
+	PrevX = F_SELECT(Active, z2x, PrevX); \
+	PrevY = F_SELECT(Active, z2y, PrevY);
+
+#define FORMULA_STEP_CASE(Enum, ...) case FRACTAL_SET_##Enum: { FORMULA_STEP_##Enum } break;
+
+//Set is a constant at every call site, so the switch folds down to the one formula
+#define FORMULA_STEP(Set) \
+	switch (Set) \
+	{ \
+	FRACTAL_FORMULAS(FORMULA_STEP_CASE) \
+	default: \
+		NewX = Zx; \
+		NewY = Zy; \
+		break; \
+	}
+
+//true for the formulas whose state includes the previous term, a cycle has to repeat it too
+#define FORMULA_HAS_MEMORY(Set) ((Set) == FRACTAL_SET_MOSAIC)
+
+//per lane golden spiral term of the mosaic formula, left in libm so every kernel matches
+static inline float MosaicSpiral(float Zx, float Zy, float r)
+{
+	const float phi = 1.6180339887f;
+	const float theta = atan2f(Zy, Zx);
+	return sinf(phi * theta - phi * r * 0.3f);
+}
+
+//MosaicSpiral from polynomials for RowJob.bFastMath, defined by each float kernel
+//over its lane ops. the angle itself is needed: the spiral turns phi = 1.618 times
+//per turn of z, and sin(phi * theta) is no function of cos theta = Zx / r and
+//sin theta = Zy / r for a phi that is not a whole number, it jumps where theta
+//wraps past pi, so there is no rewrite in those two alone. atan2 is folded onto the
+//first octant, where atan(t) of t = min / max of |x| and |y| is an odd minimax
+//polynomial (max error 2.5e-7), and unfolded with selects on the sign bits so
+//signed zeros land where atan2f puts them: pi rather than 0 at Zx = -0, and -0 or
+//-pi at Zy = -0. inside the bailout r < 4, so the phase lies in (-7.1, 5.1), one
+//wrap by 2pi and a fold onto [-pi/2, pi/2] take it to an odd minimax sine (max
+//error 3.4e-9). both errors are at the float rounding of the phase, yet mosaic
+//orbits are chaotic and amplify them, so some pixels end a few iterations apart
+//from the libm path. the kernels still agree with each other bit for bit, given
+//the contraction guard in platform.h
+#define FORMULA_FAST_SPIRAL_PI_HI 3.14159274f
+#define FORMULA_FAST_SPIRAL_PI_LO -8.74227766e-8f
+
+#define FORMULA_DEFINE_FAST_SPIRAL(Name, Target) \
+	static FORCE_INLINE Target F_T Name(const F_T Zx, const F_T Zy, const F_T r) \
+	{ \
+		const F_T Ax = F_ABS(Zx); \
+		const F_T Ay = F_ABS(Zy); \
+		const F_T Low = F_MIN(Ax, Ay); \
+		const F_T High = F_MAX(F_MAX(Ax, Ay), F_SET(FLT_MIN)); \
+		const F_T t = F_DIV(Low, High); \
+		const F_T t2 = F_MUL(t, t); \
+		F_T Theta = F_SET(0.006811793f); \
+		Theta = F_ADD(F_MUL(Theta, t2), F_SET(-0.033604221f)); \
+		Theta = F_ADD(F_MUL(Theta, t2), F_SET(0.079623672f)); \
+		Theta = F_ADD(F_MUL(Theta, t2), F_SET(-0.132333421f)); \
+		Theta = F_ADD(F_MUL(Theta, t2), F_SET(0.198078156f)); \
+		Theta = F_ADD(F_MUL(Theta, t2), F_SET(-0.333173681f)); \
+		Theta = F_ADD(F_MUL(Theta, t2), F_SET(0.999996112f)); \
+		Theta = F_MUL(Theta, t); \
+		Theta = F_SELECT(F_LESS(Ax, Ay), F_SUB(F_SET(1.57079637f), Theta), Theta); \
+		Theta = F_SELECT(F_SIGN(Zx), F_SUB(F_SET(FORMULA_FAST_SPIRAL_PI_HI), Theta), Theta); \
+		Theta = F_SELECT(F_SIGN(Zy), F_SUB(F_SET(-0.0f), Theta), Theta); \
+		F_T u = F_SUB(F_MUL(F_SET(1.6180339887f), Theta), F_MUL(F_MUL(F_SET(1.6180339887f), r), F_SET(0.3f))); \
+		u = F_SELECT(F_LESS(F_SET(FORMULA_FAST_SPIRAL_PI_HI), u), F_SUB(F_SUB(u, F_SET(2.0f * FORMULA_FAST_SPIRAL_PI_HI)), F_SET(2.0f * FORMULA_FAST_SPIRAL_PI_LO)), u); \
+		u = F_SELECT(F_LESS(u, F_SET(-FORMULA_FAST_SPIRAL_PI_HI)), F_ADD(F_ADD(u, F_SET(2.0f * FORMULA_FAST_SPIRAL_PI_HI)), F_SET(2.0f * FORMULA_FAST_SPIRAL_PI_LO)), u); \
+		u = F_SELECT(F_LESS(F_SET(0.5f * FORMULA_FAST_SPIRAL_PI_HI), u), F_ADD(F_SUB(F_SET(FORMULA_FAST_SPIRAL_PI_HI), u), F_SET(FORMULA_FAST_SPIRAL_PI_LO)), u); \
+		u = F_SELECT(F_LESS(u, F_SET(-0.5f * FORMULA_FAST_SPIRAL_PI_HI)), F_SUB(F_SUB(F_SET(-FORMULA_FAST_SPIRAL_PI_HI), u), F_SET(FORMULA_FAST_SPIRAL_PI_LO)), u); \
+		const F_T u2 = F_MUL(u, u); \
+		F_T Sine = F_SET(2.5904885e-6f); \
+		Sine = F_ADD(F_MUL(Sine, u2), F_SET(-1.98008978e-4f)); \
+		Sine = F_ADD(F_MUL(Sine, u2), F_SET(8.3328998e-3f)); \
+		Sine = F_ADD(F_MUL(Sine, u2), F_SET(-0.166666476f)); \
+		Sine = F_ADD(F_MUL(Sine, u2), F_SET(0.999999977f)); \
+		return F_MUL(Sine, u); \
+	}
@@ -0,0 +1,53 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//shared between the gpu viewer (main.c) and the headless cpu renderer
+
+//layout must match the ConstantBufferData struct in the .hlsl files
+struct ConstantBufferData
+{
+	float MaxIterations[4];
+	float WindowPos[4];
+	float JuliaPos[4];
+};
+
+//every formula, one line each. X(ENUM, Suffix, Name, IterationMultiplier, Bailout,
+//Degree, bConnected, bConjugateSymmetric, bEven), see struct FractalFormula for the
+//fields. the enum, the formula table, the shader and program names and the cpu
+//kernels of every isa are generated from this list, a new formula also needs its
+//step in formulas.h and multidouble_kernel.h and a pair of .hlsl files
+#define FRACTAL_FORMULAS(X) \
+	X(MANDELBROT,		Mandelbrot,		"mandelbrot",		4, 4.0f,	2.0f, true,	true,	true) \
+	X(TRICORN,			Tricorn,		"tricorn",			4, 4.0f,	2.0f, true,	true,	true) \
+	X(BURNINGSHIP,		Burningship,	"burningship",		1, 4.0f,	2.0f, false,	false,	true) \
+	X(DOUBLETRICORN,	Doubletricorn,	"doubletricorn",	4, 4.0f,	3.0f, false,	false,	false) \
+	X(MOSAIC,			Mosaic,			"mosaic",			6, 16.0f,	2.0f, false,	false,	false)
+
+enum FractalSet
+{
+#define FRACTAL_SET_ENUM(Enum, ...) FRACTAL_SET_##Enum,
+	FRACTAL_FORMULAS(FRACTAL_SET_ENUM)
+#undef FRACTAL_SET_ENUM
+	FRACTAL_SET_COUNT
+};
+
+enum FractalType
+{
+	FRACTAL_TYPE_JULIA,
+	FRACTAL_TYPE_BASE,
+	FRACTAL_TYPE_COUNT
+};
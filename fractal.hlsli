@@ -0,0 +1,26 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+* 
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//helpers shared by every shader, included once MyConstantBuffer is declared
+
+//squared distance under which an orbit point counts as a repeat, a ten thousandth of a pixel
+float PeriodTolerance()
+{
+    float2 PixelSize = MyConstantBuffer.WindowPos.xy / MyConstantBuffer.MaxIterations.xy;
+    float Tolerance = min(PixelSize.x, PixelSize.y) * 1e-4;
+    return Tolerance * Tolerance;
+}
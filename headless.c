@@ -0,0 +1,1253 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//command line front end for the cpu renderer, no window or gpu required
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include "animation.h"
+#include "cpurender.h"
+#include "deepzoom.h"
+#include "expmap.h"
+#include "imageio.h"
+#include "poster.h"
+#include "pyramid.h"
+#include "server.h"
+#include "tilecache.h"
+#include "userformula.h"
+#include "platform.h"
+
+struct Options
+{
+	struct CpuView View;
+	uint32_t ThreadCount;
+	uint32_t TileSize;
+	enum KernelIsa Isa;
+	bool bMinimap;
+	bool bSubdivide;
+	bool bNoInterior;
+	bool bFastMath;
+	bool bFastMathCheck;	//also render the frame without fast math and count the pixels that differ
+	bool bIsaCheck;			//also render the frame on every supported isa and count the pixels that differ
+	bool bProgressive;
+	bool bPalette;			//colour through ColorizePalette instead of ColorizeIterations
+	bool bSmooth;
+	enum PaletteType Palette;
+	double PaletteCycle;	//0 for MaxIterations.z
+	double PaletteOffset;
+	struct AntialiasSettings Antialias;	//MaxSamples == 0 without --antialias
+	uint32_t CacheMegabytes;
+	uint32_t PosterMegabytes;
+	bool bPyramid;
+	uint16_t ServePort;		//0 unless --serve
+	const char* AnimationPath;	//NULL unless --animate
+	double FramesPerSecond;
+	double ExpMapSeconds;	//0 unless --expmap
+	uint32_t RefineFrom;
+	double PanStep[2];		//pixels the centre moves per frame of --pan
+	uint32_t PanFrames;
+	double ZoomFactor;		//WindowPos.xy scale per frame of --zoom
+	uint32_t ZoomFrames;
+	double ZoomBudget;		//iterations per frame of --zoom
+	bool bAutoTier;
+	enum PrecisionTier Tier;
+	const char* FormulaSource;	//NULL unless --formula
+	float Bailout;
+	const char* OutputPath;
+	char WindowPos[4][256];	//as typed, so the deep tiers keep every digit
+};
+
+static void PrintUsage(void)
+{
+	fprintf(stderr,
+		"usage: fractal_headless [options]\n"
+		"  -o, --output FILE         output image (.ppm), default fractal.ppm\n"
+		"  --set NAME                mandelbrot, tricorn, burningship, doubletricorn, mosaic\n"
+		"  --formula EXPR            iterate z = EXPR instead of the formula of --set, which\n"
+		"                            still sets the iteration multiplier. z starts at the\n"
+		"                            pixel, c is the pixel or --julia-pos, p is the z before.\n"
+		"                            + - * / ^, i, pi and sqr conj abs re im norm mod arg\n"
+		"                            exp log sin cos, e.g. sqr(abs(z)) + c (float precision,\n"
+		"                            not with --animate, --expmap, --serve or --cache)\n"
+		"  --bailout N               |z|^2 a --formula pixel escapes at, default 4\n"
+		"  --julia                   render the julia variant instead of the base set\n"
+		"  --julia-pos X,Y           JuliaPos.xy\n"
+		"  --size WxH                MaxIterations.xy, default 1920x1080\n"
+		"  --iterations N            MaxIterations.z, default 700\n"
+		"  --refine-from N           render at MaxIterations.z = N first, then carry only\n"
+		"                            the pixels that hit that limit on to --iterations\n"
+		"                            (float precision only)\n"
+		"  --pan DX,DY,FRAMES        pan the centre by DX,DY pixels a frame for FRAMES\n"
+		"                            frames, rendering only the exposed strips, and write\n"
+		"                            the last one (float precision only)\n"
+		"  --zoom SCALE,FRAMES,BUDGET  scale the view by SCALE a frame for FRAMES frames,\n"
+		"                            resampling the previous frame and iterating at most\n"
+		"                            about BUDGET iterations a frame, then refine the last\n"
+		"                            one until it is exact (float precision only)\n"
+		"  --window W,H,X,Y          WindowPos, default 4,2.25,-0.65,0\n"
+		"  --precision NAME          auto, float, double, fixed (Q4.60, mandelbrot, tricorn\n"
+		"                            and burningship), perturbation, dd (double-double)\n"
+		"                            or qd (quad-double). default auto, which picks the\n"
+		"                            cheapest one that resolves the view\n"
+		"  --deep                    same as --precision perturbation\n"
+		"                            (mandelbrot, tricorn and burningship only)\n"
+		"  --minimap                 draw the julia minimap like the base view does\n"
+		"  --subdivide               fill rectangles with a uniform border instead of\n"
+		"                            iterating them (mandelbrot and tricorn only)\n"
+		"  --progressive             render in passes at 1/8, 1/4, 1/2 and full resolution\n"
+		"                            and write each coarse pass next to the output as\n"
+		"                            NAME_passN.ppm (float precision only)\n"
+		"  --cache MB                snap the view to the tile cache grid and render it\n"
+		"                            twice through a cache of MB megabytes, writing the\n"
+		"                            second, cached frame (float precision only)\n"
+		"  --palette NAME            colour through a lookup table: classic, fire or ice\n"
+		"  --cycle N                 iterations per trip around the palette, default\n"
+		"                            MaxIterations.z\n"
+		"  --cycle-offset F          rotate the palette by F trips\n"
+		"  --smooth                  blend the palette bands with the smooth iteration\n"
+		"                            fraction (float precision, single frame renders)\n"
+		"  --antialias N[,T]         average N jittered samples over each pixel that\n"
+		"                            differs from a neighbour by more than T iterations,\n"
+		"                            default 1 (float precision only)\n"
+		"  --poster MB               render a band of rows at a time straight into the\n"
+		"                            output, keeping the bands under MB megabytes, for\n"
+		"                            images too big for memory. a .png output is written\n"
+		"                            uncompressed (float precision only)\n"
+		"  --pyramid                 write a deep zoom image instead: the output name\n"
+		"                            without its extension gets a .dzi and a _files\n"
+		"                            directory of png tiles. a run that was cut short\n"
+		"                            picks up where it stopped (float precision only)\n"
+		"  --animate FILE            render the keyframe path in FILE as a zoom animation,\n"
+		"                            raw rgb24 frames of --size to the output, - for stdout.\n"
+		"                            one keyframe a line: TIME SET base|julia SCALE X Y\n"
+		"                            [JULIA_X JULIA_Y]\n"
+		"  --expmap SECONDS          zoom from the default window into --window over\n"
+		"                            SECONDS, iterating one log-polar strip around its\n"
+		"                            centre and resampling every frame from it. raw rgb24\n"
+		"                            frames of --size to the output, - for stdout\n"
+		"  --fps N                   frames per second of --animate and --expmap, default 60\n"
+		"  --serve PORT              serve 256 pixel png tiles over http on localhost at\n"
+		"                            /{set}/{base|julia}/{z}/{x}/{y}.png, with --iterations,\n"
+		"                            --julia-pos and the palette options applying to every\n"
+		"                            tile and --cache MB sizing the tile cache (default 256)\n"
+		"  --no-interior             iterate every interior pixel to the limit instead of\n"
+		"                            using the cardioid/bulb test and cycle detection\n"
+		"  --fast-math               polynomial atan2 and sin in the mosaic kernels, several\n"
+		"                            times faster, a few pixels end up some iterations off\n"
+		"                            (float precision)\n"
+		"  --fast-math-check         --fast-math, then render the frame again without it and\n"
+		"                            report how many pixels differ and by how much\n"
+		"  --isa-check               render the frame again with the scalar kernels and every\n"
+		"                            simd isa the cpu supports, report the pixels that differ\n"
+		"                            and exit with 1 if any do, with --progressive also\n"
+		"                            render every isa progressively against that frame\n"
+		"  --threads N               worker threads, default all cores\n"
+		"  --tile N                  tile size in pixels, default %u\n"
+		"  --isa NAME                scalar, avx2 or avx512, default the widest supported\n",
+		CPU_RENDER_DEFAULT_TILE_SIZE);
+}
+
+static bool ParseSet(const char* Name, enum FractalSet* restrict Set)
+{
+	for (int i = 0; i < FRACTAL_SET_COUNT; i++)
+	{
+		if (strcmp(Name, FractalFormulas[i].Name) == 0)
+		{
+			*Set = (enum FractalSet)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ParsePrecision(const char* Name, struct Options* restrict Options)
+{
+	if (strcmp(Name, "auto") == 0)
+	{
+		Options->bAutoTier = true;
+		return true;
+	}
+
+	for (int i = 0; i < PRECISION_TIER_COUNT; i++)
+	{
+		if (strcmp(Name, PrecisionTierNames[i]) == 0)
+		{
+			Options->bAutoTier = false;
+			Options->Tier = (enum PrecisionTier)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ParseIsa(const char* Name, enum KernelIsa* restrict Isa)
+{
+	for (int i = 0; i < KERNEL_ISA_COUNT; i++)
+	{
+		if (strcmp(Name, KernelIsaNames[i]) == 0)
+		{
+			*Isa = (enum KernelIsa)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ParsePalette(const char* Name, enum PaletteType* restrict Type)
+{
+	for (int i = 0; i < PALETTE_TYPE_COUNT; i++)
+	{
+		if (strcmp(Name, PaletteTypeNames[i]) == 0)
+		{
+			*Type = (enum PaletteType)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+//splits W,H,X,Y into the raw strings and the double copy in the view
+static bool ParseWindow(const char* Value, struct Options* restrict Options)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		const char* End = strchr(Value, ',');
+		size_t Length = (i < 3) ? (End ? (size_t)(End - Value) : 0) : strlen(Value);
+		if (Length == 0 || Length >= sizeof(Options->WindowPos[i]))
+			return false;
+
+		memcpy(Options->WindowPos[i], Value, Length);
+		Options->WindowPos[i][Length] = '\0';
+		Options->View.WindowPos[i] = strtod(Options->WindowPos[i], NULL);
+		Value += Length + 1;
+	}
+	return true;
+}
+
+static bool ParseOptions(int argc, char** argv, struct Options* restrict Options)
+{
+	memset(Options, 0, sizeof(struct Options));
+	CpuViewSetDefault(&Options->View, FRACTAL_SET_MANDELBROT, FRACTAL_TYPE_BASE, 1920, 1080);
+	Options->OutputPath = "fractal.ppm";
+	Options->Isa = GetBestKernelIsa();
+	Options->bAutoTier = true;
+	Options->FramesPerSecond = 60.0;
+	Options->Bailout = 4.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		snprintf(Options->WindowPos[i], sizeof(Options->WindowPos[i]), "%.17g", Options->View.WindowPos[i]);
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* Arg = argv[i];
+		const char* Value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (strcmp(Arg, "--julia") == 0)
+		{
+			Options->View.Type = FRACTAL_TYPE_JULIA;
+			continue;
+		}
+		if (strcmp(Arg, "--minimap") == 0)
+		{
+			Options->bMinimap = true;
+			continue;
+		}
+		if (strcmp(Arg, "--subdivide") == 0)
+		{
+			Options->bSubdivide = true;
+			continue;
+		}
+		if (strcmp(Arg, "--no-interior") == 0)
+		{
+			Options->bNoInterior = true;
+			continue;
+		}
+		if (strcmp(Arg, "--fast-math") == 0)
+		{
+			Options->bFastMath = true;
+			continue;
+		}
+		if (strcmp(Arg, "--fast-math-check") == 0)
+		{
+			Options->bFastMath = true;
+			Options->bFastMathCheck = true;
+			continue;
+		}
+		if (strcmp(Arg, "--isa-check") == 0)
+		{
+			Options->bIsaCheck = true;
+			continue;
+		}
+		if (strcmp(Arg, "--progressive") == 0)
+		{
+			Options->bProgressive = true;
+			continue;
+		}
+		if (strcmp(Arg, "--smooth") == 0)
+		{
+			Options->bPalette = true;
+			Options->bSmooth = true;
+			continue;
+		}
+		if (strcmp(Arg, "--pyramid") == 0)
+		{
+			Options->bPyramid = true;
+			continue;
+		}
+		if (strcmp(Arg, "--deep") == 0)
+		{
+			Options->bAutoTier = false;
+			Options->Tier = PRECISION_TIER_PERTURBATION;
+			continue;
+		}
+		if (strcmp(Arg, "-h") == 0 || strcmp(Arg, "--help") == 0)
+			return false;
+
+		if (Value == NULL)
+		{
+			fprintf(stderr, "missing value for %s\n", Arg);
+			return false;
+		}
+		i++;
+
+		if (strcmp(Arg, "-o") == 0 || strcmp(Arg, "--output") == 0)
+		{
+			Options->OutputPath = Value;
+		}
+		else if (strcmp(Arg, "--set") == 0)
+		{
+			if (!ParseSet(Value, &Options->View.Set))
+			{
+				fprintf(stderr, "unknown fractal set %s\n", Value);
+				return false;
+			}
+		}
+		else if (strcmp(Arg, "--formula") == 0)
+		{
+			Options->FormulaSource = Value;
+		}
+		else if (strcmp(Arg, "--bailout") == 0)
+		{
+			Options->Bailout = strtof(Value, NULL);
+			if (!(Options->Bailout > 0.0f))
+				return false;
+		}
+		else if (strcmp(Arg, "--julia-pos") == 0)
+		{
+			if (sscanf(Value, "%lf,%lf", &Options->View.JuliaPos[0], &Options->View.JuliaPos[1]) != 2)
+				return false;
+		}
+		else if (strcmp(Arg, "--size") == 0)
+		{
+			if (sscanf(Value, "%ux%u", &Options->View.Width, &Options->View.Height) != 2 || Options->View.Width == 0 || Options->View.Height == 0)
+				return false;
+		}
+		else if (strcmp(Arg, "--iterations") == 0)
+		{
+			Options->View.MaxIterations = (uint32_t)strtoul(Value, NULL, 10);
+			if (Options->View.MaxIterations == 0)
+				return false;
+		}
+		else if (strcmp(Arg, "--refine-from") == 0)
+		{
+			Options->RefineFrom = (uint32_t)strtoul(Value, NULL, 10);
+		}
+		else if (strcmp(Arg, "--pan") == 0)
+		{
+			if (sscanf(Value, "%lf,%lf,%u", &Options->PanStep[0], &Options->PanStep[1], &Options->PanFrames) != 3)
+				return false;
+		}
+		else if (strcmp(Arg, "--poster") == 0)
+		{
+			Options->PosterMegabytes = (uint32_t)strtoul(Value, NULL, 10);
+			if (Options->PosterMegabytes == 0)
+				return false;
+		}
+		else if (strcmp(Arg, "--animate") == 0)
+		{
+			Options->AnimationPath = Value;
+		}
+		else if (strcmp(Arg, "--expmap") == 0)
+		{
+			Options->ExpMapSeconds = atof(Value);
+			if (!(Options->ExpMapSeconds > 0.0))
+				return false;
+		}
+		else if (strcmp(Arg, "--fps") == 0)
+		{
+			Options->FramesPerSecond = atof(Value);
+			if (!(Options->FramesPerSecond > 0.0))
+				return false;
+		}
+		else if (strcmp(Arg, "--serve") == 0)
+		{
+			const unsigned long Port = strtoul(Value, NULL, 10);
+			if (Port == 0 || Port > 65535)
+				return false;
+			Options->ServePort = (uint16_t)Port;
+		}
+		else if (strcmp(Arg, "--cache") == 0)
+		{
+			Options->CacheMegabytes = (uint32_t)strtoul(Value, NULL, 10);
+			if (Options->CacheMegabytes == 0)
+				return false;
+		}
+		else if (strcmp(Arg, "--palette") == 0)
+		{
+			if (!ParsePalette(Value, &Options->Palette))
+			{
+				fprintf(stderr, "unknown palette %s\n", Value);
+				return false;
+			}
+			Options->bPalette = true;
+		}
+		else if (strcmp(Arg, "--cycle") == 0)
+		{
+			Options->PaletteCycle = strtod(Value, NULL);
+			if (Options->PaletteCycle <= 0.0)
+				return false;
+			Options->bPalette = true;
+		}
+		else if (strcmp(Arg, "--cycle-offset") == 0)
+		{
+			Options->PaletteOffset = strtod(Value, NULL);
+			Options->bPalette = true;
+		}
+		else if (strcmp(Arg, "--antialias") == 0)
+		{
+			Options->Antialias.Threshold = 1.0f;
+			if (sscanf(Value, "%u,%f", &Options->Antialias.MaxSamples, &Options->Antialias.Threshold) < 1 || Options->Antialias.MaxSamples == 0 || Options->Antialias.Threshold < 0.0f)
+				return false;
+		}
+		else if (strcmp(Arg, "--zoom") == 0)
+		{
+			if (sscanf(Value, "%lf,%u,%lf", &Options->ZoomFactor, &Options->ZoomFrames, &Options->ZoomBudget) != 3 || Options->ZoomFactor <= 0.0 || Options->ZoomBudget < 1.0)
+				return false;
+		}
+		else if (strcmp(Arg, "--window") == 0)
+		{
+			if (!ParseWindow(Value, Options))
+				return false;
+		}
+		else if (strcmp(Arg, "--precision") == 0)
+		{
+			if (!ParsePrecision(Value, Options))
+			{
+				fprintf(stderr, "unknown precision %s\n", Value);
+				return false;
+			}
+		}
+		else if (strcmp(Arg, "--threads") == 0)
+		{
+			Options->ThreadCount = (uint32_t)strtoul(Value, NULL, 10);
+		}
+		else if (strcmp(Arg, "--isa") == 0)
+		{
+			if (!ParseIsa(Value, &Options->Isa))
+			{
+				fprintf(stderr, "unknown isa %s\n", Value);
+				return false;
+			}
+		}
+		else if (strcmp(Arg, "--tile") == 0)
+		{
+			Options->TileSize = (uint32_t)strtoul(Value, NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "unknown option %s\n", Arg);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//the base view samples a julia render of the default window into its top right fifth
+static void DrawMinimap(struct CpuRenderer* Renderer, const struct CpuView* restrict View, uint8_t* restrict Rgba, size_t RowPitch)
+{
+	const uint32_t MinimapWidth = max(View->Width / 5, 1);
+	const uint32_t MinimapHeight = max(View->Height / 5, 1);
+
+	struct CpuView Minimap;
+	CpuViewSetDefault(&Minimap, View->Set, FRACTAL_TYPE_JULIA, MinimapWidth, MinimapHeight);
+	Minimap.MaxIterations = View->MaxIterations;
+	Minimap.JuliaPos[0] = View->JuliaPos[0];
+	Minimap.JuliaPos[1] = View->JuliaPos[1];
+
+	struct IterationBuffer Buffer;
+	IterationBufferInit(&Buffer, MinimapWidth, MinimapHeight);
+	CpuRenderFrame(Renderer, &Minimap, &Buffer, NULL);
+
+	uint8_t* MinimapRgba = malloc((size_t)MinimapWidth * MinimapHeight * 4);
+	CHECK_ALLOC(MinimapRgba);
+	ColorizeIterations(&Minimap, &Buffer, MinimapRgba, (size_t)MinimapWidth * 4);
+
+	const uint32_t Left = View->Width - MinimapWidth;
+	for (uint32_t y = 0; y < MinimapHeight; y++)
+	{
+		memcpy(Rgba + y * RowPitch + (size_t)Left * 4, MinimapRgba + (size_t)y * MinimapWidth * 4, (size_t)MinimapWidth * 4);
+	}
+
+	free(MinimapRgba);
+	IterationBufferRelease(&Buffer);
+}
+
+struct ProgressiveOutput
+{
+	const struct CpuView* View;
+	const char* OutputPath;
+};
+
+//writes every pass but the last, which main writes as the output itself
+static void WriteProgressivePass(void* Context, const struct IterationBuffer* restrict Buffer, uint32_t Stride, const struct CpuRenderStats* restrict Stats)
+{
+	const struct ProgressiveOutput* Output = Context;
+	fprintf(stderr, "pass 1/%u: %.3f s, %llu iterations\n", Stride, Stats->Seconds, (unsigned long long)Stats->TotalIterations);
+	if (Stride == 1)
+		return;
+
+	const char* Extension = strrchr(Output->OutputPath, '.');
+	const int StemLength = Extension ? (int)(Extension - Output->OutputPath) : (int)strlen(Output->OutputPath);
+	char Path[1024];
+	snprintf(Path, sizeof(Path), "%.*s_pass%u%s", StemLength, Output->OutputPath, Stride, Extension ? Extension : "");
+
+	const size_t RowPitch = (size_t)Buffer->Width * 4;
+	uint8_t* Rgba = malloc(RowPitch * Buffer->Height);
+	CHECK_ALLOC(Rgba);
+	ColorizeIterations(Output->View, Buffer, Rgba, RowPitch);
+	if (!WritePpm(Path, Rgba, Buffer->Width, Buffer->Height, RowPitch))
+		fprintf(stderr, "unable to write %s\n", Path);
+	free(Rgba);
+}
+
+struct PosterOutput
+{
+	double LastReport;
+};
+
+//a line a second at most, and one for the last band
+static void ReportPosterProgress(void* Context, const struct PosterProgress* restrict Progress)
+{
+	struct PosterOutput* Output = Context;
+	if (Progress->RowsDone != Progress->Height && Progress->Seconds - Output->LastReport < 1.0)
+		return;
+
+	Output->LastReport = Progress->Seconds;
+	fprintf(stderr, "%u/%u rows, %.1f Mpixel/s, %.0f s elapsed, %.0f s left\n",
+		Progress->RowsDone,
+		Progress->Height,
+		Progress->PixelsPerSecond * 1e-6,
+		Progress->Seconds,
+		Progress->EtaSeconds);
+}
+
+static int RenderPoster(struct CpuRenderer* Renderer, const struct Options* restrict Options, const struct CpuView* restrict View, const struct Palette* restrict Palette)
+{
+	struct PosterSettings Settings;
+	Settings.Path = Options->OutputPath;
+	Settings.MemoryLimit = (size_t)Options->PosterMegabytes << 20;
+	Settings.bSmooth = Options->bSmooth;
+
+	const uint32_t BandHeight = GetPosterBandHeight(Renderer, View, &Settings);
+	if (BandHeight == 0)
+	{
+		fprintf(stderr, "a single row of %u pixels does not fit in %u MB\n", View->Width, Options->PosterMegabytes);
+		return 1;
+	}
+	fprintf(stderr, "rendering %ux%u in bands of %u rows\n", View->Width, View->Height, BandHeight);
+
+	struct PosterOutput Output = { 0.0 };
+	struct CpuRenderStats Stats;
+	//colours like a single frame render, through the palette only with --palette
+	if (!CpuRenderPoster(Renderer, View, Options->bPalette ? Palette : NULL, &Settings, ReportPosterProgress, &Output, &Stats))
+	{
+		fprintf(stderr, "unable to write %s\n", Options->OutputPath);
+		return 1;
+	}
+
+	fprintf(stderr, "%s %s %ux%u: %.3f s, %u tiles on %u threads (%s, %s), %.1f Miter/s\n",
+		Options->FormulaSource ? Options->FormulaSource : FractalFormulas[View->Set].Name,
+		View->Type == FRACTAL_TYPE_BASE ? "base" : "julia",
+		View->Width,
+		View->Height,
+		Stats.Seconds,
+		Stats.TileCount,
+		Stats.ThreadCount,
+		KernelIsaNames[Stats.Isa],
+		PrecisionTierNames[Stats.Tier],
+		Stats.TotalIterations / Stats.Seconds * 1e-6);
+	return 0;
+}
+
+static int RenderPyramid(struct CpuRenderer* Renderer, const struct Options* restrict Options, const struct CpuView* restrict View, const struct Palette* restrict Palette)
+{
+	const char* Extension = strrchr(Options->OutputPath, '.');
+	const int StemLength = Extension ? (int)(Extension - Options->OutputPath) : (int)strlen(Options->OutputPath);
+	char Stem[1024];
+	snprintf(Stem, sizeof(Stem), "%.*s", StemLength, Options->OutputPath);
+
+	struct PyramidStats Stats;
+	//colours like a single frame render, through the palette only with --palette
+	if (!CpuRenderPyramid(Renderer, View, Options->bPalette ? Palette : NULL, Stem, &Stats))
+	{
+		fprintf(stderr, "unable to write the pyramid at %s\n", Stem);
+		return 1;
+	}
+
+	fprintf(stderr, "%s.dzi: %u levels, %llu tiles rendered, %llu downsampled, %llu already done, %.3f s, %.1f Miter/s\n",
+		Stem,
+		Stats.LevelCount,
+		(unsigned long long)Stats.RenderedTiles,
+		(unsigned long long)Stats.DownsampledTiles,
+		(unsigned long long)Stats.ResumedTiles,
+		Stats.Seconds,
+		Stats.TotalIterations / Stats.Seconds * 1e-6);
+	return 0;
+}
+
+struct AnimationOutput
+{
+	double LastReport;
+};
+
+//a line a second at most, and one for the last frame
+static void ReportAnimationProgress(void* Context, const struct AnimationProgress* restrict Progress)
+{
+	struct AnimationOutput* Output = Context;
+	if (Progress->FramesDone != Progress->FrameCount && Progress->Seconds - Output->LastReport < 1.0)
+		return;
+
+	Output->LastReport = Progress->Seconds;
+	fprintf(stderr, "%u/%u frames, %.1f frames/s, %.0f s elapsed, %.0f s left\n",
+		Progress->FramesDone,
+		Progress->FrameCount,
+		Progress->FramesDone / Progress->Seconds,
+		Progress->Seconds,
+		Progress->EtaSeconds);
+}
+
+//raw frames go to the output file, or to stdout for -
+static FILE* OpenRawOutput(const char* Path)
+{
+	if (strcmp(Path, "-") == 0)
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		return stdout;
+	}
+
+	FILE* Output = fopen(Path, "wb");
+	if (Output == NULL)
+		fprintf(stderr, "unable to write %s\n", Path);
+	return Output;
+}
+
+static int RenderAnimation(struct CpuRenderer* Renderer, const struct Options* restrict Options, const struct Palette* restrict Palette)
+{
+	struct AnimationPath Path;
+	if (!AnimationPathLoad(Options->AnimationPath, &Path))
+		return 1;
+
+	const bool bStdout = strcmp(Options->OutputPath, "-") == 0;
+	FILE* Output = OpenRawOutput(Options->OutputPath);
+	if (Output == NULL)
+	{
+		AnimationPathRelease(&Path);
+		return 1;
+	}
+
+	struct AnimationSettings Settings;
+	Settings.Width = Options->View.Width;
+	Settings.Height = Options->View.Height;
+	Settings.MaxIterations = Options->View.MaxIterations;
+	Settings.FramesPerSecond = Options->FramesPerSecond;
+	Settings.bSmooth = Options->bSmooth;
+	Settings.Palette = Palette;
+	Settings.Output = Output;
+
+	fprintf(stderr, "rendering %ux%u rgb24 at %g frames/s to %s\n", Settings.Width, Settings.Height, Settings.FramesPerSecond, bStdout ? "stdout" : Options->OutputPath);
+
+	struct AnimationOutput Progress = { 0.0 };
+	struct AnimationStats Stats;
+	bool bOk = CpuRenderAnimation(Renderer, &Path, &Settings, ReportAnimationProgress, &Progress, &Stats);
+	if (!bStdout)
+		bOk = fclose(Output) == 0 && bOk;
+	AnimationPathRelease(&Path);
+	if (!bOk)
+	{
+		fprintf(stderr, "unable to write %s\n", bStdout ? "stdout" : Options->OutputPath);
+		return 1;
+	}
+
+	const double FramePixels = (double)Settings.Width * Settings.Height;
+	fprintf(stderr, "%u frames: %.3f s, %u lattice renders, %u key frames and %u direct frames, %.1f frames worth of pixels iterated, %.1f copied, %.1f Miter/s\n",
+		Stats.FrameCount,
+		Stats.Seconds,
+		Stats.LatticeRenders,
+		Stats.KeyFrames,
+		Stats.DirectFrames,
+		Stats.IteratedPixels / FramePixels,
+		Stats.ReusedPixels / FramePixels,
+		Stats.TotalIterations / Stats.Seconds * 1e-6);
+	return 0;
+}
+
+static int RenderExpMap(struct CpuRenderer* Renderer, const struct Options* restrict Options, const struct DeepView* restrict Target, const struct Palette* restrict Palette)
+{
+	struct CpuView Start;
+	CpuViewSetDefault(&Start, Target->Set, Target->Type, Target->Width, Target->Height);
+	if (!(fabs(BigFloatToDouble(&Target->WindowPos[0])) < Start.WindowPos[0]))
+	{
+		fprintf(stderr, "--expmap zooms in from a window %g wide, --window has to be narrower\n", Start.WindowPos[0]);
+		return 1;
+	}
+
+	const bool bStdout = strcmp(Options->OutputPath, "-") == 0;
+	FILE* Output = OpenRawOutput(Options->OutputPath);
+	if (Output == NULL)
+		return 1;
+
+	struct ExpMapSettings Settings;
+	Settings.Width = Target->Width;
+	Settings.Height = Target->Height;
+	Settings.StartScale = Start.WindowPos[0];
+	Settings.Duration = Options->ExpMapSeconds;
+	Settings.FramesPerSecond = Options->FramesPerSecond;
+	Settings.bSmooth = Options->bSmooth;
+	Settings.Palette = Palette;
+	Settings.Output = Output;
+
+	fprintf(stderr, "rendering %ux%u rgb24 at %g frames/s to %s\n", Settings.Width, Settings.Height, Settings.FramesPerSecond, bStdout ? "stdout" : Options->OutputPath);
+
+	struct AnimationOutput Progress = { 0.0 };
+	struct ExpMapStats Stats;
+	bool bOk = CpuRenderExpMapZoom(Renderer, Target, &Settings, ReportAnimationProgress, &Progress, &Stats);
+	if (!bStdout)
+		bOk = fclose(Output) == 0 && bOk;
+	if (!bOk)
+	{
+		fprintf(stderr, "unable to write %s\n", bStdout ? "stdout" : Options->OutputPath);
+		return 1;
+	}
+
+	const double FramePixels = (double)Settings.Width * Settings.Height;
+	fprintf(stderr, "%u frames: %.3f s, %.3f s of it on a %ux%u strip, %.1f frames worth of pixels iterated, %.1f Miter/s\n",
+		Stats.FrameCount,
+		Stats.Seconds,
+		Stats.StripSeconds,
+		Stats.StripWidth,
+		Stats.StripRows,
+		Stats.IteratedPixels / FramePixels,
+		Stats.TotalIterations / Stats.StripSeconds * 1e-6);
+	return 0;
+}
+
+static int ServeTiles(struct CpuRenderer* Renderer, const struct Options* restrict Options, const struct Palette* restrict Palette)
+{
+	struct TileServerSettings Settings;
+	memset(&Settings, 0, sizeof(Settings));
+	Settings.Port = Options->ServePort;
+	Settings.CacheBudget = (size_t)(Options->CacheMegabytes != 0 ? Options->CacheMegabytes : 256) << 20;
+	Settings.MaxIterations = Options->View.MaxIterations;
+	Settings.JuliaPos[0] = Options->View.JuliaPos[0];
+	Settings.JuliaPos[1] = Options->View.JuliaPos[1];
+	Settings.bSmooth = Options->bSmooth;
+	Settings.Palette = Palette;
+
+	fprintf(stderr, "serving tiles on http://127.0.0.1:%u/, stats at /stats\n", Options->ServePort);
+	if (!TileServerRun(Renderer, &Settings))
+	{
+		fprintf(stderr, "unable to listen on port %u\n", Options->ServePort);
+		return 1;
+	}
+	return 0;
+}
+
+//renders the frame on every supported isa, returns true if they all match the scalar kernels
+//copies a finished frame out of a pan, zoom or resume buffer, fractions included
+static void CopyIterations(struct IterationBuffer* restrict Target, const struct IterationBuffer* restrict Source)
+{
+	const size_t PixelCount = (size_t)Target->Width * Target->Height;
+	memcpy(Target->Iterations, Source->Iterations, PixelCount * sizeof(uint32_t));
+	if (Target->Fractions && Source->Fractions)
+		memcpy(Target->Fractions, Source->Fractions, PixelCount);
+}
+
+static size_t CountDiffering(const struct IterationBuffer* restrict Check, const struct IterationBuffer* restrict Reference, size_t PixelCount)
+{
+	size_t Differing = 0;
+	for (size_t i = 0; i < PixelCount; i++)
+		Differing += Check->Iterations[i] != Reference->Iterations[i];
+	return Differing;
+}
+
+static bool CheckIsas(struct CpuRenderer* Renderer, const struct DeepView* restrict View, enum PrecisionTier Tier, bool bProgressive, uint32_t Width, uint32_t Height)
+{
+	const enum KernelIsa Isa = CpuRendererGetIsa(Renderer);
+	const size_t PixelCount = (size_t)Width * Height;
+
+	struct IterationBuffer Reference;
+	struct IterationBuffer Check;
+	IterationBufferInit(&Reference, Width, Height);
+	IterationBufferInit(&Check, Width, Height);
+
+	struct CpuRenderStats Stats;
+	struct DeepRenderStats DeepStats;
+	CpuRendererSetIsa(Renderer, KERNEL_ISA_SCALAR);
+	CpuRenderTierFrame(Renderer, View, Tier, &Reference, &Stats, &DeepStats);
+
+	bool bMatch = true;
+	for (uint32_t Other = KERNEL_ISA_SCALAR + 1; Other < KERNEL_ISA_COUNT; Other++)
+	{
+		if (!CpuRendererSetIsa(Renderer, (enum KernelIsa)Other))
+			continue;
+
+		CpuRenderTierFrame(Renderer, View, Tier, &Check, &Stats, &DeepStats);
+
+		const size_t Differing = CountDiffering(&Check, &Reference, PixelCount);
+		fprintf(stderr, "isa check: %s %s scalar, %zu of %zu pixels differ\n", KernelIsaNames[Other], Differing == 0 ? "matches" : "differs from", Differing, PixelCount);
+		bMatch = bMatch && Differing == 0;
+	}
+
+	//the last progressive pass has to match the one shot frame on every isa, scalar included
+	if (bProgressive && Tier == PRECISION_TIER_FLOAT)
+	{
+		struct CpuView FloatView;
+		CpuViewFromDeepView(&FloatView, View);
+		for (uint32_t Other = KERNEL_ISA_SCALAR; Other < KERNEL_ISA_COUNT; Other++)
+		{
+			if (!CpuRendererSetIsa(Renderer, (enum KernelIsa)Other))
+				continue;
+
+			CpuRenderFrameProgressive(Renderer, &FloatView, &Check, NULL, NULL, &Stats);
+
+			const size_t Differing = CountDiffering(&Check, &Reference, PixelCount);
+			fprintf(stderr, "isa check: progressive %s %s scalar, %zu of %zu pixels differ\n", KernelIsaNames[Other], Differing == 0 ? "matches" : "differs from", Differing, PixelCount);
+			bMatch = bMatch && Differing == 0;
+		}
+	}
+	CpuRendererSetIsa(Renderer, Isa);
+
+	IterationBufferRelease(&Check);
+	IterationBufferRelease(&Reference);
+	return bMatch;
+}
+
+int main(int argc, char** argv)
+{
+	struct Options Options;
+	if (!ParseOptions(argc, argv, &Options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const struct CpuView* View = &Options.View;
+
+	struct CpuRenderer* Renderer = CpuRendererCreate(Options.ThreadCount, Options.TileSize);
+	if (!CpuRendererSetIsa(Renderer, Options.Isa))
+	{
+		fprintf(stderr, "this cpu does not support %s\n", KernelIsaNames[Options.Isa]);
+		CpuRendererDestroy(Renderer);
+		return 1;
+	}
+	CpuRendererSetSubdivision(Renderer, Options.bSubdivide);
+	CpuRendererSetInteriorChecks(Renderer, !Options.bNoInterior);
+	CpuRendererSetFastMath(Renderer, Options.bFastMath);
+
+	struct DeepView* DeepView = malloc(sizeof(struct DeepView));
+	CHECK_ALLOC(DeepView);
+	DeepViewFromCpuView(DeepView, View);
+
+	const char* WindowPos[4] = { Options.WindowPos[0], Options.WindowPos[1], Options.WindowPos[2], Options.WindowPos[3] };
+	if (!DeepViewSetWindow(DeepView, WindowPos))
+	{
+		fprintf(stderr, "unable to parse --window\n");
+		free(DeepView);
+		CpuRendererDestroy(Renderer);
+		return 1;
+	}
+
+	//a user formula only has float kernels
+	const enum PrecisionTier Tier = !Options.bAutoTier ? Options.Tier : Options.FormulaSource ? PRECISION_TIER_FLOAT : SelectPrecisionTier(DeepView);
+	if (!IsPrecisionTierSupported(Tier, View->Set))
+	{
+		fprintf(stderr, "%s does not support %s\n", PrecisionTierNames[Tier], FractalFormulas[View->Set].Name);
+		free(DeepView);
+		CpuRendererDestroy(Renderer);
+		return 1;
+	}
+
+	struct UserFormula Formula;
+	if (Options.FormulaSource)
+	{
+		if (Tier != PRECISION_TIER_FLOAT || Options.AnimationPath || Options.ExpMapSeconds > 0.0 || Options.ServePort != 0 || Options.CacheMegabytes != 0)
+		{
+			fprintf(stderr, "--formula needs float precision and does not go with --animate, --expmap, --serve or --cache\n");
+			free(DeepView);
+			CpuRendererDestroy(Renderer);
+			return 1;
+		}
+		if (!UserFormulaCompile(Options.FormulaSource, Options.Bailout, &Formula))
+		{
+			free(DeepView);
+			CpuRendererDestroy(Renderer);
+			return 1;
+		}
+		CpuRendererSetFormula(Renderer, &Formula);
+	}
+
+	struct Palette Palette;
+	PaletteInit(&Palette, Options.Palette, Options.PaletteCycle != 0.0 ? Options.PaletteCycle : (double)View->MaxIterations);
+	Palette.Offset = Options.PaletteOffset;
+
+	//every frame and tile picks its own precision tier
+	if (Options.AnimationPath != NULL)
+	{
+		free(DeepView);
+		const int Result = RenderAnimation(Renderer, &Options, &Palette);
+		CpuRendererDestroy(Renderer);
+		return Result;
+	}
+
+	if (Options.ExpMapSeconds > 0.0)
+	{
+		const int Result = RenderExpMap(Renderer, &Options, DeepView, &Palette);
+		free(DeepView);
+		CpuRendererDestroy(Renderer);
+		return Result;
+	}
+
+	if (Options.ServePort != 0)
+	{
+		free(DeepView);
+		const int Result = ServeTiles(Renderer, &Options, &Palette);
+		CpuRendererDestroy(Renderer);
+		return Result;
+	}
+
+	if (Options.bPyramid)
+	{
+		int Result = 1;
+		if (Tier == PRECISION_TIER_FLOAT)
+		{
+			struct CpuView FloatView;
+			CpuViewFromDeepView(&FloatView, DeepView);
+			Result = RenderPyramid(Renderer, &Options, &FloatView, &Palette);
+		}
+		else
+		{
+			fprintf(stderr, "--pyramid needs float precision\n");
+		}
+		free(DeepView);
+		CpuRendererDestroy(Renderer);
+		return Result;
+	}
+
+	//a poster never exists in memory as a whole, it goes straight to the file
+	if (Options.PosterMegabytes != 0)
+	{
+		int Result = 1;
+		if (Tier == PRECISION_TIER_FLOAT)
+		{
+			struct CpuView FloatView;
+			CpuViewFromDeepView(&FloatView, DeepView);
+			Result = RenderPoster(Renderer, &Options, &FloatView, &Palette);
+		}
+		else
+		{
+			fprintf(stderr, "--poster needs float precision\n");
+		}
+		free(DeepView);
+		CpuRendererDestroy(Renderer);
+		return Result;
+	}
+
+	struct IterationBuffer Buffer;
+	IterationBufferInit(&Buffer, View->Width, View->Height);
+	if (Options.bSmooth)
+		IterationBufferAddFractions(&Buffer);
+
+	const size_t RowPitch = (size_t)View->Width * 4;
+	uint8_t* Rgba = malloc(RowPitch * View->Height);
+	CHECK_ALLOC(Rgba);
+	bool bColored = false;
+
+	struct CpuRenderStats Stats;
+	struct DeepRenderStats DeepStats;
+	if (Options.Antialias.MaxSamples != 0 && Tier == PRECISION_TIER_FLOAT)
+	{
+		struct CpuView FloatView;
+		CpuViewFromDeepView(&FloatView, DeepView);
+
+		CpuRenderFrameAntialiased(Renderer, &FloatView, &Buffer, &Palette, &Options.Antialias, Rgba, RowPitch, &Stats);
+		fprintf(stderr, "antialiasing took up to %u samples of %.1f%% of the pixels\n", Options.Antialias.MaxSamples, Stats.SupersampledPixels * 100.0 / ((double)View->Width * View->Height));
+		bColored = true;
+	}
+	else if (Options.PanFrames != 0 && Tier == PRECISION_TIER_FLOAT)
+	{
+		struct CpuView FloatView;
+		CpuViewFromDeepView(&FloatView, DeepView);
+
+		struct PanBuffer Pan;
+		PanBufferInit(&Pan, View->Width, View->Height);
+		if (Options.bSmooth)
+			IterationBufferAddFractions(&Pan.Buffer);
+
+		const double PixelCount = (double)View->Width * View->Height;
+		double PanSeconds = 0.0;
+		uint64_t PanIterations = 0;
+		for (uint32_t Frame = 0; Frame <= Options.PanFrames; Frame++)
+		{
+			if (Frame != 0)
+			{
+				FloatView.WindowPos[2] += Options.PanStep[0] * FloatView.WindowPos[0] / View->Width;
+				FloatView.WindowPos[3] -= Options.PanStep[1] * FloatView.WindowPos[1] / View->Height;
+			}
+			CpuRenderFramePanned(Renderer, &FloatView, &Pan, &Stats);
+
+			if (Frame == 0)
+			{
+				fprintf(stderr, "first frame: %.3f s, %llu iterations\n", Stats.Seconds, (unsigned long long)Stats.TotalIterations);
+				continue;
+			}
+			PanSeconds += Stats.Seconds;
+			PanIterations += Stats.TotalIterations;
+			fprintf(stderr, "pan frame %u: %.1f%% of the pixels reused, %.3f s, %llu iterations\n", Frame, Stats.ReusedPixels * 100.0 / PixelCount, Stats.Seconds, (unsigned long long)Stats.TotalIterations);
+		}
+		fprintf(stderr, "%u pan frames: %.3f s, %llu iterations\n", Options.PanFrames, PanSeconds, (unsigned long long)PanIterations);
+
+		CopyIterations(&Buffer, &Pan.Buffer);
+		PanBufferRelease(&Pan);
+	}
+	else if (Options.ZoomFrames != 0 && Tier == PRECISION_TIER_FLOAT)
+	{
+		struct CpuView FloatView;
+		CpuViewFromDeepView(&FloatView, DeepView);
+
+		struct ZoomBuffer Zoom;
+		ZoomBufferInit(&Zoom, View->Width, View->Height);
+		if (Options.bSmooth)
+			IterationBufferAddFractions(&Zoom.Buffer);
+
+		CpuRenderFrameReprojected(Renderer, &FloatView, &Zoom, 0, &Stats);
+		fprintf(stderr, "first frame: %.3f s, %llu iterations\n", Stats.Seconds, (unsigned long long)Stats.TotalIterations);
+
+		const double PixelCount = (double)View->Width * View->Height;
+		const uint64_t Budget = (uint64_t)Options.ZoomBudget;
+		double WorstSeconds = 0.0;
+		for (uint32_t Frame = 1; Frame <= Options.ZoomFrames; Frame++)
+		{
+			FloatView.WindowPos[0] *= Options.ZoomFactor;
+			FloatView.WindowPos[1] *= Options.ZoomFactor;
+			CpuRenderFrameReprojected(Renderer, &FloatView, &Zoom, Budget, &Stats);
+			WorstSeconds = max(WorstSeconds, Stats.Seconds);
+			fprintf(stderr, "zoom frame %u: %.3f s, %llu iterations, %.1f%% of the pixels pending\n", Frame, Stats.Seconds, (unsigned long long)Stats.TotalIterations, Stats.PendingPixels * 100.0 / PixelCount);
+		}
+
+		uint32_t RefineFrames = 0;
+		bool bExact = Stats.PendingPixels == 0;
+		while (!bExact)
+		{
+			bExact = CpuRenderFrameReprojected(Renderer, &FloatView, &Zoom, Budget, &Stats);
+			WorstSeconds = max(WorstSeconds, Stats.Seconds);
+			RefineFrames++;
+		}
+		fprintf(stderr, "%u zoom frames, exact after %u more, slowest frame %.3f s\n", Options.ZoomFrames, RefineFrames, WorstSeconds);
+
+		CopyIterations(&Buffer, &Zoom.Buffer);
+		ZoomBufferRelease(&Zoom);
+	}
+	else if (Options.CacheMegabytes != 0 && Tier == PRECISION_TIER_FLOAT)
+	{
+		struct CpuView FloatView;
+		CpuViewFromDeepView(&FloatView, DeepView);
+
+		struct TileCache* Cache = TileCacheCreate((size_t)Options.CacheMegabytes << 20);
+		struct TileCacheStats CacheStats;
+
+		CpuRenderFrameCached(Renderer, Cache, &FloatView, &Buffer, &Stats);
+		fprintf(stderr, "snapped to window %.17g,%.17g,%.17g,%.17g\n", FloatView.WindowPos[0], FloatView.WindowPos[1], FloatView.WindowPos[2], FloatView.WindowPos[3]);
+		fprintf(stderr, "cold frame: %.3f s, %u tiles rendered\n", Stats.Seconds, Stats.TileCount);
+
+		CpuRenderFrameCached(Renderer, Cache, &FloatView, &Buffer, &Stats);
+		TileCacheGetStats(Cache, &CacheStats);
+		fprintf(stderr, "cached frame: %.3f s, %u tiles rendered\n", Stats.Seconds, Stats.TileCount);
+		fprintf(stderr, "tile cache: %llu hits, %llu misses, %llu evictions, %zu tiles in %.1f MB\n",
+			(unsigned long long)CacheStats.Hits,
+			(unsigned long long)CacheStats.Misses,
+			(unsigned long long)CacheStats.Evictions,
+			CacheStats.TileCount,
+			CacheStats.MemoryUsed / 1048576.0);
+
+		TileCacheDestroy(Cache);
+	}
+	else if (Options.bProgressive && Tier == PRECISION_TIER_FLOAT)
+	{
+		struct CpuView FloatView;
+		CpuViewFromDeepView(&FloatView, DeepView);
+
+		struct ProgressiveOutput Output = { &FloatView, Options.OutputPath };
+		CpuRenderFrameProgressive(Renderer, &FloatView, &Buffer, WriteProgressivePass, &Output, &Stats);
+	}
+	else if (Options.RefineFrom != 0 && Tier == PRECISION_TIER_FLOAT)
+	{
+		struct CpuView FloatView;
+		CpuViewFromDeepView(&FloatView, DeepView);
+
+		struct ResumeBuffer Resume;
+		ResumeBufferInit(&Resume, View->Width, View->Height);
+		if (Options.bSmooth)
+			IterationBufferAddFractions(&Resume.Buffer);
+
+		struct CpuView FirstView = FloatView;
+		FirstView.MaxIterations = Options.RefineFrom;
+		CpuRenderFrameResumable(Renderer, &FirstView, &Resume, &Stats);
+		fprintf(stderr, "first pass at %u iterations: %.3f s, %llu iterations\n", Options.RefineFrom, Stats.Seconds, (unsigned long long)Stats.TotalIterations);
+
+		CpuRenderFrameResumable(Renderer, &FloatView, &Resume, &Stats);
+		CopyIterations(&Buffer, &Resume.Buffer);
+		ResumeBufferRelease(&Resume);
+	}
+	else
+	{
+		if (Options.RefineFrom != 0)
+			fprintf(stderr, "--refine-from needs float precision, rendering in one pass\n");
+		if (Options.PanFrames != 0)
+			fprintf(stderr, "--pan needs float precision, rendering one frame\n");
+		if (Options.ZoomFrames != 0)
+			fprintf(stderr, "--zoom needs float precision, rendering one frame\n");
+		if (Options.bProgressive)
+			fprintf(stderr, "--progressive needs float precision, rendering in one pass\n");
+		if (Options.CacheMegabytes != 0)
+			fprintf(stderr, "--cache needs float precision, rendering without it\n");
+		if (Options.Antialias.MaxSamples != 0)
+			fprintf(stderr, "--antialias needs float precision, rendering one sample per pixel\n");
+		CpuRenderTierFrame(Renderer, DeepView, Tier, &Buffer, &Stats, &DeepStats);
+	}
+
+	if (Options.bFastMathCheck && Tier == PRECISION_TIER_FLOAT)
+	{
+		struct IterationBuffer Exact;
+		IterationBufferInit(&Exact, View->Width, View->Height);
+
+		struct CpuRenderStats ExactStats;
+		struct DeepRenderStats ExactDeepStats;
+		CpuRendererSetFastMath(Renderer, false);
+		CpuRenderTierFrame(Renderer, DeepView, Tier, &Exact, &ExactStats, &ExactDeepStats);
+		CpuRendererSetFastMath(Renderer, true);
+
+		const size_t PixelCount = (size_t)View->Width * View->Height;
+		size_t Differing = 0;
+		uint32_t WorstDifference = 0;
+		uint64_t DifferenceSum = 0;
+		for (size_t i = 0; i < PixelCount; i++)
+		{
+			const uint32_t Fast = Buffer.Iterations[i];
+			const uint32_t Reference = Exact.Iterations[i];
+			const uint32_t Difference = Fast > Reference ? Fast - Reference : Reference - Fast;
+			if (Difference == 0)
+				continue;
+
+			Differing++;
+			DifferenceSum += Difference;
+			WorstDifference = max(WorstDifference, Difference);
+		}
+		fprintf(stderr, "fast math: %zu of %zu pixels (%.3f%%) differ from the exact frame, by %.1f iterations on average and %u at most. exact frame %.3f s\n",
+			Differing,
+			PixelCount,
+			Differing * 100.0 / PixelCount,
+			Differing != 0 ? (double)DifferenceSum / Differing : 0.0,
+			WorstDifference,
+			ExactStats.Seconds);
+
+		IterationBufferRelease(&Exact);
+	}
+	else if (Options.bFastMathCheck)
+	{
+		fprintf(stderr, "--fast-math-check needs float precision, fast math only changes the float kernels\n");
+	}
+
+	const bool bIsasMatch = !Options.bIsaCheck || CheckIsas(Renderer, DeepView, Tier, Options.bProgressive, View->Width, View->Height);
+	free(DeepView);
+
+	if (Stats.Tier == PRECISION_TIER_PERTURBATION)
+	{
+		fprintf(stderr, "reference orbit: %u iterations at %u limbs in %.3f s, %llu rebases\n",
+			DeepStats.ReferenceLength,
+			DeepStats.LimbCount,
+			DeepStats.ReferenceSeconds,
+			(unsigned long long)DeepStats.Rebases);
+	}
+
+	if (Stats.Steals != 0)
+		fprintf(stderr, "%u task ranges stolen by threads that ran dry\n", Stats.Steals);
+
+	if (Stats.FilledPixels != 0)
+		fprintf(stderr, "subdivision filled %.1f%% of the pixels\n", Stats.FilledPixels * 100.0 / ((double)View->Width * View->Height));
+
+	if (Stats.MirroredPixels != 0)
+		fprintf(stderr, "symmetry mirrored %.1f%% of the pixels\n", Stats.MirroredPixels * 100.0 / ((double)View->Width * View->Height));
+
+	//an antialiased frame comes out coloured already
+	if (!bColored && (Options.bPalette || Options.Antialias.MaxSamples != 0))
+	{
+		const double ColorStartTime = GetTime();
+		ColorizePalette(&Palette, &Buffer, Rgba, RowPitch);
+		fprintf(stderr, "%s palette applied in %.2f ms\n", PaletteTypeNames[Options.Palette], (GetTime() - ColorStartTime) * 1e3);
+	}
+	else if (!bColored)
+	{
+		ColorizeIterations(View, &Buffer, Rgba, RowPitch);
+	}
+
+	if (Options.bMinimap && View->Type == FRACTAL_TYPE_BASE)
+		DrawMinimap(Renderer, View, Rgba, RowPitch);
+
+	fprintf(stderr, "%s %s %ux%u: %.3f s, %u tiles on %u threads (%s, %s), %.1f Miter/s\n",
+		Options.FormulaSource ? Options.FormulaSource : FractalFormulas[View->Set].Name,
+		View->Type == FRACTAL_TYPE_BASE ? "base" : "julia",
+		View->Width,
+		View->Height,
+		Stats.Seconds,
+		Stats.TileCount,
+		Stats.ThreadCount,
+		KernelIsaNames[Stats.Isa],
+		PrecisionTierNames[Stats.Tier],
+		Stats.TotalIterations / Stats.Seconds * 1e-6);
+
+	int Result = bIsasMatch ? 0 : 1;
+	if (!WritePpm(Options.OutputPath, Rgba, View->Width, View->Height, RowPitch))
+	{
+		fprintf(stderr, "unable to write %s\n", Options.OutputPath);
+		Result = 1;
+	}
+
+	free(Rgba);
+	IterationBufferRelease(&Buffer);
+	CpuRendererDestroy(Renderer);
+	return Result;
+}
@@ -0,0 +1,459 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "imageio.h"
+#include "platform.h"
+
+bool WritePpm(const char* Path, const uint8_t* Rgba, uint32_t Width, uint32_t Height, size_t RowPitch)
+{
+	FILE* File = fopen(Path, "wb");
+	if (File == NULL)
+		return false;
+
+	fprintf(File, "P6\n%u %u\n255\n", Width, Height);
+
+	uint8_t* Row = malloc((size_t)Width * 3);
+	CHECK_ALLOC(Row);
+
+	bool bOk = true;
+	for (uint32_t y = 0; y < Height && bOk; y++)
+	{
+		const uint8_t* In = Rgba + y * RowPitch;
+		for (uint32_t x = 0; x < Width; x++)
+		{
+			Row[x * 3 + 0] = In[x * 4 + 0];
+			Row[x * 3 + 1] = In[x * 4 + 1];
+			Row[x * 3 + 2] = In[x * 4 + 2];
+		}
+		bOk = fwrite(Row, 3, Width, File) == Width;
+	}
+
+	free(Row);
+	return fclose(File) == 0 && bOk;
+}
+
+//deflate caps a stored block at this many bytes
+#define PNG_STORED_BLOCK_SIZE 65535
+
+struct ImageWriter
+{
+	FILE* File;				//NULL when writing to Memory
+	uint8_t* Memory;
+	size_t MemorySize;
+	size_t MemoryCapacity;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t RowsWritten;
+	bool bPng;
+	bool bOk;
+	uint8_t* Row;			//one output row, led by its png filter byte
+	uint8_t* Block;			//stored block being filled
+	uint32_t BlockSize;
+	uint32_t Adler[2];		//adler-32 of the zlib stream so far
+	bool bStreamStarted;	//the zlib header has gone out
+};
+
+//slicing by 4: table n advances the crc of a byte by n more zero bytes
+static uint32_t Crc32Table[4][256];
+
+static void InitCrc32Table(void)
+{
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t Crc = i;
+		for (int Bit = 0; Bit < 8; Bit++)
+		{
+			Crc = (Crc & 1) ? 0xEDB88320u ^ (Crc >> 1) : Crc >> 1;
+		}
+		Crc32Table[0][i] = Crc;
+	}
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		for (int Table = 1; Table < 4; Table++)
+		{
+			Crc32Table[Table][i] = Crc32Table[0][Crc32Table[Table - 1][i] & 0xFF] ^ (Crc32Table[Table - 1][i] >> 8);
+		}
+	}
+}
+
+static uint32_t UpdateCrc32(uint32_t Crc, const uint8_t* restrict Data, size_t Size)
+{
+	size_t i = 0;
+	for (; i + 4 <= Size; i += 4)
+	{
+		Crc ^= (uint32_t)Data[i] | ((uint32_t)Data[i + 1] << 8) | ((uint32_t)Data[i + 2] << 16) | ((uint32_t)Data[i + 3] << 24);
+		Crc = Crc32Table[3][Crc & 0xFF] ^ Crc32Table[2][(Crc >> 8) & 0xFF] ^ Crc32Table[1][(Crc >> 16) & 0xFF] ^ Crc32Table[0][Crc >> 24];
+	}
+	for (; i < Size; i++)
+	{
+		Crc = Crc32Table[0][(Crc ^ Data[i]) & 0xFF] ^ (Crc >> 8);
+	}
+	return Crc;
+}
+
+static bool WriteOutput(struct ImageWriter* Writer, const void* Data, size_t Size)
+{
+	//empty chunks such as IEND come with no data at all
+	if (Size == 0)
+		return true;
+
+	if (Writer->File)
+		return fwrite(Data, 1, Size, Writer->File) == Size;
+
+	if (Writer->MemorySize + Size > Writer->MemoryCapacity)
+	{
+		Writer->MemoryCapacity = max(Writer->MemoryCapacity * 2, Writer->MemorySize + Size);
+		Writer->Memory = realloc(Writer->Memory, Writer->MemoryCapacity);
+		CHECK_ALLOC(Writer->Memory);
+	}
+	memcpy(Writer->Memory + Writer->MemorySize, Data, Size);
+	Writer->MemorySize += Size;
+	return true;
+}
+
+static void PutBigEndian32(uint8_t* restrict Out, uint32_t Value)
+{
+	Out[0] = (uint8_t)(Value >> 24);
+	Out[1] = (uint8_t)(Value >> 16);
+	Out[2] = (uint8_t)(Value >> 8);
+	Out[3] = (uint8_t)Value;
+}
+
+//one png chunk, Prefix and Data back to back make up its contents
+static void WritePngChunk(struct ImageWriter* Writer, const char Type[4], const uint8_t* Prefix, size_t PrefixSize, const uint8_t* Data, size_t DataSize)
+{
+	uint8_t Header[8];
+	PutBigEndian32(Header, (uint32_t)(PrefixSize + DataSize));
+	memcpy(Header + 4, Type, 4);
+
+	uint32_t Crc = UpdateCrc32(0xFFFFFFFFu, Header + 4, 4);
+	Crc = UpdateCrc32(Crc, Prefix, PrefixSize);
+	Crc = UpdateCrc32(Crc, Data, DataSize);
+	uint8_t Footer[4];
+	PutBigEndian32(Footer, Crc ^ 0xFFFFFFFFu);
+
+	Writer->bOk = Writer->bOk
+		&& WriteOutput(Writer, Header, 8)
+		&& WriteOutput(Writer, Prefix, PrefixSize)
+		&& WriteOutput(Writer, Data, DataSize)
+		&& WriteOutput(Writer, Footer, 4);
+}
+
+//each stored block goes out as an idat chunk of its own, the last one also
+//carries the end of the zlib stream
+static void FlushPngBlock(struct ImageWriter* Writer, bool bFinal)
+{
+	uint8_t Prefix[7];
+	size_t PrefixSize = 0;
+	if (!Writer->bStreamStarted)
+	{
+		//zlib header: deflate, 32k window, no dictionary, fastest
+		Prefix[PrefixSize++] = 0x78;
+		Prefix[PrefixSize++] = 0x01;
+		Writer->bStreamStarted = true;
+	}
+	Prefix[PrefixSize++] = bFinal ? 1 : 0;
+	Prefix[PrefixSize++] = (uint8_t)Writer->BlockSize;
+	Prefix[PrefixSize++] = (uint8_t)(Writer->BlockSize >> 8);
+	Prefix[PrefixSize++] = (uint8_t)~Writer->BlockSize;
+	Prefix[PrefixSize++] = (uint8_t)(~Writer->BlockSize >> 8);
+
+	if (!bFinal)
+	{
+		WritePngChunk(Writer, "IDAT", Prefix, PrefixSize, Writer->Block, Writer->BlockSize);
+	}
+	else
+	{
+		PutBigEndian32(Writer->Block + Writer->BlockSize, (Writer->Adler[1] << 16) | Writer->Adler[0]);
+		WritePngChunk(Writer, "IDAT", Prefix, PrefixSize, Writer->Block, Writer->BlockSize + 4);
+	}
+	Writer->BlockSize = 0;
+}
+
+static void WritePngBytes(struct ImageWriter* Writer, const uint8_t* restrict Data, size_t Size)
+{
+	//adler-32, reduced every 5552 bytes, the most b can take without overflowing
+	uint32_t a = Writer->Adler[0];
+	uint32_t b = Writer->Adler[1];
+	while (Size != 0)
+	{
+		const size_t Count = min(Size, (size_t)(PNG_STORED_BLOCK_SIZE - Writer->BlockSize));
+		for (size_t First = 0; First < Count; First += 5552)
+		{
+			const size_t Last = min(First + 5552, Count);
+			for (size_t i = First; i < Last; i++)
+			{
+				a += Data[i];
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+		}
+
+		memcpy(Writer->Block + Writer->BlockSize, Data, Count);
+		Writer->BlockSize += (uint32_t)Count;
+		Data += Count;
+		Size -= Count;
+
+		if (Writer->BlockSize == PNG_STORED_BLOCK_SIZE)
+		{
+			Writer->Adler[0] = a;
+			Writer->Adler[1] = b;
+			FlushPngBlock(Writer, false);
+		}
+	}
+	Writer->Adler[0] = a;
+	Writer->Adler[1] = b;
+}
+
+static struct ImageWriter* CreateWriter(FILE* File, uint32_t Width, uint32_t Height, bool bPng)
+{
+	struct ImageWriter* Writer = calloc(1, sizeof(struct ImageWriter));
+	CHECK_ALLOC(Writer);
+	Writer->File = File;
+	Writer->Width = Width;
+	Writer->Height = Height;
+	Writer->bPng = bPng;
+	Writer->bOk = true;
+
+	Writer->Row = malloc((size_t)Width * 3 + 1);
+	CHECK_ALLOC(Writer->Row);
+
+	if (File == NULL)
+	{
+		//the whole file, bar the chunk headers
+		Writer->MemoryCapacity = ((size_t)Width * 3 + 1) * Height + 256;
+		Writer->Memory = malloc(Writer->MemoryCapacity);
+		CHECK_ALLOC(Writer->Memory);
+	}
+
+	if (!bPng)
+	{
+		fprintf(File, "P6\n%u %u\n255\n", Width, Height);
+		return Writer;
+	}
+
+	InitCrc32Table();
+	Writer->Block = malloc(PNG_STORED_BLOCK_SIZE + 4);
+	CHECK_ALLOC(Writer->Block);
+	Writer->Adler[0] = 1;
+	Writer->Adler[1] = 0;
+
+	static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	Writer->bOk = WriteOutput(Writer, Signature, 8);
+
+	//8 bit rgb, deflate, adaptive filtering (every row uses filter 0), no interlace
+	uint8_t Header[13];
+	PutBigEndian32(Header, Width);
+	PutBigEndian32(Header + 4, Height);
+	Header[8] = 8;
+	Header[9] = 2;
+	Header[10] = 0;
+	Header[11] = 0;
+	Header[12] = 0;
+	WritePngChunk(Writer, "IHDR", Header, sizeof(Header), NULL, 0);
+	return Writer;
+}
+
+struct ImageWriter* ImageWriterOpen(const char* Path, uint32_t Width, uint32_t Height)
+{
+	FILE* File = fopen(Path, "wb");
+	if (File == NULL)
+		return NULL;
+
+	const char* Extension = strrchr(Path, '.');
+	const bool bPng = Extension != NULL && (strcmp(Extension, ".png") == 0 || strcmp(Extension, ".PNG") == 0);
+	return CreateWriter(File, Width, Height, bPng);
+}
+
+struct ImageWriter* ImageWriterOpenMemory(uint32_t Width, uint32_t Height)
+{
+	return CreateWriter(NULL, Width, Height, true);
+}
+
+bool ImageWriterWriteRows(struct ImageWriter* Writer, const uint8_t* Rgba, uint32_t RowCount, size_t RowPitch)
+{
+	CHECK_TRUE(Writer->RowsWritten + RowCount <= Writer->Height);
+
+	for (uint32_t y = 0; y < RowCount && Writer->bOk; y++)
+	{
+		const uint8_t* In = Rgba + y * RowPitch;
+		uint8_t* Out = Writer->Row + 1;
+		for (uint32_t x = 0; x < Writer->Width; x++)
+		{
+			Out[x * 3 + 0] = In[x * 4 + 0];
+			Out[x * 3 + 1] = In[x * 4 + 1];
+			Out[x * 3 + 2] = In[x * 4 + 2];
+		}
+
+		if (Writer->bPng)
+		{
+			Writer->Row[0] = 0;
+			WritePngBytes(Writer, Writer->Row, (size_t)Writer->Width * 3 + 1);
+		}
+		else
+		{
+			Writer->bOk = WriteOutput(Writer, Out, (size_t)Writer->Width * 3);
+		}
+		Writer->RowsWritten++;
+	}
+
+	return Writer->bOk;
+}
+
+static bool FinishWriter(struct ImageWriter* Writer)
+{
+	bool bOk = Writer->bOk && Writer->RowsWritten == Writer->Height;
+	if (Writer->bPng && bOk)
+	{
+		FlushPngBlock(Writer, true);
+		WritePngChunk(Writer, "IEND", NULL, 0, NULL, 0);
+		bOk = Writer->bOk;
+	}
+
+	free(Writer->Row);
+	free(Writer->Block);
+	return bOk;
+}
+
+bool ImageWriterClose(struct ImageWriter* Writer)
+{
+	bool bOk = FinishWriter(Writer);
+	bOk = fclose(Writer->File) == 0 && bOk;
+	free(Writer);
+	return bOk;
+}
+
+uint8_t* ImageWriterCloseMemory(struct ImageWriter* Writer, size_t* restrict Size)
+{
+	const bool bOk = FinishWriter(Writer);
+	uint8_t* Memory = Writer->Memory;
+	*Size = Writer->MemorySize;
+	if (!bOk)
+	{
+		free(Memory);
+		Memory = NULL;
+		*Size = 0;
+	}
+	free(Writer);
+	return Memory;
+}
+
+static uint32_t GetBigEndian32(const uint8_t* restrict In)
+{
+	return ((uint32_t)In[0] << 24) | ((uint32_t)In[1] << 16) | ((uint32_t)In[2] << 8) | In[3];
+}
+
+bool ReadStoredPng(const char* Path, uint8_t* Rgba, uint32_t Width, uint32_t Height, size_t RowPitch)
+{
+	FILE* File = fopen(Path, "rb");
+	if (File == NULL)
+		return false;
+
+	fseek(File, 0, SEEK_END);
+	const long FileSize = ftell(File);
+	fseek(File, 0, SEEK_SET);
+	if (FileSize < 8)
+	{
+		fclose(File);
+		return false;
+	}
+
+	uint8_t* Data = malloc((size_t)FileSize);
+	CHECK_ALLOC(Data);
+	const bool bRead = fread(Data, 1, (size_t)FileSize, File) == (size_t)FileSize;
+	fclose(File);
+
+	//the idat chunks back to back are the zlib stream
+	const size_t RowSize = (size_t)Width * 3 + 1;
+	uint8_t* Stream = malloc((size_t)FileSize);
+	CHECK_ALLOC(Stream);
+	size_t StreamSize = 0;
+	bool bOk = bRead && memcmp(Data, "\x89PNG\r\n\x1A\n", 8) == 0;
+	size_t Offset = 8;
+	while (bOk && Offset + 12 <= (size_t)FileSize)
+	{
+		const uint32_t Length = GetBigEndian32(Data + Offset);
+		const uint8_t* Type = Data + Offset + 4;
+		const uint8_t* Contents = Data + Offset + 8;
+		if (Length > (size_t)FileSize - Offset - 12)
+		{
+			bOk = false;
+			break;
+		}
+
+		if (memcmp(Type, "IHDR", 4) == 0)
+		{
+			bOk = Length == 13 && GetBigEndian32(Contents) == Width && GetBigEndian32(Contents + 4) == Height
+				&& Contents[8] == 8 && Contents[9] == 2 && Contents[12] == 0;
+		}
+		else if (memcmp(Type, "IDAT", 4) == 0)
+		{
+			memcpy(Stream + StreamSize, Contents, Length);
+			StreamSize += Length;
+		}
+		Offset += (size_t)Length + 12;
+	}
+
+	//zlib header, then stored blocks only
+	size_t In = 2;
+	size_t Out = 0;
+	const size_t ImageSize = RowSize * Height;
+	uint8_t* Row = malloc(RowSize);
+	CHECK_ALLOC(Row);
+	bool bFinal = false;
+	while (bOk && !bFinal && In + 5 <= StreamSize)
+	{
+		bFinal = (Stream[In] & 1) != 0;
+		const uint32_t Length = Stream[In + 1] | ((uint32_t)Stream[In + 2] << 8);
+		const uint32_t Complement = Stream[In + 3] | ((uint32_t)Stream[In + 4] << 8);
+		In += 5;
+		if ((Stream[In - 5] & 6) != 0 || (Length ^ 0xFFFF) != Complement || In + Length > StreamSize || Out + Length > ImageSize)
+		{
+			bOk = false;
+			break;
+		}
+
+		for (uint32_t i = 0; i < Length; i++)
+		{
+			const size_t Position = Out % RowSize;
+			Row[Position] = Stream[In + i];
+			if (Position == RowSize - 1)
+			{
+				const size_t y = Out / RowSize;
+				bOk = bOk && Row[0] == 0;
+				for (uint32_t x = 0; x < Width; x++)
+				{
+					uint8_t* Pixel = Rgba + y * RowPitch + x * 4;
+					Pixel[0] = Row[1 + x * 3 + 0];
+					Pixel[1] = Row[1 + x * 3 + 1];
+					Pixel[2] = Row[1 + x * 3 + 2];
+					Pixel[3] = 0;
+				}
+			}
+			Out++;
+		}
+		In += Length;
+	}
+
+	free(Row);
+	free(Stream);
+	free(Data);
+	return bOk && bFinal && Out == ImageSize;
+}
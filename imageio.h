@@ -0,0 +1,47 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+//writes an R8G8B8A8 image as a binary ppm (alpha is dropped)
+bool WritePpm(const char* Path, const uint8_t* Rgba, uint32_t Width, uint32_t Height, size_t RowPitch);
+
+//writes an image a few rows at a time, so only the rows in flight are ever in
+//memory. a .png path gets an uncompressed png (stored deflate blocks), anything
+//else a binary ppm. alpha is dropped
+struct ImageWriter;
+
+//NULL if the file cannot be created
+struct ImageWriter* ImageWriterOpen(const char* Path, uint32_t Width, uint32_t Height);
+
+//rows go out top to bottom, Height of them in total
+bool ImageWriterWriteRows(struct ImageWriter* Writer, const uint8_t* Rgba, uint32_t RowCount, size_t RowPitch);
+
+//false if any write failed or fewer than Height rows were written
+bool ImageWriterClose(struct ImageWriter* Writer);
+
+//the same png built up in memory instead of a file
+struct ImageWriter* ImageWriterOpenMemory(uint32_t Width, uint32_t Height);
+
+//the finished png, to be released with free, and its size. NULL if fewer than Height rows were written
+uint8_t* ImageWriterCloseMemory(struct ImageWriter* Writer, size_t* restrict Size);
+
+//reads back a png ImageWriter wrote, which has to be Width x Height. alpha is
+//set to 0. false for any other png, this is no general decoder
+bool ReadStoredPng(const char* Path, uint8_t* Rgba, uint32_t Width, uint32_t Height, size_t RowPitch);
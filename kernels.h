@@ -0,0 +1,249 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//internal interface between the tile scheduler and the escape time kernels
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "fractal.h"
+
+struct UserFormula;
+
+//orbit points closer than this many pixels to a saved point count as a cycle
+#define PERIOD_TOLERANCE_PIXELS 1e-4
+
+//how a pixel of a resumable row ended
+enum PixelStatus
+{
+	PIXEL_STATUS_ESCAPED,
+	PIXEL_STATUS_INTERIOR,	//shown to be inside, it counts as the limit whatever the limit
+	PIXEL_STATUS_CAPPED		//still bounded at the limit, its OrbitState carries on from there
+};
+
+//orbit of a capped pixel after the last iteration it ran
+struct OrbitState
+{
+	float Zx;
+	float Zy;
+	float PrevX;	//phoenix term of the mosaic kernel
+	float PrevY;
+	float SavedX;	//the point the cycle check compares with, so a resumed orbit keeps its schedule
+	float SavedY;
+	float SavedPrevX;
+	float SavedPrevY;
+};
+
+//an orbit starting at z = (x, y), which is also its first saved point
+static inline struct OrbitState StartOrbit(float x, float y)
+{
+	return (struct OrbitState){ x, y, 0.0f, 0.0f, x, y, 0.0f, 0.0f };
+}
+
+//the cycle check saves the orbit at every power of two iteration, this is the
+//first save after Iteration. 0 once the powers of two run out, which never matches
+static inline uint32_t GetNextSave(uint32_t Iteration)
+{
+	uint32_t NextSave = 1;
+	while (NextSave != 0 && NextSave <= Iteration)
+		NextSave *= 2;
+	return NextSave;
+}
+
+//one horizontal run of pixels. pixel i sits at
+//(OriginX + (FirstX + i * StrideX) * StepX, OriginY + Y * StepY) so the coordinate
+//of a pixel never depends on how the frame was cut into tiles. Columns, when
+//set, gives the grid column of each pixel instead, and Points, when set, gives
+//the coordinate of each pixel off any grid
+struct RowJob
+{
+	enum FractalSet Set;
+	enum FractalType Type;
+	uint32_t Limit;			//iteration cap after the per set multiplier
+	double OriginX;
+	double OriginY;
+	double StepX;
+	double StepY;
+	int64_t FirstX;
+	int64_t StrideX;		//1 for a contiguous run
+	const int64_t* Columns;	//NULL, or Count grid columns in place of FirstX + i * StrideX
+	const double* Points;	//NULL, or Count x, y pairs in place of the grid, StepX and StepY then only set the cycle tolerance
+	int64_t Y;
+	uint32_t Count;
+	double JuliaX;
+	double JuliaY;
+	bool bInteriorChecks;	//cardioid/bulb test and cycle detection, pixels found inside get Limit
+	bool bFastMath;			//mosaic spiral from the polynomials in formulas.h instead of libm
+
+	//NULL for a plain row, otherwise Count entries each. with FirstIteration 0 the
+	//row is iterated from scratch and both are filled in, with FirstIteration at
+	//the limit they were filled in at only the capped pixels are iterated further,
+	//interior pixels are moved to the new limit and escaped ones are left alone
+	uint8_t* Status;
+	struct OrbitState* Orbits;
+	uint32_t FirstIteration;
+
+	uint8_t* Fractions;		//NULL, or Count smooth iteration fractions, see GetSmoothFraction
+
+	const struct UserFormula* Formula;	//the bytecode kernels run this in place of Set
+};
+
+//writes Job->Count iteration counts and returns their sum
+typedef uint64_t (*RowKernel)(const struct RowJob* restrict Job, uint32_t* restrict Iterations);
+
+uint64_t ScalarRowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx2RowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx512RowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations);
+
+uint64_t ScalarBytecodeRowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx2BytecodeRowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx512BytecodeRowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations);
+
+//one row for ColorizePalette. the entry of pixel i is bits 24 and up of
+//((Iterations[i] << 8) + Fractions[i]) * Scale + Phase, wrapping at 2^64, and IndexMask
+struct PaletteRowJob
+{
+	const uint32_t* Colors;
+	uint32_t IndexMask;		//entries in Colors - 1, a power of two
+	uint64_t Scale;
+	uint64_t Phase;
+	const uint32_t* Iterations;
+	const uint8_t* Fractions;	//NULL, or Count smooth iteration fractions
+	uint32_t Count;
+};
+
+//writes Job->Count R8G8B8A8 colours, Rgba need not be aligned
+typedef void (*PaletteRowKernel)(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba);
+
+void ScalarPaletteRowKernel(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba);
+void Avx2PaletteRowKernel(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba);
+void Avx512PaletteRowKernel(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba);
+
+static inline uint32_t GetPaletteIndex(const struct PaletteRowJob* restrict Job, uint32_t i)
+{
+	const uint64_t Smooth = ((uint64_t)Job->Iterations[i] << 8) + (Job->Fractions ? Job->Fractions[i] : 0);
+	return (uint32_t)((Smooth * Job->Scale + Job->Phase) >> 24) & Job->IndexMask;
+}
+
+//RowJob for the double, double-double and quad-double kernels. pixel i sits at
+//Centre + ((FirstX + i) - HalfWidth) * Step, or at Centre + Offsets[i], the offset
+//from the centre is small enough that a double carries it exactly to well below a pixel
+struct MultiDoubleRowJob
+{
+	enum FractalSet Set;
+	enum FractalType Type;
+	uint32_t Limit;
+	double CentreX[4];		//quad-double, the other kernels read as many components as they have
+	double CentreY[4];
+	double StepX;
+	double StepY;
+	double HalfWidth;
+	double HalfHeight;
+	int64_t FirstX;
+	int64_t Y;
+	uint32_t Count;
+	const double* Offsets;	//NULL, or Count x, y pairs in place of the grid
+	double JuliaX;
+	double JuliaY;
+	bool bInteriorChecks;
+};
+
+typedef uint64_t (*MultiDoubleRowKernel)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+
+uint64_t ScalarDblRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx2DblRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx512DblRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t ScalarDdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx2DdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx512DdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t ScalarQdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx2QdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx512QdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+
+//Q4.60 fixed point, mandelbrot, tricorn and burning ship only
+uint64_t ScalarFixedRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx2FixedRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+uint64_t Avx512FixedRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations);
+
+static inline int64_t GetRowJobColumn(const struct RowJob* restrict Job, uint32_t i)
+{
+	return Job->Columns ? Job->Columns[i] : Job->FirstX + (int64_t)i * Job->StrideX;
+}
+
+static inline float GetRowJobX(const struct RowJob* restrict Job, uint32_t i)
+{
+	return (float)(Job->Points ? Job->Points[i * 2] : Job->OriginX + (double)GetRowJobColumn(Job, i) * Job->StepX);
+}
+
+static inline float GetRowJobY(const struct RowJob* restrict Job, uint32_t i)
+{
+	return (float)(Job->Points ? Job->Points[i * 2 + 1] : Job->OriginY + (double)Job->Y * Job->StepY);
+}
+
+//squared distance below which the brent cycle check of a view with these pixel steps fires
+static inline double PeriodTolerance(double StepX, double StepY)
+{
+	const double Tolerance = fmin(fabs(StepX), fabs(StepY)) * PERIOD_TOLERANCE_PIXELS;
+	return Tolerance * Tolerance;
+}
+
+//FractalFormulas[Set].Bailout and .Degree as constants, the kernels pass a constant Set
+static inline float GetFormulaBailout(enum FractalSet Set)
+{
+	switch (Set)
+	{
+#define FORMULA_BAILOUT(Enum, Suffix, Name, IterationMultiplier, Bailout, ...) case FRACTAL_SET_##Enum: return Bailout;
+	FRACTAL_FORMULAS(FORMULA_BAILOUT)
+#undef FORMULA_BAILOUT
+	default: return 4.0f;
+	}
+}
+
+static inline float GetFormulaDegree(enum FractalSet Set)
+{
+	switch (Set)
+	{
+#define FORMULA_DEGREE(Enum, Suffix, Name, IterationMultiplier, Bailout, Degree, ...) case FRACTAL_SET_##Enum: return Degree;
+	FRACTAL_FORMULAS(FORMULA_DEGREE)
+#undef FORMULA_DEGREE
+	default: return 2.0f;
+	}
+}
+
+//smooth iteration fraction of a pixel that escaped with z, in 1/256ths.
+//Iterations + Fraction / 256 runs on without steps between the bands
+static inline uint8_t GetSmoothFractionOf(float Bailout, float Degree, float Zx, float Zy)
+{
+	const float Fraction = 1.0f - log2f(logf(Zx * Zx + Zy * Zy) / logf(Bailout)) / log2f(Degree);
+	return (uint8_t)fminf(fmaxf(Fraction * 256.0f, 0.0f), 255.0f);
+}
+
+static inline uint8_t GetSmoothFraction(enum FractalSet Set, float Zx, float Zy)
+{
+	return GetSmoothFractionOf(GetFormulaBailout(Set), GetFormulaDegree(Set), Zx, Zy);
+}
+
+//closed form interior of the main cardioid and the period 2 bulb of the mandelbrot set
+static inline bool IsInMandelbrotBulbs(double x, double y)
+{
+	const double q = (x - 0.25) * (x - 0.25) + y * y;
+	if (q * (q + (x - 0.25)) < 0.25 * y * y)
+		return true;
+	return (x + 1.0) * (x + 1.0) + y * y < 0.0625;
+}
@@ -0,0 +1,373 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//8 pixels per iteration. escaped lanes are frozen with a blend so every lane
+//does exactly the float math of the scalar kernel, the loop exits once the
+//movemask of the active lanes is empty
+
+#include "kernels.h"
+#include "formulas.h"
+#include "platform.h"
+
+#ifdef PLATFORM_X64
+
+#include <immintrin.h>
+#include <math.h>
+
+#define AVX2_LANES 8
+
+//lanes past the end of a row start outside the bailout radius
+#define PAD_COORD 100.0f
+
+static FORCE_INLINE TARGET_AVX2 __m256 Avx2Abs(__m256 x)
+{
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+}
+
+//MosaicSpiral of the active lanes, left in libm so it matches the scalar path
+static TARGET_AVX2 __m256 Avx2MosaicSpiral(__m256 Zx, __m256 Zy, __m256 r, int ActiveMask)
+{
+	float X[AVX2_LANES];
+	float Y[AVX2_LANES];
+	float R[AVX2_LANES];
+	float Spiral[AVX2_LANES] = { 0 };
+
+	_mm256_storeu_ps(X, Zx);
+	_mm256_storeu_ps(Y, Zy);
+	_mm256_storeu_ps(R, r);
+
+	for (int i = 0; i < AVX2_LANES; i++)
+	{
+		if (ActiveMask & (1 << i))
+		{
+			Spiral[i] = MosaicSpiral(X[i], Y[i], R[i]);
+		}
+	}
+
+	return _mm256_loadu_ps(Spiral);
+}
+
+//lane ops for FORMULA_STEP
+#define F_T __m256
+#define F_SET(x) _mm256_set1_ps(x)
+#define F_ADD(a, b) _mm256_add_ps(a, b)
+#define F_SUB(a, b) _mm256_sub_ps(a, b)
+#define F_MUL(a, b) _mm256_mul_ps(a, b)
+#define F_DIV(a, b) _mm256_div_ps(a, b)
+#define F_MIN(a, b) _mm256_min_ps(a, b)
+#define F_MAX(a, b) _mm256_max_ps(a, b)
+#define F_ABS(x) Avx2Abs(x)
+#define F_LESS(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define F_SIGN(x) (x)	//blendv only looks at the sign bit
+#define F_SELECT(m, a, b) _mm256_blendv_ps(b, a, m)
+
+FORMULA_DEFINE_FAST_SPIRAL(Avx2MosaicSpiralFast, TARGET_AVX2)
+
+#define F_SPIRAL() (bFastMath ? Avx2MosaicSpiralFast(Zx, Zy, _mm256_sqrt_ps(Magnitude)) : Avx2MosaicSpiral(Zx, Zy, _mm256_sqrt_ps(Magnitude), ActiveMask))
+
+//Set is a constant at every call site, so each instantiation keeps only its own formula.
+//lanes caught in a cycle are moved outside the bailout radius and reported in *PeriodicLanes
+static FORCE_INLINE TARGET_AVX2 __m256i Avx2Iterate(const enum FractalSet Set, const bool bFastMath, __m256* restrict ZxState, __m256* restrict ZyState, __m256* restrict PrevXState, __m256* restrict PrevYState, __m256* restrict SavedXState, __m256* restrict SavedYState, __m256* restrict SavedPrevXState, __m256* restrict SavedPrevYState, const __m256 Cx, const __m256 Cy, const uint32_t FirstIteration, const uint32_t Limit, const __m256 Tolerance, int* restrict PeriodicLanes)
+{
+	const __m256 Bailout = _mm256_set1_ps(GetFormulaBailout(Set));
+
+	__m256 Zx = *ZxState;
+	__m256 Zy = *ZyState;
+	__m256 PrevX = *PrevXState;
+	__m256 PrevY = *PrevYState;
+	__m256i Count = _mm256_set1_epi32((int)FirstIteration);
+
+	//brent cycle detection, same schedule as ScalarIterate in kernels_scalar.c
+	__m256 SavedX = *SavedXState;
+	__m256 SavedY = *SavedYState;
+	__m256 SavedPrevX = *SavedPrevXState;
+	__m256 SavedPrevY = *SavedPrevYState;
+	uint32_t NextSave = GetNextSave(FirstIteration);
+
+	for (uint32_t iter = FirstIteration; iter < Limit; iter++)
+	{
+		const __m256 x2 = _mm256_mul_ps(Zx, Zx);
+		const __m256 y2 = _mm256_mul_ps(Zy, Zy);
+		const __m256 Magnitude = _mm256_add_ps(x2, y2);
+		const __m256 Active = _mm256_cmp_ps(Magnitude, Bailout, _CMP_LT_OQ);
+
+		const int ActiveMask = _mm256_movemask_ps(Active);
+		if (ActiveMask == 0)
+			break;
+
+		__m256 NewX;
+		__m256 NewY;
+
+		FORMULA_STEP(Set)
+
+		Zx = _mm256_blendv_ps(Zx, NewX, Active);
+		Zy = _mm256_blendv_ps(Zy, NewY, Active);
+		Count = _mm256_sub_epi32(Count, _mm256_castps_si256(Active));
+
+		const __m256 Dx = _mm256_sub_ps(Zx, SavedX);
+		const __m256 Dy = _mm256_sub_ps(Zy, SavedY);
+		__m256 Distance = _mm256_add_ps(_mm256_mul_ps(Dx, Dx), _mm256_mul_ps(Dy, Dy));
+		if (FORMULA_HAS_MEMORY(Set))
+		{
+			const __m256 Dpx = _mm256_sub_ps(PrevX, SavedPrevX);
+			const __m256 Dpy = _mm256_sub_ps(PrevY, SavedPrevY);
+			Distance = _mm256_add_ps(_mm256_add_ps(Distance, _mm256_mul_ps(Dpx, Dpx)), _mm256_mul_ps(Dpy, Dpy));
+		}
+
+		const __m256 Periodic = _mm256_and_ps(_mm256_cmp_ps(Distance, Tolerance, _CMP_LT_OQ), Active);
+		const int PeriodicMask = _mm256_movemask_ps(Periodic);
+		if (PeriodicMask != 0)
+		{
+			*PeriodicLanes |= PeriodicMask;
+			Zx = _mm256_blendv_ps(Zx, _mm256_set1_ps(PAD_COORD), Periodic);
+			Zy = _mm256_blendv_ps(Zy, _mm256_set1_ps(PAD_COORD), Periodic);
+		}
+
+		if (iter + 1 == NextSave)
+		{
+			SavedX = Zx;
+			SavedY = Zy;
+			SavedPrevX = PrevX;
+			SavedPrevY = PrevY;
+			NextSave *= 2;
+		}
+	}
+
+	*ZxState = Zx;
+	*ZyState = Zy;
+	*PrevXState = PrevX;
+	*PrevYState = PrevY;
+	*SavedXState = SavedX;
+	*SavedYState = SavedY;
+	*SavedPrevXState = SavedPrevX;
+	*SavedPrevYState = SavedPrevY;
+	return Count;
+}
+
+static FORCE_INLINE TARGET_AVX2 uint64_t Avx2Row(const struct RowJob* restrict Job, uint32_t* restrict Iterations, const enum FractalSet Set, const enum FractalType Type, const bool bFastMath)
+{
+	const __m256 JuliaX = _mm256_set1_ps((float)Job->JuliaX);
+	const __m256 JuliaY = _mm256_set1_ps((float)Job->JuliaY);
+	const __m256 Tolerance = _mm256_set1_ps(Job->bInteriorChecks ? (float)PeriodTolerance(Job->StepX, Job->StepY) : 0.0f);
+	const bool bBulbs = Job->bInteriorChecks && Set == FRACTAL_SET_MANDELBROT && Type == FRACTAL_TYPE_BASE;
+	const bool bResume = Job->Status != NULL && Job->FirstIteration != 0;
+	const uint32_t FirstIteration = bResume ? Job->FirstIteration : 0;
+	uint64_t Total = 0;
+
+	for (uint32_t i = 0; i < Job->Count; i += AVX2_LANES)
+	{
+		const uint32_t Lanes = min(AVX2_LANES, Job->Count - i);
+
+		//pixels inside the cardioid or bulb are not iterated at all, and a resumed
+		//row only iterates its capped pixels. the others start outside the bailout
+		int InteriorLanes = 0;
+		int SkippedLanes = 0;
+
+		float X[AVX2_LANES];
+		float Y[AVX2_LANES];
+		struct OrbitState Orbits[AVX2_LANES];
+		for (uint32_t Lane = 0; Lane < AVX2_LANES; Lane++)
+		{
+			X[Lane] = Lane < Lanes ? GetRowJobX(Job, i + Lane) : PAD_COORD;
+			Y[Lane] = Lane < Lanes ? GetRowJobY(Job, i + Lane) : PAD_COORD;
+			Orbits[Lane] = StartOrbit(X[Lane], Y[Lane]);
+
+			if (Lane >= Lanes)
+				continue;
+
+			if (bResume)
+			{
+				if (Job->Status[i + Lane] == PIXEL_STATUS_CAPPED)
+				{
+					Orbits[Lane] = Job->Orbits[i + Lane];
+					continue;
+				}
+
+				SkippedLanes |= 1 << Lane;
+				Orbits[Lane].Zx = PAD_COORD;
+				Orbits[Lane].Zy = PAD_COORD;
+			}
+			else if (bBulbs && IsInMandelbrotBulbs(X[Lane], Y[Lane]))
+			{
+				InteriorLanes |= 1 << Lane;
+				Orbits[Lane].Zx = PAD_COORD;
+				Orbits[Lane].Zy = PAD_COORD;
+			}
+		}
+
+		float ZxIn[AVX2_LANES];
+		float ZyIn[AVX2_LANES];
+		float PrevXIn[AVX2_LANES];
+		float PrevYIn[AVX2_LANES];
+		float SavedXIn[AVX2_LANES];
+		float SavedYIn[AVX2_LANES];
+		float SavedPrevXIn[AVX2_LANES];
+		float SavedPrevYIn[AVX2_LANES];
+		for (uint32_t Lane = 0; Lane < AVX2_LANES; Lane++)
+		{
+			ZxIn[Lane] = Orbits[Lane].Zx;
+			ZyIn[Lane] = Orbits[Lane].Zy;
+			PrevXIn[Lane] = Orbits[Lane].PrevX;
+			PrevYIn[Lane] = Orbits[Lane].PrevY;
+			SavedXIn[Lane] = Orbits[Lane].SavedX;
+			SavedYIn[Lane] = Orbits[Lane].SavedY;
+			SavedPrevXIn[Lane] = Orbits[Lane].SavedPrevX;
+			SavedPrevYIn[Lane] = Orbits[Lane].SavedPrevY;
+		}
+
+		const __m256 Px = _mm256_loadu_ps(X);
+		const __m256 Py = _mm256_loadu_ps(Y);
+		__m256 Zx = _mm256_loadu_ps(ZxIn);
+		__m256 Zy = _mm256_loadu_ps(ZyIn);
+		__m256 PrevX = _mm256_loadu_ps(PrevXIn);
+		__m256 PrevY = _mm256_loadu_ps(PrevYIn);
+		__m256 SavedX = _mm256_loadu_ps(SavedXIn);
+		__m256 SavedY = _mm256_loadu_ps(SavedYIn);
+		__m256 SavedPrevX = _mm256_loadu_ps(SavedPrevXIn);
+		__m256 SavedPrevY = _mm256_loadu_ps(SavedPrevYIn);
+
+		__m256i Count;
+		if (Type == FRACTAL_TYPE_BASE)
+			Count = Avx2Iterate(Set, bFastMath, &Zx, &Zy, &PrevX, &PrevY, &SavedX, &SavedY, &SavedPrevX, &SavedPrevY, Px, Py, FirstIteration, Job->Limit, Tolerance, &InteriorLanes);
+		else
+			Count = Avx2Iterate(Set, bFastMath, &Zx, &Zy, &PrevX, &PrevY, &SavedX, &SavedY, &SavedPrevX, &SavedPrevY, JuliaX, JuliaY, FirstIteration, Job->Limit, Tolerance, &InteriorLanes);
+
+		uint32_t Out[AVX2_LANES];
+		_mm256_storeu_si256((__m256i*)Out, Count);
+		for (uint32_t Lane = 0; Lane < Lanes; Lane++)
+		{
+			if (SkippedLanes & (1 << Lane))
+			{
+				if (Job->Status[i + Lane] == PIXEL_STATUS_INTERIOR)
+					Iterations[i + Lane] = Job->Limit;
+				continue;
+			}
+
+			//bulb lanes never ran and cycles count up to where they were caught
+			const bool bInterior = (InteriorLanes & (1 << Lane)) != 0;
+			Total += Out[Lane] - FirstIteration;
+			if (bInterior)
+				Out[Lane] = Job->Limit;
+
+			if (Job->Status)
+				Job->Status[i + Lane] = bInterior ? PIXEL_STATUS_INTERIOR : Out[Lane] == Job->Limit ? PIXEL_STATUS_CAPPED : PIXEL_STATUS_ESCAPED;
+
+			Iterations[i + Lane] = Out[Lane];
+		}
+
+		if (Job->Status || Job->Fractions)
+		{
+			_mm256_storeu_ps(ZxIn, Zx);
+			_mm256_storeu_ps(ZyIn, Zy);
+			_mm256_storeu_ps(PrevXIn, PrevX);
+			_mm256_storeu_ps(PrevYIn, PrevY);
+			_mm256_storeu_ps(SavedXIn, SavedX);
+			_mm256_storeu_ps(SavedYIn, SavedY);
+			_mm256_storeu_ps(SavedPrevXIn, SavedPrevX);
+			_mm256_storeu_ps(SavedPrevYIn, SavedPrevY);
+			for (uint32_t Lane = 0; Lane < Lanes; Lane++)
+			{
+				if (SkippedLanes & (1 << Lane))
+					continue;
+
+				if (Job->Status)
+					Job->Orbits[i + Lane] = (struct OrbitState){ ZxIn[Lane], ZyIn[Lane], PrevXIn[Lane], PrevYIn[Lane], SavedXIn[Lane], SavedYIn[Lane], SavedPrevXIn[Lane], SavedPrevYIn[Lane] };
+				if (Job->Fractions)
+					Job->Fractions[i + Lane] = Out[Lane] < Job->Limit ? GetSmoothFraction(Set, ZxIn[Lane], ZyIn[Lane]) : 0;
+			}
+		}
+	}
+
+	return Total;
+}
+
+#define AVX2_ROWS(Enum, Suffix, ...) \
+	static TARGET_AVX2 uint64_t Avx2Row##Suffix(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return Avx2Row(Job, Iterations, FRACTAL_SET_##Enum, FRACTAL_TYPE_BASE, false); } \
+	static TARGET_AVX2 uint64_t Avx2Row##Suffix##Julia(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return Avx2Row(Job, Iterations, FRACTAL_SET_##Enum, FRACTAL_TYPE_JULIA, false); }
+FRACTAL_FORMULAS(AVX2_ROWS)
+#undef AVX2_ROWS
+
+static const RowKernel Avx2RowKernels[FRACTAL_SET_COUNT][FRACTAL_TYPE_COUNT] = {
+#define AVX2_ROW_ENTRY(Enum, Suffix, ...) { Avx2Row##Suffix##Julia, Avx2Row##Suffix },
+	FRACTAL_FORMULAS(AVX2_ROW_ENTRY)
+#undef AVX2_ROW_ENTRY
+};
+
+static TARGET_AVX2 uint64_t Avx2RowMosaicFast(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return Avx2Row(Job, Iterations, FRACTAL_SET_MOSAIC, FRACTAL_TYPE_BASE, true); }
+static TARGET_AVX2 uint64_t Avx2RowMosaicFastJulia(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return Avx2Row(Job, Iterations, FRACTAL_SET_MOSAIC, FRACTAL_TYPE_JULIA, true); }
+
+uint64_t Avx2RowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	if (Job->bFastMath && Job->Set == FRACTAL_SET_MOSAIC)
+		return Job->Type == FRACTAL_TYPE_BASE ? Avx2RowMosaicFast(Job, Iterations) : Avx2RowMosaicFastJulia(Job, Iterations);
+	return Avx2RowKernels[Job->Set][Job->Type](Job, Iterations);
+}
+
+//the index only needs bits 24 to 55 of the product, so both factors split into
+//32 bit halves: the low halves multiply to 64 bits, the cross terms land on bit 32
+//so only their low 32 bits count, and the high halves meet past bit 64
+static FORCE_INLINE TARGET_AVX2 __m256i Avx2PaletteIndex(__m256i Smooth, __m256i SmoothHigh, __m256i ScaleLow, __m256i ScaleHigh, __m256i Phase, __m256i IndexMask)
+{
+	const __m256i Even = _mm256_add_epi64(_mm256_mul_epu32(Smooth, ScaleLow), Phase);
+	const __m256i Odd = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(Smooth, 32), ScaleLow), Phase);
+	const __m256i Low = _mm256_blend_epi32(_mm256_srli_epi64(Even, 24), _mm256_slli_epi64(Odd, 8), 0xAA);
+	const __m256i Cross = _mm256_add_epi32(_mm256_mullo_epi32(SmoothHigh, ScaleLow), _mm256_mullo_epi32(Smooth, ScaleHigh));
+	return _mm256_and_si256(_mm256_add_epi32(Low, _mm256_slli_epi32(Cross, 8)), IndexMask);
+}
+
+static TARGET_AVX2 void Avx2PaletteRow(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba)
+{
+	const __m256i ScaleLow = _mm256_set1_epi32((int)(uint32_t)Job->Scale);
+	const __m256i ScaleHigh = _mm256_set1_epi32((int)(uint32_t)(Job->Scale >> 32));
+	const __m256i Phase = _mm256_set1_epi64x((long long)Job->Phase);
+	const __m256i IndexMask = _mm256_set1_epi32((int)Job->IndexMask);
+	const int* Colors = (const int*)Job->Colors;
+
+	uint32_t i = 0;
+	for (; i + AVX2_LANES <= Job->Count; i += AVX2_LANES)
+	{
+		const __m256i Iterations = _mm256_loadu_si256((const __m256i*)(Job->Iterations + i));
+		__m256i Smooth = _mm256_slli_epi32(Iterations, 8);
+		if (Job->Fractions)
+			Smooth = _mm256_or_si256(Smooth, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(Job->Fractions + i))));
+		const __m256i Index = Avx2PaletteIndex(Smooth, _mm256_srli_epi32(Iterations, 24), ScaleLow, ScaleHigh, Phase, IndexMask);
+		_mm256_storeu_si256((__m256i*)(Rgba + i * 4), _mm256_i32gather_epi32(Colors, Index, 4));
+	}
+
+	struct PaletteRowJob Tail = *Job;
+	Tail.Iterations += i;
+	Tail.Fractions = Job->Fractions ? Job->Fractions + i : NULL;
+	Tail.Count -= i;
+	ScalarPaletteRowKernel(&Tail, Rgba + i * 4);
+}
+
+void Avx2PaletteRowKernel(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba)
+{
+	Avx2PaletteRow(Job, Rgba);
+}
+
+#else
+
+uint64_t Avx2RowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	return ScalarRowKernel(Job, Iterations);
+}
+
+void Avx2PaletteRowKernel(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba)
+{
+	ScalarPaletteRowKernel(Job, Rgba);
+}
+
+#endif
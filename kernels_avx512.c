@@ -0,0 +1,360 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//16 pixels per iteration, same structure as kernels_avx2.c but the escape
+//state lives in a mask register so the updates are masked moves
+
+#include "kernels.h"
+#include "formulas.h"
+#include "platform.h"
+
+#ifdef PLATFORM_X64
+
+#include <immintrin.h>
+#include <math.h>
+
+#define AVX512_LANES 16
+
+//lanes past the end of a row start outside the bailout radius
+#define PAD_COORD 100.0f
+
+static TARGET_AVX512 __m512 Avx512MosaicSpiral(__m512 Zx, __m512 Zy, __m512 r, __mmask16 Active)
+{
+	float X[AVX512_LANES];
+	float Y[AVX512_LANES];
+	float R[AVX512_LANES];
+	float Spiral[AVX512_LANES] = { 0 };
+
+	_mm512_storeu_ps(X, Zx);
+	_mm512_storeu_ps(Y, Zy);
+	_mm512_storeu_ps(R, r);
+
+	for (int i = 0; i < AVX512_LANES; i++)
+	{
+		if (Active & (1 << i))
+		{
+			Spiral[i] = MosaicSpiral(X[i], Y[i], R[i]);
+		}
+	}
+
+	return _mm512_loadu_ps(Spiral);
+}
+
+//lane ops for FORMULA_STEP
+#define F_T __m512
+#define F_SET(x) _mm512_set1_ps(x)
+#define F_ADD(a, b) _mm512_add_ps(a, b)
+#define F_SUB(a, b) _mm512_sub_ps(a, b)
+#define F_MUL(a, b) _mm512_mul_ps(a, b)
+#define F_DIV(a, b) _mm512_div_ps(a, b)
+#define F_MIN(a, b) _mm512_min_ps(a, b)
+#define F_MAX(a, b) _mm512_max_ps(a, b)
+#define F_ABS(x) _mm512_abs_ps(x)
+#define F_LESS(a, b) _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
+#define F_SIGN(x) _mm512_test_epi32_mask(_mm512_castps_si512(x), _mm512_set1_epi32(INT32_MIN))
+#define F_SELECT(m, a, b) _mm512_mask_mov_ps(b, m, a)
+
+FORMULA_DEFINE_FAST_SPIRAL(Avx512MosaicSpiralFast, TARGET_AVX512)
+
+#define F_SPIRAL() (bFastMath ? Avx512MosaicSpiralFast(Zx, Zy, _mm512_sqrt_ps(Magnitude)) : Avx512MosaicSpiral(Zx, Zy, _mm512_sqrt_ps(Magnitude), Active))
+
+static FORCE_INLINE TARGET_AVX512 __m512i Avx512Iterate(const enum FractalSet Set, const bool bFastMath, __m512* restrict ZxState, __m512* restrict ZyState, __m512* restrict PrevXState, __m512* restrict PrevYState, __m512* restrict SavedXState, __m512* restrict SavedYState, __m512* restrict SavedPrevXState, __m512* restrict SavedPrevYState, const __m512 Cx, const __m512 Cy, const uint32_t FirstIteration, const uint32_t Limit, const __m512 Tolerance, __mmask16* restrict PeriodicLanes)
+{
+	const __m512 Bailout = _mm512_set1_ps(GetFormulaBailout(Set));
+	const __m512i One = _mm512_set1_epi32(1);
+
+	__m512 Zx = *ZxState;
+	__m512 Zy = *ZyState;
+	__m512 PrevX = *PrevXState;
+	__m512 PrevY = *PrevYState;
+	__m512i Count = _mm512_set1_epi32((int)FirstIteration);
+
+	__m512 SavedX = *SavedXState;
+	__m512 SavedY = *SavedYState;
+	__m512 SavedPrevX = *SavedPrevXState;
+	__m512 SavedPrevY = *SavedPrevYState;
+	uint32_t NextSave = GetNextSave(FirstIteration);
+
+	for (uint32_t iter = FirstIteration; iter < Limit; iter++)
+	{
+		const __m512 x2 = _mm512_mul_ps(Zx, Zx);
+		const __m512 y2 = _mm512_mul_ps(Zy, Zy);
+		const __m512 Magnitude = _mm512_add_ps(x2, y2);
+		const __mmask16 Active = _mm512_cmp_ps_mask(Magnitude, Bailout, _CMP_LT_OQ);
+
+		if (Active == 0)
+			break;
+
+		__m512 NewX;
+		__m512 NewY;
+
+		FORMULA_STEP(Set)
+
+		Zx = _mm512_mask_mov_ps(Zx, Active, NewX);
+		Zy = _mm512_mask_mov_ps(Zy, Active, NewY);
+		Count = _mm512_mask_add_epi32(Count, Active, Count, One);
+
+		const __m512 Dx = _mm512_sub_ps(Zx, SavedX);
+		const __m512 Dy = _mm512_sub_ps(Zy, SavedY);
+		__m512 Distance = _mm512_add_ps(_mm512_mul_ps(Dx, Dx), _mm512_mul_ps(Dy, Dy));
+		if (FORMULA_HAS_MEMORY(Set))
+		{
+			const __m512 Dpx = _mm512_sub_ps(PrevX, SavedPrevX);
+			const __m512 Dpy = _mm512_sub_ps(PrevY, SavedPrevY);
+			Distance = _mm512_add_ps(_mm512_add_ps(Distance, _mm512_mul_ps(Dpx, Dpx)), _mm512_mul_ps(Dpy, Dpy));
+		}
+
+		const __mmask16 Periodic = _mm512_mask_cmp_ps_mask(Active, Distance, Tolerance, _CMP_LT_OQ);
+		if (Periodic != 0)
+		{
+			*PeriodicLanes |= Periodic;
+			Zx = _mm512_mask_mov_ps(Zx, Periodic, _mm512_set1_ps(PAD_COORD));
+			Zy = _mm512_mask_mov_ps(Zy, Periodic, _mm512_set1_ps(PAD_COORD));
+		}
+
+		if (iter + 1 == NextSave)
+		{
+			SavedX = Zx;
+			SavedY = Zy;
+			SavedPrevX = PrevX;
+			SavedPrevY = PrevY;
+			NextSave *= 2;
+		}
+	}
+
+	*ZxState = Zx;
+	*ZyState = Zy;
+	*PrevXState = PrevX;
+	*PrevYState = PrevY;
+	*SavedXState = SavedX;
+	*SavedYState = SavedY;
+	*SavedPrevXState = SavedPrevX;
+	*SavedPrevYState = SavedPrevY;
+	return Count;
+}
+
+static FORCE_INLINE TARGET_AVX512 uint64_t Avx512Row(const struct RowJob* restrict Job, uint32_t* restrict Iterations, const enum FractalSet Set, const enum FractalType Type, const bool bFastMath)
+{
+	const __m512 JuliaX = _mm512_set1_ps((float)Job->JuliaX);
+	const __m512 JuliaY = _mm512_set1_ps((float)Job->JuliaY);
+	const __m512 Tolerance = _mm512_set1_ps(Job->bInteriorChecks ? (float)PeriodTolerance(Job->StepX, Job->StepY) : 0.0f);
+	const bool bBulbs = Job->bInteriorChecks && Set == FRACTAL_SET_MANDELBROT && Type == FRACTAL_TYPE_BASE;
+	const bool bResume = Job->Status != NULL && Job->FirstIteration != 0;
+	const uint32_t FirstIteration = bResume ? Job->FirstIteration : 0;
+	uint64_t Total = 0;
+
+	for (uint32_t i = 0; i < Job->Count; i += AVX512_LANES)
+	{
+		const uint32_t Lanes = min(AVX512_LANES, Job->Count - i);
+
+		//pixels inside the cardioid or bulb are not iterated at all, and a resumed
+		//row only iterates its capped pixels. the others start outside the bailout
+		__mmask16 InteriorLanes = 0;
+		__mmask16 SkippedLanes = 0;
+
+		float X[AVX512_LANES];
+		float Y[AVX512_LANES];
+		struct OrbitState Orbits[AVX512_LANES];
+		for (uint32_t Lane = 0; Lane < AVX512_LANES; Lane++)
+		{
+			X[Lane] = Lane < Lanes ? GetRowJobX(Job, i + Lane) : PAD_COORD;
+			Y[Lane] = Lane < Lanes ? GetRowJobY(Job, i + Lane) : PAD_COORD;
+			Orbits[Lane] = StartOrbit(X[Lane], Y[Lane]);
+
+			if (Lane >= Lanes)
+				continue;
+
+			if (bResume)
+			{
+				if (Job->Status[i + Lane] == PIXEL_STATUS_CAPPED)
+				{
+					Orbits[Lane] = Job->Orbits[i + Lane];
+					continue;
+				}
+
+				SkippedLanes |= 1 << Lane;
+				Orbits[Lane].Zx = PAD_COORD;
+				Orbits[Lane].Zy = PAD_COORD;
+			}
+			else if (bBulbs && IsInMandelbrotBulbs(X[Lane], Y[Lane]))
+			{
+				InteriorLanes |= 1 << Lane;
+				Orbits[Lane].Zx = PAD_COORD;
+				Orbits[Lane].Zy = PAD_COORD;
+			}
+		}
+
+		float ZxIn[AVX512_LANES];
+		float ZyIn[AVX512_LANES];
+		float PrevXIn[AVX512_LANES];
+		float PrevYIn[AVX512_LANES];
+		float SavedXIn[AVX512_LANES];
+		float SavedYIn[AVX512_LANES];
+		float SavedPrevXIn[AVX512_LANES];
+		float SavedPrevYIn[AVX512_LANES];
+		for (uint32_t Lane = 0; Lane < AVX512_LANES; Lane++)
+		{
+			ZxIn[Lane] = Orbits[Lane].Zx;
+			ZyIn[Lane] = Orbits[Lane].Zy;
+			PrevXIn[Lane] = Orbits[Lane].PrevX;
+			PrevYIn[Lane] = Orbits[Lane].PrevY;
+			SavedXIn[Lane] = Orbits[Lane].SavedX;
+			SavedYIn[Lane] = Orbits[Lane].SavedY;
+			SavedPrevXIn[Lane] = Orbits[Lane].SavedPrevX;
+			SavedPrevYIn[Lane] = Orbits[Lane].SavedPrevY;
+		}
+
+		const __m512 Px = _mm512_loadu_ps(X);
+		const __m512 Py = _mm512_loadu_ps(Y);
+		__m512 Zx = _mm512_loadu_ps(ZxIn);
+		__m512 Zy = _mm512_loadu_ps(ZyIn);
+		__m512 PrevX = _mm512_loadu_ps(PrevXIn);
+		__m512 PrevY = _mm512_loadu_ps(PrevYIn);
+		__m512 SavedX = _mm512_loadu_ps(SavedXIn);
+		__m512 SavedY = _mm512_loadu_ps(SavedYIn);
+		__m512 SavedPrevX = _mm512_loadu_ps(SavedPrevXIn);
+		__m512 SavedPrevY = _mm512_loadu_ps(SavedPrevYIn);
+
+		__m512i Count;
+		if (Type == FRACTAL_TYPE_BASE)
+			Count = Avx512Iterate(Set, bFastMath, &Zx, &Zy, &PrevX, &PrevY, &SavedX, &SavedY, &SavedPrevX, &SavedPrevY, Px, Py, FirstIteration, Job->Limit, Tolerance, &InteriorLanes);
+		else
+			Count = Avx512Iterate(Set, bFastMath, &Zx, &Zy, &PrevX, &PrevY, &SavedX, &SavedY, &SavedPrevX, &SavedPrevY, JuliaX, JuliaY, FirstIteration, Job->Limit, Tolerance, &InteriorLanes);
+
+		uint32_t Out[AVX512_LANES];
+		_mm512_storeu_si512(Out, Count);
+		for (uint32_t Lane = 0; Lane < Lanes; Lane++)
+		{
+			if (SkippedLanes & (1 << Lane))
+			{
+				if (Job->Status[i + Lane] == PIXEL_STATUS_INTERIOR)
+					Iterations[i + Lane] = Job->Limit;
+				continue;
+			}
+
+			//bulb lanes never ran and cycles count up to where they were caught
+			const bool bInterior = (InteriorLanes & (1 << Lane)) != 0;
+			Total += Out[Lane] - FirstIteration;
+			if (bInterior)
+				Out[Lane] = Job->Limit;
+
+			if (Job->Status)
+				Job->Status[i + Lane] = bInterior ? PIXEL_STATUS_INTERIOR : Out[Lane] == Job->Limit ? PIXEL_STATUS_CAPPED : PIXEL_STATUS_ESCAPED;
+
+			Iterations[i + Lane] = Out[Lane];
+		}
+
+		if (Job->Status || Job->Fractions)
+		{
+			_mm512_storeu_ps(ZxIn, Zx);
+			_mm512_storeu_ps(ZyIn, Zy);
+			_mm512_storeu_ps(PrevXIn, PrevX);
+			_mm512_storeu_ps(PrevYIn, PrevY);
+			_mm512_storeu_ps(SavedXIn, SavedX);
+			_mm512_storeu_ps(SavedYIn, SavedY);
+			_mm512_storeu_ps(SavedPrevXIn, SavedPrevX);
+			_mm512_storeu_ps(SavedPrevYIn, SavedPrevY);
+			for (uint32_t Lane = 0; Lane < Lanes; Lane++)
+			{
+				if (SkippedLanes & (1 << Lane))
+					continue;
+
+				if (Job->Status)
+					Job->Orbits[i + Lane] = (struct OrbitState){ ZxIn[Lane], ZyIn[Lane], PrevXIn[Lane], PrevYIn[Lane], SavedXIn[Lane], SavedYIn[Lane], SavedPrevXIn[Lane], SavedPrevYIn[Lane] };
+				if (Job->Fractions)
+					Job->Fractions[i + Lane] = Out[Lane] < Job->Limit ? GetSmoothFraction(Set, ZxIn[Lane], ZyIn[Lane]) : 0;
+			}
+		}
+	}
+
+	return Total;
+}
+
+#define AVX512_ROWS(Enum, Suffix, ...) \
+	static TARGET_AVX512 uint64_t Avx512Row##Suffix(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return Avx512Row(Job, Iterations, FRACTAL_SET_##Enum, FRACTAL_TYPE_BASE, false); } \
+	static TARGET_AVX512 uint64_t Avx512Row##Suffix##Julia(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return Avx512Row(Job, Iterations, FRACTAL_SET_##Enum, FRACTAL_TYPE_JULIA, false); }
+FRACTAL_FORMULAS(AVX512_ROWS)
+#undef AVX512_ROWS
+
+static const RowKernel Avx512RowKernels[FRACTAL_SET_COUNT][FRACTAL_TYPE_COUNT] = {
+#define AVX512_ROW_ENTRY(Enum, Suffix, ...) { Avx512Row##Suffix##Julia, Avx512Row##Suffix },
+	FRACTAL_FORMULAS(AVX512_ROW_ENTRY)
+#undef AVX512_ROW_ENTRY
+};
+
+static TARGET_AVX512 uint64_t Avx512RowMosaicFast(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return Avx512Row(Job, Iterations, FRACTAL_SET_MOSAIC, FRACTAL_TYPE_BASE, true); }
+static TARGET_AVX512 uint64_t Avx512RowMosaicFastJulia(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return Avx512Row(Job, Iterations, FRACTAL_SET_MOSAIC, FRACTAL_TYPE_JULIA, true); }
+
+uint64_t Avx512RowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	if (Job->bFastMath && Job->Set == FRACTAL_SET_MOSAIC)
+		return Job->Type == FRACTAL_TYPE_BASE ? Avx512RowMosaicFast(Job, Iterations) : Avx512RowMosaicFastJulia(Job, Iterations);
+	return Avx512RowKernels[Job->Set][Job->Type](Job, Iterations);
+}
+
+//Avx2PaletteIndex with 16 lanes
+static FORCE_INLINE TARGET_AVX512 __m512i Avx512PaletteIndex(__m512i Smooth, __m512i SmoothHigh, __m512i ScaleLow, __m512i ScaleHigh, __m512i Phase, __m512i IndexMask)
+{
+	const __m512i Even = _mm512_add_epi64(_mm512_mul_epu32(Smooth, ScaleLow), Phase);
+	const __m512i Odd = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(Smooth, 32), ScaleLow), Phase);
+	const __m512i Low = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(Even, 24), _mm512_slli_epi64(Odd, 8));
+	const __m512i Cross = _mm512_add_epi32(_mm512_mullo_epi32(SmoothHigh, ScaleLow), _mm512_mullo_epi32(Smooth, ScaleHigh));
+	return _mm512_and_si512(_mm512_add_epi32(Low, _mm512_slli_epi32(Cross, 8)), IndexMask);
+}
+
+static TARGET_AVX512 void Avx512PaletteRow(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba)
+{
+	const __m512i ScaleLow = _mm512_set1_epi32((int)(uint32_t)Job->Scale);
+	const __m512i ScaleHigh = _mm512_set1_epi32((int)(uint32_t)(Job->Scale >> 32));
+	const __m512i Phase = _mm512_set1_epi64((long long)Job->Phase);
+	const __m512i IndexMask = _mm512_set1_epi32((int)Job->IndexMask);
+	const int* Colors = (const int*)Job->Colors;
+
+	uint32_t i = 0;
+	for (; i + AVX512_LANES <= Job->Count; i += AVX512_LANES)
+	{
+		const __m512i Iterations = _mm512_loadu_si512(Job->Iterations + i);
+		__m512i Smooth = _mm512_slli_epi32(Iterations, 8);
+		if (Job->Fractions)
+			Smooth = _mm512_or_si512(Smooth, _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(Job->Fractions + i))));
+		const __m512i Index = Avx512PaletteIndex(Smooth, _mm512_srli_epi32(Iterations, 24), ScaleLow, ScaleHigh, Phase, IndexMask);
+		_mm512_storeu_si512(Rgba + i * 4, _mm512_i32gather_epi32(Index, Colors, 4));
+	}
+
+	struct PaletteRowJob Tail = *Job;
+	Tail.Iterations += i;
+	Tail.Fractions = Job->Fractions ? Job->Fractions + i : NULL;
+	Tail.Count -= i;
+	ScalarPaletteRowKernel(&Tail, Rgba + i * 4);
+}
+
+void Avx512PaletteRowKernel(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba)
+{
+	Avx512PaletteRow(Job, Rgba);
+}
+
+#else
+
+uint64_t Avx512RowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	return ScalarRowKernel(Job, Iterations);
+}
+
+void Avx512PaletteRowKernel(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba)
+{
+	ScalarPaletteRowKernel(Job, Rgba);
+}
+
+#endif
@@ -0,0 +1,341 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+//runs a UserFormula over a batch of BYTECODE_LANES pixels at a time. each op of
+//the bytecode is one loop over the batch, which the compiler vectorises for the
+//isa of the instantiation at the bottom of the file. a lane whose pixel is done
+//is refilled with the next pixel of the row once enough of them are, so a few
+//slow pixels do not keep a whole batch idle. the orbit, the cycle detection and
+//what is written out follow ScalarRow, and with contraction off (platform.h) the
+//ops round like the builtin kernels, so the same formula gives the same image
+
+#include <string.h>
+#include <math.h>
+
+#include "kernels.h"
+#include "userformula.h"
+#include "platform.h"
+
+//a multiple of every vector width, and wide enough that decoding an op costs
+//little next to running it over the batch
+#define BYTECODE_LANES 64
+
+//finished lanes are left idle until this many of them can be refilled at once
+#define BYTECODE_REFILL_LANES (BYTECODE_LANES / 4)
+
+//idle lanes sit outside the bailout radius, away from denormals
+#define PAD_COORD 100.0f
+
+struct BytecodeRegisters
+{
+	float Re[USER_FORMULA_MAX_REGISTERS][BYTECODE_LANES];
+	float Im[USER_FORMULA_MAX_REGISTERS][BYTECODE_LANES];
+};
+
+struct BytecodeLanes
+{
+	int32_t Pixel[BYTECODE_LANES];		//index in the row, -1 for an idle lane
+	int32_t Live[BYTECODE_LANES];		//LANE_MASK, still iterating
+	int32_t Periodic[BYTECODE_LANES];	//LANE_MASK, caught in a cycle
+	uint32_t Iteration[BYTECODE_LANES];
+	uint32_t NextSave[BYTECODE_LANES];
+	float SavedX[BYTECODE_LANES];
+	float SavedY[BYTECODE_LANES];
+	float SavedPrevX[BYTECODE_LANES];
+	float SavedPrevY[BYTECODE_LANES];
+	uint32_t Occupied;
+	uint32_t LiveCount;
+	uint32_t NextPixel;
+};
+
+//one op over every lane. Dst is never one of the operands, the registers come in
+//as restrict parameters so the loop vectorises without a check for overlap
+static FORCE_INLINE void RunOp(const enum FormulaOp Op, float* restrict DstRe, float* restrict DstIm, const float* restrict ARe, const float* restrict AIm, const float* restrict BRe, const float* restrict BIm)
+{
+	for (uint32_t Lane = 0; Lane < BYTECODE_LANES; Lane++)
+	{
+		float Re;
+		float Im;
+		ApplyFormulaOp(Op, ARe[Lane], AIm[Lane], BRe[Lane], BIm[Lane], &Re, &Im);
+		DstRe[Lane] = Re;
+		DstIm[Lane] = Im;
+	}
+}
+
+#define BYTECODE_OP_CASE(Op) \
+	case Op: \
+		RunOp(Op, Registers->Re[Instruction->Dst], Registers->Im[Instruction->Dst], Registers->Re[Instruction->A], Registers->Im[Instruction->A], Registers->Re[Instruction->B], Registers->Im[Instruction->B]); \
+		break;
+
+static FORCE_INLINE void RunInstructions(const struct FormulaInstruction* restrict Instructions, uint32_t Count, struct BytecodeRegisters* restrict Registers)
+{
+	for (uint32_t i = 0; i < Count; i++)
+	{
+		const struct FormulaInstruction* Instruction = &Instructions[i];
+		switch (Instruction->Op)
+		{
+		case FORMULA_OP_CONST:
+			for (uint32_t Lane = 0; Lane < BYTECODE_LANES; Lane++)
+			{
+				Registers->Re[Instruction->Dst][Lane] = Instruction->Re;
+				Registers->Im[Instruction->Dst][Lane] = Instruction->Im;
+			}
+			break;
+		BYTECODE_OP_CASE(FORMULA_OP_ADD)
+		BYTECODE_OP_CASE(FORMULA_OP_SUB)
+		BYTECODE_OP_CASE(FORMULA_OP_MUL)
+		BYTECODE_OP_CASE(FORMULA_OP_MULR)
+		BYTECODE_OP_CASE(FORMULA_OP_DIV)
+		BYTECODE_OP_CASE(FORMULA_OP_DIVR)
+		BYTECODE_OP_CASE(FORMULA_OP_SQR)
+		BYTECODE_OP_CASE(FORMULA_OP_NEG)
+		BYTECODE_OP_CASE(FORMULA_OP_CONJ)
+		BYTECODE_OP_CASE(FORMULA_OP_ABS)
+		BYTECODE_OP_CASE(FORMULA_OP_RE)
+		BYTECODE_OP_CASE(FORMULA_OP_IM)
+		BYTECODE_OP_CASE(FORMULA_OP_NORM)
+		BYTECODE_OP_CASE(FORMULA_OP_MOD)
+		BYTECODE_OP_CASE(FORMULA_OP_ARG)
+		BYTECODE_OP_CASE(FORMULA_OP_EXP)
+		BYTECODE_OP_CASE(FORMULA_OP_LOG)
+		BYTECODE_OP_CASE(FORMULA_OP_SIN)
+		BYTECODE_OP_CASE(FORMULA_OP_COS)
+		BYTECODE_OP_CASE(FORMULA_OP_COPY)
+		default:
+			break;
+		}
+	}
+}
+
+#undef BYTECODE_OP_CASE
+
+//all ones where x holds, the lane state below keeps its flags this way
+#define LANE_MASK(x) (-(int32_t)(x))
+
+//a where Mask is all ones and b where it is 0. done on the bits, since a ternary
+//becomes a branch the compiler threads the other tests on the same mask through,
+//and a loop with branches in it does not vectorise
+static FORCE_INLINE float SelectLane(int32_t Mask, float a, float b)
+{
+	uint32_t aBits;
+	uint32_t bBits;
+	memcpy(&aBits, &a, sizeof(float));
+	memcpy(&bBits, &b, sizeof(float));
+	const uint32_t Bits = (aBits & (uint32_t)Mask) | (bBits & ~(uint32_t)Mask);
+	float Result;
+	memcpy(&Result, &Bits, sizeof(float));
+	return Result;
+}
+
+//moves the live lanes on to the z the step left in NewX and NewY, then drops the
+//ones that closed a cycle, escaped or reached the limit. returns how many carry on
+static FORCE_INLINE uint32_t AdvanceLanes(float* restrict Zx, float* restrict Zy, float* restrict PrevX, float* restrict PrevY, const float* restrict NewX, const float* restrict NewY, struct BytecodeLanes* restrict Lanes, float Bailout, float Tolerance, uint32_t Limit, const bool bPrevious)
+{
+	uint32_t LiveCount = 0;
+	for (uint32_t Lane = 0; Lane < BYTECODE_LANES; Lane++)
+	{
+		const int32_t Live = Lanes->Live[Lane];
+		const float OldX = Zx[Lane];
+		const float OldY = Zy[Lane];
+		const float x = SelectLane(Live, NewX[Lane], OldX);
+		const float y = SelectLane(Live, NewY[Lane], OldY);
+		const float px = bPrevious ? SelectLane(Live, OldX, PrevX[Lane]) : PrevX[Lane];
+		const float py = bPrevious ? SelectLane(Live, OldY, PrevY[Lane]) : PrevY[Lane];
+		const uint32_t Iteration = Lanes->Iteration[Lane] - (uint32_t)Live;
+
+		const float SavedX = Lanes->SavedX[Lane];
+		const float SavedY = Lanes->SavedY[Lane];
+		const float SavedPrevX = Lanes->SavedPrevX[Lane];
+		const float SavedPrevY = Lanes->SavedPrevY[Lane];
+		const float Dx = x - SavedX;
+		const float Dy = y - SavedY;
+		float Distance = Dx * Dx + Dy * Dy;
+		if (bPrevious)
+		{
+			const float Dpx = px - SavedPrevX;
+			const float Dpy = py - SavedPrevY;
+			Distance = Distance + Dpx * Dpx + Dpy * Dpy;
+		}
+		const int32_t Periodic = Live & LANE_MASK(Distance < Tolerance);
+
+		const uint32_t NextSave = Lanes->NextSave[Lane];
+		const int32_t Save = Live & LANE_MASK(Iteration == NextSave);
+		Lanes->SavedX[Lane] = SelectLane(Save, x, SavedX);
+		Lanes->SavedY[Lane] = SelectLane(Save, y, SavedY);
+		Lanes->SavedPrevX[Lane] = SelectLane(Save, px, SavedPrevX);
+		Lanes->SavedPrevY[Lane] = SelectLane(Save, py, SavedPrevY);
+		Lanes->NextSave[Lane] = NextSave + (NextSave & (uint32_t)Save);
+
+		const int32_t Next = Live & ~Periodic & LANE_MASK(x * x + y * y < Bailout) & LANE_MASK(Iteration < Limit);
+		Zx[Lane] = SelectLane(Periodic, PAD_COORD, x);
+		Zy[Lane] = SelectLane(Periodic, PAD_COORD, y);
+		PrevX[Lane] = px;
+		PrevY[Lane] = py;
+		Lanes->Iteration[Lane] = Iteration;
+		Lanes->Periodic[Lane] |= Periodic;
+		Lanes->Live[Lane] = Next;
+		LiveCount += (uint32_t)Next & 1;
+	}
+	return LiveCount;
+}
+
+//writes out the lanes that are done and starts the next pixels of the row in
+//their place, then reruns the setup part for the new values of c
+static uint64_t RefillLanes(const struct RowJob* restrict Job, uint32_t* restrict Iterations, struct BytecodeRegisters* restrict Registers, struct BytecodeLanes* restrict Lanes)
+{
+	const struct UserFormula* Formula = Job->Formula;
+	const bool bResume = Job->Status != NULL && Job->FirstIteration != 0;
+	const uint32_t FirstIteration = bResume ? Job->FirstIteration : 0;
+	float* restrict Zx = Registers->Re[USER_FORMULA_REGISTER_Z];
+	float* restrict Zy = Registers->Im[USER_FORMULA_REGISTER_Z];
+	float* restrict Cx = Registers->Re[USER_FORMULA_REGISTER_C];
+	float* restrict Cy = Registers->Im[USER_FORMULA_REGISTER_C];
+	float* restrict PrevX = Registers->Re[USER_FORMULA_REGISTER_P];
+	float* restrict PrevY = Registers->Im[USER_FORMULA_REGISTER_P];
+
+	uint64_t Total = 0;
+	do
+	{
+		for (uint32_t Lane = 0; Lane < BYTECODE_LANES; Lane++)
+		{
+			if (Lanes->Live[Lane])
+				continue;
+
+			const int32_t i = Lanes->Pixel[Lane];
+			if (i >= 0)
+			{
+				const bool bInterior = Lanes->Periodic[Lane] != 0;
+				const uint32_t iter = bInterior ? Job->Limit : Lanes->Iteration[Lane];
+				if (Job->Status)
+				{
+					Job->Status[i] = bInterior ? PIXEL_STATUS_INTERIOR : iter == Job->Limit ? PIXEL_STATUS_CAPPED : PIXEL_STATUS_ESCAPED;
+					Job->Orbits[i] = (struct OrbitState){ Zx[Lane], Zy[Lane], PrevX[Lane], PrevY[Lane], Lanes->SavedX[Lane], Lanes->SavedY[Lane], Lanes->SavedPrevX[Lane], Lanes->SavedPrevY[Lane] };
+				}
+
+				Iterations[i] = iter;
+				if (Job->Fractions)
+					Job->Fractions[i] = iter < Job->Limit ? GetSmoothFractionOf(Formula->Bailout, Formula->Degree, Zx[Lane], Zy[Lane]) : 0;
+				Total += Lanes->Iteration[Lane] - FirstIteration;
+				Lanes->Occupied--;
+			}
+
+			//a resumed row only iterates its capped pixels
+			while (bResume && Lanes->NextPixel < Job->Count && Job->Status[Lanes->NextPixel] != PIXEL_STATUS_CAPPED)
+			{
+				if (Job->Status[Lanes->NextPixel] == PIXEL_STATUS_INTERIOR)
+					Iterations[Lanes->NextPixel] = Job->Limit;
+				Lanes->NextPixel++;
+			}
+
+			Lanes->Pixel[Lane] = -1;
+			Zx[Lane] = Zy[Lane] = Cx[Lane] = Cy[Lane] = PAD_COORD;
+			PrevX[Lane] = PrevY[Lane] = 0.0f;
+			if (Lanes->NextPixel == Job->Count)
+				continue;
+
+			const uint32_t Next = Lanes->NextPixel++;
+			const float x = GetRowJobX(Job, Next);
+			const float y = GetRowJobY(Job, Next);
+			struct OrbitState Orbit = bResume ? Job->Orbits[Next] : StartOrbit(x, y);
+			Zx[Lane] = Orbit.Zx;
+			Zy[Lane] = Orbit.Zy;
+			PrevX[Lane] = Orbit.PrevX;
+			PrevY[Lane] = Orbit.PrevY;
+			Cx[Lane] = Job->Type == FRACTAL_TYPE_BASE ? x : (float)Job->JuliaX;
+			Cy[Lane] = Job->Type == FRACTAL_TYPE_BASE ? y : (float)Job->JuliaY;
+
+			Lanes->Pixel[Lane] = (int32_t)Next;
+			Lanes->Periodic[Lane] = 0;
+			Lanes->Iteration[Lane] = FirstIteration;
+			Lanes->NextSave[Lane] = GetNextSave(FirstIteration);
+			Lanes->SavedX[Lane] = Orbit.SavedX;
+			Lanes->SavedY[Lane] = Orbit.SavedY;
+			Lanes->SavedPrevX[Lane] = Orbit.SavedPrevX;
+			Lanes->SavedPrevY[Lane] = Orbit.SavedPrevY;
+			Lanes->Live[Lane] = LANE_MASK(FirstIteration < Job->Limit && Orbit.Zx * Orbit.Zx + Orbit.Zy * Orbit.Zy < Formula->Bailout);
+			Lanes->LiveCount += Lanes->Live[Lane] != 0;
+			Lanes->Occupied++;
+		}
+	} while (Lanes->LiveCount == 0 && Lanes->NextPixel < Job->Count);
+
+	RunInstructions(Formula->Instructions, Formula->SetupCount, Registers);
+	return Total;
+}
+
+static FORCE_INLINE uint64_t BytecodeRow(const struct RowJob* restrict Job, uint32_t* restrict Iterations, const bool bPrevious)
+{
+	const struct UserFormula* Formula = Job->Formula;
+	const struct FormulaInstruction* Step = Formula->Instructions + Formula->SetupCount;
+	const float Tolerance = Job->bInteriorChecks ? (float)PeriodTolerance(Job->StepX, Job->StepY) : 0.0f;
+
+	struct BytecodeRegisters Registers;
+	struct BytecodeLanes Lanes;
+	for (uint32_t Lane = 0; Lane < BYTECODE_LANES; Lane++)
+	{
+		Lanes.Pixel[Lane] = -1;
+		Lanes.Live[Lane] = 0;
+	}
+	Lanes.Occupied = 0;
+	Lanes.LiveCount = 0;
+	Lanes.NextPixel = 0;
+
+	uint64_t Total = 0;
+	do
+	{
+		Total += RefillLanes(Job, Iterations, &Registers, &Lanes);
+		while (Lanes.LiveCount != 0)
+		{
+			RunInstructions(Step, Formula->StepCount, &Registers);
+			Lanes.LiveCount = AdvanceLanes(Registers.Re[USER_FORMULA_REGISTER_Z], Registers.Im[USER_FORMULA_REGISTER_Z], Registers.Re[USER_FORMULA_REGISTER_P], Registers.Im[USER_FORMULA_REGISTER_P],
+				Registers.Re[Formula->Result], Registers.Im[Formula->Result], &Lanes, Formula->Bailout, Tolerance, Job->Limit, bPrevious);
+
+			if (Lanes.Occupied - Lanes.LiveCount >= BYTECODE_REFILL_LANES && Lanes.NextPixel < Job->Count)
+				break;
+		}
+	} while (Lanes.Occupied != 0);
+
+	return Total;
+}
+
+//the memory of p only costs where the formula has one
+#define BYTECODE_KERNEL(Isa, Target) \
+	static Target uint64_t Isa##BytecodeRow(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return BytecodeRow(Job, Iterations, false); } \
+	static Target uint64_t Isa##BytecodeRowPrevious(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return BytecodeRow(Job, Iterations, true); } \
+	uint64_t Isa##BytecodeRowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations) \
+	{ \
+		return Job->Formula->bUsesPrevious ? Isa##BytecodeRowPrevious(Job, Iterations) : Isa##BytecodeRow(Job, Iterations); \
+	}
+
+BYTECODE_KERNEL(Scalar, )
+
+#ifdef PLATFORM_X64
+
+BYTECODE_KERNEL(Avx2, TARGET_AVX2)
+BYTECODE_KERNEL(Avx512, TARGET_AVX512)
+
+#else
+
+uint64_t Avx2BytecodeRowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	return ScalarBytecodeRowKernel(Job, Iterations);
+}
+
+uint64_t Avx512BytecodeRowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	return ScalarBytecodeRowKernel(Job, Iterations);
+}
+
+#endif
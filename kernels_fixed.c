@@ -0,0 +1,238 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//Q4.60 fixed point escape time kernels for the z^2 family, between double and
+//double-double: 60 fraction bits where a double has 53 significand bits. the loop
+//(fixed_kernel.h) is instantiated here for scalar, 4 wide avx2 and 8 wide avx512
+//int64 lanes. it is exact integer arithmetic, so the output depends on neither the
+//isa nor how the frame is cut into tiles and threads.
+//with the guard bits of SelectPrecisionTier the tier covers pixel steps from 2^-45
+//down to 2^-52 of the centre's magnitude (at least 1), about 3e-14 to 2e-16, seven
+//octaves past double and not the 1e-17 a wider format would reach. 60 is the most
+//an int64 lane has room for: the 4 integer bits hold the sign and the |z| < 8 of
+//z^2 + c before the escape test, so finer steps go to perturbation or double-double
+
+#include <math.h>
+
+#include "kernels.h"
+#include "platform.h"
+
+#define FIXED_FRACTION_BITS 60
+#define FIXED_ONE ((int64_t)1 << FIXED_FRACTION_BITS)
+
+//lanes past the end of a row start outside the escape radius
+#define FIXED_PAD (FIXED_ONE * 4)
+
+//the centre, the offsets and the julia position are clamped to +-3.5. a pixel
+//beyond 2 escapes before it is used, and the clamp keeps a centre plus an offset
+//and z^2 + c below 8
+#define FIXED_COORD_LIMIT 3.5
+
+static inline int64_t FixedFromDouble(double x)
+{
+	return llrint(ldexp(fmin(fmax(x, -FIXED_COORD_LIMIT), FIXED_COORD_LIMIT), FIXED_FRACTION_BITS));
+}
+
+//the lower components are below 2^-53 of the leading one and are rounded one by one
+static inline int64_t FixedFromQd(const double x[4])
+{
+	if (fabs(x[0]) >= FIXED_COORD_LIMIT)
+		return FixedFromDouble(x[0]);
+
+	int64_t Fixed = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		Fixed += llrint(ldexp(x[i], FIXED_FRACTION_BITS));
+	}
+	return Fixed;
+}
+
+//a * b / 2^Shift rounded to nearest, exactly. truncating would bias every step the
+//same way and the error would grow linearly along the orbit. with 32 bit halves
+//a * b is Hi * 2^64 + Mid * 2^32 + Lo, the part of Lo below 2^32 cannot reach the
+//rounding bit. the simd versions do the same
+static inline uint64_t FixedMulHi(uint64_t a, uint64_t b, int Shift)
+{
+#ifdef __SIZEOF_INT128__
+	return (uint64_t)(((unsigned __int128)a * b + ((unsigned __int128)1 << (Shift - 1))) >> Shift);
+#else
+	const uint64_t Lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+	const uint64_t Mid = (a >> 32) * (b & 0xFFFFFFFF) + (a & 0xFFFFFFFF) * (b >> 32);
+	const uint64_t Hi = (a >> 32) * (b >> 32) + (Mid >> 32);
+	const uint64_t Carry = (Lo >> 32) + (Mid & 0xFFFFFFFF) + ((uint64_t)1 << (Shift - 33));
+	return (Hi << (64 - Shift)) + (Carry >> (Shift - 32));
+#endif
+}
+
+//scalar
+
+#define FX_T int64_t
+#define FX_LANES 1
+#define FX_TARGET
+#define FX_NAME(x) ScalarFixed##x
+#define FX_SET(x) ((int64_t)(x))
+#define FX_LOAD(p) (*(p))
+#define FX_ADD(a, b) ((int64_t)((uint64_t)(a) + (uint64_t)(b)))
+#define FX_SUB(a, b) ((int64_t)((uint64_t)(a) - (uint64_t)(b)))
+#define FX_ABS(x) ((x) < 0 ? -(x) : (x))
+#define FX_MULHI(a, b, s) ((int64_t)FixedMulHi((uint64_t)(a), (uint64_t)(b), s))
+#define FX_XOR(a, b) ((a) ^ (b))
+#define FX_NEGATE_WHERE(x, s) ((s) < 0 ? -(x) : (x))
+#define FX_MASK bool
+#define FX_LT(a, b) ((a) < (b))
+#define FX_AND(m, n) ((m) && (n))
+#define FX_MASK_BITS(m) ((unsigned)(m))
+#define FX_SELECT(m, a, b) ((m) ? (a) : (b))
+#define FX_COUNT uint64_t
+#define FX_COUNT_ZERO 0
+#define FX_COUNT_ADD(c, m) ((c) + (m))
+#define FX_STORE_COUNT(p, c) (*(p) = (c))
+
+#include "fixed_kernel.h"
+
+#undef FX_T
+#undef FX_LANES
+#undef FX_TARGET
+#undef FX_NAME
+#undef FX_SET
+#undef FX_LOAD
+#undef FX_ADD
+#undef FX_SUB
+#undef FX_ABS
+#undef FX_MULHI
+#undef FX_XOR
+#undef FX_NEGATE_WHERE
+#undef FX_MASK
+#undef FX_LT
+#undef FX_AND
+#undef FX_MASK_BITS
+#undef FX_SELECT
+#undef FX_COUNT
+#undef FX_COUNT_ZERO
+#undef FX_COUNT_ADD
+#undef FX_STORE_COUNT
+
+#ifdef PLATFORM_X64
+
+#include <immintrin.h>
+
+//avx2, which has no 64 bit abs
+
+static FORCE_INLINE TARGET_AVX2 __m256i Avx2FixedNegateWhere(__m256i x, __m256i s)
+{
+	const __m256i Negative = _mm256_cmpgt_epi64(_mm256_setzero_si256(), s);
+	return _mm256_sub_epi64(_mm256_xor_si256(x, Negative), Negative);
+}
+
+static FORCE_INLINE TARGET_AVX2 __m256i Avx2FixedMulHi(__m256i a, __m256i b, const int Shift)
+{
+	const __m256i aHi = _mm256_srli_epi64(a, 32);
+	const __m256i bHi = _mm256_srli_epi64(b, 32);
+	const __m256i Lo = _mm256_mul_epu32(a, b);
+	const __m256i Mid = _mm256_add_epi64(_mm256_mul_epu32(aHi, b), _mm256_mul_epu32(a, bHi));
+	const __m256i Hi = _mm256_add_epi64(_mm256_mul_epu32(aHi, bHi), _mm256_srli_epi64(Mid, 32));
+	const __m256i Carry = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(Lo, 32), _mm256_and_si256(Mid, _mm256_set1_epi64x(0xFFFFFFFF))), _mm256_set1_epi64x((int64_t)1 << (Shift - 33)));
+	return _mm256_add_epi64(_mm256_slli_epi64(Hi, 64 - Shift), _mm256_srli_epi64(Carry, Shift - 32));
+}
+
+#define FX_T __m256i
+#define FX_LANES 4
+#define FX_TARGET TARGET_AVX2
+#define FX_NAME(x) Avx2Fixed##x
+#define FX_SET(x) _mm256_set1_epi64x(x)
+#define FX_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define FX_ADD(a, b) _mm256_add_epi64(a, b)
+#define FX_SUB(a, b) _mm256_sub_epi64(a, b)
+#define FX_ABS(x) Avx2FixedNegateWhere(x, x)
+#define FX_MULHI(a, b, s) Avx2FixedMulHi(a, b, s)
+#define FX_XOR(a, b) _mm256_xor_si256(a, b)
+#define FX_NEGATE_WHERE(x, s) Avx2FixedNegateWhere(x, s)
+#define FX_MASK __m256i
+#define FX_LT(a, b) _mm256_cmpgt_epi64(b, a)
+#define FX_AND(m, n) _mm256_and_si256(m, n)
+#define FX_MASK_BITS(m) ((unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(m)))
+#define FX_SELECT(m, a, b) _mm256_blendv_epi8(b, a, m)
+#define FX_COUNT __m256i
+#define FX_COUNT_ZERO _mm256_setzero_si256()
+#define FX_COUNT_ADD(c, m) _mm256_sub_epi64(c, m)
+#define FX_STORE_COUNT(p, c) _mm256_storeu_si256((__m256i*)(p), c)
+
+#include "fixed_kernel.h"
+
+#undef FX_T
+#undef FX_LANES
+#undef FX_TARGET
+#undef FX_NAME
+#undef FX_SET
+#undef FX_LOAD
+#undef FX_ADD
+#undef FX_SUB
+#undef FX_ABS
+#undef FX_MULHI
+#undef FX_XOR
+#undef FX_NEGATE_WHERE
+#undef FX_MASK
+#undef FX_LT
+#undef FX_AND
+#undef FX_MASK_BITS
+#undef FX_SELECT
+#undef FX_COUNT
+#undef FX_COUNT_ZERO
+#undef FX_COUNT_ADD
+#undef FX_STORE_COUNT
+
+//avx512
+
+static FORCE_INLINE TARGET_AVX512 __m512i Avx512FixedMulHi(__m512i a, __m512i b, const int Shift)
+{
+	const __m512i aHi = _mm512_srli_epi64(a, 32);
+	const __m512i bHi = _mm512_srli_epi64(b, 32);
+	const __m512i Lo = _mm512_mul_epu32(a, b);
+	const __m512i Mid = _mm512_add_epi64(_mm512_mul_epu32(aHi, b), _mm512_mul_epu32(a, bHi));
+	const __m512i Hi = _mm512_add_epi64(_mm512_mul_epu32(aHi, bHi), _mm512_srli_epi64(Mid, 32));
+	const __m512i Carry = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(Lo, 32), _mm512_and_si512(Mid, _mm512_set1_epi64(0xFFFFFFFF))), _mm512_set1_epi64((int64_t)1 << (Shift - 33)));
+	return _mm512_add_epi64(_mm512_slli_epi64(Hi, 64 - Shift), _mm512_srli_epi64(Carry, Shift - 32));
+}
+
+#define FX_T __m512i
+#define FX_LANES 8
+#define FX_TARGET TARGET_AVX512
+#define FX_NAME(x) Avx512Fixed##x
+#define FX_SET(x) _mm512_set1_epi64(x)
+#define FX_LOAD(p) _mm512_loadu_si512(p)
+#define FX_ADD(a, b) _mm512_add_epi64(a, b)
+#define FX_SUB(a, b) _mm512_sub_epi64(a, b)
+#define FX_ABS(x) _mm512_abs_epi64(x)
+#define FX_MULHI(a, b, s) Avx512FixedMulHi(a, b, s)
+#define FX_XOR(a, b) _mm512_xor_si512(a, b)
+#define FX_NEGATE_WHERE(x, s) _mm512_mask_sub_epi64(x, _mm512_cmplt_epi64_mask(s, _mm512_setzero_si512()), _mm512_setzero_si512(), x)
+#define FX_MASK __mmask8
+#define FX_LT(a, b) _mm512_cmplt_epi64_mask(a, b)
+#define FX_AND(m, n) ((__mmask8)((m) & (n)))
+#define FX_MASK_BITS(m) ((unsigned)(m))
+#define FX_SELECT(m, a, b) _mm512_mask_mov_epi64(b, m, a)
+#define FX_COUNT __m512i
+#define FX_COUNT_ZERO _mm512_setzero_si512()
+#define FX_COUNT_ADD(c, m) _mm512_mask_add_epi64(c, m, c, _mm512_set1_epi64(1))
+#define FX_STORE_COUNT(p, c) _mm512_storeu_si512(p, c)
+
+#include "fixed_kernel.h"
+
+#else
+
+uint64_t Avx2FixedRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarFixedRowKernel(Job, Iterations); }
+uint64_t Avx512FixedRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarFixedRowKernel(Job, Iterations); }
+
+#endif
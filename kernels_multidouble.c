@@ -0,0 +1,325 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//double, double-double and quad-double escape time kernels for zooms past float precision.
+//the arithmetic (multidouble_ops.h) and the loop (multidouble_kernel.h) are written
+//once and instantiated here for scalar doubles, 4 wide avx2 and 8 wide avx512 lanes.
+//every instantiation does the same fma sequence, so all of them agree bit for bit
+
+#include "kernels.h"
+#include "multidouble.h"
+#include "platform.h"
+
+//lanes past the end of a row start outside the bailout radius
+#define PAD_OFFSET 100.0
+
+//scalar
+
+#define KN_T double
+#define KN_LANES 1
+#define KN_TARGET
+#define KN_SET(x) (x)
+#define KN_LOAD(p) (*(p))
+#define KN_STORE(p, v) (*(p) = (v))
+#define KN_ADD(a, b) ((a) + (b))
+#define KN_DOT(x, y) ((x) * (x) + (y) * (y))
+#define KN_MASK bool
+#define KN_LT(a, b) ((a) < (b))
+#define KN_MASK_BITS(m) ((unsigned)(m))
+#define KN_COUNT uint64_t
+#define KN_COUNT_ZERO 0
+#define KN_COUNT_ADD(c, m) ((c) + (m))
+#define KN_STORE_COUNT(p, c) (*(p) = (c))
+
+#define KN_NUM struct Dbl
+#define KN_SCALAR_NUM struct Dbl
+#define KN_OP(x) Dbl##x
+#define KN_SCALAR_OP(x) Dbl##x
+#define KN_NAME(x) ScalarDbl##x
+#define KN_COMPONENTS 1
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#define KN_NUM struct Dd
+#define KN_SCALAR_NUM struct Dd
+#define KN_OP(x) Dd##x
+#define KN_SCALAR_OP(x) Dd##x
+#define KN_NAME(x) ScalarDd##x
+#define KN_COMPONENTS 2
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#define KN_NUM struct Qd
+#define KN_SCALAR_NUM struct Qd
+#define KN_OP(x) Qd##x
+#define KN_SCALAR_OP(x) Qd##x
+#define KN_NAME(x) ScalarQd##x
+#define KN_COMPONENTS 4
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#undef KN_T
+#undef KN_LANES
+#undef KN_TARGET
+#undef KN_SET
+#undef KN_LOAD
+#undef KN_STORE
+#undef KN_ADD
+#undef KN_DOT
+#undef KN_MASK
+#undef KN_LT
+#undef KN_MASK_BITS
+#undef KN_COUNT
+#undef KN_COUNT_ZERO
+#undef KN_COUNT_ADD
+#undef KN_STORE_COUNT
+
+#ifdef PLATFORM_X64
+
+#include <immintrin.h>
+
+//avx2
+
+#define MD_T __m256d
+#define MD_NAME(x) Avx2##x
+#define MD_FUNC static FORCE_INLINE TARGET_AVX2
+#define MD_ADD(a, b) _mm256_add_pd(a, b)
+#define MD_SUB(a, b) _mm256_sub_pd(a, b)
+#define MD_MUL(a, b) _mm256_mul_pd(a, b)
+#define MD_FMA(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define MD_FMS(a, b, c) _mm256_fmsub_pd(a, b, c)
+#define MD_SET(x) _mm256_set1_pd(x)
+#define MD_XORSIGN(x, s) _mm256_xor_pd(x, _mm256_and_pd(s, _mm256_set1_pd(-0.0)))
+#define MD_MASK __m256d
+#define MD_BLEND(m, a, b) _mm256_blendv_pd(b, a, m)
+
+#include "multidouble_ops.h"
+
+#undef MD_T
+#undef MD_NAME
+#undef MD_FUNC
+#undef MD_ADD
+#undef MD_SUB
+#undef MD_MUL
+#undef MD_FMA
+#undef MD_FMS
+#undef MD_SET
+#undef MD_XORSIGN
+#undef MD_MASK
+#undef MD_BLEND
+
+#define KN_T __m256d
+#define KN_LANES 4
+#define KN_TARGET TARGET_AVX2
+#define KN_SET(x) _mm256_set1_pd(x)
+#define KN_LOAD(p) _mm256_loadu_pd(p)
+#define KN_STORE(p, v) _mm256_storeu_pd(p, v)
+#define KN_ADD(a, b) _mm256_add_pd(a, b)
+#define KN_DOT(x, y) _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y))
+#define KN_MASK __m256d
+#define KN_LT(a, b) _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define KN_MASK_BITS(m) ((unsigned)_mm256_movemask_pd(m))
+#define KN_COUNT __m256i
+#define KN_COUNT_ZERO _mm256_setzero_si256()
+#define KN_COUNT_ADD(c, m) _mm256_sub_epi64(c, _mm256_castpd_si256(m))
+#define KN_STORE_COUNT(p, c) _mm256_storeu_si256((__m256i*)(p), c)
+
+#define KN_NUM struct Avx2Dbl
+#define KN_SCALAR_NUM struct Dbl
+#define KN_OP(x) Avx2Dbl##x
+#define KN_SCALAR_OP(x) Dbl##x
+#define KN_NAME(x) Avx2Dbl##x
+#define KN_COMPONENTS 1
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#define KN_NUM struct Avx2Dd
+#define KN_SCALAR_NUM struct Dd
+#define KN_OP(x) Avx2Dd##x
+#define KN_SCALAR_OP(x) Dd##x
+#define KN_NAME(x) Avx2Dd##x
+#define KN_COMPONENTS 2
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#define KN_NUM struct Avx2Qd
+#define KN_SCALAR_NUM struct Qd
+#define KN_OP(x) Avx2Qd##x
+#define KN_SCALAR_OP(x) Qd##x
+#define KN_NAME(x) Avx2Qd##x
+#define KN_COMPONENTS 4
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#undef KN_T
+#undef KN_LANES
+#undef KN_TARGET
+#undef KN_SET
+#undef KN_LOAD
+#undef KN_STORE
+#undef KN_ADD
+#undef KN_DOT
+#undef KN_MASK
+#undef KN_LT
+#undef KN_MASK_BITS
+#undef KN_COUNT
+#undef KN_COUNT_ZERO
+#undef KN_COUNT_ADD
+#undef KN_STORE_COUNT
+
+//avx512, masks live in k registers instead of vector lanes
+
+#define MD_T __m512d
+#define MD_NAME(x) Avx512##x
+#define MD_FUNC static FORCE_INLINE TARGET_AVX512
+#define MD_ADD(a, b) _mm512_add_pd(a, b)
+#define MD_SUB(a, b) _mm512_sub_pd(a, b)
+#define MD_MUL(a, b) _mm512_mul_pd(a, b)
+#define MD_FMA(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define MD_FMS(a, b, c) _mm512_fmsub_pd(a, b, c)
+#define MD_SET(x) _mm512_set1_pd(x)
+#define MD_XORSIGN(x, s) _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(x), _mm512_and_si512(_mm512_castpd_si512(s), _mm512_set1_epi64(INT64_MIN))))
+#define MD_MASK __mmask8
+#define MD_BLEND(m, a, b) _mm512_mask_blend_pd(m, b, a)
+
+#include "multidouble_ops.h"
+
+#undef MD_T
+#undef MD_NAME
+#undef MD_FUNC
+#undef MD_ADD
+#undef MD_SUB
+#undef MD_MUL
+#undef MD_FMA
+#undef MD_FMS
+#undef MD_SET
+#undef MD_XORSIGN
+#undef MD_MASK
+#undef MD_BLEND
+
+#define KN_T __m512d
+#define KN_LANES 8
+#define KN_TARGET TARGET_AVX512
+#define KN_SET(x) _mm512_set1_pd(x)
+#define KN_LOAD(p) _mm512_loadu_pd(p)
+#define KN_STORE(p, v) _mm512_storeu_pd(p, v)
+#define KN_ADD(a, b) _mm512_add_pd(a, b)
+#define KN_DOT(x, y) _mm512_add_pd(_mm512_mul_pd(x, x), _mm512_mul_pd(y, y))
+#define KN_MASK __mmask8
+#define KN_LT(a, b) _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+#define KN_MASK_BITS(m) ((unsigned)(m))
+#define KN_COUNT __m512i
+#define KN_COUNT_ZERO _mm512_setzero_si512()
+#define KN_COUNT_ADD(c, m) _mm512_mask_add_epi64(c, m, c, _mm512_set1_epi64(1))
+#define KN_STORE_COUNT(p, c) _mm512_storeu_si512(p, c)
+
+#define KN_NUM struct Avx512Dbl
+#define KN_SCALAR_NUM struct Dbl
+#define KN_OP(x) Avx512Dbl##x
+#define KN_SCALAR_OP(x) Dbl##x
+#define KN_NAME(x) Avx512Dbl##x
+#define KN_COMPONENTS 1
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#define KN_NUM struct Avx512Dd
+#define KN_SCALAR_NUM struct Dd
+#define KN_OP(x) Avx512Dd##x
+#define KN_SCALAR_OP(x) Dd##x
+#define KN_NAME(x) Avx512Dd##x
+#define KN_COMPONENTS 2
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#define KN_NUM struct Avx512Qd
+#define KN_SCALAR_NUM struct Qd
+#define KN_OP(x) Avx512Qd##x
+#define KN_SCALAR_OP(x) Qd##x
+#define KN_NAME(x) Avx512Qd##x
+#define KN_COMPONENTS 4
+#include "multidouble_kernel.h"
+#undef KN_NUM
+#undef KN_SCALAR_NUM
+#undef KN_OP
+#undef KN_SCALAR_OP
+#undef KN_NAME
+#undef KN_COMPONENTS
+
+#undef KN_T
+#undef KN_LANES
+#undef KN_TARGET
+#undef KN_SET
+#undef KN_LOAD
+#undef KN_STORE
+#undef KN_ADD
+#undef KN_DOT
+#undef KN_MASK
+#undef KN_LT
+#undef KN_MASK_BITS
+#undef KN_COUNT
+#undef KN_COUNT_ZERO
+#undef KN_COUNT_ADD
+#undef KN_STORE_COUNT
+
+#else
+
+uint64_t Avx2DblRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarDblRowKernel(Job, Iterations); }
+uint64_t Avx512DblRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarDblRowKernel(Job, Iterations); }
+uint64_t Avx2DdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarDdRowKernel(Job, Iterations); }
+uint64_t Avx512DdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarDdRowKernel(Job, Iterations); }
+uint64_t Avx2QdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarQdRowKernel(Job, Iterations); }
+uint64_t Avx512QdRowKernel(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarQdRowKernel(Job, Iterations); }
+
+#endif
@@ -0,0 +1,205 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include "kernels.h"
+#include "formulas.h"
+#include "platform.h"
+
+//float ports of Mandelbrot()/Julia() from the .hlsl files. ScalarIterate carries
+//on from the orbit in *Orbit after iter iterations and leaves its last point there
+
+//lane ops for FORMULA_STEP
+#define F_T float
+#define F_SET(x) (x)
+#define F_ADD(a, b) ((a) + (b))
+#define F_SUB(a, b) ((a) - (b))
+#define F_MUL(a, b) ((a) * (b))
+#define F_DIV(a, b) ((a) / (b))
+#define F_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define F_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define F_ABS(x) fabsf(x)
+#define F_LESS(a, b) ((a) < (b))
+#define F_SIGN(x) signbit(x)
+#define F_SELECT(m, a, b) ((m) ? (a) : (b))
+
+FORMULA_DEFINE_FAST_SPIRAL(ScalarMosaicSpiralFast, )
+
+#define F_SPIRAL() (bFastMath ? ScalarMosaicSpiralFast(Zx, Zy, sqrtf(Magnitude)) : MosaicSpiral(Zx, Zy, sqrtf(Magnitude)))
+
+//Set and bFastMath are constants at every call site. brent cycle detection: every
+//iteration the orbit is compared with the point saved at the last power of two
+//iteration, a Tolerance of 0 turns it off. an orbit caught in a cycle sets
+//*bPeriodic and returns the iteration it was caught at
+static FORCE_INLINE uint32_t ScalarIterate(const enum FractalSet Set, const bool bFastMath, struct OrbitState* restrict Orbit, const float Cx, const float Cy, uint32_t iter, const uint32_t Limit, const float Tolerance, bool* restrict bPeriodic)
+{
+	const float Bailout = GetFormulaBailout(Set);
+	const bool Active = true;
+	(void)Active;
+
+	float Zx = Orbit->Zx;
+	float Zy = Orbit->Zy;
+	float PrevX = Orbit->PrevX;
+	float PrevY = Orbit->PrevY;
+
+	float SavedX = Orbit->SavedX;
+	float SavedY = Orbit->SavedY;
+	float SavedPrevX = Orbit->SavedPrevX;
+	float SavedPrevY = Orbit->SavedPrevY;
+	uint32_t NextSave = GetNextSave(iter);
+
+	while (iter < Limit)
+	{
+		const float x2 = Zx * Zx;
+		const float y2 = Zy * Zy;
+		const float Magnitude = x2 + y2;
+		if (!(Magnitude < Bailout))
+			break;
+
+		float NewX;
+		float NewY;
+		FORMULA_STEP(Set)
+
+		Zx = NewX;
+		Zy = NewY;
+		iter++;
+
+		const float Dx = Zx - SavedX;
+		const float Dy = Zy - SavedY;
+		float Distance = Dx * Dx + Dy * Dy;
+		if (FORMULA_HAS_MEMORY(Set))
+		{
+			const float Dpx = PrevX - SavedPrevX;
+			const float Dpy = PrevY - SavedPrevY;
+			Distance = Distance + Dpx * Dpx + Dpy * Dpy;
+		}
+		if (Distance < Tolerance)
+		{
+			*bPeriodic = true;
+			return iter;
+		}
+
+		if (iter == NextSave)
+		{
+			SavedX = Zx;
+			SavedY = Zy;
+			SavedPrevX = PrevX;
+			SavedPrevY = PrevY;
+			NextSave *= 2;
+		}
+	}
+
+	Orbit->Zx = Zx;
+	Orbit->Zy = Zy;
+	Orbit->PrevX = PrevX;
+	Orbit->PrevY = PrevY;
+	Orbit->SavedX = SavedX;
+	Orbit->SavedY = SavedY;
+	Orbit->SavedPrevX = SavedPrevX;
+	Orbit->SavedPrevY = SavedPrevY;
+	return iter;
+}
+
+static FORCE_INLINE uint64_t ScalarRow(const struct RowJob* restrict Job, uint32_t* restrict Iterations, const enum FractalSet Set, const enum FractalType Type, const bool bFastMath)
+{
+	const float RowY = (float)(Job->OriginY + (double)Job->Y * Job->StepY);
+	const float Tolerance = Job->bInteriorChecks ? (float)PeriodTolerance(Job->StepX, Job->StepY) : 0.0f;
+	const bool bBulbs = Job->bInteriorChecks && Set == FRACTAL_SET_MANDELBROT && Type == FRACTAL_TYPE_BASE;
+	const bool bResume = Job->Status != NULL && Job->FirstIteration != 0;
+	uint64_t Total = 0;
+
+	for (uint32_t i = 0; i < Job->Count; i++)
+	{
+		const float x = GetRowJobX(Job, i);
+		const float y = Job->Points ? (float)Job->Points[i * 2 + 1] : RowY;
+
+		struct OrbitState Orbit = StartOrbit(x, y);
+		uint32_t FirstIteration = 0;
+		if (bResume)
+		{
+			if (Job->Status[i] == PIXEL_STATUS_INTERIOR)
+				Iterations[i] = Job->Limit;
+			if (Job->Status[i] != PIXEL_STATUS_CAPPED)
+				continue;
+
+			Orbit = Job->Orbits[i];
+			FirstIteration = Job->FirstIteration;
+		}
+
+		//the total only counts the iterations that ran, interior pixels still get the limit
+		bool bInterior = false;
+		uint32_t iter;
+		if (bBulbs && !bResume && IsInMandelbrotBulbs(x, y))
+		{
+			bInterior = true;
+			iter = FirstIteration;
+		}
+		else if (Type == FRACTAL_TYPE_BASE)
+			iter = ScalarIterate(Set, bFastMath, &Orbit, x, y, FirstIteration, Job->Limit, Tolerance, &bInterior);
+		else
+			iter = ScalarIterate(Set, bFastMath, &Orbit, (float)Job->JuliaX, (float)Job->JuliaY, FirstIteration, Job->Limit, Tolerance, &bInterior);
+
+		Total += iter - FirstIteration;
+		if (bInterior)
+			iter = Job->Limit;
+
+		if (Job->Status)
+		{
+			Job->Status[i] = bInterior ? PIXEL_STATUS_INTERIOR : iter == Job->Limit ? PIXEL_STATUS_CAPPED : PIXEL_STATUS_ESCAPED;
+			Job->Orbits[i] = Orbit;
+		}
+
+		Iterations[i] = iter;
+		if (Job->Fractions)
+			Job->Fractions[i] = iter < Job->Limit ? GetSmoothFraction(Set, Orbit.Zx, Orbit.Zy) : 0;
+	}
+
+	return Total;
+}
+
+//one instantiation per formula and seed, so neither is looked at inside the loop
+#define SCALAR_ROWS(Enum, Suffix, ...) \
+	static uint64_t ScalarRow##Suffix(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarRow(Job, Iterations, FRACTAL_SET_##Enum, FRACTAL_TYPE_BASE, false); } \
+	static uint64_t ScalarRow##Suffix##Julia(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarRow(Job, Iterations, FRACTAL_SET_##Enum, FRACTAL_TYPE_JULIA, false); }
+FRACTAL_FORMULAS(SCALAR_ROWS)
+#undef SCALAR_ROWS
+
+static const RowKernel ScalarRowKernels[FRACTAL_SET_COUNT][FRACTAL_TYPE_COUNT] = {
+#define SCALAR_ROW_ENTRY(Enum, Suffix, ...) { ScalarRow##Suffix##Julia, ScalarRow##Suffix },
+	FRACTAL_FORMULAS(SCALAR_ROW_ENTRY)
+#undef SCALAR_ROW_ENTRY
+};
+
+//mosaic is the only formula with anything for fast math to replace
+static uint64_t ScalarRowMosaicFast(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarRow(Job, Iterations, FRACTAL_SET_MOSAIC, FRACTAL_TYPE_BASE, true); }
+static uint64_t ScalarRowMosaicFastJulia(const struct RowJob* restrict Job, uint32_t* restrict Iterations) { return ScalarRow(Job, Iterations, FRACTAL_SET_MOSAIC, FRACTAL_TYPE_JULIA, true); }
+
+uint64_t ScalarRowKernel(const struct RowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	if (Job->bFastMath && Job->Set == FRACTAL_SET_MOSAIC)
+		return Job->Type == FRACTAL_TYPE_BASE ? ScalarRowMosaicFast(Job, Iterations) : ScalarRowMosaicFastJulia(Job, Iterations);
+	return ScalarRowKernels[Job->Set][Job->Type](Job, Iterations);
+}
+
+void ScalarPaletteRowKernel(const struct PaletteRowJob* restrict Job, uint8_t* restrict Rgba)
+{
+	for (uint32_t i = 0; i < Job->Count; i++)
+	{
+		const uint32_t Color = Job->Colors[GetPaletteIndex(Job, i)];
+		memcpy(Rgba + i * 4, &Color, 4);
+	}
+}
@@ -29,6 +29,8 @@
 #include <stdio.h>
 #include <math.h>
 
+#include "fractal.h"
+
 #pragma comment(linker, "/DEFAULTLIB:D3d12.lib")
 #pragma comment(linker, "/DEFAULTLIB:DXGI.lib")
 #pragma comment(linker, "/DEFAULTLIB:dxguid.lib")
@@ -103,32 +105,8 @@ static const bool bWarp = false;
 #define BUFFER_COUNT 3
 #define WM_INIT (WM_USER + 1)
 
-struct ConstantBufferData
-{
-	float MaxIterations[4];
-	float WindowPos[4];
-	float JuliaPos[4];
-};
-
 static const int ConstantBufferDataAlignedSize = (sizeof(struct ConstantBufferData) + 255) & ~255;
 
-enum FractalSet
-{
-	FRACTAL_SET_MANDELBROT,
-	FRACTAL_SET_TRICORN,
-	FRACTAL_SET_BURNINGSHIP,
-	FRACTAL_SET_DOUBLETRICORN,
-	FRACTAL_SET_MOSAIC,
-	FRACTAL_SET_COUNT
-};
-
-enum FractalType
-{
-	FRACTAL_TYPE_JULIA,
-	FRACTAL_TYPE_BASE,
-	FRACTAL_TYPE_COUNT
-};
-
 enum RenderMode
 {
 	RENDER_MODE_JULIA,
@@ -137,19 +115,15 @@ enum RenderMode
 };
 
 static const LPCWSTR const ShaderFileNames[FRACTAL_SET_COUNT][FRACTAL_TYPE_COUNT] = {
-	{ L"mandelbrot_julia.cso",		L"mandelbrot.cso" },
-	{ L"tricorn_julia.cso",			L"tricorn.cso" },
-	{ L"burningship_julia.cso",		L"burningship.cso" },
-	{ L"doubletricorn_julia.cso",	L"doubletricorn.cso" },
-	{ L"mosaic_julia.cso",			L"mosaic.cso" }
+#define SHADER_FILE_NAMES(Enum, Suffix, Name, ...) { L"" Name "_julia.cso", L"" Name ".cso" },
+	FRACTAL_FORMULAS(SHADER_FILE_NAMES)
+#undef SHADER_FILE_NAMES
 };
 
 static const LPCWSTR const ProgramNames[FRACTAL_SET_COUNT][FRACTAL_TYPE_COUNT] = {
-	{ L"MANDELBROT_JULIA",		L"MANDELBROT" },
-	{ L"TRICORN_JULIA",			L"TRICORN" },
-	{ L"BURNINGSHIP_JULIA",		L"BURNINGSHIP" },
-	{ L"DOUBLETRICORN_JULIA",	L"DOUBLETRICORN" },
-	{ L"MOSAIC_JULIA",			L"MOSAIC" }
+#define PROGRAM_NAMES(Enum, ...) { L"" #Enum "_JULIA", L"" #Enum },
+	FRACTAL_FORMULAS(PROGRAM_NAMES)
+#undef PROGRAM_NAMES
 };
 
 struct DxObjects
@@ -25,6 +25,8 @@ Texture2D Texture : register(t0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 SamplerState MySampler : register(s0);
 
+#include "fractal.hlsli"
+
 float Mandelbrot(float2 Coord)
 {
     uint MaxIterations = (uint) MyConstantBuffer.MaxIterations.z * 4;
@@ -33,10 +35,32 @@ float Mandelbrot(float2 Coord)
     float2 z = Coord;
     float2 c = Coord;
     
+    // main cardioid and period 2 bulb, never escape
+    float q = (c.x - 0.25) * (c.x - 0.25) + c.y * c.y;
+    if (q * (q + (c.x - 0.25)) < 0.25 * c.y * c.y || (c.x + 1.0) * (c.x + 1.0) + c.y * c.y < 0.0625)
+        return frac((float) MaxIterations / MyConstantBuffer.MaxIterations.z);
+    
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 4.0)
     {
         z = float2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        if (dot(Delta, Delta) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            NextSave *= 2;
+        }
     }
     
     return frac((float) iter / MyConstantBuffer.MaxIterations.z);
@@ -23,6 +23,8 @@ struct ConstantBufferData
 RWTexture2D<float4> Framebuffer : register(u0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 
+#include "fractal.hlsli"
+
 float Julia(float2 Coord)
 {
     uint MaxIterations = (uint) MyConstantBuffer.MaxIterations.z * 4;
@@ -31,10 +33,27 @@ float Julia(float2 Coord)
     float2 z = Coord;
     float2 c = MyConstantBuffer.JuliaPos.xy;
     
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 4.0)
     {
         z = float2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        if (dot(Delta, Delta) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            NextSave *= 2;
+        }
     }
     
     return frac((float) iter / MyConstantBuffer.MaxIterations.z);
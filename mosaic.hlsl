@@ -25,6 +25,8 @@ Texture2D Texture : register(t0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 SamplerState MySampler : register(s0);
 
+#include "fractal.hlsli"
+
 float Mandelbrot(float2 Coord)
 {
     uint MaxIterations = (uint) (MyConstantBuffer.MaxIterations.z * 6);
@@ -37,6 +39,12 @@ float Mandelbrot(float2 Coord)
     
     const float phi = 1.6180339887; // Golden ratio for organic curves
 
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    float2 SavedPrev = prev;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 16.0)
     {
         // Phoenix: z^2 + c + k*previous
@@ -52,6 +60,20 @@ float Mandelbrot(float2 Coord)
         z = z2 + c + 0.15 * prev * spiral;
         prev = z2; // Update phoenix term
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        float2 DeltaPrev = prev - SavedPrev;
+        if (dot(Delta, Delta) + dot(DeltaPrev, DeltaPrev) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            SavedPrev = prev;
+            NextSave *= 2;
+        }
     }
     
     return frac((float) iter / MyConstantBuffer.MaxIterations.z);
@@ -23,6 +23,8 @@ struct ConstantBufferData
 RWTexture2D<float4> Framebuffer : register(u0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 
+#include "fractal.hlsli"
+
 float Julia(float2 Coord)
 {
     uint MaxIterations = (uint) (MyConstantBuffer.MaxIterations.z * 6);
@@ -35,6 +37,12 @@ float Julia(float2 Coord)
     
     const float phi = 1.6180339887; // Golden ratio for organic curves
 
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    float2 SavedPrev = prev;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 16.0)
     {
         // Phoenix: z^2 + c + k*previous
@@ -50,6 +58,20 @@ float Julia(float2 Coord)
         z = z2 + c + 0.15 * prev * spiral;
         prev = z2; // Update phoenix term
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        float2 DeltaPrev = prev - SavedPrev;
+        if (dot(Delta, Delta) + dot(DeltaPrev, DeltaPrev) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            SavedPrev = prev;
+            NextSave *= 2;
+        }
     }
     
     return frac((float) iter / MyConstantBuffer.MaxIterations.z);
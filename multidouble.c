@@ -0,0 +1,70 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "multidouble.h"
+
+static const double PiOver2Components[4] = {
+	1.5707963267948966,
+	6.123233995736766e-17,
+	-1.4973849048591698e-33,
+	5.562271104316826e-50
+};
+
+void QdFromBigFloat(struct Qd* restrict Result, const struct BigFloat* restrict x)
+{
+	//peel off one rounded double at a time, the rest stays exact in BigFloat
+	struct BigFloat Remainder = *x;
+	struct BigFloat Component;
+	double c[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		c[i] = BigFloatToDouble(&Remainder);
+		BigFloatFromDouble(&Component, c[i], Remainder.LimbCount);
+		BigFloatSub(&Remainder, &Remainder, &Component);
+	}
+
+	*Result = QdRenormalize(c[0], c[1], c[2], c[3], 0.0);
+}
+
+struct Dbl DblMosaicSpiral(struct Dbl x, struct Dbl y)
+{
+	const double r = sqrt(x.x[0] * x.x[0] + y.x[0] * y.x[0]);
+	const double Theta = atan2(y.x[0], x.x[0]);
+	return DblFromDouble(sin(MOSAIC_PHI * Theta - MOSAIC_PHI * r * MOSAIC_SPIRAL_PITCH));
+}
+
+#define MM_NUM struct Dd
+#define MM_OP(x) Dd##x
+#define MM_COMPONENTS 2
+#define MM_EPSILON 1e-33
+#include "multidouble_math.h"
+#undef MM_NUM
+#undef MM_OP
+#undef MM_COMPONENTS
+#undef MM_EPSILON
+
+#define MM_NUM struct Qd
+#define MM_OP(x) Qd##x
+#define MM_COMPONENTS 4
+#define MM_EPSILON 1e-66
+#include "multidouble_math.h"
+#undef MM_NUM
+#undef MM_OP
+#undef MM_COMPONENTS
+#undef MM_EPSILON
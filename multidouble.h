@@ -0,0 +1,78 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//scalar double-double (~106 bit) and quad-double (~212 bit) numbers. a value is
+//the unevaluated sum of its components, largest first. Dbl is a one component
+//double behind the same interface
+
+#include <stdbool.h>
+#include <math.h>
+
+#include "bigfloat.h"
+
+//the .hlsl constants are floats, the deeper precisions keep their exact float
+//values so every precision iterates the same formula
+#define DOUBLETRICORN_SKEW ((double)0.2f)
+#define MOSAIC_PREVIOUS_WEIGHT ((double)0.15f)
+#define MOSAIC_PHI ((double)1.6180339887f)
+#define MOSAIC_SPIRAL_PITCH ((double)0.3f)
+
+#define MD_T double
+#define MD_NAME(x) x
+#define MD_FUNC static inline
+#define MD_ADD(a, b) ((a) + (b))
+#define MD_SUB(a, b) ((a) - (b))
+#define MD_MUL(a, b) ((a) * (b))
+#define MD_FMA(a, b, c) fma(a, b, c)
+#define MD_FMS(a, b, c) fma(a, b, -(c))
+#define MD_SET(x) (x)
+#define MD_XORSIGN(x, s) ((s) < 0 ? -(x) : (x))
+#define MD_MASK bool
+#define MD_BLEND(m, a, b) ((m) ? (a) : (b))
+
+#include "multidouble_ops.h"
+
+#undef MD_T
+#undef MD_NAME
+#undef MD_FUNC
+#undef MD_ADD
+#undef MD_SUB
+#undef MD_MUL
+#undef MD_FMA
+#undef MD_FMS
+#undef MD_SET
+#undef MD_XORSIGN
+#undef MD_MASK
+#undef MD_BLEND
+
+//rounds to the nearest quad-double, the double-double is its first two components
+void QdFromBigFloat(struct Qd* restrict Result, const struct BigFloat* restrict x);
+
+struct Dd DdDivDouble(struct Dd a, double b);
+struct Dd DdSqrt(struct Dd a);
+void DdSinCos(struct Dd a, struct Dd* restrict Sin, struct Dd* restrict Cos);
+struct Dd DdAtan2(struct Dd y, struct Dd x);
+
+struct Qd QdDivDouble(struct Qd a, double b);
+struct Qd QdSqrt(struct Qd a);
+void QdSinCos(struct Qd a, struct Qd* restrict Sin, struct Qd* restrict Cos);
+struct Qd QdAtan2(struct Qd y, struct Qd x);
+
+//sin(phi * atan2(y, x) - phi * |z| * 0.3), the golden spiral term of the mosaic kernel
+struct Dbl DblMosaicSpiral(struct Dbl x, struct Dbl y);
+struct Dd DdMosaicSpiral(struct Dd x, struct Dd y);
+struct Qd QdMosaicSpiral(struct Qd x, struct Qd y);
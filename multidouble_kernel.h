@@ -0,0 +1,261 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//escape time loop over KN_LANES pixels in double, double-double or quad-double.
+//no include guard, kernels_multidouble.c includes this once per precision and isa with:
+//  KN_NUM, KN_SCALAR_NUM     vector and scalar number type
+//  KN_OP(x), KN_SCALAR_OP(x) prefix of their arithmetic
+//  KN_NAME(x)                prefix of the generated functions
+//  KN_COMPONENTS             doubles per number
+//  KN_TARGET                 target attribute
+//  KN_T, KN_LANES            lane type and width
+//  KN_SET(x), KN_LOAD(p), KN_STORE(p, v)
+//  KN_ADD(a, b)              a + b
+//  KN_DOT(x, y)              x * x + y * y
+//  KN_MASK, KN_LT(a, b), KN_MASK_BITS(m)
+//  KN_COUNT, KN_COUNT_ZERO, KN_COUNT_ADD(c, m), KN_STORE_COUNT(p, c)
+//
+//escaped lanes are frozen with a select like the float kernels, bailout is
+//tested on the leading components only. the cycle check measures the full
+//precision distance, at these depths the leading components alone would
+//call any two nearby points equal
+
+//per lane golden spiral term of the mosaic kernel, the scalar transcendentals carry the full precision.
+//numbers go through pointers, a one vector struct passed by value to a function
+//with a target attribute does not get the same calling convention on both sides
+static KN_TARGET void KN_NAME(MosaicSpiral)(const KN_NUM* restrict x, const KN_NUM* restrict y, unsigned ActiveBits, KN_NUM* restrict Result)
+{
+	double X[KN_COMPONENTS][KN_LANES];
+	double Y[KN_COMPONENTS][KN_LANES];
+	double Spiral[KN_COMPONENTS][KN_LANES] = { 0 };
+
+	for (int c = 0; c < KN_COMPONENTS; c++)
+	{
+		KN_STORE(X[c], x->x[c]);
+		KN_STORE(Y[c], y->x[c]);
+	}
+
+	for (int Lane = 0; Lane < KN_LANES; Lane++)
+	{
+		if ((ActiveBits & (1u << Lane)) == 0)
+			continue;
+
+		KN_SCALAR_NUM LaneX;
+		KN_SCALAR_NUM LaneY;
+		for (int c = 0; c < KN_COMPONENTS; c++)
+		{
+			LaneX.x[c] = X[c][Lane];
+			LaneY.x[c] = Y[c][Lane];
+		}
+
+		const KN_SCALAR_NUM LaneSpiral = KN_SCALAR_OP(MosaicSpiral)(LaneX, LaneY);
+		for (int c = 0; c < KN_COMPONENTS; c++)
+		{
+			Spiral[c][Lane] = LaneSpiral.x[c];
+		}
+	}
+
+	for (int c = 0; c < KN_COMPONENTS; c++)
+	{
+		Result->x[c] = KN_LOAD(Spiral[c]);
+	}
+}
+
+//Set is a constant at every call site, so each instantiation keeps only its own formula
+//lanes caught in a cycle are moved outside the bailout radius and reported in *PeriodicLanes
+static FORCE_INLINE KN_TARGET KN_COUNT KN_NAME(Iterate)(const enum FractalSet Set, KN_NUM Zx, KN_NUM Zy, const KN_NUM Cx, const KN_NUM Cy, const uint32_t Limit, const KN_T Tolerance, unsigned* restrict PeriodicLanes)
+{
+	const KN_T Bailout = KN_SET(GetFormulaBailout(Set));
+	const KN_T Three = KN_SET(3.0);
+	const KN_NUM Escaped = KN_OP(FromDouble)(KN_SET(PAD_OFFSET));
+
+	KN_NUM PrevX = KN_OP(FromDouble)(KN_SET(0.0));
+	KN_NUM PrevY = PrevX;
+	KN_COUNT Count = KN_COUNT_ZERO;
+
+	//brent cycle detection, compared every iteration with the state saved at the last power of two
+	KN_NUM SavedX = Zx;
+	KN_NUM SavedY = Zy;
+	KN_NUM SavedPrevX = PrevX;
+	KN_NUM SavedPrevY = PrevY;
+	uint32_t NextSave = 1;
+
+	for (uint32_t iter = 0; iter < Limit; iter++)
+	{
+		const KN_MASK Active = KN_LT(KN_DOT(KN_OP(Hi)(Zx), KN_OP(Hi)(Zy)), Bailout);
+		const unsigned ActiveBits = KN_MASK_BITS(Active);
+		if (ActiveBits == 0)
+			break;
+
+		const KN_NUM x2 = KN_OP(Sqr)(Zx);
+		const KN_NUM y2 = KN_OP(Sqr)(Zy);
+
+		KN_NUM NewX;
+		KN_NUM NewY;
+
+		switch (Set)
+		{
+		case FRACTAL_SET_MANDELBROT:
+		{
+			const KN_NUM xy = KN_OP(Mul)(Zx, Zy);
+			NewX = KN_OP(Add)(KN_OP(Sub)(x2, y2), Cx);
+			NewY = KN_OP(Add)(KN_OP(Add)(xy, xy), Cy);
+			break;
+		}
+		case FRACTAL_SET_TRICORN:
+		{
+			const KN_NUM xy = KN_OP(Mul)(Zx, Zy);
+			NewX = KN_OP(Add)(KN_OP(Sub)(x2, y2), Cx);
+			NewY = KN_OP(Sub)(Cy, KN_OP(Add)(xy, xy));
+			break;
+		}
+		case FRACTAL_SET_BURNINGSHIP:
+		{
+			const KN_NUM xy = KN_OP(Abs)(KN_OP(Mul)(Zx, Zy));
+			NewX = KN_OP(Add)(KN_OP(Sub)(x2, y2), Cx);
+			NewY = KN_OP(Add)(KN_OP(Add)(xy, xy), Cy);
+			break;
+		}
+		case FRACTAL_SET_DOUBLETRICORN:
+		{
+			KN_NUM z3x = KN_OP(Mul)(KN_OP(Abs)(Zx), KN_OP(Sub)(x2, KN_OP(MulDouble)(y2, Three)));
+			const KN_NUM z3y = KN_OP(Mul)(KN_OP(Abs)(Zy), KN_OP(Sub)(KN_OP(MulDouble)(x2, Three), y2));
+			z3x = KN_OP(Add)(z3x, KN_OP(MulDouble)(z3y, KN_SET(DOUBLETRICORN_SKEW)));
+			NewX = KN_OP(Add)(z3x, Cx);
+			NewY = KN_OP(Add)(z3y, Cy);
+			break;
+		}
+		case FRACTAL_SET_MOSAIC:
+		default:
+		{
+			const KN_NUM xy = KN_OP(Mul)(Zx, Zy);
+			const KN_NUM z2x = KN_OP(Sub)(x2, y2);
+			const KN_NUM z2y = KN_OP(Add)(xy, xy);
+			KN_NUM Spiral;
+			KN_NAME(MosaicSpiral)(&Zx, &Zy, ActiveBits, &Spiral);
+			const KN_T k = KN_SET(MOSAIC_PREVIOUS_WEIGHT);
+			NewX = KN_OP(Add)(KN_OP(Add)(z2x, Cx), KN_OP(Mul)(KN_OP(MulDouble)(PrevX, k), Spiral));
+			NewY = KN_OP(Add)(KN_OP(Add)(z2y, Cy), KN_OP(Mul)(KN_OP(MulDouble)(PrevY, k), Spiral));
+			PrevX = KN_OP(Select)(Active, z2x, PrevX);
+			PrevY = KN_OP(Select)(Active, z2y, PrevY);
+			break;
+		}
+		}
+
+		Zx = KN_OP(Select)(Active, NewX, Zx);
+		Zy = KN_OP(Select)(Active, NewY, Zy);
+		Count = KN_COUNT_ADD(Count, Active);
+
+		KN_T Distance = KN_DOT(KN_OP(Hi)(KN_OP(Sub)(Zx, SavedX)), KN_OP(Hi)(KN_OP(Sub)(Zy, SavedY)));
+		if (Set == FRACTAL_SET_MOSAIC)
+			Distance = KN_ADD(Distance, KN_DOT(KN_OP(Hi)(KN_OP(Sub)(PrevX, SavedPrevX)), KN_OP(Hi)(KN_OP(Sub)(PrevY, SavedPrevY))));
+
+		//escaped lanes sit still and always look periodic, moving them again is harmless
+		const KN_MASK Periodic = KN_LT(Distance, Tolerance);
+		const unsigned PeriodicBits = KN_MASK_BITS(Periodic) & ActiveBits;
+		if (PeriodicBits != 0)
+		{
+			*PeriodicLanes |= PeriodicBits;
+			Zx = KN_OP(Select)(Periodic, Escaped, Zx);
+			Zy = KN_OP(Select)(Periodic, Escaped, Zy);
+		}
+
+		if (iter + 1 == NextSave)
+		{
+			SavedX = Zx;
+			SavedY = Zy;
+			SavedPrevX = PrevX;
+			SavedPrevY = PrevY;
+			NextSave *= 2;
+		}
+	}
+
+	return Count;
+}
+
+static FORCE_INLINE KN_TARGET uint64_t KN_NAME(Row)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations, const enum FractalSet Set, const enum FractalType Type)
+{
+	const KN_NUM CentreX = KN_OP(Broadcast)(Job->CentreX);
+	const KN_NUM CentreY = KN_OP(Broadcast)(Job->CentreY);
+	const KN_NUM JuliaX = KN_OP(FromDouble)(KN_SET(Job->JuliaX));
+	const KN_NUM JuliaY = KN_OP(FromDouble)(KN_SET(Job->JuliaY));
+	const double OffsetY = ((double)Job->Y - Job->HalfHeight) * Job->StepY;
+	const KN_T Tolerance = KN_SET(Job->bInteriorChecks ? PeriodTolerance(Job->StepX, Job->StepY) : 0.0);
+	const bool bBulbs = Job->bInteriorChecks && Set == FRACTAL_SET_MANDELBROT && Type == FRACTAL_TYPE_BASE;
+	uint64_t Total = 0;
+
+	for (uint32_t i = 0; i < Job->Count; i += KN_LANES)
+	{
+		const uint32_t Lanes = min(KN_LANES, Job->Count - i);
+
+		//the bulb test only needs the leading double, a pixel it gets wrong lies
+		//within 1e-16 of the boundary and would not escape before the limit anyway
+		unsigned InteriorLanes = 0;
+
+		double X[KN_LANES];
+		double Y[KN_LANES];
+		for (uint32_t Lane = 0; Lane < KN_LANES; Lane++)
+		{
+			X[Lane] = Lane >= Lanes ? PAD_OFFSET : Job->Offsets ? Job->Offsets[(i + Lane) * 2] : ((double)(Job->FirstX + i + Lane) - Job->HalfWidth) * Job->StepX;
+			Y[Lane] = Lane >= Lanes ? PAD_OFFSET : Job->Offsets ? Job->Offsets[(i + Lane) * 2 + 1] : OffsetY;
+
+			if (bBulbs && Lane < Lanes && IsInMandelbrotBulbs(Job->CentreX[0] + X[Lane], Job->CentreY[0] + Y[Lane]))
+			{
+				InteriorLanes |= 1u << Lane;
+				X[Lane] = PAD_OFFSET;
+				Y[Lane] = PAD_OFFSET;
+			}
+		}
+
+		const KN_NUM Px = KN_OP(Add)(CentreX, KN_OP(FromDouble)(KN_LOAD(X)));
+		const KN_NUM Py = KN_OP(Add)(CentreY, KN_OP(FromDouble)(KN_LOAD(Y)));
+
+		KN_COUNT Count;
+		if (Type == FRACTAL_TYPE_BASE)
+			Count = KN_NAME(Iterate)(Set, Px, Py, Px, Py, Job->Limit, Tolerance, &InteriorLanes);
+		else
+			Count = KN_NAME(Iterate)(Set, Px, Py, JuliaX, JuliaY, Job->Limit, Tolerance, &InteriorLanes);
+
+		uint64_t Out[KN_LANES];
+		KN_STORE_COUNT(Out, Count);
+		for (uint32_t Lane = 0; Lane < Lanes; Lane++)
+		{
+			Total += Out[Lane];
+			if (InteriorLanes & (1u << Lane))
+				Out[Lane] = Job->Limit;
+
+			Iterations[i + Lane] = (uint32_t)Out[Lane];
+		}
+	}
+
+	return Total;
+}
+
+#define KN_ROWS(Enum, Suffix, ...) \
+	static KN_TARGET uint64_t KN_NAME(Row##Suffix)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return KN_NAME(Row)(Job, Iterations, FRACTAL_SET_##Enum, FRACTAL_TYPE_BASE); } \
+	static KN_TARGET uint64_t KN_NAME(Row##Suffix##Julia)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations) { return KN_NAME(Row)(Job, Iterations, FRACTAL_SET_##Enum, FRACTAL_TYPE_JULIA); }
+FRACTAL_FORMULAS(KN_ROWS)
+#undef KN_ROWS
+
+static const MultiDoubleRowKernel KN_NAME(RowKernels)[FRACTAL_SET_COUNT][FRACTAL_TYPE_COUNT] = {
+#define KN_ROW_ENTRY(Enum, Suffix, ...) { KN_NAME(Row##Suffix##Julia), KN_NAME(Row##Suffix) },
+	FRACTAL_FORMULAS(KN_ROW_ENTRY)
+#undef KN_ROW_ENTRY
+};
+
+uint64_t KN_NAME(RowKernel)(const struct MultiDoubleRowJob* restrict Job, uint32_t* restrict Iterations)
+{
+	return KN_NAME(RowKernels)[Job->Set][Job->Type](Job, Iterations);
+}
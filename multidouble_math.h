@@ -0,0 +1,140 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//transcendental functions for the scalar double-double and quad-double types.
+//no include guard, multidouble.c includes this once per type with:
+//  MM_NUM               number type
+//  MM_OP(x)             prefix of the arithmetic and of the generated functions
+//  MM_COMPONENTS        doubles per number, also the number of refinement passes
+//  MM_EPSILON           series terms below this no longer change the result
+//
+//everything starts from the libm double result and refines it, one pass of
+//each refinement gains about 53 bits
+
+//a / b, one double quotient digit per component
+MM_NUM MM_OP(DivDouble)(MM_NUM a, double b)
+{
+	MM_NUM Quotient = MM_OP(FromDouble)(0.0);
+	MM_NUM Remainder = a;
+
+	for (int i = 0; i < MM_COMPONENTS; i++)
+	{
+		const double Digit = MM_OP(Hi)(Remainder) / b;
+		Quotient = MM_OP(Add)(Quotient, MM_OP(FromDouble)(Digit));
+		Remainder = MM_OP(Sub)(Remainder, MM_OP(MulDouble)(MM_OP(FromDouble)(Digit), b));
+	}
+
+	return Quotient;
+}
+
+MM_NUM MM_OP(Sqrt)(MM_NUM a)
+{
+	const double Seed = sqrt(MM_OP(Hi)(a));
+	if (Seed == 0)
+		return MM_OP(FromDouble)(0.0);
+
+	//newton on x^2 - a with the derivative frozen at the seed
+	const double HalfInverse = 0.5 / Seed;
+	MM_NUM x = MM_OP(FromDouble)(Seed);
+
+	for (int i = 1; i < MM_COMPONENTS; i++)
+	{
+		x = MM_OP(Add)(x, MM_OP(MulDouble)(MM_OP(Sub)(a, MM_OP(Sqr)(x)), HalfInverse));
+	}
+
+	return x;
+}
+
+//Cos may be NULL
+void MM_OP(SinCos)(MM_NUM a, MM_NUM* restrict Sin, MM_NUM* restrict Cos)
+{
+	//reduce to |r| <= pi / 4 around the nearest multiple of pi / 2
+	const MM_NUM PiOver2 = MM_OP(Broadcast)(PiOver2Components);
+	const double k = nearbyint(MM_OP(Hi)(a) / PiOver2Components[0]);
+	const MM_NUM r = MM_OP(Sub)(a, MM_OP(MulDouble)(PiOver2, k));
+	const MM_NUM r2 = MM_OP(Sqr)(r);
+
+	MM_NUM SinR = r;
+	MM_NUM Term = r;
+	for (double n = 3; fabs(MM_OP(Hi)(Term)) > MM_EPSILON; n += 2)
+	{
+		Term = MM_OP(DivDouble)(MM_OP(Mul)(Term, r2), -(n - 1) * n);
+		SinR = MM_OP(Add)(SinR, Term);
+	}
+
+	MM_NUM CosR = MM_OP(FromDouble)(1.0);
+	if (Cos)
+	{
+		Term = CosR;
+		for (double n = 2; fabs(MM_OP(Hi)(Term)) > MM_EPSILON; n += 2)
+		{
+			Term = MM_OP(DivDouble)(MM_OP(Mul)(Term, r2), -(n - 1) * n);
+			CosR = MM_OP(Add)(CosR, Term);
+		}
+	}
+
+	switch ((int64_t)k & 3)
+	{
+	case 0:
+		*Sin = SinR;
+		if (Cos) *Cos = CosR;
+		break;
+	case 1:
+		*Sin = CosR;
+		if (Cos) *Cos = MM_OP(Neg)(SinR);
+		break;
+	case 2:
+		*Sin = MM_OP(Neg)(SinR);
+		if (Cos) *Cos = MM_OP(Neg)(CosR);
+		break;
+	default:
+		*Sin = MM_OP(Neg)(CosR);
+		if (Cos) *Cos = SinR;
+		break;
+	}
+}
+
+MM_NUM MM_OP(Atan2)(MM_NUM y, MM_NUM x)
+{
+	if (MM_OP(Hi)(x) == 0 && MM_OP(Hi)(y) == 0)
+		return MM_OP(FromDouble)(0.0);
+
+	//newton on sin(theta - atan2(y, x)) = 0
+	MM_NUM Theta = MM_OP(FromDouble)(atan2(MM_OP(Hi)(y), MM_OP(Hi)(x)));
+
+	for (int i = 1; i < MM_COMPONENTS; i++)
+	{
+		MM_NUM Sin;
+		MM_NUM Cos;
+		MM_OP(SinCos)(Theta, &Sin, &Cos);
+
+		const MM_NUM Numerator = MM_OP(Sub)(MM_OP(Mul)(y, Cos), MM_OP(Mul)(x, Sin));
+		const MM_NUM Denominator = MM_OP(Add)(MM_OP(Mul)(x, Cos), MM_OP(Mul)(y, Sin));
+		Theta = MM_OP(Add)(Theta, MM_OP(DivDouble)(Numerator, MM_OP(Hi)(Denominator)));
+	}
+
+	return Theta;
+}
+
+MM_NUM MM_OP(MosaicSpiral)(MM_NUM x, MM_NUM y)
+{
+	const MM_NUM r = MM_OP(Sqrt)(MM_OP(Add)(MM_OP(Sqr)(x), MM_OP(Sqr)(y)));
+	const MM_NUM Theta = MM_OP(Atan2)(y, x);
+	const MM_NUM Angle = MM_OP(Sub)(MM_OP(MulDouble)(Theta, MOSAIC_PHI), MM_OP(MulDouble)(MM_OP(MulDouble)(r, MOSAIC_PHI), MOSAIC_SPIRAL_PITCH));
+
+	MM_NUM Sin;
+	MM_OP(SinCos)(Angle, &Sin, NULL);
+	return Sin;
+}
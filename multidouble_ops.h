@@ -0,0 +1,405 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+//double, double-double and quad-double arithmetic written once over a lane type.
+//no include guard, this file is included once per lane type with:
+//  MD_T                 lane type (double, __m256d)
+//  MD_NAME(x)           prefix for every type and function name
+//  MD_FUNC              storage class and target attributes
+//  MD_ADD, MD_SUB, MD_MUL(a, b)
+//  MD_FMA(a, b, c)      a * b + c with a single rounding
+//  MD_FMS(a, b, c)      a * b - c with a single rounding
+//  MD_SET(x)            broadcast a double constant
+//  MD_XORSIGN(x, s)     x with its sign flipped in the lanes where s is negative
+//  MD_MASK              per lane comparison result
+//  MD_BLEND(m, a, b)    a in the lanes set in m, b elsewhere
+//
+//error free transforms follow Hida, Li and Bailey's qd library. the quad-double
+//renormalisation skips qd's tests for zero components so every lane runs the same
+//instruction stream, zero components stay exact through quick two sum anyway
+
+#define MD_DBL MD_NAME(Dbl)
+#define MD_DD MD_NAME(Dd)
+#define MD_QD MD_NAME(Qd)
+
+//plain double with the same interface, so the kernels can run it too
+struct MD_DBL
+{
+	MD_T x[1];
+};
+
+struct MD_DD
+{
+	MD_T x[2];
+};
+
+struct MD_QD
+{
+	MD_T x[4];
+};
+
+//s + e == a + b exactly
+MD_FUNC MD_T MD_NAME(TwoSum)(MD_T a, MD_T b, MD_T* restrict e)
+{
+	MD_T s = MD_ADD(a, b);
+	MD_T bb = MD_SUB(s, a);
+	*e = MD_ADD(MD_SUB(a, MD_SUB(s, bb)), MD_SUB(b, bb));
+	return s;
+}
+
+//same as TwoSum but requires |a| >= |b| or a == 0
+MD_FUNC MD_T MD_NAME(QuickTwoSum)(MD_T a, MD_T b, MD_T* restrict e)
+{
+	MD_T s = MD_ADD(a, b);
+	*e = MD_SUB(b, MD_SUB(s, a));
+	return s;
+}
+
+MD_FUNC MD_T MD_NAME(TwoProd)(MD_T a, MD_T b, MD_T* restrict e)
+{
+	MD_T p = MD_MUL(a, b);
+	*e = MD_FMS(a, b, p);
+	return p;
+}
+
+//double
+
+MD_FUNC struct MD_DBL MD_NAME(DblFromDouble)(MD_T a)
+{
+	struct MD_DBL Result = { { a } };
+	return Result;
+}
+
+MD_FUNC struct MD_DBL MD_NAME(DblBroadcast)(const double* restrict x)
+{
+	struct MD_DBL Result = { { MD_SET(x[0]) } };
+	return Result;
+}
+
+MD_FUNC MD_T MD_NAME(DblHi)(struct MD_DBL a)
+{
+	return a.x[0];
+}
+
+MD_FUNC struct MD_DBL MD_NAME(DblSelect)(MD_MASK m, struct MD_DBL a, struct MD_DBL b)
+{
+	struct MD_DBL Result = { { MD_BLEND(m, a.x[0], b.x[0]) } };
+	return Result;
+}
+
+MD_FUNC struct MD_DBL MD_NAME(DblAdd)(struct MD_DBL a, struct MD_DBL b)
+{
+	struct MD_DBL Result = { { MD_ADD(a.x[0], b.x[0]) } };
+	return Result;
+}
+
+MD_FUNC struct MD_DBL MD_NAME(DblSub)(struct MD_DBL a, struct MD_DBL b)
+{
+	struct MD_DBL Result = { { MD_SUB(a.x[0], b.x[0]) } };
+	return Result;
+}
+
+MD_FUNC struct MD_DBL MD_NAME(DblMul)(struct MD_DBL a, struct MD_DBL b)
+{
+	struct MD_DBL Result = { { MD_MUL(a.x[0], b.x[0]) } };
+	return Result;
+}
+
+MD_FUNC struct MD_DBL MD_NAME(DblSqr)(struct MD_DBL a)
+{
+	return MD_NAME(DblMul)(a, a);
+}
+
+MD_FUNC struct MD_DBL MD_NAME(DblMulDouble)(struct MD_DBL a, MD_T b)
+{
+	struct MD_DBL Result = { { MD_MUL(a.x[0], b) } };
+	return Result;
+}
+
+MD_FUNC struct MD_DBL MD_NAME(DblAbs)(struct MD_DBL a)
+{
+	struct MD_DBL Result = { { MD_XORSIGN(a.x[0], a.x[0]) } };
+	return Result;
+}
+
+//double-double
+
+MD_FUNC struct MD_DD MD_NAME(DdFromDouble)(MD_T a)
+{
+	struct MD_DD Result = { { a, MD_SET(0.0) } };
+	return Result;
+}
+
+//x[0] + x[1] in every lane
+MD_FUNC struct MD_DD MD_NAME(DdBroadcast)(const double* restrict x)
+{
+	struct MD_DD Result = { { MD_SET(x[0]), MD_SET(x[1]) } };
+	return Result;
+}
+
+MD_FUNC MD_T MD_NAME(DdHi)(struct MD_DD a)
+{
+	return a.x[0];
+}
+
+MD_FUNC struct MD_DD MD_NAME(DdSelect)(MD_MASK m, struct MD_DD a, struct MD_DD b)
+{
+	struct MD_DD Result = { { MD_BLEND(m, a.x[0], b.x[0]), MD_BLEND(m, a.x[1], b.x[1]) } };
+	return Result;
+}
+
+MD_FUNC struct MD_DD MD_NAME(DdAdd)(struct MD_DD a, struct MD_DD b)
+{
+	MD_T e;
+	MD_T f;
+	MD_T s = MD_NAME(TwoSum)(a.x[0], b.x[0], &e);
+	MD_T t = MD_NAME(TwoSum)(a.x[1], b.x[1], &f);
+	e = MD_ADD(e, t);
+	s = MD_NAME(QuickTwoSum)(s, e, &e);
+	e = MD_ADD(e, f);
+
+	struct MD_DD Result;
+	Result.x[0] = MD_NAME(QuickTwoSum)(s, e, &Result.x[1]);
+	return Result;
+}
+
+MD_FUNC struct MD_DD MD_NAME(DdNeg)(struct MD_DD a)
+{
+	struct MD_DD Result = { { MD_SUB(MD_SET(0.0), a.x[0]), MD_SUB(MD_SET(0.0), a.x[1]) } };
+	return Result;
+}
+
+MD_FUNC struct MD_DD MD_NAME(DdSub)(struct MD_DD a, struct MD_DD b)
+{
+	return MD_NAME(DdAdd)(a, MD_NAME(DdNeg)(b));
+}
+
+MD_FUNC struct MD_DD MD_NAME(DdMul)(struct MD_DD a, struct MD_DD b)
+{
+	MD_T e;
+	MD_T p = MD_NAME(TwoProd)(a.x[0], b.x[0], &e);
+	e = MD_FMA(a.x[0], b.x[1], e);
+	e = MD_FMA(a.x[1], b.x[0], e);
+
+	struct MD_DD Result;
+	Result.x[0] = MD_NAME(QuickTwoSum)(p, e, &Result.x[1]);
+	return Result;
+}
+
+MD_FUNC struct MD_DD MD_NAME(DdSqr)(struct MD_DD a)
+{
+	MD_T e;
+	MD_T p = MD_NAME(TwoProd)(a.x[0], a.x[0], &e);
+	e = MD_FMA(MD_ADD(a.x[0], a.x[0]), a.x[1], e);
+
+	struct MD_DD Result;
+	Result.x[0] = MD_NAME(QuickTwoSum)(p, e, &Result.x[1]);
+	return Result;
+}
+
+MD_FUNC struct MD_DD MD_NAME(DdMulDouble)(struct MD_DD a, MD_T b)
+{
+	MD_T e;
+	MD_T p = MD_NAME(TwoProd)(a.x[0], b, &e);
+	e = MD_FMA(a.x[1], b, e);
+
+	struct MD_DD Result;
+	Result.x[0] = MD_NAME(QuickTwoSum)(p, e, &Result.x[1]);
+	return Result;
+}
+
+MD_FUNC struct MD_DD MD_NAME(DdAbs)(struct MD_DD a)
+{
+	struct MD_DD Result = { { MD_XORSIGN(a.x[0], a.x[0]), MD_XORSIGN(a.x[1], a.x[0]) } };
+	return Result;
+}
+
+//quad-double
+
+MD_FUNC struct MD_QD MD_NAME(QdFromDouble)(MD_T a)
+{
+	struct MD_QD Result = { { a, MD_SET(0.0), MD_SET(0.0), MD_SET(0.0) } };
+	return Result;
+}
+
+//x[0] + x[1] + x[2] + x[3] in every lane
+MD_FUNC struct MD_QD MD_NAME(QdBroadcast)(const double* restrict x)
+{
+	struct MD_QD Result = { { MD_SET(x[0]), MD_SET(x[1]), MD_SET(x[2]), MD_SET(x[3]) } };
+	return Result;
+}
+
+MD_FUNC MD_T MD_NAME(QdHi)(struct MD_QD a)
+{
+	return a.x[0];
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdSelect)(MD_MASK m, struct MD_QD a, struct MD_QD b)
+{
+	struct MD_QD Result;
+	for (int i = 0; i < 4; i++)
+	{
+		Result.x[i] = MD_BLEND(m, a.x[i], b.x[i]);
+	}
+	return Result;
+}
+
+//(a, b, c) <- a + b + c as a non overlapping triple
+MD_FUNC void MD_NAME(ThreeSum)(MD_T* restrict a, MD_T* restrict b, MD_T* restrict c)
+{
+	MD_T t2;
+	MD_T t3;
+	MD_T t1 = MD_NAME(TwoSum)(*a, *b, &t2);
+	*a = MD_NAME(TwoSum)(*c, t1, &t3);
+	*b = MD_NAME(TwoSum)(t2, t3, c);
+}
+
+//(a, b) <- a + b + c with the last term folded in
+MD_FUNC void MD_NAME(ThreeSum2)(MD_T* restrict a, MD_T* restrict b, MD_T c)
+{
+	MD_T t2;
+	MD_T t3;
+	MD_T t1 = MD_NAME(TwoSum)(*a, *b, &t2);
+	*a = MD_NAME(TwoSum)(c, t1, &t3);
+	*b = MD_ADD(t2, t3);
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdRenormalize)(MD_T c0, MD_T c1, MD_T c2, MD_T c3, MD_T c4)
+{
+	//bottom up, then top down so every component ends up non overlapping
+	c3 = MD_NAME(QuickTwoSum)(c3, c4, &c4);
+	c2 = MD_NAME(QuickTwoSum)(c2, c3, &c3);
+	c1 = MD_NAME(QuickTwoSum)(c1, c2, &c2);
+	c0 = MD_NAME(QuickTwoSum)(c0, c1, &c1);
+
+	c1 = MD_NAME(QuickTwoSum)(c1, c2, &c2);
+	c2 = MD_NAME(QuickTwoSum)(c2, c3, &c3);
+	c3 = MD_ADD(c3, c4);
+
+	struct MD_QD Result = { { c0, c1, c2, c3 } };
+	return Result;
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdAdd)(struct MD_QD a, struct MD_QD b)
+{
+	MD_T t0;
+	MD_T t1;
+	MD_T t2;
+	MD_T t3;
+	MD_T s0 = MD_NAME(TwoSum)(a.x[0], b.x[0], &t0);
+	MD_T s1 = MD_NAME(TwoSum)(a.x[1], b.x[1], &t1);
+	MD_T s2 = MD_NAME(TwoSum)(a.x[2], b.x[2], &t2);
+	MD_T s3 = MD_NAME(TwoSum)(a.x[3], b.x[3], &t3);
+
+	s1 = MD_NAME(TwoSum)(s1, t0, &t0);
+	MD_NAME(ThreeSum)(&s2, &t0, &t1);
+	MD_NAME(ThreeSum2)(&s3, &t0, t2);
+	t0 = MD_ADD(MD_ADD(t0, t1), t3);
+
+	return MD_NAME(QdRenormalize)(s0, s1, s2, s3, t0);
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdNeg)(struct MD_QD a)
+{
+	struct MD_QD Result;
+	for (int i = 0; i < 4; i++)
+	{
+		Result.x[i] = MD_SUB(MD_SET(0.0), a.x[i]);
+	}
+	return Result;
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdSub)(struct MD_QD a, struct MD_QD b)
+{
+	return MD_NAME(QdAdd)(a, MD_NAME(QdNeg)(b));
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdMul)(struct MD_QD a, struct MD_QD b)
+{
+	MD_T q0;
+	MD_T q1;
+	MD_T q2;
+	MD_T q3;
+	MD_T q4;
+	MD_T q5;
+	MD_T p0 = MD_NAME(TwoProd)(a.x[0], b.x[0], &q0);
+	MD_T p1 = MD_NAME(TwoProd)(a.x[0], b.x[1], &q1);
+	MD_T p2 = MD_NAME(TwoProd)(a.x[1], b.x[0], &q2);
+	MD_T p3 = MD_NAME(TwoProd)(a.x[0], b.x[2], &q3);
+	MD_T p4 = MD_NAME(TwoProd)(a.x[1], b.x[1], &q4);
+	MD_T p5 = MD_NAME(TwoProd)(a.x[2], b.x[0], &q5);
+
+	MD_NAME(ThreeSum)(&p1, &p2, &q0);
+
+	//six-three sum of p2, q1, q2, p3, p4, p5
+	MD_NAME(ThreeSum)(&p2, &q1, &q2);
+	MD_NAME(ThreeSum)(&p3, &p4, &p5);
+
+	MD_T t0;
+	MD_T t1;
+	MD_T s0 = MD_NAME(TwoSum)(p2, p3, &t0);
+	MD_T s1 = MD_NAME(TwoSum)(q1, p4, &t1);
+	MD_T s2 = MD_ADD(q2, p5);
+	s1 = MD_NAME(TwoSum)(s1, t0, &t0);
+	s2 = MD_ADD(s2, MD_ADD(t0, t1));
+
+	//order eps^3 terms
+	MD_T Tail = MD_MUL(a.x[0], b.x[3]);
+	Tail = MD_FMA(a.x[1], b.x[2], Tail);
+	Tail = MD_FMA(a.x[2], b.x[1], Tail);
+	Tail = MD_FMA(a.x[3], b.x[0], Tail);
+	Tail = MD_ADD(Tail, MD_ADD(MD_ADD(q0, q3), MD_ADD(q4, q5)));
+	s1 = MD_ADD(s1, Tail);
+
+	return MD_NAME(QdRenormalize)(p0, p1, s0, s1, s2);
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdSqr)(struct MD_QD a)
+{
+	return MD_NAME(QdMul)(a, a);
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdMulDouble)(struct MD_QD a, MD_T b)
+{
+	MD_T q0;
+	MD_T q1;
+	MD_T q2;
+	MD_T p0 = MD_NAME(TwoProd)(a.x[0], b, &q0);
+	MD_T p1 = MD_NAME(TwoProd)(a.x[1], b, &q1);
+	MD_T p2 = MD_NAME(TwoProd)(a.x[2], b, &q2);
+	MD_T p3 = MD_MUL(a.x[3], b);
+
+	MD_T s2;
+	MD_T s1 = MD_NAME(TwoSum)(q0, p1, &s2);
+	MD_NAME(ThreeSum)(&s2, &q1, &p2);
+	MD_NAME(ThreeSum2)(&q1, &q2, p3);
+	MD_T s4 = MD_ADD(q2, p2);
+
+	return MD_NAME(QdRenormalize)(p0, s1, s2, q1, s4);
+}
+
+MD_FUNC struct MD_QD MD_NAME(QdAbs)(struct MD_QD a)
+{
+	struct MD_QD Result;
+	for (int i = 0; i < 4; i++)
+	{
+		Result.x[i] = MD_XORSIGN(a.x[i], a.x[0]);
+	}
+	return Result;
+}
+
+#undef MD_DBL
+#undef MD_DD
+#undef MD_QD
@@ -0,0 +1,279 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//thin portability layer for the headless renderer, which has to build on
+//windows (msvc) as well as on the linux render farm (gcc/clang)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <malloc.h>
+#include <direct.h>
+#include <errno.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#endif
+
+static inline void FATAL_IMPL(const char* Message, const char* File, int Line)
+{
+	fprintf(stderr, "an error occured: %s\nlocation:%s line %i\n", Message, File, Line);
+	fflush(stderr);
+	abort();
+}
+
+#define FATAL(x) FATAL_IMPL(x, __FILE__, __LINE__)
+
+#define CHECK_ALLOC(x) if((x) == NULL) FATAL("out of memory")
+
+#define CHECK_TRUE(x) if(!(x)) FATAL(#x)
+
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+#ifdef _MSC_VER
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PLATFORM_X64
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//msvc lets any function use any intrinsic, gcc and clang need the isa spelled out per function
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+//with fma enabled gcc and clang fuse a multiply and an add on their own, which
+//rounds once instead of twice and makes the simd kernels disagree with the
+//scalar ones. msvc only contracts under /fp:contract
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+static inline void* AlignedAlloc(size_t Size, size_t Alignment)
+{
+#ifdef _WIN32
+	void* Memory = _aligned_malloc(Size, Alignment);
+#else
+	void* Memory = NULL;
+	if (posix_memalign(&Memory, Alignment, Size) != 0)
+		Memory = NULL;
+#endif
+	CHECK_ALLOC(Memory);
+	return Memory;
+}
+
+static inline void AlignedFree(void* Memory)
+{
+#ifdef _WIN32
+	_aligned_free(Memory);
+#else
+	free(Memory);
+#endif
+}
+
+//atomics
+
+#ifdef _WIN32
+static inline int32_t AtomicAdd32(volatile int32_t* Target, int32_t Value) { return InterlockedExchangeAdd((volatile LONG*)Target, Value); }
+static inline int64_t AtomicAdd64(volatile int64_t* Target, int64_t Value) { return InterlockedExchangeAdd64((volatile LONG64*)Target, Value); }
+static inline int32_t AtomicLoad32(volatile int32_t* Target) { return InterlockedCompareExchange((volatile LONG*)Target, 0, 0); }
+static inline void AtomicStore32(volatile int32_t* Target, int32_t Value) { InterlockedExchange((volatile LONG*)Target, Value); }
+#else
+static inline int32_t AtomicAdd32(volatile int32_t* Target, int32_t Value) { return __atomic_fetch_add(Target, Value, __ATOMIC_SEQ_CST); }
+static inline int64_t AtomicAdd64(volatile int64_t* Target, int64_t Value) { return __atomic_fetch_add(Target, Value, __ATOMIC_SEQ_CST); }
+static inline int32_t AtomicLoad32(volatile int32_t* Target) { return __atomic_load_n(Target, __ATOMIC_SEQ_CST); }
+static inline void AtomicStore32(volatile int32_t* Target, int32_t Value) { __atomic_store_n(Target, Value, __ATOMIC_SEQ_CST); }
+#endif
+
+//threads
+
+#ifdef _WIN32
+typedef SRWLOCK PlatformMutex;
+typedef CONDITION_VARIABLE PlatformCondition;
+typedef HANDLE PlatformThread;
+
+static inline void MutexInit(PlatformMutex* Mutex) { InitializeSRWLock(Mutex); }
+static inline void MutexDestroy(PlatformMutex* Mutex) { (void)Mutex; }
+static inline void MutexLock(PlatformMutex* Mutex) { AcquireSRWLockExclusive(Mutex); }
+static inline void MutexUnlock(PlatformMutex* Mutex) { ReleaseSRWLockExclusive(Mutex); }
+
+static inline void ConditionInit(PlatformCondition* Condition) { InitializeConditionVariable(Condition); }
+static inline void ConditionDestroy(PlatformCondition* Condition) { (void)Condition; }
+static inline void ConditionWait(PlatformCondition* Condition, PlatformMutex* Mutex) { SleepConditionVariableSRW(Condition, Mutex, INFINITE, 0); }
+static inline void ConditionSignal(PlatformCondition* Condition) { WakeConditionVariable(Condition); }
+static inline void ConditionBroadcast(PlatformCondition* Condition) { WakeAllConditionVariable(Condition); }
+#else
+typedef pthread_mutex_t PlatformMutex;
+typedef pthread_cond_t PlatformCondition;
+typedef pthread_t PlatformThread;
+
+static inline void MutexInit(PlatformMutex* Mutex) { CHECK_TRUE(pthread_mutex_init(Mutex, NULL) == 0); }
+static inline void MutexDestroy(PlatformMutex* Mutex) { pthread_mutex_destroy(Mutex); }
+static inline void MutexLock(PlatformMutex* Mutex) { pthread_mutex_lock(Mutex); }
+static inline void MutexUnlock(PlatformMutex* Mutex) { pthread_mutex_unlock(Mutex); }
+
+static inline void ConditionInit(PlatformCondition* Condition) { CHECK_TRUE(pthread_cond_init(Condition, NULL) == 0); }
+static inline void ConditionDestroy(PlatformCondition* Condition) { pthread_cond_destroy(Condition); }
+static inline void ConditionWait(PlatformCondition* Condition, PlatformMutex* Mutex) { pthread_cond_wait(Condition, Mutex); }
+static inline void ConditionSignal(PlatformCondition* Condition) { pthread_cond_signal(Condition); }
+static inline void ConditionBroadcast(PlatformCondition* Condition) { pthread_cond_broadcast(Condition); }
+#endif
+
+typedef void (*PlatformThreadProc)(void* Context);
+
+struct PlatformThreadStart
+{
+	PlatformThreadProc Proc;
+	void* Context;
+};
+
+#ifdef _WIN32
+static inline DWORD WINAPI PlatformThreadTrampoline(LPVOID Parameter)
+#else
+static inline void* PlatformThreadTrampoline(void* Parameter)
+#endif
+{
+	struct PlatformThreadStart Start = *(struct PlatformThreadStart*)Parameter;
+	free(Parameter);
+	Start.Proc(Start.Context);
+	return 0;
+}
+
+static inline PlatformThread ThreadCreate(PlatformThreadProc Proc, void* Context)
+{
+	struct PlatformThreadStart* Start = malloc(sizeof(struct PlatformThreadStart));
+	CHECK_ALLOC(Start);
+	Start->Proc = Proc;
+	Start->Context = Context;
+
+	PlatformThread Thread;
+#ifdef _WIN32
+	Thread = CreateThread(NULL, 0, PlatformThreadTrampoline, Start, 0, NULL);
+	if (Thread == NULL)
+		FATAL("unable to create thread");
+#else
+	if (pthread_create(&Thread, NULL, PlatformThreadTrampoline, Start) != 0)
+		FATAL("unable to create thread");
+#endif
+	return Thread;
+}
+
+static inline void ThreadJoin(PlatformThread Thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(Thread, INFINITE);
+	CloseHandle(Thread);
+#else
+	pthread_join(Thread, NULL);
+#endif
+}
+
+static inline uint32_t GetProcessorCount(void)
+{
+#ifdef _WIN32
+	return GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+#else
+	long Count = sysconf(_SC_NPROCESSORS_ONLN);
+	return Count > 0 ? (uint32_t)Count : 1;
+#endif
+}
+
+//runtime isa checks, including whether the os saves the wider registers
+static inline bool CpuSupportsAvx2(void)
+{
+#if defined(PLATFORM_X64) && defined(_MSC_VER) && !defined(__clang__)
+	int Info[4];
+	__cpuid(Info, 1);
+	const bool bOsxsave = (Info[2] & (1 << 27)) != 0;
+	const bool bFma = (Info[2] & (1 << 12)) != 0;
+	if (!bOsxsave || !bFma || (_xgetbv(0) & 0x6) != 0x6)
+		return false;
+	__cpuidex(Info, 7, 0);
+	return (Info[1] & (1 << 5)) != 0;
+#elif defined(PLATFORM_X64)
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	return false;
+#endif
+}
+
+static inline bool CpuSupportsAvx512(void)
+{
+#if defined(PLATFORM_X64) && defined(_MSC_VER) && !defined(__clang__)
+	if (!CpuSupportsAvx2() || (_xgetbv(0) & 0xE6) != 0xE6)
+		return false;
+	int Info[4];
+	__cpuidex(Info, 7, 0);
+	return (Info[1] & (1 << 16)) != 0;
+#elif defined(PLATFORM_X64)
+	return CpuSupportsAvx2() && __builtin_cpu_supports("avx512f");
+#else
+	return false;
+#endif
+}
+
+//true if the directory exists afterwards, its parent has to exist already
+static inline bool MakeDirectory(const char* Path)
+{
+#ifdef _WIN32
+	return _mkdir(Path) == 0 || errno == EEXIST;
+#else
+	return mkdir(Path, 0777) == 0 || errno == EEXIST;
+#endif
+}
+
+//seconds since an arbitrary fixed point
+static inline double GetTime(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER Counter;
+	QueryPerformanceFrequency(&Frequency);
+	QueryPerformanceCounter(&Counter);
+	return Counter.QuadPart / (double)Frequency.QuadPart;
+#else
+	struct timespec Now;
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return Now.tv_sec + Now.tv_nsec * 1e-9;
+#endif
+}
@@ -0,0 +1,115 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <string.h>
+
+#include "poster.h"
+#include "imageio.h"
+#include "platform.h"
+
+//per row: iterations, the fraction when smooth, and the colour of the band, plus
+//the image writer's own row
+static size_t GetPosterRowBytes(const struct CpuView* restrict View, bool bSmooth)
+{
+	return (size_t)View->Width * (sizeof(uint32_t) + (bSmooth ? 1 : 0) + 4 + 3);
+}
+
+uint32_t GetPosterBandHeight(const struct CpuRenderer* Renderer, const struct CpuView* restrict View, const struct PosterSettings* restrict Settings)
+{
+	const size_t RowBytes = GetPosterRowBytes(View, Settings->bSmooth);
+	const size_t Rows = min(Settings->MemoryLimit / RowBytes, (size_t)View->Height);
+	const uint32_t TileSize = CpuRendererGetTileSize(Renderer);
+	if (Rows >= TileSize && Rows < View->Height)
+		return (uint32_t)(Rows / TileSize * TileSize);
+	return (uint32_t)Rows;
+}
+
+bool CpuRenderPoster(struct CpuRenderer* Renderer, const struct CpuView* restrict View, const struct Palette* restrict Palette, const struct PosterSettings* restrict Settings, PosterProgressCallback Progress, void* Context, struct CpuRenderStats* restrict Stats)
+{
+	const uint32_t BandHeight = GetPosterBandHeight(Renderer, View, Settings);
+	if (BandHeight == 0)
+		return false;
+
+	struct ImageWriter* Writer = ImageWriterOpen(Settings->Path, View->Width, View->Height);
+	if (Writer == NULL)
+		return false;
+
+	const double StartTime = GetTime();
+
+	struct IterationBuffer Buffer;
+	IterationBufferInit(&Buffer, View->Width, BandHeight);
+	if (Settings->bSmooth)
+		IterationBufferAddFractions(&Buffer);
+
+	const size_t RowPitch = (size_t)View->Width * 4;
+	uint8_t* Rgba = AlignedAlloc(RowPitch * BandHeight, 64);
+
+	struct CpuRenderStats BandStats;
+	uint64_t TotalIterations = 0;
+	uint64_t FilledPixels = 0;
+	uint64_t MirroredPixels = 0;
+	uint32_t TileCount = 0;
+	uint32_t Steals = 0;
+
+	bool bOk = true;
+	for (uint32_t FirstRow = 0; FirstRow < View->Height && bOk; FirstRow += BandHeight)
+	{
+		//the last band is cut short, the buffers keep their size
+		Buffer.Height = min(BandHeight, View->Height - FirstRow);
+
+		CpuRenderFrameRegion(Renderer, View, 0, FirstRow, &Buffer, &BandStats);
+		if (Palette)
+			ColorizePalette(Palette, &Buffer, Rgba, RowPitch);
+		else
+			ColorizeIterations(View, &Buffer, Rgba, RowPitch);
+		bOk = ImageWriterWriteRows(Writer, Rgba, Buffer.Height, RowPitch);
+
+		TotalIterations += BandStats.TotalIterations;
+		FilledPixels += BandStats.FilledPixels;
+		MirroredPixels += BandStats.MirroredPixels;
+		TileCount += BandStats.TileCount;
+		Steals += BandStats.Steals;
+
+		if (Progress)
+		{
+			struct PosterProgress Report;
+			Report.RowsDone = FirstRow + Buffer.Height;
+			Report.Height = View->Height;
+			Report.Seconds = GetTime() - StartTime;
+			Report.PixelsPerSecond = (double)Report.RowsDone * View->Width / Report.Seconds;
+			Report.EtaSeconds = Report.Seconds * (View->Height - Report.RowsDone) / Report.RowsDone;
+			Progress(Context, &Report);
+		}
+	}
+
+	bOk = ImageWriterClose(Writer) && bOk;
+
+	Buffer.Height = BandHeight;
+	IterationBufferRelease(&Buffer);
+	AlignedFree(Rgba);
+
+	if (Stats)
+	{
+		*Stats = BandStats;
+		Stats->Seconds = GetTime() - StartTime;
+		Stats->TotalIterations = TotalIterations;
+		Stats->FilledPixels = FilledPixels;
+		Stats->MirroredPixels = MirroredPixels;
+		Stats->TileCount = TileCount;
+		Stats->Steals = Steals;
+	}
+	return bOk;
+}
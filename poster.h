@@ -0,0 +1,54 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//renders images far bigger than memory, a band of rows at a time, straight
+//into an image file
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpurender.h"
+
+struct PosterSettings
+{
+	const char* Path;		//.png or .ppm, see ImageWriterOpen
+	size_t MemoryLimit;		//bytes the band buffers may take between them
+	bool bSmooth;			//colour with the smooth iteration fraction
+};
+
+struct PosterProgress
+{
+	uint32_t RowsDone;
+	uint32_t Height;
+	double Seconds;
+	double PixelsPerSecond;
+	double EtaSeconds;		//at the rate so far
+};
+
+//called after every band has been written
+typedef void (*PosterProgressCallback)(void* Context, const struct PosterProgress* restrict Progress);
+
+//the rows a band holds under Settings->MemoryLimit, a multiple of the tile size
+//where there is room for one. 0 if not even a single row fits
+uint32_t GetPosterBandHeight(const struct CpuRenderer* Renderer, const struct CpuView* restrict View, const struct PosterSettings* restrict Settings);
+
+//renders View a band at a time, colours each band through Palette, or like
+//ColorizeIterations if it is NULL, and appends it to the image. false if the image cannot be written or a row does not fit in
+//the memory limit. Stats covers the whole image
+bool CpuRenderPoster(struct CpuRenderer* Renderer, const struct CpuView* restrict View, const struct Palette* restrict Palette, const struct PosterSettings* restrict Settings, PosterProgressCallback Progress, void* Context, struct CpuRenderStats* restrict Stats);
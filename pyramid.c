@@ -0,0 +1,426 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <string.h>
+
+#include "pyramid.h"
+#include "imageio.h"
+#include "platform.h"
+
+#define PYRAMID_MAX_LEVELS 33
+#define PYRAMID_PATH_SIZE 1024
+
+struct PyramidLevel
+{
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t TilesX;
+	uint32_t TilesY;
+	uint8_t* Done;			//per tile, row major
+	uint8_t* Children;		//the up to four tiles under the one being built, NULL at the finest level
+};
+
+struct Pyramid
+{
+	struct CpuRenderer* Renderer;
+	const struct CpuView* View;
+	const struct Palette* Palette;
+	const char* Stem;
+	uint32_t LevelCount;
+	struct PyramidLevel Levels[PYRAMID_MAX_LEVELS];
+	struct IterationBuffer Region;	//2x2 finest tiles rendered at once
+	uint8_t* RegionRgba;
+	FILE* Manifest;
+	struct PyramidStats* Stats;
+};
+
+#define TILE_PITCH (PYRAMID_TILE_SIZE * 4)
+#define TILE_BYTES ((size_t)PYRAMID_TILE_SIZE * TILE_PITCH)
+
+//identifies the view and palette a manifest belongs to
+static void GetManifestHeader(const struct Pyramid* Pyramid, char* Header, size_t Size)
+{
+	const struct CpuView* View = Pyramid->View;
+	const struct Palette* Palette = Pyramid->Palette;
+
+	//ColorizeIterations has nothing to tell apart but the view
+	char Colouring[96] = "iterations";
+	if (Palette)
+	{
+		uint32_t Checksum = 0;
+		for (uint32_t i = 0; i < PALETTE_SIZE; i++)
+		{
+			Checksum = Checksum * 31 + Palette->Colors[i];
+		}
+		snprintf(Colouring, sizeof(Colouring), "%.17g %.17g %08x", Palette->CycleLength, Palette->Offset, Checksum);
+	}
+
+	snprintf(Header, Size, "pyramid %s %s %ux%u %u %.17g,%.17g,%.17g,%.17g %.17g,%.17g %s\n",
+		FractalFormulas[View->Set].Name,
+		View->Type == FRACTAL_TYPE_BASE ? "base" : "julia",
+		View->Width,
+		View->Height,
+		View->MaxIterations,
+		View->WindowPos[0], View->WindowPos[1], View->WindowPos[2], View->WindowPos[3],
+		View->JuliaPos[0], View->JuliaPos[1],
+		Colouring);
+}
+
+//marks the tiles an earlier run finished and opens the manifest to add to it
+static bool OpenManifest(struct Pyramid* Pyramid)
+{
+	char Path[PYRAMID_PATH_SIZE];
+	snprintf(Path, sizeof(Path), "%s_files/manifest.txt", Pyramid->Stem);
+
+	char Header[512];
+	GetManifestHeader(Pyramid, Header, sizeof(Header));
+
+	FILE* Existing = fopen(Path, "r");
+	if (Existing)
+	{
+		char Line[512];
+		if (fgets(Line, sizeof(Line), Existing) == NULL || strcmp(Line, Header) != 0)
+		{
+			fclose(Existing);
+			fprintf(stderr, "%s belongs to another view or palette\n", Path);
+			return false;
+		}
+
+		uint32_t Level;
+		uint32_t Column;
+		uint32_t Row;
+		while (fscanf(Existing, "%u %u %u", &Level, &Column, &Row) == 3)
+		{
+			if (Level < Pyramid->LevelCount && Column < Pyramid->Levels[Level].TilesX && Row < Pyramid->Levels[Level].TilesY)
+				Pyramid->Levels[Level].Done[(size_t)Row * Pyramid->Levels[Level].TilesX + Column] = 1;
+		}
+		fclose(Existing);
+	}
+
+	Pyramid->Manifest = fopen(Path, "a");
+	if (Pyramid->Manifest == NULL)
+		return false;
+	if (Existing == NULL)
+		fputs(Header, Pyramid->Manifest);
+	return fflush(Pyramid->Manifest) == 0;
+}
+
+static void GetTilePath(const struct Pyramid* Pyramid, uint32_t Level, uint32_t Column, uint32_t Row, char* Path, size_t Size)
+{
+	snprintf(Path, Size, "%s_files/%u/%u_%u.png", Pyramid->Stem, Level, Column, Row);
+}
+
+static void GetTileSize(const struct PyramidLevel* Level, uint32_t Column, uint32_t Row, uint32_t* restrict Width, uint32_t* restrict Height)
+{
+	*Width = min(PYRAMID_TILE_SIZE, Level->Width - Column * PYRAMID_TILE_SIZE);
+	*Height = min(PYRAMID_TILE_SIZE, Level->Height - Row * PYRAMID_TILE_SIZE);
+}
+
+//the manifest line only goes out once the tile is safely on disk
+static bool WriteTile(struct Pyramid* Pyramid, uint32_t Level, uint32_t Column, uint32_t Row, const uint8_t* Pixels)
+{
+	struct PyramidLevel* PyramidLevel = &Pyramid->Levels[Level];
+	uint32_t Width;
+	uint32_t Height;
+	GetTileSize(PyramidLevel, Column, Row, &Width, &Height);
+
+	char Path[PYRAMID_PATH_SIZE];
+	GetTilePath(Pyramid, Level, Column, Row, Path, sizeof(Path));
+	struct ImageWriter* Writer = ImageWriterOpen(Path, Width, Height);
+	if (Writer == NULL)
+		return false;
+	ImageWriterWriteRows(Writer, Pixels, Height, TILE_PITCH);
+	if (!ImageWriterClose(Writer))
+		return false;
+
+	PyramidLevel->Done[(size_t)Row * PyramidLevel->TilesX + Column] = 1;
+	fprintf(Pyramid->Manifest, "%u %u %u\n", Level, Column, Row);
+	return fflush(Pyramid->Manifest) == 0;
+}
+
+//Width x Height pixels of the finest level from (x, y) on, coloured
+static void RenderRegion(struct Pyramid* Pyramid, uint32_t x, uint32_t y, uint32_t Width, uint32_t Height)
+{
+	Pyramid->Region.Width = Width;
+	Pyramid->Region.Height = Height;
+
+	struct CpuRenderStats Stats;
+	CpuRenderFrameRegion(Pyramid->Renderer, Pyramid->View, x, y, &Pyramid->Region, &Stats);
+	if (Pyramid->Palette)
+		ColorizePalette(Pyramid->Palette, &Pyramid->Region, Pyramid->RegionRgba, (size_t)Width * 4);
+	else
+		ColorizeIterations(Pyramid->View, &Pyramid->Region, Pyramid->RegionRgba, (size_t)Width * 4);
+	Pyramid->Stats->TotalIterations += Stats.TotalIterations;
+}
+
+//the finest tiles under a tile of the level above, rendered as one region so
+//the renderer gets enough tiles to keep every thread busy
+static bool RenderChildren(struct Pyramid* Pyramid, uint32_t Level, uint32_t Column, uint32_t Row)
+{
+	const struct PyramidLevel* Finest = &Pyramid->Levels[Level + 1];
+	const uint32_t x = Column * 2 * PYRAMID_TILE_SIZE;
+	const uint32_t y = Row * 2 * PYRAMID_TILE_SIZE;
+	const uint32_t Width = min(2 * PYRAMID_TILE_SIZE, Finest->Width - x);
+	const uint32_t Height = min(2 * PYRAMID_TILE_SIZE, Finest->Height - y);
+	RenderRegion(Pyramid, x, y, Width, Height);
+
+	for (uint32_t Child = 0; Child < 4; Child++)
+	{
+		const uint32_t ChildColumn = Column * 2 + (Child & 1);
+		const uint32_t ChildRow = Row * 2 + (Child >> 1);
+		if (ChildColumn >= Finest->TilesX || ChildRow >= Finest->TilesY)
+			continue;
+
+		uint32_t ChildWidth;
+		uint32_t ChildHeight;
+		GetTileSize(Finest, ChildColumn, ChildRow, &ChildWidth, &ChildHeight);
+
+		uint8_t* Pixels = Pyramid->Levels[Level].Children + Child * TILE_BYTES;
+		const uint8_t* In = Pyramid->RegionRgba + ((size_t)(Child >> 1) * PYRAMID_TILE_SIZE * Width + (Child & 1) * PYRAMID_TILE_SIZE) * 4;
+		for (uint32_t i = 0; i < ChildHeight; i++)
+		{
+			memcpy(Pixels + i * TILE_PITCH, In + (size_t)i * Width * 4, (size_t)ChildWidth * 4);
+		}
+
+		if (!WriteTile(Pyramid, Level + 1, ChildColumn, ChildRow, Pixels))
+			return false;
+		Pyramid->Stats->RenderedTiles++;
+	}
+	return true;
+}
+
+//each pixel is the mean of the up to 2x2 pixels under it
+static void DownsampleChildren(const struct Pyramid* Pyramid, uint32_t Level, uint32_t Column, uint32_t Row, uint8_t* restrict Pixels)
+{
+	const struct PyramidLevel* Below = &Pyramid->Levels[Level + 1];
+	const uint8_t* Children = Pyramid->Levels[Level].Children;
+	uint32_t Width;
+	uint32_t Height;
+	GetTileSize(&Pyramid->Levels[Level], Column, Row, &Width, &Height);
+
+	//pixels of the level below, from the top left of this tile
+	const uint32_t BelowWidth = min(2 * PYRAMID_TILE_SIZE, Below->Width - Column * 2 * PYRAMID_TILE_SIZE);
+	const uint32_t BelowHeight = min(2 * PYRAMID_TILE_SIZE, Below->Height - Row * 2 * PYRAMID_TILE_SIZE);
+
+	for (uint32_t y = 0; y < Height; y++)
+	{
+		//whole 2x2 footprints, all four in one child
+		uint32_t x = 0;
+		if (y * 2 + 1 < BelowHeight)
+		{
+			const uint32_t Y = y * 2;
+			for (; x * 2 + 1 < BelowWidth; x++)
+			{
+				const uint32_t X = x * 2;
+				const uint32_t Child = (Y / PYRAMID_TILE_SIZE) * 2 + X / PYRAMID_TILE_SIZE;
+				const uint8_t* In = Children + Child * TILE_BYTES + (Y % PYRAMID_TILE_SIZE) * TILE_PITCH + (X % PYRAMID_TILE_SIZE) * 4;
+				uint8_t* Out = Pixels + y * TILE_PITCH + x * 4;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					Out[c] = (uint8_t)((In[c] + In[c + 4] + In[TILE_PITCH + c] + In[TILE_PITCH + c + 4] + 2) >> 2);
+				}
+			}
+		}
+
+		//the odd column or row at the edge of the level
+		for (; x < Width; x++)
+		{
+			uint32_t Sum[4] = { 0, 0, 0, 0 };
+			uint32_t Count = 0;
+			for (uint32_t Y = y * 2; Y < min(y * 2 + 2, BelowHeight); Y++)
+			{
+				for (uint32_t X = x * 2; X < min(x * 2 + 2, BelowWidth); X++)
+				{
+					const uint32_t Child = (Y / PYRAMID_TILE_SIZE) * 2 + X / PYRAMID_TILE_SIZE;
+					const uint8_t* In = Children + Child * TILE_BYTES + (Y % PYRAMID_TILE_SIZE) * TILE_PITCH + (X % PYRAMID_TILE_SIZE) * 4;
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						Sum[c] += In[c];
+					}
+					Count++;
+				}
+			}
+
+			uint8_t* Out = Pixels + y * TILE_PITCH + x * 4;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				Out[c] = (uint8_t)((Sum[c] + Count / 2) / Count);
+			}
+		}
+	}
+}
+
+//makes sure a tile is on disk, and leaves its pixels in Pixels when bNeedPixels
+static bool BuildTile(struct Pyramid* Pyramid, uint32_t Level, uint32_t Column, uint32_t Row, uint8_t* restrict Pixels, bool bNeedPixels)
+{
+	struct PyramidLevel* PyramidLevel = &Pyramid->Levels[Level];
+	uint32_t Width;
+	uint32_t Height;
+	GetTileSize(PyramidLevel, Column, Row, &Width, &Height);
+
+	if (PyramidLevel->Done[(size_t)Row * PyramidLevel->TilesX + Column])
+	{
+		Pyramid->Stats->ResumedTiles++;
+		if (!bNeedPixels)
+			return true;
+
+		char Path[PYRAMID_PATH_SIZE];
+		GetTilePath(Pyramid, Level, Column, Row, Path, sizeof(Path));
+		if (ReadStoredPng(Path, Pixels, Width, Height, TILE_PITCH))
+			return true;
+
+		//listed but unreadable, build it again
+		Pyramid->Stats->ResumedTiles--;
+	}
+
+	if (Level + 1 == Pyramid->LevelCount)
+	{
+		RenderRegion(Pyramid, Column * PYRAMID_TILE_SIZE, Row * PYRAMID_TILE_SIZE, Width, Height);
+		for (uint32_t i = 0; i < Height; i++)
+		{
+			memcpy(Pixels + i * TILE_PITCH, Pyramid->RegionRgba + (size_t)i * Width * 4, (size_t)Width * 4);
+		}
+		Pyramid->Stats->RenderedTiles++;
+		return WriteTile(Pyramid, Level, Column, Row, Pixels);
+	}
+
+	const struct PyramidLevel* Below = &Pyramid->Levels[Level + 1];
+	bool bAnyDone = false;
+	for (uint32_t Child = 0; Child < 4; Child++)
+	{
+		const uint32_t ChildColumn = Column * 2 + (Child & 1);
+		const uint32_t ChildRow = Row * 2 + (Child >> 1);
+		if (ChildColumn < Below->TilesX && ChildRow < Below->TilesY)
+			bAnyDone |= Below->Done[(size_t)ChildRow * Below->TilesX + ChildColumn] != 0;
+	}
+
+	if (Level + 2 == Pyramid->LevelCount && !bAnyDone)
+	{
+		if (!RenderChildren(Pyramid, Level, Column, Row))
+			return false;
+	}
+	else
+	{
+		for (uint32_t Child = 0; Child < 4; Child++)
+		{
+			const uint32_t ChildColumn = Column * 2 + (Child & 1);
+			const uint32_t ChildRow = Row * 2 + (Child >> 1);
+			if (ChildColumn >= Below->TilesX || ChildRow >= Below->TilesY)
+				continue;
+
+			if (!BuildTile(Pyramid, Level + 1, ChildColumn, ChildRow, PyramidLevel->Children + Child * TILE_BYTES, true))
+				return false;
+		}
+	}
+
+	DownsampleChildren(Pyramid, Level, Column, Row, Pixels);
+	Pyramid->Stats->DownsampledTiles++;
+	return WriteTile(Pyramid, Level, Column, Row, Pixels);
+}
+
+static bool WriteDescriptor(const struct Pyramid* Pyramid)
+{
+	char Path[PYRAMID_PATH_SIZE];
+	snprintf(Path, sizeof(Path), "%s.dzi", Pyramid->Stem);
+	FILE* File = fopen(Path, "w");
+	if (File == NULL)
+		return false;
+
+	fprintf(File,
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" TileSize=\"%u\" Overlap=\"0\" Format=\"png\">\n"
+		"\t<Size Width=\"%u\" Height=\"%u\"/>\n"
+		"</Image>\n",
+		PYRAMID_TILE_SIZE,
+		Pyramid->View->Width,
+		Pyramid->View->Height);
+	return fclose(File) == 0;
+}
+
+bool CpuRenderPyramid(struct CpuRenderer* Renderer, const struct CpuView* restrict View, const struct Palette* restrict Palette, const char* Stem, struct PyramidStats* restrict Stats)
+{
+	const double StartTime = GetTime();
+
+	struct PyramidStats LocalStats;
+	memset(&LocalStats, 0, sizeof(struct PyramidStats));
+
+	struct Pyramid Pyramid;
+	memset(&Pyramid, 0, sizeof(struct Pyramid));
+	Pyramid.Renderer = Renderer;
+	Pyramid.View = View;
+	Pyramid.Palette = Palette;
+	Pyramid.Stem = Stem;
+	Pyramid.Stats = &LocalStats;
+
+	//level 0 is a single pixel, each level doubles the one before up to the full size
+	uint32_t Largest = max(View->Width, View->Height);
+	Pyramid.LevelCount = 1;
+	while ((1ull << (Pyramid.LevelCount - 1)) < Largest)
+		Pyramid.LevelCount++;
+
+	uint32_t Width = View->Width;
+	uint32_t Height = View->Height;
+	for (uint32_t i = Pyramid.LevelCount; i-- > 0;)
+	{
+		struct PyramidLevel* Level = &Pyramid.Levels[i];
+		Level->Width = Width;
+		Level->Height = Height;
+		Level->TilesX = (Width + PYRAMID_TILE_SIZE - 1) / PYRAMID_TILE_SIZE;
+		Level->TilesY = (Height + PYRAMID_TILE_SIZE - 1) / PYRAMID_TILE_SIZE;
+		Level->Done = calloc((size_t)Level->TilesX * Level->TilesY, 1);
+		CHECK_ALLOC(Level->Done);
+		Level->Children = i + 1 < Pyramid.LevelCount ? AlignedAlloc(4 * TILE_BYTES, 64) : NULL;
+		Width = (Width + 1) / 2;
+		Height = (Height + 1) / 2;
+	}
+
+	IterationBufferInit(&Pyramid.Region, 2 * PYRAMID_TILE_SIZE, 2 * PYRAMID_TILE_SIZE);
+	Pyramid.RegionRgba = AlignedAlloc(4 * TILE_BYTES, 64);
+	uint8_t* Root = AlignedAlloc(TILE_BYTES, 64);
+
+	char Path[PYRAMID_PATH_SIZE];
+	snprintf(Path, sizeof(Path), "%s_files", Stem);
+	bool bOk = MakeDirectory(Path);
+	for (uint32_t i = 0; i < Pyramid.LevelCount && bOk; i++)
+	{
+		snprintf(Path, sizeof(Path), "%s_files/%u", Stem, i);
+		bOk = MakeDirectory(Path);
+	}
+
+	bOk = bOk && OpenManifest(&Pyramid);
+	bOk = bOk && BuildTile(&Pyramid, 0, 0, 0, Root, false);
+	bOk = bOk && WriteDescriptor(&Pyramid);
+
+	if (Pyramid.Manifest)
+		fclose(Pyramid.Manifest);
+	Pyramid.Region.Width = 2 * PYRAMID_TILE_SIZE;
+	Pyramid.Region.Height = 2 * PYRAMID_TILE_SIZE;
+	IterationBufferRelease(&Pyramid.Region);
+	AlignedFree(Pyramid.RegionRgba);
+	AlignedFree(Root);
+	for (uint32_t i = 0; i < Pyramid.LevelCount; i++)
+	{
+		free(Pyramid.Levels[i].Done);
+		if (Pyramid.Levels[i].Children)
+			AlignedFree(Pyramid.Levels[i].Children);
+	}
+
+	LocalStats.Seconds = GetTime() - StartTime;
+	LocalStats.LevelCount = Pyramid.LevelCount;
+	if (Stats)
+		*Stats = LocalStats;
+	return bOk;
+}
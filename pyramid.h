@@ -0,0 +1,45 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//deep zoom image (dzi) pyramids. only the finest level is rendered, every
+//coarser tile is the 2x2 downsample of the four tiles under it, and a manifest
+//of finished tiles lets an interrupted run carry on where it stopped
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpurender.h"
+
+#define PYRAMID_TILE_SIZE 256
+
+struct PyramidStats
+{
+	double Seconds;
+	uint64_t TotalIterations;
+	uint32_t LevelCount;
+	uint64_t RenderedTiles;		//finest level tiles iterated
+	uint64_t DownsampledTiles;	//coarser tiles built from the ones below them
+	uint64_t ResumedTiles;		//tiles the manifest already had
+};
+
+//writes View coloured through Palette, or like ColorizeIterations if it is NULL,
+//as Stem.dzi and Stem_files/<level>/<column>_<row>.png, with Stem_files/manifest.txt
+//listing the tiles done so far. a manifest left by a run of another view or
+//palette is an error, not overwritten
+bool CpuRenderPyramid(struct CpuRenderer* Renderer, const struct CpuView* restrict View, const struct Palette* restrict Palette, const char* Stem, struct PyramidStats* restrict Stats);
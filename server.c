@@ -0,0 +1,690 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+#include <string.h>
+#include <math.h>
+
+#include "server.h"
+#include "deepzoom.h"
+#include "imageio.h"
+#include "platform.h"
+
+#ifdef _WIN32
+typedef SOCKET Socket;
+#define SOCKET_INVALID INVALID_SOCKET
+#define SEND_FLAGS 0
+static void CloseSocket(Socket Connection) { closesocket(Connection); }
+#else
+typedef int Socket;
+#define SOCKET_INVALID (-1)
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+static void CloseSocket(Socket Connection) { close(Connection); }
+#endif
+
+#define DEFAULT_HANDLER_COUNT 256
+#define CONNECTION_QUEUE_SIZE 1024
+#define REQUEST_SIZE 4096
+#define SOCKET_TIMEOUT_MS 5000
+#define CACHE_BUCKET_COUNT (1 << 14)
+
+//latency bucket i counts requests answered in under 2^i ms, the last one the rest
+#define LATENCY_BUCKET_COUNT 16
+
+enum TileOutcome
+{
+	TILE_OUTCOME_HIT,		//the png was in the cache
+	TILE_OUTCOME_COALESCED,	//waited on a render another request had started
+	TILE_OUTCOME_RENDERED,
+	TILE_OUTCOME_COUNT
+};
+
+static const char* const TileOutcomeNames[TILE_OUTCOME_COUNT] = {
+	"hit",
+	"coalesced",
+	"rendered"
+};
+
+struct TileKey
+{
+	enum FractalSet Set;
+	enum FractalType Type;
+	uint32_t Zoom;
+	uint64_t X;
+	uint64_t Y;
+};
+
+//a finished png. the cache holds one reference and every response being sent another
+struct TileData
+{
+	volatile int32_t References;
+	size_t Size;
+	uint8_t Bytes[];
+};
+
+struct CacheEntry
+{
+	struct TileKey Key;
+	struct TileData* Data;		//NULL while the tile is being rendered
+	uint32_t Pins;				//requests waiting on the entry, which keep it from being evicted
+	struct CacheEntry* NextInBucket;
+	struct CacheEntry* Newer;	//lru list of finished entries
+	struct CacheEntry* Older;
+};
+
+struct TileServer
+{
+	struct CpuRenderer* Renderer;
+	const struct TileServerSettings* Settings;
+
+	//cache, guarded by CacheMutex. RenderDone is broadcast whenever a render finishes
+	PlatformMutex CacheMutex;
+	PlatformCondition RenderDone;
+	struct CacheEntry* Buckets[CACHE_BUCKET_COUNT];
+	struct CacheEntry* Newest;
+	struct CacheEntry* Oldest;
+	size_t MemoryUsed;
+	uint32_t TileCount;
+	uint32_t PendingRenders;	//entries without Data
+	uint32_t MaxPendingRenders;	//beyond this new tiles are turned away, so cached ones keep handlers free
+	uint64_t Evictions;
+
+	//the renderer does one frame at a time
+	PlatformMutex RenderMutex;
+	struct DeepView* DeepView;
+	struct IterationBuffer Buffer;
+	uint8_t* Rgba;
+
+	//accepted connections waiting for a handler
+	PlatformMutex QueueMutex;
+	PlatformCondition QueueReady;
+	Socket Queue[CONNECTION_QUEUE_SIZE];
+	uint32_t QueueHead;
+	uint32_t QueueCount;
+
+	volatile int64_t Outcomes[TILE_OUTCOME_COUNT];
+	volatile int64_t Latency[TILE_OUTCOME_COUNT][LATENCY_BUCKET_COUNT];
+	volatile int64_t Rejected;		//turned away with 503
+	volatile int64_t NotFound;
+	volatile int64_t Dropped;		//connections closed because the queue was full
+	volatile int64_t RenderMicroseconds;
+	double StartTime;
+};
+
+static uint32_t GetKeyBucket(const struct TileKey* restrict Key)
+{
+	//splitmix64 finaliser over the packed key
+	uint64_t Hash = Key->X * 0x9E3779B97F4A7C15ull ^ (Key->Y + ((uint64_t)Key->Zoom << 58) + ((uint64_t)Key->Set << 48) + ((uint64_t)Key->Type << 52));
+	Hash = (Hash ^ (Hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+	Hash = (Hash ^ (Hash >> 27)) * 0x94D049BB133111EBull;
+	return (uint32_t)(Hash ^ (Hash >> 31)) & (CACHE_BUCKET_COUNT - 1);
+}
+
+static bool IsSameKey(const struct TileKey* restrict a, const struct TileKey* restrict b)
+{
+	return a->Set == b->Set && a->Type == b->Type && a->Zoom == b->Zoom && a->X == b->X && a->Y == b->Y;
+}
+
+static void ReleaseTileData(struct TileData* Data)
+{
+	if (AtomicAdd32(&Data->References, -1) == 1)
+		free(Data);
+}
+
+static void UnlinkLru(struct TileServer* Server, struct CacheEntry* Entry)
+{
+	if (Entry->Newer)
+		Entry->Newer->Older = Entry->Older;
+	else
+		Server->Newest = Entry->Older;
+	if (Entry->Older)
+		Entry->Older->Newer = Entry->Newer;
+	else
+		Server->Oldest = Entry->Newer;
+	Entry->Newer = NULL;
+	Entry->Older = NULL;
+}
+
+static void PushLru(struct TileServer* Server, struct CacheEntry* Entry)
+{
+	Entry->Older = Server->Newest;
+	Entry->Newer = NULL;
+	if (Server->Newest)
+		Server->Newest->Newer = Entry;
+	else
+		Server->Oldest = Entry;
+	Server->Newest = Entry;
+}
+
+static size_t GetEntrySize(const struct CacheEntry* Entry)
+{
+	return sizeof(struct CacheEntry) + sizeof(struct TileData) + Entry->Data->Size;
+}
+
+//drops the least recently used finished tiles until the cache is within budget.
+//pinned entries are skipped, a request is about to take their data
+static void EvictTiles(struct TileServer* Server)
+{
+	struct CacheEntry* Entry = Server->Oldest;
+	while (Entry != NULL && Server->MemoryUsed > Server->Settings->CacheBudget)
+	{
+		struct CacheEntry* Newer = Entry->Newer;
+		if (Entry->Pins == 0)
+		{
+			struct CacheEntry** Link = &Server->Buckets[GetKeyBucket(&Entry->Key)];
+			while (*Link != Entry)
+			{
+				Link = &(*Link)->NextInBucket;
+			}
+			*Link = Entry->NextInBucket;
+
+			UnlinkLru(Server, Entry);
+			Server->MemoryUsed -= GetEntrySize(Entry);
+			Server->TileCount--;
+			Server->Evictions++;
+			ReleaseTileData(Entry->Data);
+			free(Entry);
+		}
+		Entry = Newer;
+	}
+}
+
+//the window of tile (Key->X, Key->Y), on the quadtree over the default view of the set
+static void GetTileView(const struct TileServer* Server, const struct TileKey* restrict Key, struct CpuView* restrict View)
+{
+	CpuViewSetDefault(View, Key->Set, Key->Type, TILE_SERVER_TILE_SIZE, TILE_SERVER_TILE_SIZE);
+	View->MaxIterations = Server->Settings->MaxIterations;
+	View->JuliaPos[0] = Server->Settings->JuliaPos[0];
+	View->JuliaPos[1] = Server->Settings->JuliaPos[1];
+
+	const double RootSide = max(View->WindowPos[0], View->WindowPos[1]);
+	const double RootLeft = View->WindowPos[2] - RootSide * 0.5;
+	const double RootTop = -View->WindowPos[3] - RootSide * 0.5;	//grid row 0, see CpuViewGetPixelGrid
+	const double Side = ldexp(RootSide, -(int)Key->Zoom);
+
+	View->WindowPos[0] = Side;
+	View->WindowPos[1] = Side;
+	View->WindowPos[2] = RootLeft + ((double)Key->X + 0.5) * Side;
+	View->WindowPos[3] = -(RootTop + ((double)Key->Y + 0.5) * Side);
+}
+
+static struct TileData* RenderTile(struct TileServer* Server, const struct TileKey* restrict Key)
+{
+	struct CpuView View;
+	GetTileView(Server, Key, &View);
+
+	MutexLock(&Server->RenderMutex);
+
+	DeepViewFromCpuView(Server->DeepView, &View);
+	const enum PrecisionTier Tier = SelectPrecisionTier(Server->DeepView);
+	struct CpuRenderStats Stats;
+	CpuRenderTierFrame(Server->Renderer, Server->DeepView, Tier, &Server->Buffer, &Stats, NULL);
+	if (Server->Buffer.Fractions && Stats.Tier != PRECISION_TIER_FLOAT)
+		IterationBufferClearFractions(&Server->Buffer);
+
+	const size_t RowPitch = TILE_SERVER_TILE_SIZE * 4;
+	ColorizePalette(Server->Settings->Palette, &Server->Buffer, Server->Rgba, RowPitch);
+
+	struct ImageWriter* Writer = ImageWriterOpenMemory(TILE_SERVER_TILE_SIZE, TILE_SERVER_TILE_SIZE);
+	ImageWriterWriteRows(Writer, Server->Rgba, TILE_SERVER_TILE_SIZE, RowPitch);
+	size_t Size;
+	uint8_t* Png = ImageWriterCloseMemory(Writer, &Size);
+	CHECK_ALLOC(Png);
+
+	MutexUnlock(&Server->RenderMutex);
+
+	struct TileData* Data = malloc(sizeof(struct TileData) + Size);
+	CHECK_ALLOC(Data);
+	Data->References = 1;
+	Data->Size = Size;
+	memcpy(Data->Bytes, Png, Size);
+	free(Png);
+
+	AtomicAdd64(&Server->RenderMicroseconds, (int64_t)(Stats.Seconds * 1e6));
+	return Data;
+}
+
+//returns a reference to the tile's png, or NULL when too many renders are queued
+//already. only one request renders a given tile, any others asking for it meanwhile wait for it
+static struct TileData* GetTile(struct TileServer* Server, const struct TileKey* restrict Key, enum TileOutcome* restrict Outcome)
+{
+	MutexLock(&Server->CacheMutex);
+
+	const uint32_t Bucket = GetKeyBucket(Key);
+	struct CacheEntry* Entry = Server->Buckets[Bucket];
+	while (Entry != NULL && !IsSameKey(&Entry->Key, Key))
+	{
+		Entry = Entry->NextInBucket;
+	}
+
+	if (Entry != NULL && Entry->Data != NULL)
+	{
+		UnlinkLru(Server, Entry);
+		PushLru(Server, Entry);
+		struct TileData* Data = Entry->Data;
+		AtomicAdd32(&Data->References, 1);
+		MutexUnlock(&Server->CacheMutex);
+		*Outcome = TILE_OUTCOME_HIT;
+		return Data;
+	}
+
+	if (Entry != NULL)
+	{
+		Entry->Pins++;
+		while (Entry->Data == NULL)
+		{
+			ConditionWait(&Server->RenderDone, &Server->CacheMutex);
+		}
+		Entry->Pins--;
+		struct TileData* Data = Entry->Data;
+		AtomicAdd32(&Data->References, 1);
+		MutexUnlock(&Server->CacheMutex);
+		*Outcome = TILE_OUTCOME_COALESCED;
+		return Data;
+	}
+
+	if (Server->PendingRenders >= Server->MaxPendingRenders)
+	{
+		MutexUnlock(&Server->CacheMutex);
+		return NULL;
+	}
+
+	Entry = calloc(1, sizeof(struct CacheEntry));
+	CHECK_ALLOC(Entry);
+	Entry->Key = *Key;
+	Entry->Pins = 1;
+	Entry->NextInBucket = Server->Buckets[Bucket];
+	Server->Buckets[Bucket] = Entry;
+	Server->PendingRenders++;
+	MutexUnlock(&Server->CacheMutex);
+
+	struct TileData* Data = RenderTile(Server, Key);
+
+	MutexLock(&Server->CacheMutex);
+	Entry->Data = Data;
+	Entry->Pins--;
+	AtomicAdd32(&Data->References, 1);
+	Server->PendingRenders--;
+	Server->TileCount++;
+	Server->MemoryUsed += GetEntrySize(Entry);
+	PushLru(Server, Entry);
+	EvictTiles(Server);
+	ConditionBroadcast(&Server->RenderDone);
+	MutexUnlock(&Server->CacheMutex);
+
+	*Outcome = TILE_OUTCOME_RENDERED;
+	return Data;
+}
+
+static bool SendAll(Socket Connection, const void* Data, size_t Size)
+{
+	const char* Bytes = Data;
+	while (Size != 0)
+	{
+		const int Chunk = (int)min(Size, (size_t)1 << 20);
+		const int Sent = send(Connection, Bytes, Chunk, SEND_FLAGS);
+		if (Sent <= 0)
+			return false;
+		Bytes += Sent;
+		Size -= (size_t)Sent;
+	}
+	return true;
+}
+
+static void SendResponse(Socket Connection, const char* Status, const char* ContentType, const void* Body, size_t Size)
+{
+	char Header[256];
+	const int HeaderSize = snprintf(Header, sizeof(Header),
+		"HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n%sConnection: close\r\n\r\n",
+		Status,
+		ContentType,
+		Size,
+		strcmp(Status, "503 Service Unavailable") == 0 ? "Retry-After: 1\r\n" : "");
+	if (SendAll(Connection, Header, (size_t)HeaderSize))
+		SendAll(Connection, Body, Size);
+}
+
+static void SendText(Socket Connection, const char* Status, const char* Text)
+{
+	SendResponse(Connection, Status, "text/plain", Text, strlen(Text));
+}
+
+static void SendStats(struct TileServer* Server, Socket Connection)
+{
+	MutexLock(&Server->CacheMutex);
+	const uint32_t TileCount = Server->TileCount;
+	const size_t MemoryUsed = Server->MemoryUsed;
+	const uint32_t PendingRenders = Server->PendingRenders;
+	const uint64_t Evictions = Server->Evictions;
+	MutexUnlock(&Server->CacheMutex);
+
+	int64_t Outcomes[TILE_OUTCOME_COUNT];
+	int64_t Requests = 0;
+	for (int i = 0; i < TILE_OUTCOME_COUNT; i++)
+	{
+		Outcomes[i] = AtomicAdd64(&Server->Outcomes[i], 0);
+		Requests += Outcomes[i];
+	}
+	const int64_t Rendered = Outcomes[TILE_OUTCOME_RENDERED];
+
+	char Text[4096];
+	int Length = snprintf(Text, sizeof(Text),
+		"uptime %.0f s\n"
+		"tiles served %lld: %lld hits, %lld coalesced, %lld rendered, hit rate %.1f%%\n"
+		"rejected %lld, not found %lld, connections dropped %lld\n"
+		"cache %u tiles, %.1f of %.1f MB, %llu evictions, %u renders in flight\n"
+		"mean render %.2f ms\n"
+		"latency  ",
+		GetTime() - Server->StartTime,
+		(long long)Requests,
+		(long long)Outcomes[TILE_OUTCOME_HIT],
+		(long long)Outcomes[TILE_OUTCOME_COALESCED],
+		(long long)Rendered,
+		Requests != 0 ? (Outcomes[TILE_OUTCOME_HIT] + Outcomes[TILE_OUTCOME_COALESCED]) * 100.0 / Requests : 0.0,
+		(long long)AtomicAdd64(&Server->Rejected, 0),
+		(long long)AtomicAdd64(&Server->NotFound, 0),
+		(long long)AtomicAdd64(&Server->Dropped, 0),
+		TileCount,
+		MemoryUsed / 1048576.0,
+		Server->Settings->CacheBudget / 1048576.0,
+		(unsigned long long)Evictions,
+		PendingRenders,
+		Rendered != 0 ? AtomicAdd64(&Server->RenderMicroseconds, 0) * 1e-3 / Rendered : 0.0);
+
+	for (int i = 0; i < TILE_OUTCOME_COUNT; i++)
+	{
+		Length += snprintf(Text + Length, sizeof(Text) - Length, "%10s", TileOutcomeNames[i]);
+	}
+	for (int Bucket = 0; Bucket < LATENCY_BUCKET_COUNT; Bucket++)
+	{
+		if (Bucket == LATENCY_BUCKET_COUNT - 1)
+			Length += snprintf(Text + Length, sizeof(Text) - Length, "\n>=%-5u ms", 1u << (Bucket - 1));
+		else
+			Length += snprintf(Text + Length, sizeof(Text) - Length, "\n<%-6u ms", 1u << Bucket);
+		for (int i = 0; i < TILE_OUTCOME_COUNT; i++)
+		{
+			Length += snprintf(Text + Length, sizeof(Text) - Length, "%10lld", (long long)AtomicAdd64(&Server->Latency[i][Bucket], 0));
+		}
+	}
+	snprintf(Text + Length, sizeof(Text) - Length, "\n");
+
+	SendText(Connection, "200 OK", Text);
+}
+
+static bool ParseNumber(const char** restrict Cursor, uint64_t* restrict Value)
+{
+	const char* Start = *Cursor;
+	uint64_t Number = 0;
+	while (**Cursor >= '0' && **Cursor <= '9' && *Cursor - Start < 19)
+	{
+		Number = Number * 10 + (uint64_t)(**Cursor - '0');
+		(*Cursor)++;
+	}
+	*Value = Number;
+	return *Cursor != Start;
+}
+
+//Path is /{set}/{type}/{z}/{x}/{y} with an optional .png
+static bool ParseTilePath(const char* Path, struct TileKey* restrict Key)
+{
+	if (*Path++ != '/')
+		return false;
+
+	const char* Slash = strchr(Path, '/');
+	if (Slash == NULL)
+		return false;
+	int Set = 0;
+	while (Set < FRACTAL_SET_COUNT && (strlen(FractalFormulas[Set].Name) != (size_t)(Slash - Path) || strncmp(Path, FractalFormulas[Set].Name, Slash - Path) != 0))
+	{
+		Set++;
+	}
+	if (Set == FRACTAL_SET_COUNT)
+		return false;
+	Key->Set = (enum FractalSet)Set;
+
+	Path = Slash + 1;
+	if (strncmp(Path, "base/", 5) == 0)
+		Key->Type = FRACTAL_TYPE_BASE;
+	else if (strncmp(Path, "julia/", 6) == 0)
+		Key->Type = FRACTAL_TYPE_JULIA;
+	else
+		return false;
+	Path = strchr(Path, '/') + 1;
+
+	uint64_t Zoom;
+	if (!ParseNumber(&Path, &Zoom) || *Path++ != '/' || Zoom > TILE_SERVER_MAX_ZOOM)
+		return false;
+	Key->Zoom = (uint32_t)Zoom;
+	if (!ParseNumber(&Path, &Key->X) || *Path++ != '/' || !ParseNumber(&Path, &Key->Y))
+		return false;
+	if (strcmp(Path, ".png") != 0 && *Path != '\0')
+		return false;
+
+	return Key->X < (1ull << Zoom) && Key->Y < (1ull << Zoom);
+}
+
+static void RecordLatency(struct TileServer* Server, enum TileOutcome Outcome, double Seconds)
+{
+	int Bucket = 0;
+	while (Bucket < LATENCY_BUCKET_COUNT - 1 && Seconds * 1e3 >= (double)(1u << Bucket))
+	{
+		Bucket++;
+	}
+	AtomicAdd64(&Server->Outcomes[Outcome], 1);
+	AtomicAdd64(&Server->Latency[Outcome][Bucket], 1);
+}
+
+static void ServeConnection(struct TileServer* Server, Socket Connection)
+{
+	const double StartTime = GetTime();
+
+	//the request line and headers, the body of a GET is ignored
+	char Request[REQUEST_SIZE];
+	size_t Size = 0;
+	while (Size < sizeof(Request) - 1)
+	{
+		const int Received = recv(Connection, Request + Size, (int)(sizeof(Request) - 1 - Size), 0);
+		if (Received <= 0)
+			return;
+		Size += (size_t)Received;
+		Request[Size] = '\0';
+		if (strstr(Request, "\r\n\r\n") != NULL)
+			break;
+	}
+	Request[Size] = '\0';
+
+	char* Path = strchr(Request, ' ');
+	char* PathEnd = Path ? strchr(Path + 1, ' ') : NULL;
+	if (PathEnd == NULL)
+	{
+		SendText(Connection, "400 Bad Request", "bad request\n");
+		return;
+	}
+	Path++;
+	*PathEnd = '\0';
+	char* Query = strchr(Path, '?');
+	if (Query)
+		*Query = '\0';
+
+	if (strncmp(Request, "GET ", 4) != 0)
+	{
+		SendText(Connection, "405 Method Not Allowed", "only GET is served\n");
+		return;
+	}
+
+	if (strcmp(Path, "/stats") == 0)
+	{
+		SendStats(Server, Connection);
+		return;
+	}
+
+	struct TileKey Key;
+	if (!ParseTilePath(Path, &Key))
+	{
+		AtomicAdd64(&Server->NotFound, 1);
+		SendText(Connection, "404 Not Found", "tiles are at /{set}/{base|julia}/{z}/{x}/{y}.png, stats at /stats\n");
+		return;
+	}
+
+	enum TileOutcome Outcome;
+	struct TileData* Data = GetTile(Server, &Key, &Outcome);
+	if (Data == NULL)
+	{
+		AtomicAdd64(&Server->Rejected, 1);
+		SendText(Connection, "503 Service Unavailable", "too many tiles rendering\n");
+		return;
+	}
+
+	SendResponse(Connection, "200 OK", "image/png", Data->Bytes, Data->Size);
+	ReleaseTileData(Data);
+	RecordLatency(Server, Outcome, GetTime() - StartTime);
+}
+
+static void SetSocketTimeout(Socket Connection)
+{
+#ifdef _WIN32
+	const DWORD Timeout = SOCKET_TIMEOUT_MS;
+#else
+	const struct timeval Timeout = { SOCKET_TIMEOUT_MS / 1000, (SOCKET_TIMEOUT_MS % 1000) * 1000 };
+#endif
+	setsockopt(Connection, SOL_SOCKET, SO_RCVTIMEO, (const char*)&Timeout, sizeof(Timeout));
+	setsockopt(Connection, SOL_SOCKET, SO_SNDTIMEO, (const char*)&Timeout, sizeof(Timeout));
+}
+
+static void HandlerThread(void* Context)
+{
+	struct TileServer* Server = Context;
+	for (;;)
+	{
+		MutexLock(&Server->QueueMutex);
+		while (Server->QueueCount == 0)
+		{
+			ConditionWait(&Server->QueueReady, &Server->QueueMutex);
+		}
+		const Socket Connection = Server->Queue[Server->QueueHead];
+		Server->QueueHead = (Server->QueueHead + 1) % CONNECTION_QUEUE_SIZE;
+		Server->QueueCount--;
+		MutexUnlock(&Server->QueueMutex);
+
+		SetSocketTimeout(Connection);
+		ServeConnection(Server, Connection);
+		CloseSocket(Connection);
+	}
+}
+
+static Socket OpenListener(uint16_t Port)
+{
+#ifdef _WIN32
+	WSADATA WsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &WsaData) != 0)
+		return SOCKET_INVALID;
+#endif
+
+	Socket Listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (Listener == SOCKET_INVALID)
+		return SOCKET_INVALID;
+
+	const int bReuse = 1;
+	setsockopt(Listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&bReuse, sizeof(bReuse));
+
+	struct sockaddr_in Address;
+	memset(&Address, 0, sizeof(Address));
+	Address.sin_family = AF_INET;
+	Address.sin_port = htons(Port);
+	Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(Listener, (struct sockaddr*)&Address, sizeof(Address)) != 0 || listen(Listener, SOMAXCONN) != 0)
+	{
+		CloseSocket(Listener);
+		return SOCKET_INVALID;
+	}
+	return Listener;
+}
+
+bool TileServerRun(struct CpuRenderer* Renderer, const struct TileServerSettings* restrict Settings)
+{
+	const Socket Listener = OpenListener(Settings->Port);
+	if (Listener == SOCKET_INVALID)
+		return false;
+
+	struct TileServer* Server = calloc(1, sizeof(struct TileServer));
+	CHECK_ALLOC(Server);
+	Server->Renderer = Renderer;
+	Server->Settings = Settings;
+	Server->StartTime = GetTime();
+
+	const uint32_t HandlerCount = Settings->HandlerCount != 0 ? Settings->HandlerCount : DEFAULT_HANDLER_COUNT;
+	Server->MaxPendingRenders = max(HandlerCount - HandlerCount / 4, 1u);
+
+	MutexInit(&Server->CacheMutex);
+	ConditionInit(&Server->RenderDone);
+	MutexInit(&Server->RenderMutex);
+	MutexInit(&Server->QueueMutex);
+	ConditionInit(&Server->QueueReady);
+
+	Server->DeepView = malloc(sizeof(struct DeepView));
+	CHECK_ALLOC(Server->DeepView);
+	IterationBufferInit(&Server->Buffer, TILE_SERVER_TILE_SIZE, TILE_SERVER_TILE_SIZE);
+	if (Settings->bSmooth)
+		IterationBufferAddFractions(&Server->Buffer);
+	Server->Rgba = malloc((size_t)TILE_SERVER_TILE_SIZE * TILE_SERVER_TILE_SIZE * 4);
+	CHECK_ALLOC(Server->Rgba);
+
+	//handlers live as long as the process, like the server
+	for (uint32_t i = 0; i < HandlerCount; i++)
+	{
+		ThreadCreate(HandlerThread, Server);
+	}
+
+	for (;;)
+	{
+		const Socket Connection = accept(Listener, NULL, NULL);
+		if (Connection == SOCKET_INVALID)
+			continue;
+
+		const int bNoDelay = 1;
+		setsockopt(Connection, IPPROTO_TCP, TCP_NODELAY, (const char*)&bNoDelay, sizeof(bNoDelay));
+
+		MutexLock(&Server->QueueMutex);
+		const bool bQueued = Server->QueueCount < CONNECTION_QUEUE_SIZE;
+		if (bQueued)
+		{
+			Server->Queue[(Server->QueueHead + Server->QueueCount) % CONNECTION_QUEUE_SIZE] = Connection;
+			Server->QueueCount++;
+			ConditionSignal(&Server->QueueReady);
+		}
+		MutexUnlock(&Server->QueueMutex);
+
+		if (!bQueued)
+		{
+			AtomicAdd64(&Server->Dropped, 1);
+			CloseSocket(Connection);
+		}
+	}
+}
@@ -0,0 +1,49 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//local http tile server. GET /{set}/{type}/{z}/{x}/{y}.png answers with a
+//256 pixel png of a quadtree over the default view: zoom 0 is one tile covering
+//a square the width of the default window, each zoom splits every tile in four,
+//x runs right and y down. tiles are kept as finished pngs in an lru cache,
+//requests for a tile already being rendered wait for that render instead of
+//starting another, and GET /stats reports hit rates and latency histograms
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpurender.h"
+
+#define TILE_SERVER_TILE_SIZE 256
+
+//tile centres are doubles, at this zoom a pixel is still some 32 ulps of the plane across
+#define TILE_SERVER_MAX_ZOOM 40
+
+struct TileServerSettings
+{
+	uint16_t Port;				//listens on 127.0.0.1 only
+	uint32_t HandlerCount;		//connections served at once, 0 for 256
+	size_t CacheBudget;			//bytes of png kept
+	uint32_t MaxIterations;
+	double JuliaPos[2];
+	bool bSmooth;
+	const struct Palette* Palette;
+};
+
+//serves until the process is ended, false if the port cannot be listened on.
+//each tile is iterated in the cheapest precision tier that resolves it
+bool TileServerRun(struct CpuRenderer* Renderer, const struct TileServerSettings* restrict Settings);
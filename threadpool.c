@@ -0,0 +1,286 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "threadpool.h"
+#include "platform.h"
+
+struct ThreadPoolWorker
+{
+	struct ThreadPool* Pool;
+	uint32_t ThreadIndex;
+
+	//tasks [Next, End) of a ThreadPoolRunStealing this thread still owns
+	PlatformMutex RangeMutex;
+	uint32_t Next;
+	uint32_t End;
+};
+
+struct ThreadPool
+{
+	uint32_t ThreadCount;
+	PlatformThread* Threads;
+	struct ThreadPoolWorker* Workers;
+
+	PlatformMutex Mutex;
+	PlatformCondition WorkAvailable;
+	PlatformCondition WorkFinished;
+	uint64_t Generation;
+	uint32_t BusyWorkers;
+	bool bShutdown;
+
+	ThreadPoolTask Task;
+	void* Context;
+	uint32_t TaskCount;
+	volatile int32_t NextTask;
+	bool bStealing;
+	volatile int32_t Steals;
+};
+
+static void ThreadPoolDrain(struct ThreadPool* Pool, uint32_t ThreadIndex)
+{
+	for (;;)
+	{
+		int32_t TaskIndex = AtomicAdd32(&Pool->NextTask, 1);
+		if (TaskIndex >= (int32_t)Pool->TaskCount)
+			break;
+
+		Pool->Task(Pool->Context, (uint32_t)TaskIndex, ThreadIndex);
+	}
+}
+
+//moves the back half of the fullest range another thread owns over to ThreadIndex,
+//returns false once every range is empty
+static bool ThreadPoolSteal(struct ThreadPool* Pool, uint32_t ThreadIndex)
+{
+	for (;;)
+	{
+		uint32_t Victim = 0;
+		uint32_t Largest = 0;
+		for (uint32_t i = 0; i < Pool->ThreadCount; i++)
+		{
+			if (i == ThreadIndex)
+				continue;
+
+			struct ThreadPoolWorker* Worker = &Pool->Workers[i];
+			MutexLock(&Worker->RangeMutex);
+			const uint32_t Remaining = Worker->End - Worker->Next;
+			MutexUnlock(&Worker->RangeMutex);
+
+			if (Remaining > Largest)
+			{
+				Victim = i;
+				Largest = Remaining;
+			}
+		}
+
+		if (Largest == 0)
+			return false;
+
+		//the owner may have got through it in the meantime, then look again
+		struct ThreadPoolWorker* Worker = &Pool->Workers[Victim];
+		MutexLock(&Worker->RangeMutex);
+		const uint32_t Remaining = Worker->End - Worker->Next;
+		const uint32_t Taken = (Remaining + 1) / 2;
+		const uint32_t End = Worker->End;
+		Worker->End -= Taken;
+		MutexUnlock(&Worker->RangeMutex);
+
+		if (Taken == 0)
+			continue;
+
+		struct ThreadPoolWorker* Thief = &Pool->Workers[ThreadIndex];
+		MutexLock(&Thief->RangeMutex);
+		Thief->Next = End - Taken;
+		Thief->End = End;
+		MutexUnlock(&Thief->RangeMutex);
+
+		AtomicAdd32(&Pool->Steals, 1);
+		return true;
+	}
+}
+
+static void ThreadPoolDrainStealing(struct ThreadPool* Pool, uint32_t ThreadIndex)
+{
+	struct ThreadPoolWorker* Worker = &Pool->Workers[ThreadIndex];
+	for (;;)
+	{
+		MutexLock(&Worker->RangeMutex);
+		const uint32_t TaskIndex = Worker->Next;
+		const bool bOwned = TaskIndex < Worker->End;
+		if (bOwned)
+			Worker->Next++;
+		MutexUnlock(&Worker->RangeMutex);
+
+		if (bOwned)
+			Pool->Task(Pool->Context, TaskIndex, ThreadIndex);
+		else if (!ThreadPoolSteal(Pool, ThreadIndex))
+			break;
+	}
+}
+
+static void ThreadPoolWorkerProc(void* Context)
+{
+	struct ThreadPoolWorker* Worker = Context;
+	struct ThreadPool* Pool = Worker->Pool;
+	uint64_t SeenGeneration = 0;
+
+	MutexLock(&Pool->Mutex);
+	for (;;)
+	{
+		while (!Pool->bShutdown && Pool->Generation == SeenGeneration)
+			ConditionWait(&Pool->WorkAvailable, &Pool->Mutex);
+
+		if (Pool->bShutdown)
+			break;
+
+		SeenGeneration = Pool->Generation;
+		MutexUnlock(&Pool->Mutex);
+
+		if (Pool->bStealing)
+			ThreadPoolDrainStealing(Pool, Worker->ThreadIndex);
+		else
+			ThreadPoolDrain(Pool, Worker->ThreadIndex);
+
+		MutexLock(&Pool->Mutex);
+		if (--Pool->BusyWorkers == 0)
+			ConditionBroadcast(&Pool->WorkFinished);
+	}
+	MutexUnlock(&Pool->Mutex);
+}
+
+struct ThreadPool* ThreadPoolCreate(uint32_t ThreadCount)
+{
+	if (ThreadCount == 0)
+		ThreadCount = GetProcessorCount();
+
+	struct ThreadPool* Pool = calloc(1, sizeof(struct ThreadPool));
+	CHECK_ALLOC(Pool);
+
+	Pool->ThreadCount = ThreadCount;
+	MutexInit(&Pool->Mutex);
+	ConditionInit(&Pool->WorkAvailable);
+	ConditionInit(&Pool->WorkFinished);
+
+	//index 0 is the thread calling ThreadPoolRun
+	Pool->Threads = calloc(ThreadCount, sizeof(PlatformThread));
+	Pool->Workers = calloc(ThreadCount, sizeof(struct ThreadPoolWorker));
+	CHECK_ALLOC(Pool->Threads);
+	CHECK_ALLOC(Pool->Workers);
+
+	for (uint32_t i = 0; i < ThreadCount; i++)
+	{
+		MutexInit(&Pool->Workers[i].RangeMutex);
+	}
+
+	for (uint32_t i = 1; i < ThreadCount; i++)
+	{
+		Pool->Workers[i].Pool = Pool;
+		Pool->Workers[i].ThreadIndex = i;
+		Pool->Threads[i] = ThreadCreate(ThreadPoolWorkerProc, &Pool->Workers[i]);
+	}
+
+	return Pool;
+}
+
+void ThreadPoolDestroy(struct ThreadPool* Pool)
+{
+	MutexLock(&Pool->Mutex);
+	Pool->bShutdown = true;
+	ConditionBroadcast(&Pool->WorkAvailable);
+	MutexUnlock(&Pool->Mutex);
+
+	for (uint32_t i = 1; i < Pool->ThreadCount; i++)
+	{
+		ThreadJoin(Pool->Threads[i]);
+	}
+
+	for (uint32_t i = 0; i < Pool->ThreadCount; i++)
+	{
+		MutexDestroy(&Pool->Workers[i].RangeMutex);
+	}
+
+	ConditionDestroy(&Pool->WorkFinished);
+	ConditionDestroy(&Pool->WorkAvailable);
+	MutexDestroy(&Pool->Mutex);
+	free(Pool->Workers);
+	free(Pool->Threads);
+	free(Pool);
+}
+
+uint32_t ThreadPoolGetThreadCount(const struct ThreadPool* Pool)
+{
+	return Pool->ThreadCount;
+}
+
+void ThreadPoolRun(struct ThreadPool* Pool, ThreadPoolTask Task, void* Context, uint32_t TaskCount)
+{
+	if (TaskCount == 0)
+		return;
+
+	MutexLock(&Pool->Mutex);
+	Pool->Task = Task;
+	Pool->Context = Context;
+	Pool->TaskCount = TaskCount;
+	AtomicStore32(&Pool->NextTask, 0);
+	Pool->bStealing = false;
+	Pool->BusyWorkers = Pool->ThreadCount - 1;
+	Pool->Generation++;
+	ConditionBroadcast(&Pool->WorkAvailable);
+	MutexUnlock(&Pool->Mutex);
+
+	ThreadPoolDrain(Pool, 0);
+
+	MutexLock(&Pool->Mutex);
+	while (Pool->BusyWorkers != 0)
+		ConditionWait(&Pool->WorkFinished, &Pool->Mutex);
+	MutexUnlock(&Pool->Mutex);
+}
+
+void ThreadPoolRunStealing(struct ThreadPool* Pool, ThreadPoolTask Task, void* Context, uint32_t TaskCount, const uint32_t* Partition)
+{
+	if (TaskCount == 0)
+		return;
+
+	MutexLock(&Pool->Mutex);
+	Pool->Task = Task;
+	Pool->Context = Context;
+	Pool->TaskCount = TaskCount;
+	Pool->bStealing = true;
+	AtomicStore32(&Pool->Steals, 0);
+
+	//the workers are all parked on the pool mutex, so the ranges need no locking here
+	for (uint32_t i = 0; i < Pool->ThreadCount; i++)
+	{
+		Pool->Workers[i].Next = Partition ? Partition[i] : (uint32_t)((uint64_t)TaskCount * i / Pool->ThreadCount);
+		Pool->Workers[i].End = Partition ? Partition[i + 1] : (uint32_t)((uint64_t)TaskCount * (i + 1) / Pool->ThreadCount);
+	}
+
+	Pool->BusyWorkers = Pool->ThreadCount - 1;
+	Pool->Generation++;
+	ConditionBroadcast(&Pool->WorkAvailable);
+	MutexUnlock(&Pool->Mutex);
+
+	ThreadPoolDrainStealing(Pool, 0);
+
+	MutexLock(&Pool->Mutex);
+	while (Pool->BusyWorkers != 0)
+		ConditionWait(&Pool->WorkFinished, &Pool->Mutex);
+	MutexUnlock(&Pool->Mutex);
+}
+
+uint32_t ThreadPoolGetStealCount(const struct ThreadPool* Pool)
+{
+	return (uint32_t)AtomicLoad32((volatile int32_t*)&Pool->Steals);
+}
@@ -0,0 +1,41 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+typedef void (*ThreadPoolTask)(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex);
+
+struct ThreadPool;
+
+//ThreadCount == 0 uses every online processor
+struct ThreadPool* ThreadPoolCreate(uint32_t ThreadCount);
+void ThreadPoolDestroy(struct ThreadPool* Pool);
+
+uint32_t ThreadPoolGetThreadCount(const struct ThreadPool* Pool);
+
+//runs Task for every index in [0, TaskCount) and returns once all of them have finished.
+//the calling thread takes part as thread index 0
+void ThreadPoolRun(struct ThreadPool* Pool, ThreadPoolTask Task, void* Context, uint32_t TaskCount);
+
+//ThreadPoolRun by work stealing. thread i starts on the tasks in
+//[Partition[i], Partition[i + 1]) and runs them in order, a thread that runs out
+//takes the back half of the largest range another thread has left. Partition
+//has ThreadCount + 1 ascending entries from 0 to TaskCount, NULL splits evenly
+void ThreadPoolRunStealing(struct ThreadPool* Pool, ThreadPoolTask Task, void* Context, uint32_t TaskCount, const uint32_t* Partition);
+
+//ranges taken over from another thread during the last ThreadPoolRunStealing
+uint32_t ThreadPoolGetStealCount(const struct ThreadPool* Pool);
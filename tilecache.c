@@ -0,0 +1,448 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <math.h>
+#include <string.h>
+
+#include "tilecache.h"
+#include "kernels.h"
+#include "threadpool.h"
+#include "platform.h"
+
+#define TILE_CACHE_PIXELS (TILE_CACHE_TILE_SIZE * TILE_CACHE_TILE_SIZE)
+
+//pixel step mantissas of the levels in an octave, in sixteenths. a step of
+//Mantissa * 2^-n keeps every pixel coordinate of the level exact in double
+static const uint32_t LevelMantissas[TILE_CACHE_LEVELS_PER_OCTAVE] = { 16, 19, 23, 27 };
+
+static const RowKernel TileKernels[KERNEL_ISA_COUNT] = {
+	ScalarRowKernel,
+	Avx2RowKernel,
+	Avx512RowKernel
+};
+
+struct TileKey
+{
+	enum FractalSet Set;
+	enum FractalType Type;
+	double JuliaPos[2];
+	int32_t Level;
+	int64_t TileX;
+	int64_t TileY;
+	uint32_t MaxIterations;
+};
+
+struct TileEntry
+{
+	struct TileKey Key;
+	uint64_t Hash;
+	struct TileEntry* HashNext;
+	struct TileEntry* Newer;	//lru list, most recently used at Cache->Newest
+	struct TileEntry* Older;
+	uint64_t Frame;				//last frame that used it, those are never evicted
+	uint32_t* Iterations;
+};
+
+struct TileCache
+{
+	size_t MemoryBudget;
+	size_t MemoryUsed;
+	size_t TileCount;
+	struct TileEntry** Buckets;
+	uint32_t BucketCount;		//power of two
+	struct TileEntry* Newest;
+	struct TileEntry* Oldest;
+	uint64_t Frame;
+	uint64_t Hits;
+	uint64_t Misses;
+	uint64_t Evictions;
+};
+
+static const size_t TileEntryBytes = sizeof(struct TileEntry) + TILE_CACHE_PIXELS * sizeof(uint32_t);
+
+struct TileCache* TileCacheCreate(size_t MemoryBudget)
+{
+	struct TileCache* Cache = malloc(sizeof(struct TileCache));
+	CHECK_ALLOC(Cache);
+	memset(Cache, 0, sizeof(struct TileCache));
+	Cache->MemoryBudget = MemoryBudget;
+
+	//about two buckets per tile the budget holds
+	const size_t Capacity = max(MemoryBudget / TileEntryBytes, 64);
+	Cache->BucketCount = 1;
+	while (Cache->BucketCount < Capacity * 2 && Cache->BucketCount < (1u << 30))
+		Cache->BucketCount *= 2;
+
+	Cache->Buckets = calloc(Cache->BucketCount, sizeof(struct TileEntry*));
+	CHECK_ALLOC(Cache->Buckets);
+	return Cache;
+}
+
+void TileCacheClear(struct TileCache* Cache)
+{
+	struct TileEntry* Entry = Cache->Newest;
+	while (Entry)
+	{
+		struct TileEntry* Older = Entry->Older;
+		AlignedFree(Entry->Iterations);
+		free(Entry);
+		Entry = Older;
+	}
+
+	memset(Cache->Buckets, 0, Cache->BucketCount * sizeof(struct TileEntry*));
+	Cache->Newest = NULL;
+	Cache->Oldest = NULL;
+	Cache->MemoryUsed = 0;
+	Cache->TileCount = 0;
+}
+
+void TileCacheDestroy(struct TileCache* Cache)
+{
+	TileCacheClear(Cache);
+	free(Cache->Buckets);
+	free(Cache);
+}
+
+void TileCacheGetStats(const struct TileCache* Cache, struct TileCacheStats* restrict Stats)
+{
+	Stats->Hits = Cache->Hits;
+	Stats->Misses = Cache->Misses;
+	Stats->Evictions = Cache->Evictions;
+	Stats->TileCount = Cache->TileCount;
+	Stats->MemoryUsed = Cache->MemoryUsed;
+}
+
+static double GetLevelStep(int32_t Level)
+{
+	//floor division, levels below 0 are zoomed out past a pixel step of 1
+	const int32_t Octave = Level >= 0 ? Level / TILE_CACHE_LEVELS_PER_OCTAVE : -((-Level + TILE_CACHE_LEVELS_PER_OCTAVE - 1) / TILE_CACHE_LEVELS_PER_OCTAVE);
+	const uint32_t Mantissa = LevelMantissas[Level - Octave * TILE_CACHE_LEVELS_PER_OCTAVE];
+	return ldexp((double)Mantissa, -Octave - 4);
+}
+
+//largest level step at or below Step, the level numbers grow as the view zooms in
+static int32_t GetZoomLevel(double Step)
+{
+	int32_t Level = (int32_t)floor(-log2(Step) * TILE_CACHE_LEVELS_PER_OCTAVE);
+	while (GetLevelStep(Level) > Step)
+		Level++;
+	while (GetLevelStep(Level - 1) <= Step)
+		Level--;
+	return Level;
+}
+
+//the view's first pixel as a global pixel of its level
+static void GetGlobalOrigin(const struct CpuView* restrict View, double Step, int64_t* restrict OriginX, int64_t* restrict OriginY)
+{
+	struct PixelGrid Grid;
+	CpuViewGetPixelGrid(View, &Grid);
+	*OriginX = llround(Grid.OriginX / Step);
+	*OriginY = llround(Grid.OriginY / Step);
+}
+
+void TileCacheSnapView(struct CpuView* restrict View)
+{
+	const double Step = GetLevelStep(GetZoomLevel(View->WindowPos[0] / View->Width));
+
+	//the centre stays where it is, give or take half a pixel
+	const int64_t OriginX = llround(View->WindowPos[2] / Step - View->Width * 0.5);
+	const int64_t OriginY = llround(-View->WindowPos[3] / Step - View->Height * 0.5);
+
+	//every value here is a small integer times Step, so CpuViewGetPixelGrid gets Origin and Step back exactly
+	View->WindowPos[0] = Step * View->Width;
+	View->WindowPos[1] = Step * View->Height;
+	View->WindowPos[2] = (double)(OriginX * 2 + View->Width) * Step * 0.5;
+	View->WindowPos[3] = -(double)(OriginY * 2 + View->Height) * Step * 0.5;
+}
+
+static uint64_t MixHash(uint64_t Hash, uint64_t Value)
+{
+	//boost style combine, then the splitmix64 finaliser
+	Hash ^= Value + 0x9E3779B97F4A7C15ull + (Hash << 6) + (Hash >> 2);
+	Hash = (Hash ^ (Hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+	Hash = (Hash ^ (Hash >> 27)) * 0x94D049BB133111EBull;
+	return Hash ^ (Hash >> 31);
+}
+
+static uint64_t HashTileKey(const struct TileKey* restrict Key)
+{
+	uint64_t JuliaBits[2];
+	memcpy(JuliaBits, Key->JuliaPos, sizeof(JuliaBits));
+
+	uint64_t Hash = MixHash(0, (uint64_t)Key->Set << 32 | (uint64_t)Key->Type);
+	Hash = MixHash(Hash, JuliaBits[0]);
+	Hash = MixHash(Hash, JuliaBits[1]);
+	Hash = MixHash(Hash, (uint64_t)(uint32_t)Key->Level << 32 | Key->MaxIterations);
+	Hash = MixHash(Hash, (uint64_t)Key->TileX);
+	return MixHash(Hash, (uint64_t)Key->TileY);
+}
+
+static bool IsSameTileKey(const struct TileKey* restrict a, const struct TileKey* restrict b)
+{
+	return a->Set == b->Set
+		&& a->Type == b->Type
+		&& memcmp(a->JuliaPos, b->JuliaPos, sizeof(a->JuliaPos)) == 0
+		&& a->Level == b->Level
+		&& a->TileX == b->TileX
+		&& a->TileY == b->TileY
+		&& a->MaxIterations == b->MaxIterations;
+}
+
+static void UnlinkLru(struct TileCache* Cache, struct TileEntry* Entry)
+{
+	if (Entry->Newer)
+		Entry->Newer->Older = Entry->Older;
+	else
+		Cache->Newest = Entry->Older;
+
+	if (Entry->Older)
+		Entry->Older->Newer = Entry->Newer;
+	else
+		Cache->Oldest = Entry->Newer;
+}
+
+static void PushNewest(struct TileCache* Cache, struct TileEntry* Entry)
+{
+	Entry->Newer = NULL;
+	Entry->Older = Cache->Newest;
+	if (Cache->Newest)
+		Cache->Newest->Newer = Entry;
+	else
+		Cache->Oldest = Entry;
+	Cache->Newest = Entry;
+}
+
+static struct TileEntry* FindTile(struct TileCache* Cache, const struct TileKey* restrict Key, uint64_t Hash)
+{
+	for (struct TileEntry* Entry = Cache->Buckets[Hash & (Cache->BucketCount - 1)]; Entry; Entry = Entry->HashNext)
+	{
+		if (Entry->Hash == Hash && IsSameTileKey(&Entry->Key, Key))
+			return Entry;
+	}
+	return NULL;
+}
+
+static void EvictOldest(struct TileCache* Cache)
+{
+	struct TileEntry* Entry = Cache->Oldest;
+	UnlinkLru(Cache, Entry);
+
+	struct TileEntry** Link = &Cache->Buckets[Entry->Hash & (Cache->BucketCount - 1)];
+	while (*Link != Entry)
+		Link = &(*Link)->HashNext;
+	*Link = Entry->HashNext;
+
+	AlignedFree(Entry->Iterations);
+	free(Entry);
+	Cache->MemoryUsed -= TileEntryBytes;
+	Cache->TileCount--;
+	Cache->Evictions++;
+}
+
+//evicts the least recently used tiles until Bytes more fit, short of the ones the current frame uses
+static void MakeRoom(struct TileCache* Cache, size_t Bytes)
+{
+	while (Cache->Oldest && Cache->Oldest->Frame != Cache->Frame && Cache->MemoryUsed + Bytes > Cache->MemoryBudget)
+		EvictOldest(Cache);
+}
+
+static struct TileEntry* InsertTile(struct TileCache* Cache, const struct TileKey* restrict Key, uint64_t Hash)
+{
+	MakeRoom(Cache, TileEntryBytes);
+
+	struct TileEntry* Entry = malloc(sizeof(struct TileEntry));
+	CHECK_ALLOC(Entry);
+	Entry->Key = *Key;
+	Entry->Hash = Hash;
+	Entry->Frame = Cache->Frame;
+	Entry->Iterations = AlignedAlloc(TILE_CACHE_PIXELS * sizeof(uint32_t), 64);
+
+	struct TileEntry** Bucket = &Cache->Buckets[Hash & (Cache->BucketCount - 1)];
+	Entry->HashNext = *Bucket;
+	*Bucket = Entry;
+	PushNewest(Cache, Entry);
+
+	Cache->MemoryUsed += TileEntryBytes;
+	Cache->TileCount++;
+	return Entry;
+}
+
+struct CachedFrame
+{
+	const struct CpuView* View;
+	RowKernel Kernel;
+	uint32_t Limit;
+	double Step;
+	bool bInteriorChecks;
+	bool bFastMath;
+	struct TileEntry** Misses;
+	volatile int64_t TotalIterations;
+};
+
+//a tile is rendered whole at its global pixels, whatever part of it the view shows
+static void RenderCachedTile(void* Context, uint32_t TaskIndex, uint32_t ThreadIndex)
+{
+	(void)ThreadIndex;
+	struct CachedFrame* Frame = Context;
+	const struct CpuView* View = Frame->View;
+	struct TileEntry* Entry = Frame->Misses[TaskIndex];
+
+	struct RowJob Job;
+	memset(&Job, 0, sizeof(struct RowJob));
+	Job.Set = View->Set;
+	Job.Type = View->Type;
+	Job.Limit = Frame->Limit;
+	Job.StepX = Frame->Step;
+	Job.StepY = Frame->Step;
+	Job.FirstX = Entry->Key.TileX * TILE_CACHE_TILE_SIZE;
+	Job.StrideX = 1;
+	Job.Count = TILE_CACHE_TILE_SIZE;
+	Job.JuliaX = View->JuliaPos[0];
+	Job.JuliaY = View->JuliaPos[1];
+	Job.bInteriorChecks = Frame->bInteriorChecks;
+	Job.bFastMath = Frame->bFastMath;
+
+	uint64_t Total = 0;
+	for (uint32_t y = 0; y < TILE_CACHE_TILE_SIZE; y++)
+	{
+		Job.Y = Entry->Key.TileY * TILE_CACHE_TILE_SIZE + y;
+		Total += Frame->Kernel(&Job, Entry->Iterations + y * TILE_CACHE_TILE_SIZE);
+	}
+
+	AtomicAdd64(&Frame->TotalIterations, (int64_t)Total);
+}
+
+//floor division for global pixel coordinates left of or above zero
+static int64_t GetTileIndex(int64_t Pixel)
+{
+	return Pixel >= 0 ? Pixel / TILE_CACHE_TILE_SIZE : -((-Pixel + TILE_CACHE_TILE_SIZE - 1) / TILE_CACHE_TILE_SIZE);
+}
+
+//copies the part of Entry's tile the view covers into Buffer, returns its pixel count
+static uint64_t CopyTile(const struct TileEntry* restrict Entry, int64_t OriginX, int64_t OriginY, struct IterationBuffer* restrict Buffer)
+{
+	const int64_t TileLeft = Entry->Key.TileX * TILE_CACHE_TILE_SIZE;
+	const int64_t TileTop = Entry->Key.TileY * TILE_CACHE_TILE_SIZE;
+	const int64_t Left = max(TileLeft, OriginX);
+	const int64_t Right = min(TileLeft + TILE_CACHE_TILE_SIZE, OriginX + Buffer->Width);
+	const int64_t Top = max(TileTop, OriginY);
+	const int64_t Bottom = min(TileTop + TILE_CACHE_TILE_SIZE, OriginY + Buffer->Height);
+
+	for (int64_t y = Top; y < Bottom; y++)
+	{
+		memcpy(
+			Buffer->Iterations + (size_t)(y - OriginY) * Buffer->Width + (Left - OriginX),
+			Entry->Iterations + (y - TileTop) * TILE_CACHE_TILE_SIZE + (Left - TileLeft),
+			(size_t)(Right - Left) * sizeof(uint32_t));
+	}
+
+	return (uint64_t)((Right - Left) * (Bottom - Top));
+}
+
+void CpuRenderFrameCached(struct CpuRenderer* Renderer, struct TileCache* Cache, struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats)
+{
+	CHECK_TRUE(Buffer->Width == View->Width && Buffer->Height == View->Height);
+
+	const double StartTime = GetTime();
+	IterationBufferClearFractions(Buffer);
+
+	TileCacheSnapView(View);
+	const double Step = View->WindowPos[0] / View->Width;
+
+	int64_t OriginX;
+	int64_t OriginY;
+	GetGlobalOrigin(View, Step, &OriginX, &OriginY);
+
+	const int64_t FirstTileX = GetTileIndex(OriginX);
+	const int64_t FirstTileY = GetTileIndex(OriginY);
+	const int64_t TilesX = GetTileIndex(OriginX + View->Width - 1) - FirstTileX + 1;
+	const int64_t TilesY = GetTileIndex(OriginY + View->Height - 1) - FirstTileY + 1;
+
+	struct CachedFrame Frame = { 0 };
+	Frame.View = View;
+	Frame.Kernel = TileKernels[CpuRendererGetIsa(Renderer)];
+	Frame.Limit = CpuViewGetIterationLimit(View);
+	Frame.Step = Step;
+	Frame.bInteriorChecks = CpuRendererGetInteriorChecks(Renderer);
+	Frame.bFastMath = CpuRendererGetFastMath(Renderer);
+	Frame.Misses = malloc((size_t)(TilesX * TilesY) * sizeof(struct TileEntry*));
+	CHECK_ALLOC(Frame.Misses);
+
+	struct TileKey Key;
+	memset(&Key, 0, sizeof(struct TileKey));
+	Key.Set = View->Set;
+	Key.Type = View->Type;
+	Key.JuliaPos[0] = View->JuliaPos[0];
+	Key.JuliaPos[1] = View->JuliaPos[1];
+	Key.Level = GetZoomLevel(Step);
+	Key.MaxIterations = View->MaxIterations;
+
+	//hits are copied straight away, so evicting them later in the frame is harmless
+	Cache->Frame++;
+	uint32_t MissCount = 0;
+	uint64_t ReusedPixels = 0;
+	for (int64_t TileY = FirstTileY; TileY < FirstTileY + TilesY; TileY++)
+	{
+		for (int64_t TileX = FirstTileX; TileX < FirstTileX + TilesX; TileX++)
+		{
+			Key.TileX = TileX;
+			Key.TileY = TileY;
+			const uint64_t Hash = HashTileKey(&Key);
+
+			struct TileEntry* Entry = FindTile(Cache, &Key, Hash);
+			if (Entry)
+			{
+				UnlinkLru(Cache, Entry);
+				PushNewest(Cache, Entry);
+				Entry->Frame = Cache->Frame;
+				ReusedPixels += CopyTile(Entry, OriginX, OriginY, Buffer);
+				Cache->Hits++;
+			}
+			else
+			{
+				Frame.Misses[MissCount++] = InsertTile(Cache, &Key, Hash);
+				Cache->Misses++;
+			}
+		}
+	}
+
+	ThreadPoolRun(CpuRendererGetThreadPool(Renderer), RenderCachedTile, &Frame, MissCount);
+
+	for (uint32_t i = 0; i < MissCount; i++)
+	{
+		CopyTile(Frame.Misses[i], OriginX, OriginY, Buffer);
+	}
+	free(Frame.Misses);
+
+	//this frame's tiles stay even past the budget, the next frame can evict them
+	MakeRoom(Cache, 0);
+
+	if (Stats)
+	{
+		Stats->Seconds = GetTime() - StartTime;
+		Stats->TotalIterations = (uint64_t)Frame.TotalIterations;
+		Stats->TileCount = MissCount;
+		Stats->ThreadCount = ThreadPoolGetThreadCount(CpuRendererGetThreadPool(Renderer));
+		Stats->Isa = CpuRendererGetIsa(Renderer);
+		Stats->Tier = PRECISION_TIER_FLOAT;
+		Stats->FilledPixels = 0;
+		Stats->ReusedPixels = ReusedPixels;
+		Stats->PendingPixels = 0;
+		Stats->Steals = 0;
+		Stats->SupersampledPixels = 0;
+		Stats->MirroredPixels = 0;
+	}
+}
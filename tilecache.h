@@ -0,0 +1,57 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//lru cache of raw iteration tiles. a view snapped to one of the quantized zoom
+//levels sits on a global pixel grid for that level, so any tile of it can be
+//kept and copied into later frames of the same fractal, such as after a switch
+//of set or type or when panning back over ground already rendered
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpurender.h"
+
+#define TILE_CACHE_TILE_SIZE 64
+#define TILE_CACHE_LEVELS_PER_OCTAVE 4
+
+struct TileCacheStats
+{
+	uint64_t Hits;
+	uint64_t Misses;
+	uint64_t Evictions;
+	size_t TileCount;
+	size_t MemoryUsed;	//bytes, tiles and their bookkeeping
+};
+
+struct TileCache;
+
+//MemoryBudget is in bytes. a frame that needs more tiles than fit still renders,
+//the cache holds on to them over budget until the next frame evicts them
+struct TileCache* TileCacheCreate(size_t MemoryBudget);
+void TileCacheDestroy(struct TileCache* Cache);
+void TileCacheClear(struct TileCache* Cache);
+void TileCacheGetStats(const struct TileCache* Cache, struct TileCacheStats* restrict Stats);
+
+//moves View to the closest zoom level at or inside its extent and onto that
+//level's pixel grid, with square pixels. the view renders the same with or without the cache
+void TileCacheSnapView(struct CpuView* restrict View);
+
+//CpuRenderFrame through the cache. View is snapped first, tiles the cache has are
+//copied and the rest are rendered whole and kept. only the float tier is cached
+void CpuRenderFrameCached(struct CpuRenderer* Renderer, struct TileCache* Cache, struct CpuView* restrict View, struct IterationBuffer* restrict Buffer, struct CpuRenderStats* restrict Stats);
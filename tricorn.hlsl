@@ -25,6 +25,8 @@ Texture2D Texture : register(t0);
 ConstantBuffer<ConstantBufferData> MyConstantBuffer : register(b0, space0);
 SamplerState MySampler : register(s0);
 
+#include "fractal.hlsli"
+
 float Tricorn(float2 Coord)
 {
     uint MaxIterations = (uint)MyConstantBuffer.MaxIterations.z * 4;
@@ -33,12 +35,29 @@ float Tricorn(float2 Coord)
     float2 z = Coord;
     float2 c = Coord;
     
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 4.0f)
     {
         float x = z.x * z.x - z.y * z.y;
         float y = -2.0f * z.x * z.y;
         z = float2(x, y) + c;
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        if (dot(Delta, Delta) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            NextSave *= 2;
+        }
     }
     
     return frac((float)iter / MyConstantBuffer.MaxIterations.z);
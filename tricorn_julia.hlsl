@@ -28,6 +28,8 @@ float2 ComplexSquareConjugate(float2 z)
     return float2(z.x * z.x - z.y * z.y, -2.0 * z.x * z.y);
 }
 
+#include "fractal.hlsli"
+
 float Julia(float2 Coord)
 {
     uint MaxIterations = (uint)MyConstantBuffer.MaxIterations.z * 4;
@@ -36,12 +38,29 @@ float Julia(float2 Coord)
     float2 z = Coord;
     float2 c = MyConstantBuffer.JuliaPos.xy;
     
+    // brent cycle detection: an orbit that comes back to a saved point is periodic
+    float Tolerance = PeriodTolerance();
+    float2 SavedZ = z;
+    uint NextSave = 1;
+    
     while (iter < MaxIterations && dot(z, z) < 4.0f)
     {
         float x = z.x * z.x - z.y * z.y;
         float y = -2.0f * z.x * z.y;
         z = float2(x, y) + c;
         iter++;
+        
+        float2 Delta = z - SavedZ;
+        if (dot(Delta, Delta) < Tolerance)
+        {
+            iter = MaxIterations;
+            break;
+        }
+        if (iter == NextSave)
+        {
+            SavedZ = z;
+            NextSave *= 2;
+        }
     }
     
     return frac((float)iter / MyConstantBuffer.MaxIterations.z);
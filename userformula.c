@@ -0,0 +1,558 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "userformula.h"
+#include "platform.h"
+
+#define USER_FORMULA_MAX_NODES 256
+#define USER_FORMULA_MAX_POWER 64	//integer powers past this go through exp and log
+
+//leaves of the expression, they sit in the fixed registers instead of being computed
+enum
+{
+	NODE_Z = FORMULA_OP_COUNT,
+	NODE_C,
+	NODE_P
+};
+
+//the expression as a dag. every node is looked up before it is added, so a
+//subexpression that comes up twice is one node and gets computed once
+struct FormulaNode
+{
+	uint8_t Op;
+	int32_t A;
+	int32_t B;		//-1 for the ops with one operand
+	float Re;		//FORMULA_OP_CONST only
+	float Im;
+	bool bVarying;	//depends on z or p, so it runs every iteration and not once per pixel
+	bool bReal;		//imaginary part known to be 0
+	float Degree;	//power of z it grows with
+};
+
+struct FormulaCompiler
+{
+	const char* Source;
+	const char* Cursor;
+	const char* Error;		//NULL until something fails
+	const char* ErrorAt;
+	struct FormulaNode Nodes[USER_FORMULA_MAX_NODES];
+	int32_t NodeCount;
+};
+
+struct FormulaFunction
+{
+	const char* Name;
+	enum FormulaOp Op;
+};
+
+static const struct FormulaFunction FormulaFunctions[] = {
+	{ "sqr", FORMULA_OP_SQR },
+	{ "conj", FORMULA_OP_CONJ },
+	{ "abs", FORMULA_OP_ABS },
+	{ "re", FORMULA_OP_RE },
+	{ "im", FORMULA_OP_IM },
+	{ "norm", FORMULA_OP_NORM },
+	{ "mod", FORMULA_OP_MOD },
+	{ "arg", FORMULA_OP_ARG },
+	{ "exp", FORMULA_OP_EXP },
+	{ "log", FORMULA_OP_LOG },
+	{ "sin", FORMULA_OP_SIN },
+	{ "cos", FORMULA_OP_COS }
+};
+
+static bool IsBinaryOp(uint8_t Op)
+{
+	return Op == FORMULA_OP_ADD || Op == FORMULA_OP_SUB || Op == FORMULA_OP_MUL || Op == FORMULA_OP_MULR || Op == FORMULA_OP_DIV || Op == FORMULA_OP_DIVR;
+}
+
+static int32_t Fail(struct FormulaCompiler* restrict Compiler, const char* Message)
+{
+	if (Compiler->Error == NULL)
+	{
+		Compiler->Error = Message;
+		Compiler->ErrorAt = Compiler->Cursor;
+	}
+	return -1;
+}
+
+static int32_t FindOrAddNode(struct FormulaCompiler* restrict Compiler, const struct FormulaNode* restrict Node)
+{
+	for (int32_t i = 0; i < Compiler->NodeCount; i++)
+	{
+		const struct FormulaNode* Other = &Compiler->Nodes[i];
+		if (Other->Op == Node->Op && Other->A == Node->A && Other->B == Node->B && memcmp(&Other->Re, &Node->Re, sizeof(float)) == 0 && memcmp(&Other->Im, &Node->Im, sizeof(float)) == 0)
+			return i;
+	}
+
+	if (Compiler->NodeCount == USER_FORMULA_MAX_NODES)
+		return Fail(Compiler, "formula too long");
+
+	Compiler->Nodes[Compiler->NodeCount] = *Node;
+	return Compiler->NodeCount++;
+}
+
+static int32_t AddConstant(struct FormulaCompiler* restrict Compiler, float Re, float Im)
+{
+	const struct FormulaNode Node = { FORMULA_OP_CONST, -1, -1, Re, Im, false, Im == 0.0f, 0.0f };
+	return FindOrAddNode(Compiler, &Node);
+}
+
+static int32_t AddLeaf(struct FormulaCompiler* restrict Compiler, uint8_t Op)
+{
+	const struct FormulaNode Node = { Op, -1, -1, 0.0f, 0.0f, Op != NODE_C, false, Op == NODE_C ? 0.0f : 1.0f };
+	return FindOrAddNode(Compiler, &Node);
+}
+
+static bool IsConstant(const struct FormulaCompiler* restrict Compiler, int32_t Index, float Re, float Im)
+{
+	const struct FormulaNode* Node = &Compiler->Nodes[Index];
+	return Node->Op == FORMULA_OP_CONST && Node->Re == Re && Node->Im == Im;
+}
+
+//folds constants, drops ops that do nothing and picks the cheaper op when an
+//operand is known to be real, then adds the node unless it is there already
+static int32_t AddOp(struct FormulaCompiler* restrict Compiler, enum FormulaOp Op, int32_t A, int32_t B)
+{
+	const bool bBinary = IsBinaryOp(Op);
+	if (A < 0 || (bBinary && B < 0))
+		return -1;
+	if (!bBinary)
+		B = -1;
+
+	const struct FormulaNode a = Compiler->Nodes[A];
+	const struct FormulaNode b = bBinary ? Compiler->Nodes[B] : a;
+
+	if (a.Op == FORMULA_OP_CONST && b.Op == FORMULA_OP_CONST)
+	{
+		float Re;
+		float Im;
+		ApplyFormulaOp(Op, a.Re, a.Im, b.Re, b.Im, &Re, &Im);
+		return AddConstant(Compiler, Re, Im);
+	}
+
+	switch (Op)
+	{
+	case FORMULA_OP_ADD:
+		if (IsConstant(Compiler, A, 0.0f, 0.0f))
+			return B;
+		if (IsConstant(Compiler, B, 0.0f, 0.0f))
+			return A;
+		if (A > B)
+			return AddOp(Compiler, Op, B, A);
+		break;
+	case FORMULA_OP_SUB:
+		if (IsConstant(Compiler, B, 0.0f, 0.0f))
+			return A;
+		if (IsConstant(Compiler, A, 0.0f, 0.0f))
+			return AddOp(Compiler, FORMULA_OP_NEG, B, -1);
+		break;
+	case FORMULA_OP_MUL:
+		if (A == B)
+			return AddOp(Compiler, FORMULA_OP_SQR, A, -1);
+		if (b.bReal)
+			return AddOp(Compiler, FORMULA_OP_MULR, A, B);
+		if (a.bReal)
+			return AddOp(Compiler, FORMULA_OP_MULR, B, A);
+		if (A > B)
+			return AddOp(Compiler, Op, B, A);
+		break;
+	case FORMULA_OP_MULR:
+		if (IsConstant(Compiler, B, 1.0f, 0.0f))
+			return A;
+		if (IsConstant(Compiler, B, -1.0f, 0.0f))
+			return AddOp(Compiler, FORMULA_OP_NEG, A, -1);
+		break;
+	case FORMULA_OP_DIV:
+		if (b.bReal)
+			return AddOp(Compiler, FORMULA_OP_DIVR, A, B);
+		break;
+	case FORMULA_OP_DIVR:
+		if (IsConstant(Compiler, B, 1.0f, 0.0f))
+			return A;
+		break;
+	case FORMULA_OP_NEG:
+		if (a.Op == FORMULA_OP_NEG)
+			return a.A;
+		break;
+	case FORMULA_OP_CONJ:
+		if (a.Op == FORMULA_OP_CONJ)
+			return a.A;
+		if (a.bReal)
+			return A;
+		break;
+	case FORMULA_OP_ABS:
+		if (a.Op == FORMULA_OP_ABS)
+			return A;
+		break;
+	case FORMULA_OP_RE:
+		if (a.bReal)
+			return A;
+		break;
+	case FORMULA_OP_IM:
+		if (a.bReal)
+			return AddConstant(Compiler, 0.0f, 0.0f);
+		break;
+	default:
+		break;
+	}
+
+	struct FormulaNode Node = { (uint8_t)Op, A, B, 0.0f, 0.0f, a.bVarying || b.bVarying, false, a.Degree };
+	switch (Op)
+	{
+	case FORMULA_OP_ADD:
+	case FORMULA_OP_SUB:
+		Node.bReal = a.bReal && b.bReal;
+		Node.Degree = fmaxf(a.Degree, b.Degree);
+		break;
+	case FORMULA_OP_MUL:
+	case FORMULA_OP_MULR:
+		Node.bReal = a.bReal && b.bReal;
+		Node.Degree = a.Degree + b.Degree;
+		break;
+	case FORMULA_OP_DIV:
+	case FORMULA_OP_DIVR:
+		Node.bReal = a.bReal && b.bReal;
+		Node.Degree = fmaxf(a.Degree - b.Degree, 0.0f);
+		break;
+	case FORMULA_OP_SQR:
+		Node.bReal = a.bReal;
+		Node.Degree = a.Degree * 2.0f;
+		break;
+	case FORMULA_OP_NORM:
+		Node.bReal = true;
+		Node.Degree = a.Degree * 2.0f;
+		break;
+	case FORMULA_OP_NEG:
+	case FORMULA_OP_CONJ:
+	case FORMULA_OP_ABS:
+		Node.bReal = a.bReal;
+		break;
+	case FORMULA_OP_RE:
+	case FORMULA_OP_IM:
+	case FORMULA_OP_MOD:
+		Node.bReal = true;
+		break;
+	case FORMULA_OP_ARG:
+		Node.bReal = true;
+		Node.Degree = 0.0f;
+		break;
+	case FORMULA_OP_EXP:
+	case FORMULA_OP_SIN:
+	case FORMULA_OP_COS:
+		Node.bReal = a.bReal;
+		Node.Degree = 0.0f;
+		break;
+	default:
+		Node.Degree = 0.0f;
+		break;
+	}
+	return FindOrAddNode(Compiler, &Node);
+}
+
+//square and multiply, so z^4 is two squarings and z^3 reuses z^2
+static int32_t AddIntegerPower(struct FormulaCompiler* restrict Compiler, int32_t Base, int32_t Exponent)
+{
+	if (Exponent < 0)
+		return AddOp(Compiler, FORMULA_OP_DIV, AddConstant(Compiler, 1.0f, 0.0f), AddIntegerPower(Compiler, Base, -Exponent));
+	if (Exponent == 0)
+		return AddConstant(Compiler, 1.0f, 0.0f);
+	if (Exponent == 1)
+		return Base;
+
+	const int32_t Square = AddOp(Compiler, FORMULA_OP_SQR, AddIntegerPower(Compiler, Base, Exponent / 2), -1);
+	return Exponent % 2 ? AddOp(Compiler, FORMULA_OP_MUL, Square, Base) : Square;
+}
+
+static int32_t AddPower(struct FormulaCompiler* restrict Compiler, int32_t Base, int32_t Exponent)
+{
+	if (Base < 0 || Exponent < 0)
+		return -1;
+
+	const struct FormulaNode* Node = &Compiler->Nodes[Exponent];
+	if (Node->Op == FORMULA_OP_CONST && Node->Im == 0.0f && Node->Re == floorf(Node->Re) && fabsf(Node->Re) <= USER_FORMULA_MAX_POWER)
+		return AddIntegerPower(Compiler, Base, (int32_t)Node->Re);
+
+	return AddOp(Compiler, FORMULA_OP_EXP, AddOp(Compiler, FORMULA_OP_MUL, Exponent, AddOp(Compiler, FORMULA_OP_LOG, Base, -1)), -1);
+}
+
+static void SkipSpaces(struct FormulaCompiler* restrict Compiler)
+{
+	while (isspace((unsigned char)*Compiler->Cursor))
+	{
+		Compiler->Cursor++;
+	}
+}
+
+static bool Accept(struct FormulaCompiler* restrict Compiler, char Character)
+{
+	SkipSpaces(Compiler);
+	if (*Compiler->Cursor != Character)
+		return false;
+
+	Compiler->Cursor++;
+	return true;
+}
+
+static int32_t ParseSum(struct FormulaCompiler* restrict Compiler);
+
+static int32_t ParsePrimary(struct FormulaCompiler* restrict Compiler)
+{
+	SkipSpaces(Compiler);
+	const char* Start = Compiler->Cursor;
+
+	if (Accept(Compiler, '('))
+	{
+		const int32_t Inner = ParseSum(Compiler);
+		if (!Accept(Compiler, ')'))
+			return Fail(Compiler, "expected )");
+		return Inner;
+	}
+
+	if (isdigit((unsigned char)*Start) || *Start == '.')
+	{
+		char* End;
+		const float Value = strtof(Start, &End);
+		Compiler->Cursor = End;
+		if (*End == 'i' && !isalnum((unsigned char)End[1]))
+		{
+			Compiler->Cursor++;
+			return AddConstant(Compiler, 0.0f, Value);
+		}
+		return AddConstant(Compiler, Value, 0.0f);
+	}
+
+	if (!isalpha((unsigned char)*Start))
+		return Fail(Compiler, "expected a number, a name or (");
+
+	size_t Length = 0;
+	while (isalnum((unsigned char)Start[Length]))
+	{
+		Length++;
+	}
+	Compiler->Cursor = Start + Length;
+
+	if (Length == 1 && *Start == 'z')
+		return AddLeaf(Compiler, NODE_Z);
+	if (Length == 1 && *Start == 'c')
+		return AddLeaf(Compiler, NODE_C);
+	if (Length == 1 && *Start == 'p')
+		return AddLeaf(Compiler, NODE_P);
+	if (Length == 1 && *Start == 'i')
+		return AddConstant(Compiler, 0.0f, 1.0f);
+	if (Length == 2 && strncmp(Start, "pi", 2) == 0)
+		return AddConstant(Compiler, 3.14159265358979f, 0.0f);
+
+	for (size_t i = 0; i < sizeof(FormulaFunctions) / sizeof(FormulaFunctions[0]); i++)
+	{
+		if (strlen(FormulaFunctions[i].Name) != Length || strncmp(Start, FormulaFunctions[i].Name, Length) != 0)
+			continue;
+
+		if (!Accept(Compiler, '('))
+			return Fail(Compiler, "expected (");
+		const int32_t Argument = ParseSum(Compiler);
+		if (!Accept(Compiler, ')'))
+			return Fail(Compiler, "expected )");
+		return AddOp(Compiler, FormulaFunctions[i].Op, Argument, -1);
+	}
+
+	Compiler->Cursor = Start;
+	return Fail(Compiler, "unknown name");
+}
+
+static int32_t ParseUnary(struct FormulaCompiler* restrict Compiler);
+
+//^ binds tighter than a leading minus and groups to the right
+static int32_t ParsePowerOf(struct FormulaCompiler* restrict Compiler)
+{
+	const int32_t Base = ParsePrimary(Compiler);
+	if (!Accept(Compiler, '^'))
+		return Base;
+	return AddPower(Compiler, Base, ParseUnary(Compiler));
+}
+
+static int32_t ParseUnary(struct FormulaCompiler* restrict Compiler)
+{
+	if (Accept(Compiler, '-'))
+		return AddOp(Compiler, FORMULA_OP_NEG, ParseUnary(Compiler), -1);
+	if (Accept(Compiler, '+'))
+		return ParseUnary(Compiler);
+	return ParsePowerOf(Compiler);
+}
+
+static int32_t ParseProduct(struct FormulaCompiler* restrict Compiler)
+{
+	int32_t Result = ParseUnary(Compiler);
+	while (Result >= 0)
+	{
+		if (Accept(Compiler, '*'))
+			Result = AddOp(Compiler, FORMULA_OP_MUL, Result, ParseUnary(Compiler));
+		else if (Accept(Compiler, '/'))
+			Result = AddOp(Compiler, FORMULA_OP_DIV, Result, ParseUnary(Compiler));
+		else
+			break;
+	}
+	return Result;
+}
+
+static int32_t ParseSum(struct FormulaCompiler* restrict Compiler)
+{
+	int32_t Result = ParseProduct(Compiler);
+	while (Result >= 0)
+	{
+		if (Accept(Compiler, '+'))
+			Result = AddOp(Compiler, FORMULA_OP_ADD, Result, ParseProduct(Compiler));
+		else if (Accept(Compiler, '-'))
+			Result = AddOp(Compiler, FORMULA_OP_SUB, Result, ParseProduct(Compiler));
+		else
+			break;
+	}
+	return Result;
+}
+
+//nodes come after their operands, so node order is already an order to run them
+//in. the setup part keeps its registers for good, the step part hands a register
+//back after the last node that reads it, but never to the node that reads it, so
+//no op writes over one of its own operands
+static bool EmitBytecode(struct FormulaCompiler* restrict Compiler, int32_t Root, struct UserFormula* restrict Formula)
+{
+	const struct FormulaNode* Nodes = Compiler->Nodes;
+	const int32_t NodeCount = Compiler->NodeCount;
+
+	bool bReachable[USER_FORMULA_MAX_NODES] = { false };
+	int32_t LastUse[USER_FORMULA_MAX_NODES];
+	uint8_t Registers[USER_FORMULA_MAX_NODES];
+	bReachable[Root] = true;
+	for (int32_t i = Root; i >= 0; i--)
+	{
+		LastUse[i] = i == Root ? NodeCount : -1;
+		if (!bReachable[i] || Nodes[i].Op >= FORMULA_OP_COUNT || Nodes[i].Op == FORMULA_OP_CONST)
+			continue;
+		bReachable[Nodes[i].A] = true;
+		if (Nodes[i].B >= 0)
+			bReachable[Nodes[i].B] = true;
+	}
+	for (int32_t i = 0; i <= Root; i++)
+	{
+		if (!bReachable[i] || !Nodes[i].bVarying || Nodes[i].Op >= FORMULA_OP_COUNT)
+			continue;
+		LastUse[Nodes[i].A] = max(LastUse[Nodes[i].A], i);
+		if (Nodes[i].B >= 0)
+			LastUse[Nodes[i].B] = max(LastUse[Nodes[i].B], i);
+	}
+
+	bool bBusy[USER_FORMULA_MAX_REGISTERS] = { true, true, true };
+	uint32_t RegisterCount = USER_FORMULA_FIRST_TEMPORARY;
+	uint32_t InstructionCount = 0;
+	Formula->bUsesPrevious = false;
+
+	for (int32_t Pass = 0; Pass < 2; Pass++)
+	{
+		const bool bStep = Pass == 1;
+		for (int32_t i = 0; i <= Root; i++)
+		{
+			const struct FormulaNode* Node = &Nodes[i];
+			if (!bReachable[i])
+				continue;
+
+			if (Node->Op >= FORMULA_OP_COUNT)
+			{
+				Registers[i] = Node->Op == NODE_Z ? USER_FORMULA_REGISTER_Z : Node->Op == NODE_C ? USER_FORMULA_REGISTER_C : USER_FORMULA_REGISTER_P;
+				Formula->bUsesPrevious |= Node->Op == NODE_P;
+				continue;
+			}
+			if (Node->bVarying != bStep)
+				continue;
+
+			uint32_t Dst = 0;
+			while (Dst < USER_FORMULA_MAX_REGISTERS && bBusy[Dst])
+			{
+				Dst++;
+			}
+			if (Dst == USER_FORMULA_MAX_REGISTERS || InstructionCount == USER_FORMULA_MAX_INSTRUCTIONS)
+			{
+				Fail(Compiler, "formula too long");
+				return false;
+			}
+			bBusy[Dst] = true;
+			RegisterCount = max(RegisterCount, Dst + 1);
+			Registers[i] = (uint8_t)Dst;
+
+			struct FormulaInstruction* Instruction = &Formula->Instructions[InstructionCount++];
+			Instruction->Op = Node->Op;
+			Instruction->Dst = (uint8_t)Dst;
+			Instruction->A = Node->Op == FORMULA_OP_CONST ? 0 : Registers[Node->A];
+			Instruction->B = Node->B >= 0 ? Registers[Node->B] : Instruction->A;
+			Instruction->Re = Node->Re;
+			Instruction->Im = Node->Im;
+
+			if (!bStep)
+				continue;
+			if (Node->A >= 0 && Nodes[Node->A].bVarying && Nodes[Node->A].Op < FORMULA_OP_COUNT && LastUse[Node->A] == i)
+				bBusy[Registers[Node->A]] = false;
+			if (Node->B >= 0 && Node->B != Node->A && Nodes[Node->B].bVarying && Nodes[Node->B].Op < FORMULA_OP_COUNT && LastUse[Node->B] == i)
+				bBusy[Registers[Node->B]] = false;
+		}
+
+		if (!bStep)
+			Formula->SetupCount = InstructionCount;
+	}
+
+	Formula->StepCount = InstructionCount - Formula->SetupCount;
+	Formula->RegisterCount = RegisterCount;
+	Formula->Result = Registers[Root];
+	Formula->Degree = Nodes[Root].Degree > 1.0f ? Nodes[Root].Degree : 2.0f;
+	return true;
+}
+
+bool UserFormulaCompile(const char* Source, float Bailout, struct UserFormula* restrict Formula)
+{
+	memset(Formula, 0, sizeof(struct UserFormula));
+	Formula->Bailout = Bailout;
+
+	struct FormulaCompiler* Compiler = calloc(1, sizeof(struct FormulaCompiler));
+	CHECK_ALLOC(Compiler);
+	Compiler->Source = Source;
+	Compiler->Cursor = Source;
+
+	if (strlen(Source) >= USER_FORMULA_MAX_SOURCE)
+	{
+		Fail(Compiler, "formula too long");
+	}
+	else
+	{
+		strcpy(Formula->Source, Source);
+		int32_t Root = ParseSum(Compiler);
+		SkipSpaces(Compiler);
+		if (Root >= 0 && *Compiler->Cursor != '\0')
+			Fail(Compiler, "unexpected character");
+
+		//the step has to leave the next z somewhere other than z or p
+		if (Root >= 0 && (Compiler->Nodes[Root].Op == NODE_Z || Compiler->Nodes[Root].Op == NODE_P))
+			Root = AddOp(Compiler, FORMULA_OP_COPY, Root, -1);
+		if (Compiler->Error == NULL)
+			EmitBytecode(Compiler, Root, Formula);
+	}
+
+	const bool bOk = Compiler->Error == NULL;
+	if (!bOk)
+		fprintf(stderr, "unable to compile formula %s: %s at column %d\n", Source, Compiler->Error, (int)(Compiler->ErrorAt - Source) + 1);
+	free(Compiler);
+	return bOk;
+}
@@ -0,0 +1,140 @@
+/*
+* (C) 2024-2026 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//iteration formulas typed in as an expression instead of added to FRACTAL_FORMULAS.
+//the expression is compiled once into a register bytecode: a setup part that only
+//depends on c and constants, run once per pixel, and a step part run every
+//iteration. the bytecode kernels run it over a batch of pixels at a time, one op
+//over every lane of the batch before the next op, so the op loops vectorise and
+//the cost of decoding an op is shared by the whole batch
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "platform.h"
+
+#define USER_FORMULA_MAX_SOURCE 256
+#define USER_FORMULA_MAX_INSTRUCTIONS 128
+#define USER_FORMULA_MAX_REGISTERS 32
+
+//registers the kernel fills in before the setup part runs
+#define USER_FORMULA_REGISTER_Z 0
+#define USER_FORMULA_REGISTER_C 1
+#define USER_FORMULA_REGISTER_P 2	//z of the iteration before, 0 to begin with
+#define USER_FORMULA_FIRST_TEMPORARY 3
+
+//every op is on complex registers, the ones marked real leave 0 in the imaginary part
+enum FormulaOp
+{
+	FORMULA_OP_CONST,	//Re + Im i
+	FORMULA_OP_ADD,
+	FORMULA_OP_SUB,
+	FORMULA_OP_MUL,
+	FORMULA_OP_MULR,	//A times the real B
+	FORMULA_OP_DIV,
+	FORMULA_OP_DIVR,	//A over the real B
+	FORMULA_OP_SQR,
+	FORMULA_OP_NEG,
+	FORMULA_OP_CONJ,
+	FORMULA_OP_ABS,		//|re| + |im| i, the burning ship fold
+	FORMULA_OP_RE,		//real
+	FORMULA_OP_IM,		//real
+	FORMULA_OP_NORM,	//re^2 + im^2, real
+	FORMULA_OP_MOD,		//real
+	FORMULA_OP_ARG,		//real
+	FORMULA_OP_EXP,
+	FORMULA_OP_LOG,
+	FORMULA_OP_SIN,
+	FORMULA_OP_COS,
+	FORMULA_OP_COPY,	//only for a formula that is z or p as it stands
+	FORMULA_OP_COUNT
+};
+
+struct FormulaInstruction
+{
+	uint8_t Op;
+	uint8_t Dst;	//never one of the operands
+	uint8_t A;
+	uint8_t B;
+	float Re;		//FORMULA_OP_CONST only
+	float Im;
+};
+
+struct UserFormula
+{
+	char Source[USER_FORMULA_MAX_SOURCE];
+	float Bailout;			//|z|^2 a pixel escapes at
+	float Degree;			//highest power of z, for the smooth fraction
+	bool bUsesPrevious;		//p appears, so a cycle has to repeat it too
+	uint32_t RegisterCount;
+	uint32_t SetupCount;	//Instructions[0, SetupCount) run once per pixel
+	uint32_t StepCount;		//the StepCount after them run every iteration
+	uint32_t Result;		//register the step leaves the next z in, never z or p
+	struct FormulaInstruction Instructions[USER_FORMULA_MAX_INSTRUCTIONS];
+};
+
+//z starts at the pixel, c is the pixel for the base set and JuliaPos for the julia
+//set, p is the z before. operators + - * / ^ (an integer power multiplies out, any
+//other goes through exp and log), i, pi, numbers with an optional i suffix and
+//sqr conj abs re im norm mod arg exp log sin cos. false, after saying why on
+//stderr, if Source does not parse or does not fit the bytecode
+bool UserFormulaCompile(const char* Source, float Bailout, struct UserFormula* restrict Formula);
+
+//one op on one lane. the kernels and the constant folding both go through this, so
+//a folded constant is the value the kernel would have computed. Op is a constant
+//at every call in the kernels, which leaves only the one case
+static FORCE_INLINE void ApplyFormulaOp(enum FormulaOp Op, float ar, float ai, float br, float bi, float* restrict Re, float* restrict Im)
+{
+	switch (Op)
+	{
+	case FORMULA_OP_ADD: *Re = ar + br; *Im = ai + bi; break;
+	case FORMULA_OP_SUB: *Re = ar - br; *Im = ai - bi; break;
+	case FORMULA_OP_MUL: *Re = ar * br - ai * bi; *Im = ar * bi + ai * br; break;
+	case FORMULA_OP_MULR: *Re = ar * br; *Im = ai * br; break;
+	case FORMULA_OP_DIV:
+	{
+		const float Denominator = br * br + bi * bi;
+		*Re = (ar * br + ai * bi) / Denominator;
+		*Im = (ai * br - ar * bi) / Denominator;
+		break;
+	}
+	case FORMULA_OP_DIVR: *Re = ar / br; *Im = ai / br; break;
+	case FORMULA_OP_SQR: *Re = ar * ar - ai * ai; *Im = (ar + ar) * ai; break;
+	case FORMULA_OP_NEG: *Re = -ar; *Im = -ai; break;
+	case FORMULA_OP_CONJ: *Re = ar; *Im = -ai; break;
+	case FORMULA_OP_ABS: *Re = fabsf(ar); *Im = fabsf(ai); break;
+	case FORMULA_OP_RE: *Re = ar; *Im = 0.0f; break;
+	case FORMULA_OP_IM: *Re = ai; *Im = 0.0f; break;
+	case FORMULA_OP_NORM: *Re = ar * ar + ai * ai; *Im = 0.0f; break;
+	case FORMULA_OP_MOD: *Re = sqrtf(ar * ar + ai * ai); *Im = 0.0f; break;
+	case FORMULA_OP_ARG: *Re = atan2f(ai, ar); *Im = 0.0f; break;
+	case FORMULA_OP_EXP:
+	{
+		const float Scale = expf(ar);
+		*Re = Scale * cosf(ai);
+		*Im = Scale * sinf(ai);
+		break;
+	}
+	case FORMULA_OP_LOG: *Re = 0.5f * logf(ar * ar + ai * ai); *Im = atan2f(ai, ar); break;
+	case FORMULA_OP_SIN: *Re = sinf(ar) * coshf(ai); *Im = cosf(ar) * sinhf(ai); break;
+	case FORMULA_OP_COS: *Re = cosf(ar) * coshf(ai); *Im = -(sinf(ar) * sinhf(ai)); break;
+	case FORMULA_OP_COPY:
+	default: *Re = ar; *Im = ai; break;
+	}
+}